@@ -0,0 +1,78 @@
+import argparse
+import json
+import sys
+
+
+def load(path):
+    # Map benchmark and metric names to their entries
+    with open(path) as file:
+        results = json.load(file)
+    benchmarks = {entry["name"]: entry for entry in results.get("benchmarks", [])}
+    metrics = {entry["name"]: entry["value"] for entry in results.get("metrics", [])}
+    return benchmarks, metrics
+
+
+def change(before, after):
+    # Relative change in percent, None when it can not be computed
+    if before is None or after is None or before == 0:
+        return None
+    return (after - before) / before * 100.0
+
+
+def main():
+    # Set up argument parsing
+    parser = argparse.ArgumentParser(description="Compare two benchmark runs written with --json")
+    parser.add_argument("baseline", type=str, help="Results of the earlier run, e.g. the last release")
+    parser.add_argument("current", type=str, help="Results of the run to check")
+    parser.add_argument("--field", type=str, default="minMs", choices=["meanMs", "minMs", "maxMs"],
+                        help="Time to compare, the minimum is the least noisy (default: minMs)")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Percent a benchmark may slow down before it counts as a regression (default: 5)")
+    args = parser.parse_args()
+
+    baseBenchmarks, baseMetrics = load(args.baseline)
+    benchmarks, metrics = load(args.current)
+
+    regressions = []
+    print(f"{'Benchmark':<56} {'Baseline':>12} {'Current':>12} {'Change':>9}")
+    for name, entry in benchmarks.items():
+        if name not in baseBenchmarks:
+            print(f"{name:<56} {'-':>12} {entry[args.field]:>12.4f} {'new':>9}")
+            continue
+
+        before = baseBenchmarks[name][args.field]
+        after = entry[args.field]
+        percent = change(before, after)
+        marker = ""
+        if percent is not None and percent > args.threshold:
+            marker = "  SLOWER"
+            regressions.append(name)
+        elif percent is not None and percent < -args.threshold:
+            marker = "  faster"
+
+        shown = f"{percent:+8.1f}%" if percent is not None else f"{'-':>9}"
+        print(f"{name:<56} {before:>12.4f} {after:>12.4f} {shown}{marker}")
+
+    for name in baseBenchmarks:
+        if name not in benchmarks:
+            print(f"{name:<56} {baseBenchmarks[name][args.field]:>12.4f} {'-':>12} {'removed':>9}")
+
+    # Metrics have no direction that is always better, only show how they moved
+    if metrics or baseMetrics:
+        print(f"\n{'Metric':<56} {'Baseline':>12} {'Current':>12} {'Change':>9}")
+        for name in list(baseMetrics) + [name for name in metrics if name not in baseMetrics]:
+            before = baseMetrics.get(name)
+            after = metrics.get(name)
+            percent = change(before, after)
+            beforeText = f"{before:>12.4f}" if before is not None else f"{'-':>12}"
+            afterText = f"{after:>12.4f}" if after is not None else f"{'-':>12}"
+            shown = f"{percent:+8.1f}%" if percent is not None else f"{'-':>9}"
+            print(f"{name:<56} {beforeText} {afterText} {shown}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than {args.threshold}%")
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
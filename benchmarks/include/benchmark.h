@@ -0,0 +1,104 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * A minimal benchmark harness. Runs a function
+ * a number of times after a warm-up run and records
+ * the mean / min / max time per iteration. Results
+ * are kept so they can be printed once all benchmarks
+ * have been run. Benchmarks can also report metrics
+ * that are not times, like cache miss ratios.
+ * Results are written as JSON with writeJson, so runs
+ * of different releases can be compared with
+ * benchmarks/compare.py.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "clock.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+struct BenchmarkResult
+{
+    std::string name;
+    unsigned iterations;
+    double meanMs;
+    double minMs;
+    double maxMs;
+};
+
+struct BenchmarkMetric
+{
+    std::string name;
+    double value;
+};
+
+// Prevent the compiler from optimizing away a value that is otherwise unused
+template<typename T>
+void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    // Tell the compiler the value is read and memory may change, without emitting anything
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const volatile void* volatile sink;
+    sink = &value;
+#endif
+}
+
+class BenchmarkRunner
+{
+public:
+    // Run fn iterations times after one warm-up run and record the result under the name
+    template<typename F>
+    void run(const std::string& name, unsigned iterations, F&& fn);
+
+    // Record a value measured by a benchmark under the name
+    void addMetric(const std::string& name, double value);
+
+    // Get all results recorded so far
+    const std::vector<BenchmarkResult>& getResults() const;
+
+    // Get all metrics recorded so far
+    const std::vector<BenchmarkMetric>& getMetrics() const;
+
+    // Print all results as a table to stdout
+    void print() const;
+
+    // Write all results and metrics as JSON to the file. Returns false on failure
+    bool writeJson(const std::string& filepath) const;
+
+private:
+    // Results recorded so far
+    std::vector<BenchmarkResult> mResults;
+
+    // Metrics recorded so far
+    std::vector<BenchmarkMetric> mMetrics;
+};
+
+template<typename F>
+void BenchmarkRunner::run(const std::string& name, unsigned iterations, F&& fn)
+{
+    // Warm up caches and branch predictors
+    fn();
+
+    BenchmarkResult result{ name, iterations, 0.0, 1e300, 0.0 };
+    for (unsigned i = 0; i != iterations; ++i)
+    {
+        Clock clock;
+        fn();
+        const double ms = clock.timeSinceStart().count() * 1000.0;
+
+        result.meanMs += ms;
+        result.minMs = std::min(result.minMs, ms);
+        result.maxMs = std::max(result.maxMs, ms);
+    }
+    result.meanMs /= std::max(iterations, 1u);
+
+    mResults.push_back(result);
+}
+
+#endif // BENCHMARK_H
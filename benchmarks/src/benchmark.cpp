@@ -0,0 +1,84 @@
+#include "benchmark.h"
+#include "json.h"
+#include "logging.h"
+
+#include <cmath>
+#include <cstdio>
+
+void BenchmarkRunner::addMetric(const std::string& name, double value)
+{
+    mMetrics.push_back(BenchmarkMetric{ name, value });
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::getResults() const
+{
+    return mResults;
+}
+
+const std::vector<BenchmarkMetric>& BenchmarkRunner::getMetrics() const
+{
+    return mMetrics;
+}
+
+void BenchmarkRunner::print() const
+{
+    std::printf("%-48s %10s %12s %12s %12s\n", "Benchmark", "Iterations", "Mean (ms)", "Min (ms)", "Max (ms)");
+    for (const auto& result : mResults)
+    {
+        std::printf("%-48s %10u %12.4f %12.4f %12.4f\n", result.name.c_str(), result.iterations,
+                    result.meanMs, result.minMs, result.maxMs);
+    }
+
+    if (mMetrics.empty()) return;
+
+    std::printf("\n%-48s %12s\n", "Metric", "Value");
+    for (const auto& metric : mMetrics)
+    {
+        std::printf("%-48s %12.4f\n", metric.name.c_str(), metric.value);
+    }
+}
+
+bool BenchmarkRunner::writeJson(const std::string& filepath) const
+{
+    std::FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+    {
+        logErr("Benchmark: Failed to create {}", filepath);
+        return false;
+    }
+
+    std::fputs("{\n\"benchmarks\": [", file);
+    for (size_t i = 0; i != mResults.size(); ++i)
+    {
+        const auto& result = mResults[i];
+        std::fputs(i == 0 ? "\n  {\"name\": " : ",\n  {\"name\": ", file);
+        writeJsonString(file, result.name);
+        std::fprintf(file, ", \"iterations\": %u, \"meanMs\": %.6f, \"minMs\": %.6f, \"maxMs\": %.6f}",
+                     result.iterations, result.meanMs, result.minMs, result.maxMs);
+    }
+
+    std::fputs("\n],\n\"metrics\": [", file);
+    for (size_t i = 0; i != mMetrics.size(); ++i)
+    {
+        std::fputs(i == 0 ? "\n  {\"name\": " : ",\n  {\"name\": ", file);
+        writeJsonString(file, mMetrics[i].name);
+
+        // JSON has no NaN or infinity, e.g. a ratio of a benchmark that took no time
+        if (std::isfinite(mMetrics[i].value))
+            std::fprintf(file, ", \"value\": %.6f}", mMetrics[i].value);
+        else
+            std::fputs(", \"value\": null}", file);
+    }
+    std::fputs("\n]\n}\n", file);
+
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if (failed)
+    {
+        logErr("Benchmark: Failed to write {}", filepath);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+#include "benchmark.h"
+#include "bvh.h"
+#include "cullingList.h"
+#include "frustum.h"
+#include "randomEngine.h"
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+void runCullingBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr unsigned ObjectCount = 1'000'000;
+
+    // Spread spheres in a large volume, so that roughly a fraction of them is visible
+    RandomEngine random;
+    std::vector<BoundingSphere> spheres;
+    spheres.reserve(ObjectCount);
+    for (unsigned i = 0; i != ObjectCount; ++i)
+    {
+        const glm::vec3 center(random.uniform(-1000.0, 1000.0), random.uniform(-1000.0, 1000.0), random.uniform(-1000.0, 1000.0));
+        spheres.push_back(BoundingSphere{ center, static_cast<float>(random.uniform(0.5, 5.0)) });
+    }
+
+    const glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 512.f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    const Frustum frustum(proj * view);
+
+    std::vector<unsigned> visible;
+    visible.reserve(ObjectCount);
+
+    runner.run("Culling/Scalar/1M spheres", 20, [&]()
+    {
+        visible.clear();
+        for (unsigned i = 0; i != ObjectCount; ++i)
+        {
+            if (frustum.intersects(spheres[i]))
+                visible.push_back(i);
+        }
+        doNotOptimize(visible.size());
+    });
+
+    CullingList list;
+    list.reserve(ObjectCount);
+    for (const auto& sphere : spheres)
+    {
+        list.add(sphere);
+    }
+
+    runner.run("Culling/CullingList (SIMD)/1M spheres", 20, [&]()
+    {
+        visible.clear();
+        list.cull(frustum, visible);
+        doNotOptimize(visible.size());
+    });
+
+    // Hierarchy versus linear iteration over the boxes of a city sized scene
+    constexpr unsigned SceneSize = 100'000;
+    std::vector<AABB> boxes;
+    boxes.reserve(SceneSize);
+    for (unsigned i = 0; i != SceneSize; ++i)
+    {
+        const auto& sphere = spheres[i];
+        boxes.push_back(AABB{ sphere.center - glm::vec3(sphere.radius), sphere.center + glm::vec3(sphere.radius) });
+    }
+
+    runner.run("Culling/Linear AABB/100k boxes", 20, [&]()
+    {
+        visible.clear();
+        for (unsigned i = 0; i != SceneSize; ++i)
+        {
+            if (frustum.intersects(boxes[i]))
+                visible.push_back(i);
+        }
+        doNotOptimize(visible.size());
+    });
+
+    BVH hierarchy;
+    runner.run("Culling/BVH build/100k boxes", 5, [&]()
+    {
+        hierarchy.build(boxes);
+        doNotOptimize(hierarchy.nodeCount());
+    });
+
+    runner.run("Culling/BVH query/100k boxes", 20, [&]()
+    {
+        visible.clear();
+        hierarchy.queryFrustum(frustum, visible);
+        doNotOptimize(visible.size());
+    });
+
+    runner.run("Culling/BVH refit/100k boxes", 20, [&]()
+    {
+        hierarchy.refit();
+        doNotOptimize(hierarchy.nodeCount());
+    });
+}
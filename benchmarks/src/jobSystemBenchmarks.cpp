@@ -0,0 +1,89 @@
+#include "benchmark.h"
+#include "cullingList.h"
+#include "frustum.h"
+#include "jobSystem.h"
+#include "randomEngine.h"
+
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+void runJobSystemBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr unsigned ObjectCount = 1'000'000;
+    constexpr unsigned MaxThreads = 32;
+
+    // More threads than the hardware runs only measures time slicing
+    const unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    RandomEngine random;
+    CullingList list;
+    list.reserve(ObjectCount);
+    for (unsigned i = 0; i != ObjectCount; ++i)
+    {
+        const glm::vec3 center(random.uniform(-1000.0, 1000.0), random.uniform(-1000.0, 1000.0), random.uniform(-1000.0, 1000.0));
+        list.add(BoundingSphere{ center, static_cast<float>(random.uniform(0.5, 5.0)) });
+    }
+
+    const glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 512.f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    const Frustum frustum(proj * view);
+
+    std::vector<unsigned> visible;
+    visible.reserve(ObjectCount);
+    std::vector<float> values(ObjectCount);
+
+    double baseCompute = 0.0;
+    double baseCulling = 0.0;
+    for (unsigned threads = 1; threads <= std::min(MaxThreads, hardwareThreads); threads *= 2)
+    {
+        JobSystem jobs(threads - 1);
+        const std::string suffix = "/" + std::to_string(threads) + " threads";
+
+        // Compute bound loop with automatic grain, scales with the cores as long as memory keeps up
+        runner.run("JobSystem/parallelFor 1M" + suffix, 20, [&]()
+        {
+            jobs.parallelFor(0, ObjectCount, 0, [&](unsigned begin, unsigned end)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                {
+                    values[i] = std::sqrt(static_cast<float>(i)) * std::sin(static_cast<float>(i));
+                }
+            });
+            doNotOptimize(values[ObjectCount / 2]);
+        });
+        const double compute = runner.getResults().back().meanMs;
+
+        runner.run("JobSystem/CullingList 1M spheres" + suffix, 20, [&]()
+        {
+            visible.clear();
+            list.cull(frustum, visible, jobs);
+            doNotOptimize(visible.size());
+        });
+        const double culling = runner.getResults().back().meanMs;
+
+        if (threads == 1)
+        {
+            baseCompute = compute;
+            baseCulling = culling;
+        }
+        runner.addMetric("JobSystem/parallelFor speedup" + suffix, baseCompute / compute);
+        runner.addMetric("JobSystem/CullingList speedup" + suffix, baseCulling / culling);
+    }
+
+    // Many tiny jobs, measures the scheduling overhead itself
+    JobSystem jobs;
+    runner.run("JobSystem/10k empty jobs/" + std::to_string(jobs.getThreadCount()) + " threads", 20, [&]()
+    {
+        JobCounter counter;
+        for (unsigned i = 0; i != 10'000; ++i)
+        {
+            jobs.run([]() {}, counter);
+        }
+        jobs.wait(counter);
+    });
+}
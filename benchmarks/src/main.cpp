@@ -0,0 +1,51 @@
+#include "benchmark.h"
+#include "logging.h"
+
+#include <cstring>
+
+// Benchmark groups, defined in their own translation units
+void runCullingBenchmarks(BenchmarkRunner& runner);
+void runTessellationBenchmarks(BenchmarkRunner& runner);
+void runMeshOptimizerBenchmarks(BenchmarkRunner& runner);
+void runJobSystemBenchmarks(BenchmarkRunner& runner);
+void runMathBenchmarks(BenchmarkRunner& runner);
+void runResourceBenchmarks(BenchmarkRunner& runner);
+void runRenderingBenchmarks(BenchmarkRunner& runner);
+
+// Usage: OpenGLRenderingBenchmarks [--json results.json]
+int main(int argc, char** argv)
+{
+    // The engine code logs through the DEBUG logger, only show warnings and up
+    auto debugLog = initLogging(false);
+    debugLog->set_level(spdlog::level::warn);
+
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            logWarn("Benchmark: Unknown argument {}, usage: {} [--json results.json]", argv[i], argv[0]);
+        }
+    }
+
+    BenchmarkRunner runner;
+    runCullingBenchmarks(runner);
+    runTessellationBenchmarks(runner);
+    runMeshOptimizerBenchmarks(runner);
+    runJobSystemBenchmarks(runner);
+    runMathBenchmarks(runner);
+    runResourceBenchmarks(runner);
+    runRenderingBenchmarks(runner);
+    runner.print();
+
+    if (jsonPath && !runner.writeJson(jsonPath))
+    {
+        return 1;
+    }
+
+    return 0;
+}
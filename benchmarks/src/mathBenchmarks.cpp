@@ -0,0 +1,137 @@
+#include "benchmark.h"
+#include "interpolation.h"
+#include "linalg.h"
+#include "randomEngine.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+void runMathBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr unsigned MatrixCount = 10'000;
+    constexpr unsigned SampleCount = 1'000'000;
+
+    RandomEngine random;
+
+    // Model matrices as the application builds them, multiplied pairwise so every product is independent
+    std::vector<matM<float, 4>> lhs;
+    std::vector<matM<float, 4>> rhs;
+    std::vector<glm::mat4> glmLhs;
+    std::vector<glm::mat4> glmRhs;
+    for (unsigned i = 0; i != MatrixCount; ++i)
+    {
+        const auto x = static_cast<float>(random.uniform(-100.0, 100.0));
+        const auto y = static_cast<float>(random.uniform(-100.0, 100.0));
+        const auto angle = static_cast<float>(random.uniform(0.0, 360.0));
+
+        lhs.push_back(matM<float, 4>::translate(x, y, 0.f));
+        rhs.push_back(matM<float, 4>::rotate(angle, 0.f, 0.f, 1.f));
+        glmLhs.push_back(glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.f)));
+        glmRhs.push_back(glm::rotate(glm::mat4(1.f), glm::radians(angle), glm::vec3(0.f, 0.f, 1.f)));
+    }
+
+    std::vector<matM<float, 4>> products(MatrixCount);
+    runner.run("Linalg/matM4 multiply 10k", 100, [&]()
+    {
+        for (unsigned i = 0; i != MatrixCount; ++i)
+        {
+            products[i] = lhs[i] * rhs[i];
+        }
+        doNotOptimize(products[MatrixCount / 2]);
+    });
+
+    // The same products with glm as a reference for the hand written matrices
+    std::vector<glm::mat4> glmProducts(MatrixCount);
+    runner.run("Linalg/glm mat4 multiply 10k (reference)", 100, [&]()
+    {
+        for (unsigned i = 0; i != MatrixCount; ++i)
+        {
+            glmProducts[i] = glmLhs[i] * glmRhs[i];
+        }
+        doNotOptimize(glmProducts[MatrixCount / 2]);
+    });
+
+    std::vector<float> samples(SampleCount);
+    for (auto& t : samples)
+    {
+        t = static_cast<float>(random.uniform(0.0, 1.0));
+    }
+
+    // The blend functions are called through a pointer, as animations pick them at runtime
+    const std::pair<const char*, BlendFunctionPtr> blends[] = {
+        { "Linear", blendLinear },
+        { "Quadratic", blendQuadratic },
+        { "SquareRoot", blendSquareRoot },
+        { "SmoothStepI", blendSmoothStepI },
+        { "SmoothStepII", blendSmoothStepII },
+    };
+
+    for (const auto& blend : blends)
+    {
+        runner.run(std::string("Interpolation/lerp ") + blend.first + " 1M", 20, [&]()
+        {
+            float sum = 0.f;
+            for (const float t : samples)
+            {
+                sum += lerp(0.f, 10.f, t, blend.second);
+            }
+            doNotOptimize(sum);
+        });
+    }
+
+    runner.run("Interpolation/cubic vec2 1M", 20, [&]()
+    {
+        glm::vec2 sum(0.f);
+        for (const float t : samples)
+        {
+            sum += cubic(glm::vec2(0.f, 0.f), glm::vec2(1.f, 3.f), glm::vec2(2.f, -3.f), glm::vec2(3.f, 0.f), t, blendSmoothStepI);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("RandomEngine/uniform int 1M", 20, [&]()
+    {
+        int sum = 0;
+        for (unsigned i = 0; i != SampleCount; ++i)
+        {
+            sum += random.uniform(0, 1000);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("RandomEngine/uniform real 1M", 20, [&]()
+    {
+        double sum = 0.0;
+        for (unsigned i = 0; i != SampleCount; ++i)
+        {
+            sum += random.uniform(0.0, 1.0);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("RandomEngine/normal 1M", 20, [&]()
+    {
+        double sum = 0.0;
+        for (unsigned i = 0; i != SampleCount; ++i)
+        {
+            sum += random.normal(0.0, 1.0);
+        }
+        doNotOptimize(sum);
+    });
+
+    std::vector<unsigned> deck(SampleCount);
+    for (unsigned i = 0; i != SampleCount; ++i)
+    {
+        deck[i] = i;
+    }
+
+    runner.run("RandomEngine/shuffle 1M", 20, [&]()
+    {
+        random.shuffle(deck.begin(), deck.end());
+        doNotOptimize(deck.front());
+    });
+}
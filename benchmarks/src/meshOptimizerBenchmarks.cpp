@@ -0,0 +1,98 @@
+#include "benchmark.h"
+#include "meshOptimizer.h"
+#include "randomEngine.h"
+#include "vertex.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    // A grid of size x size quads, with the triangles in random order like an unoptimized export
+    void makeShuffledGrid(unsigned size, std::vector<Vertex>& vertices, std::vector<unsigned>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        for (unsigned y = 0; y <= size; ++y)
+        {
+            for (unsigned x = 0; x <= size; ++x)
+            {
+                vertices.push_back({ static_cast<float>(x), static_cast<float>(y), 0.f, 1.f, 1.f, 1.f, 0.f, 0.f });
+            }
+        }
+
+        std::vector<unsigned> triangles;
+        for (unsigned y = 0; y < size; ++y)
+        {
+            for (unsigned x = 0; x < size; ++x)
+            {
+                const unsigned corner = y * (size + 1) + x;
+                triangles.push_back(corner);
+                triangles.push_back(corner + 1);
+                triangles.push_back(corner + size + 2);
+                triangles.push_back(corner + size + 2);
+                triangles.push_back(corner + size + 1);
+                triangles.push_back(corner);
+            }
+        }
+
+        RandomEngine random;
+        std::vector<unsigned> order(static_cast<unsigned>(triangles.size() / 3));
+        for (unsigned i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        for (unsigned i = static_cast<unsigned>(order.size()) - 1; i > 0; --i)
+        {
+            std::swap(order[i], order[static_cast<unsigned>(random.uniform(0, static_cast<int>(i)))]);
+        }
+
+        for (const auto t : order)
+        {
+            indices.insert(indices.end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3);
+        }
+    }
+}
+
+void runMeshOptimizerBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr unsigned GridSize = 256;
+
+    std::vector<Vertex> sourceVertices;
+    std::vector<unsigned> sourceIndices;
+    makeShuffledGrid(GridSize, sourceVertices, sourceIndices);
+    const auto vertexCount = static_cast<unsigned>(sourceVertices.size());
+    const auto indexCount = static_cast<unsigned>(sourceIndices.size());
+
+    runner.addMetric("MeshOptimizer/ACMR shuffled grid", analyzeVertexCache(sourceIndices.data(), indexCount, vertexCount).acmr);
+
+    std::vector<unsigned> indices;
+    runner.run("MeshOptimizer/Vertex cache/256x256 grid", 5, [&]()
+    {
+        indices = sourceIndices;
+        optimizeVertexCache(indices.data(), indexCount, vertexCount);
+        doNotOptimize(indices.data());
+    });
+
+    const auto optimized = analyzeVertexCache(indices.data(), indexCount, vertexCount);
+    runner.addMetric("MeshOptimizer/ACMR after vertex cache", optimized.acmr);
+    runner.addMetric("MeshOptimizer/ATVR after vertex cache", optimized.atvr);
+
+    std::vector<unsigned> overdrawIndices;
+    runner.run("MeshOptimizer/Overdraw/256x256 grid", 5, [&]()
+    {
+        overdrawIndices = indices;
+        optimizeOverdraw(overdrawIndices.data(), indexCount, sourceVertices.data(), sizeof(Vertex), vertexCount);
+        doNotOptimize(overdrawIndices.data());
+    });
+    runner.addMetric("MeshOptimizer/ACMR after overdraw", analyzeVertexCache(overdrawIndices.data(), indexCount, vertexCount).acmr);
+
+    std::vector<Vertex> vertices;
+    runner.run("MeshOptimizer/Vertex fetch/256x256 grid", 5, [&]()
+    {
+        vertices = sourceVertices;
+        overdrawIndices = indices;
+        optimizeVertexFetch(vertices.data(), vertexCount, sizeof(Vertex), overdrawIndices.data(), indexCount);
+        doNotOptimize(vertices.data());
+    });
+}
@@ -0,0 +1,164 @@
+#include "benchmark.h"
+#include "glBackend.h"
+#include "headlessContext.h"
+#include "logging.h"
+#include "renderBatch.h"
+#include "shader.h"
+#include "shapes.h"
+
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace
+{
+    constexpr unsigned ShapeCount = 1000;
+    constexpr unsigned RetainedCount = 10'000;
+    constexpr unsigned UniformCount = 10'000;
+
+    // Run the benchmarks on the current GL backend, the suffix tells the backends apart
+    void runGLBenchmarks(BenchmarkRunner& runner, const std::string& suffix)
+    {
+        // Kept alive so the quads below find its geometry in the cache
+        const Quad quad(glm::vec2(1.f), glm::vec3(1.f, 0.5f, 0.f));
+
+        runner.run("Shape2D/Quad cached 1k" + suffix, 100, [&]()
+        {
+            for (unsigned i = 0; i != ShapeCount; ++i)
+            {
+                const Quad copy(glm::vec2(1.f), glm::vec3(1.f, 0.5f, 0.f));
+                doNotOptimize(copy);
+            }
+        });
+
+        // Every circle is different, so each tessellates and uploads its own geometry
+        unsigned circleSeed = 0;
+        runner.run("Shape2D/Circle 32 points uncached 1k" + suffix, 10, [&]()
+        {
+            for (unsigned i = 0; i != ShapeCount; ++i)
+            {
+                const Circle circle(1.f + static_cast<float>(++circleSeed) * 1e-4f, 32, glm::vec3(1.f));
+                doNotOptimize(circle);
+            }
+        });
+
+        const Circle circle(1.f, 32, glm::vec3(0.f, 0.5f, 1.f));
+        RenderBatch batch;
+
+        runner.run("RenderBatch/push 1k quads" + suffix, 100, [&]()
+        {
+            batch.clear();
+            for (unsigned i = 0; i != ShapeCount; ++i)
+            {
+                batch.push(quad);
+            }
+            doNotOptimize(batch);
+        });
+
+        runner.run("RenderBatch/push+commit 1k quads" + suffix, 100, [&]()
+        {
+            batch.clear();
+            for (unsigned i = 0; i != ShapeCount; ++i)
+            {
+                batch.push(quad);
+            }
+            batch.commit();
+        });
+
+        runner.run("RenderBatch/push+commit 1k circles" + suffix, 100, [&]()
+        {
+            batch.clear();
+            for (unsigned i = 0; i != ShapeCount; ++i)
+            {
+                batch.push(circle);
+            }
+            batch.commit();
+        });
+
+        // A retained batch only uploads what changed, here one element in a hundred per commit
+        RenderBatch retained;
+        std::vector<BatchHandle> handles;
+        for (unsigned i = 0; i != RetainedCount; ++i)
+        {
+            handles.push_back(retained.add(quad));
+        }
+        retained.commit();
+
+        std::vector<Vertex> moved = quad.getGeometry()->vertices;
+        unsigned updateOffset = 0;
+        runner.run("RenderBatch/retained update 1% + commit of 10k quads" + suffix, 100, [&]()
+        {
+            for (auto& vertex : moved)
+            {
+                vertex.x += 0.01f;
+            }
+
+            for (unsigned i = 0; i != RetainedCount / 100; ++i)
+            {
+                retained.update(handles[(updateOffset + i * 100) % RetainedCount], moved);
+            }
+            ++updateOffset;
+            retained.commit();
+        });
+
+        Shader shader(std::string(BENCHMARK_RESOURCE_DIR) + "/vertex.vert", std::string(BENCHMARK_RESOURCE_DIR) + "/frag.frag");
+        shader.bind();
+
+        // Uniforms are looked up by name on every set, the cost is the cache lookup plus the GL call
+        const glm::mat4 mvp = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+        runner.run("Shader/setUniformMat4 10k" + suffix, 100, [&]()
+        {
+            for (unsigned i = 0; i != UniformCount; ++i)
+            {
+                shader.setUniformMat4("mvpMatrix", mvp);
+            }
+        });
+
+        runner.run("Shader/setUniform1i 10k" + suffix, 100, [&]()
+        {
+            for (unsigned i = 0; i != UniformCount; ++i)
+            {
+                shader.setUniform1i("textures", 0);
+            }
+        });
+
+        shader.unbind();
+    }
+}
+
+void runRenderingBenchmarks(BenchmarkRunner& runner)
+{
+    // The context has to outlive every GL object made with it
+    HeadlessContext context;
+    if (context.isValid())
+    {
+        runGLBenchmarks(runner, "");
+    }
+    else
+    {
+        logWarn("Benchmark: No {} GL context, only running the rendering benchmarks on the null backend",
+                HeadlessContext::isSupported() ? "headless" : "EGL support for a headless");
+    }
+
+    // Without the driver all that is left is what the engine spends submitting
+    GLBackend::useNull();
+    runGLBenchmarks(runner, " (null GL)");
+
+    // Objects made on the null backend have to be gone before switching back to the driver
+    {
+        const Quad quad(glm::vec2(1.f), glm::vec3(1.f, 0.5f, 0.f));
+        RenderBatch batch;
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            batch.push(quad);
+        }
+
+        GLBackend::resetCallCounts();
+        batch.commit();
+        runner.addMetric("RenderBatch/GL calls per commit of 1k quads", static_cast<double>(GLBackend::getTotalCallCount()));
+    }
+
+    GLBackend::useDriver();
+}
@@ -0,0 +1,89 @@
+#include "benchmark.h"
+#include "files.h"
+#include "logging.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "spdlog/fmt/fmt.h"
+#include "stb_image.h"
+
+namespace
+{
+    // Resources are read from the source tree, the benchmarks do not copy or pack res/
+    std::string resourceFile(const std::string& name)
+    {
+        return std::string(BENCHMARK_RESOURCE_DIR) + "/" + name;
+    }
+}
+
+void runResourceBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr size_t LargeFileSize = 16 * 1024 * 1024;
+    constexpr size_t PageSize = 4096;
+    const std::string largeFile = "benchmarkLargeFile.bin";
+
+    {
+        std::vector<char> data(LargeFileSize);
+        for (size_t i = 0; i != data.size(); ++i)
+        {
+            data[i] = static_cast<char>(i * 31);
+        }
+
+        std::ofstream out(largeFile, std::ios::binary);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    const std::string shaderFile = resourceFile("vertex.vert");
+    runner.run("Files/readFile shader", 1000, [&]()
+    {
+        const auto source = readFile(shaderFile);
+        doNotOptimize(source);
+    });
+
+    runner.run("Files/readFile 16MB", 20, [&]()
+    {
+        const auto contents = readFile(largeFile);
+        doNotOptimize(contents);
+    });
+
+    // Mapped files are only read where they are touched, touch every page to compare with readFile
+    runner.run("Files/openFile 16MB touch pages", 20, [&]()
+    {
+        const FileView file = openFile(largeFile);
+        char sum = 0;
+        for (size_t i = 0; i < file.size(); i += PageSize)
+        {
+            sum += file.data()[i];
+        }
+        doNotOptimize(sum);
+    });
+
+    std::remove(largeFile.c_str());
+
+    // Decoded to RGBA from memory, the way Texture loads them
+    for (const auto& name : { "concrete.png", "highrise.png", "noisemap.png" })
+    {
+        const FileView file = openFile(resourceFile(name));
+
+        int width, height, comp;
+        unsigned char* probe = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()),
+                                                     &width, &height, &comp, STBI_rgb_alpha);
+        if (!probe)
+        {
+            logWarn("Benchmark: Can not decode {} ({}), skipping it", name, stbi_failure_reason());
+            continue;
+        }
+        stbi_image_free(probe);
+
+        runner.run(fmt::format("Texture/decode {} {}x{}", name, width, height), 50, [&]()
+        {
+            unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()),
+                                                          &width, &height, &comp, STBI_rgb_alpha);
+            doNotOptimize(pixels[0]);
+            stbi_image_free(pixels);
+        });
+    }
+}
@@ -0,0 +1,133 @@
+#include "benchmark.h"
+#include "tessellation.h"
+#include "vertex.h"
+
+#include <cmath>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace
+{
+    // The vertex generation Circle used before the Tessellator: Two sin / cos pairs per point, one push per vertex
+    void legacyCircle(std::vector<Vertex>& vertices, std::vector<unsigned>& indices, float radius, unsigned points, const glm::vec3& col)
+    {
+        const auto first = static_cast<unsigned>(vertices.size());
+        vertices.push_back({ 0.f, 0.f, 0.f, col.r, col.g, col.b, 0.5f, 0.5f });
+
+        constexpr float PI = 3.14156f;
+        for (unsigned i = 0; i <= points; ++i)
+        {
+            auto x = std::cos((2 * PI / points) * i) * (radius * 2);
+            auto y = std::sin((2 * PI / points) * i) * (radius * 2);
+
+            auto u = std::cos(((2 * PI / points) * i) + 1.f) / 2.f;
+            auto v = std::sin(((2 * PI / points) * i) + 1.f) / 2.f;
+
+            vertices.push_back({ x, y, 0.f, col.r, col.g, col.b, u, v });
+        }
+
+        for (unsigned i = 0; i < points; ++i)
+        {
+            indices.push_back(first);
+            indices.push_back(first + i + 2);
+            indices.push_back(first + i + 1);
+        }
+    }
+}
+
+void runTessellationBenchmarks(BenchmarkRunner& runner)
+{
+    constexpr unsigned ShapeCount = 10'000;
+    constexpr unsigned Segments = 64;
+    const glm::vec3 color(0.88f, 0.4f, 0.1f);
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned> indices;
+    vertices.reserve(ShapeCount * (Segments + 2));
+    indices.reserve(ShapeCount * Segments * 3);
+
+    runner.run("Tessellation/Legacy Circle/10k x 64 segments", 20, [&]()
+    {
+        vertices.clear();
+        indices.clear();
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            legacyCircle(vertices, indices, 10.f, Segments, color);
+        }
+        doNotOptimize(vertices.size());
+    });
+
+    Tessellator<Vertex> tessellator(vertices, indices);
+    runner.run("Tessellation/Circle/10k x 64 segments", 20, [&]()
+    {
+        vertices.clear();
+        indices.clear();
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            tessellator.circle(glm::vec2(static_cast<float>(i), 0.f), 10.f, Segments, color);
+        }
+        doNotOptimize(vertices.size());
+    });
+
+    std::vector<CompactVertex> compactVertices;
+    std::vector<unsigned> compactIndices;
+    Tessellator<CompactVertex> compactTessellator(compactVertices, compactIndices);
+    runner.run("Tessellation/Circle (compact)/10k x 64 segments", 20, [&]()
+    {
+        compactVertices.clear();
+        compactIndices.clear();
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            compactTessellator.circle(glm::vec2(static_cast<float>(i), 0.f), 10.f, Segments, color);
+        }
+        doNotOptimize(compactVertices.size());
+    });
+
+    runner.run("Tessellation/Arc/10k x 64 segments", 20, [&]()
+    {
+        vertices.clear();
+        indices.clear();
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            tessellator.arc(glm::vec2(static_cast<float>(i), 0.f), 10.f, 2.f, 0.f, 4.f, Segments, color);
+        }
+        doNotOptimize(vertices.size());
+    });
+
+    runner.run("Tessellation/Rounded rect/10k x 8 segment corners", 20, [&]()
+    {
+        vertices.clear();
+        indices.clear();
+        for (unsigned i = 0; i != ShapeCount; ++i)
+        {
+            tessellator.roundedRect(glm::vec2(static_cast<float>(i), 0.f), glm::vec2(40.f, 20.f), 5.f, 8, color);
+        }
+        doNotOptimize(vertices.size());
+    });
+
+    // A zig-zag exercising a join at every point
+    std::vector<glm::vec2> points;
+    for (unsigned i = 0; i != 1000; ++i)
+    {
+        points.emplace_back(static_cast<float>(i) * 4.f, (i % 2) * 4.f);
+    }
+
+    const std::pair<const char*, ELineJoin> joins[] = {
+        { "Tessellation/Polyline miter/100 x 1000 points", ELineJoin::Miter },
+        { "Tessellation/Polyline bevel/100 x 1000 points", ELineJoin::Bevel },
+        { "Tessellation/Polyline round/100 x 1000 points", ELineJoin::Round } };
+    for (const auto& join : joins)
+    {
+        runner.run(join.first, 20, [&]()
+        {
+            vertices.clear();
+            indices.clear();
+            for (unsigned i = 0; i != 100; ++i)
+            {
+                tessellator.polyline(points.data(), static_cast<unsigned>(points.size()), 1.5f, join.second, false, color);
+            }
+            doNotOptimize(vertices.size());
+        });
+    }
+}
@@ -2230,6 +2230,9 @@ typedef unsigned int GLhandleARB;
 			namespace sys
 			{
 				void CheckExtensions();
+
+				// Resolve functions with loader instead of the platform's loader, e.g. eglGetProcAddress
+				void SetProcAddressLoader(void* (*loader)(const char *name));
 				
 			}
 		}
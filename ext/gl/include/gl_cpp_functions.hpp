@@ -0,0 +1,692 @@
+/* Every function of gl_cpp.hpp in declaration order, for code that handles all of them
+ * (see glBackend.h). Define GL_FUNCTION(name) before including, the file undefines nothing.
+ * Regenerate it together with gl_cpp.hpp. */
+
+// Extension: 1.0
+GL_FUNCTION(BlendFunc)
+GL_FUNCTION(Clear)
+GL_FUNCTION(ClearColor)
+GL_FUNCTION(ClearDepth)
+GL_FUNCTION(ClearStencil)
+GL_FUNCTION(ColorMask)
+GL_FUNCTION(CullFace)
+GL_FUNCTION(DepthFunc)
+GL_FUNCTION(DepthMask)
+GL_FUNCTION(DepthRange)
+GL_FUNCTION(Disable)
+GL_FUNCTION(DrawBuffer)
+GL_FUNCTION(Enable)
+GL_FUNCTION(Finish)
+GL_FUNCTION(Flush)
+GL_FUNCTION(FrontFace)
+GL_FUNCTION(GetBooleanv)
+GL_FUNCTION(GetDoublev)
+GL_FUNCTION(GetError)
+GL_FUNCTION(GetFloatv)
+GL_FUNCTION(GetIntegerv)
+GL_FUNCTION(GetString)
+GL_FUNCTION(GetTexImage)
+GL_FUNCTION(GetTexLevelParameterfv)
+GL_FUNCTION(GetTexLevelParameteriv)
+GL_FUNCTION(GetTexParameterfv)
+GL_FUNCTION(GetTexParameteriv)
+GL_FUNCTION(Hint)
+GL_FUNCTION(IsEnabled)
+GL_FUNCTION(LineWidth)
+GL_FUNCTION(LogicOp)
+GL_FUNCTION(PixelStoref)
+GL_FUNCTION(PixelStorei)
+GL_FUNCTION(PointSize)
+GL_FUNCTION(PolygonMode)
+GL_FUNCTION(ReadBuffer)
+GL_FUNCTION(ReadPixels)
+GL_FUNCTION(Scissor)
+GL_FUNCTION(StencilFunc)
+GL_FUNCTION(StencilMask)
+GL_FUNCTION(StencilOp)
+GL_FUNCTION(TexImage1D)
+GL_FUNCTION(TexImage2D)
+GL_FUNCTION(TexParameterf)
+GL_FUNCTION(TexParameterfv)
+GL_FUNCTION(TexParameteri)
+GL_FUNCTION(TexParameteriv)
+GL_FUNCTION(Viewport)
+
+// Extension: 1.1
+GL_FUNCTION(BindTexture)
+GL_FUNCTION(CopyTexImage1D)
+GL_FUNCTION(CopyTexImage2D)
+GL_FUNCTION(CopyTexSubImage1D)
+GL_FUNCTION(CopyTexSubImage2D)
+GL_FUNCTION(DeleteTextures)
+GL_FUNCTION(DrawArrays)
+GL_FUNCTION(DrawElements)
+GL_FUNCTION(GenTextures)
+GL_FUNCTION(GetPointerv)
+GL_FUNCTION(IsTexture)
+GL_FUNCTION(PolygonOffset)
+GL_FUNCTION(TexSubImage1D)
+GL_FUNCTION(TexSubImage2D)
+
+// Extension: 1.2
+GL_FUNCTION(CopyTexSubImage3D)
+GL_FUNCTION(DrawRangeElements)
+GL_FUNCTION(TexImage3D)
+GL_FUNCTION(TexSubImage3D)
+
+// Extension: 1.3
+GL_FUNCTION(ActiveTexture)
+GL_FUNCTION(CompressedTexImage1D)
+GL_FUNCTION(CompressedTexImage2D)
+GL_FUNCTION(CompressedTexImage3D)
+GL_FUNCTION(CompressedTexSubImage1D)
+GL_FUNCTION(CompressedTexSubImage2D)
+GL_FUNCTION(CompressedTexSubImage3D)
+GL_FUNCTION(GetCompressedTexImage)
+GL_FUNCTION(SampleCoverage)
+
+// Extension: 1.4
+GL_FUNCTION(BlendColor)
+GL_FUNCTION(BlendEquation)
+GL_FUNCTION(BlendFuncSeparate)
+GL_FUNCTION(MultiDrawArrays)
+GL_FUNCTION(MultiDrawElements)
+GL_FUNCTION(PointParameterf)
+GL_FUNCTION(PointParameterfv)
+GL_FUNCTION(PointParameteri)
+GL_FUNCTION(PointParameteriv)
+
+// Extension: 1.5
+GL_FUNCTION(BeginQuery)
+GL_FUNCTION(BindBuffer)
+GL_FUNCTION(BufferData)
+GL_FUNCTION(BufferSubData)
+GL_FUNCTION(DeleteBuffers)
+GL_FUNCTION(DeleteQueries)
+GL_FUNCTION(EndQuery)
+GL_FUNCTION(GenBuffers)
+GL_FUNCTION(GenQueries)
+GL_FUNCTION(GetBufferParameteriv)
+GL_FUNCTION(GetBufferPointerv)
+GL_FUNCTION(GetBufferSubData)
+GL_FUNCTION(GetQueryObjectiv)
+GL_FUNCTION(GetQueryObjectuiv)
+GL_FUNCTION(GetQueryiv)
+GL_FUNCTION(IsBuffer)
+GL_FUNCTION(IsQuery)
+GL_FUNCTION(MapBuffer)
+GL_FUNCTION(UnmapBuffer)
+
+// Extension: 2.0
+GL_FUNCTION(AttachShader)
+GL_FUNCTION(BindAttribLocation)
+GL_FUNCTION(BlendEquationSeparate)
+GL_FUNCTION(CompileShader)
+GL_FUNCTION(CreateProgram)
+GL_FUNCTION(CreateShader)
+GL_FUNCTION(DeleteProgram)
+GL_FUNCTION(DeleteShader)
+GL_FUNCTION(DetachShader)
+GL_FUNCTION(DisableVertexAttribArray)
+GL_FUNCTION(DrawBuffers)
+GL_FUNCTION(EnableVertexAttribArray)
+GL_FUNCTION(GetActiveAttrib)
+GL_FUNCTION(GetActiveUniform)
+GL_FUNCTION(GetAttachedShaders)
+GL_FUNCTION(GetAttribLocation)
+GL_FUNCTION(GetProgramInfoLog)
+GL_FUNCTION(GetProgramiv)
+GL_FUNCTION(GetShaderInfoLog)
+GL_FUNCTION(GetShaderSource)
+GL_FUNCTION(GetShaderiv)
+GL_FUNCTION(GetUniformLocation)
+GL_FUNCTION(GetUniformfv)
+GL_FUNCTION(GetUniformiv)
+GL_FUNCTION(GetVertexAttribPointerv)
+GL_FUNCTION(GetVertexAttribdv)
+GL_FUNCTION(GetVertexAttribfv)
+GL_FUNCTION(GetVertexAttribiv)
+GL_FUNCTION(IsProgram)
+GL_FUNCTION(IsShader)
+GL_FUNCTION(LinkProgram)
+GL_FUNCTION(ShaderSource)
+GL_FUNCTION(StencilFuncSeparate)
+GL_FUNCTION(StencilMaskSeparate)
+GL_FUNCTION(StencilOpSeparate)
+GL_FUNCTION(Uniform1f)
+GL_FUNCTION(Uniform1fv)
+GL_FUNCTION(Uniform1i)
+GL_FUNCTION(Uniform1iv)
+GL_FUNCTION(Uniform2f)
+GL_FUNCTION(Uniform2fv)
+GL_FUNCTION(Uniform2i)
+GL_FUNCTION(Uniform2iv)
+GL_FUNCTION(Uniform3f)
+GL_FUNCTION(Uniform3fv)
+GL_FUNCTION(Uniform3i)
+GL_FUNCTION(Uniform3iv)
+GL_FUNCTION(Uniform4f)
+GL_FUNCTION(Uniform4fv)
+GL_FUNCTION(Uniform4i)
+GL_FUNCTION(Uniform4iv)
+GL_FUNCTION(UniformMatrix2fv)
+GL_FUNCTION(UniformMatrix3fv)
+GL_FUNCTION(UniformMatrix4fv)
+GL_FUNCTION(UseProgram)
+GL_FUNCTION(ValidateProgram)
+GL_FUNCTION(VertexAttrib1d)
+GL_FUNCTION(VertexAttrib1dv)
+GL_FUNCTION(VertexAttrib1f)
+GL_FUNCTION(VertexAttrib1fv)
+GL_FUNCTION(VertexAttrib1s)
+GL_FUNCTION(VertexAttrib1sv)
+GL_FUNCTION(VertexAttrib2d)
+GL_FUNCTION(VertexAttrib2dv)
+GL_FUNCTION(VertexAttrib2f)
+GL_FUNCTION(VertexAttrib2fv)
+GL_FUNCTION(VertexAttrib2s)
+GL_FUNCTION(VertexAttrib2sv)
+GL_FUNCTION(VertexAttrib3d)
+GL_FUNCTION(VertexAttrib3dv)
+GL_FUNCTION(VertexAttrib3f)
+GL_FUNCTION(VertexAttrib3fv)
+GL_FUNCTION(VertexAttrib3s)
+GL_FUNCTION(VertexAttrib3sv)
+GL_FUNCTION(VertexAttrib4Nbv)
+GL_FUNCTION(VertexAttrib4Niv)
+GL_FUNCTION(VertexAttrib4Nsv)
+GL_FUNCTION(VertexAttrib4Nub)
+GL_FUNCTION(VertexAttrib4Nubv)
+GL_FUNCTION(VertexAttrib4Nuiv)
+GL_FUNCTION(VertexAttrib4Nusv)
+GL_FUNCTION(VertexAttrib4bv)
+GL_FUNCTION(VertexAttrib4d)
+GL_FUNCTION(VertexAttrib4dv)
+GL_FUNCTION(VertexAttrib4f)
+GL_FUNCTION(VertexAttrib4fv)
+GL_FUNCTION(VertexAttrib4iv)
+GL_FUNCTION(VertexAttrib4s)
+GL_FUNCTION(VertexAttrib4sv)
+GL_FUNCTION(VertexAttrib4ubv)
+GL_FUNCTION(VertexAttrib4uiv)
+GL_FUNCTION(VertexAttrib4usv)
+GL_FUNCTION(VertexAttribPointer)
+
+// Extension: 2.1
+GL_FUNCTION(UniformMatrix2x3fv)
+GL_FUNCTION(UniformMatrix2x4fv)
+GL_FUNCTION(UniformMatrix3x2fv)
+GL_FUNCTION(UniformMatrix3x4fv)
+GL_FUNCTION(UniformMatrix4x2fv)
+GL_FUNCTION(UniformMatrix4x3fv)
+
+// Extension: 3.0
+GL_FUNCTION(BeginConditionalRender)
+GL_FUNCTION(BeginTransformFeedback)
+GL_FUNCTION(BindBufferBase)
+GL_FUNCTION(BindBufferRange)
+GL_FUNCTION(BindFragDataLocation)
+GL_FUNCTION(BindFramebuffer)
+GL_FUNCTION(BindRenderbuffer)
+GL_FUNCTION(BindVertexArray)
+GL_FUNCTION(BlitFramebuffer)
+GL_FUNCTION(CheckFramebufferStatus)
+GL_FUNCTION(ClampColor)
+GL_FUNCTION(ClearBufferfi)
+GL_FUNCTION(ClearBufferfv)
+GL_FUNCTION(ClearBufferiv)
+GL_FUNCTION(ClearBufferuiv)
+GL_FUNCTION(ColorMaski)
+GL_FUNCTION(DeleteFramebuffers)
+GL_FUNCTION(DeleteRenderbuffers)
+GL_FUNCTION(DeleteVertexArrays)
+GL_FUNCTION(Disablei)
+GL_FUNCTION(Enablei)
+GL_FUNCTION(EndConditionalRender)
+GL_FUNCTION(EndTransformFeedback)
+GL_FUNCTION(FlushMappedBufferRange)
+GL_FUNCTION(FramebufferRenderbuffer)
+GL_FUNCTION(FramebufferTexture1D)
+GL_FUNCTION(FramebufferTexture2D)
+GL_FUNCTION(FramebufferTexture3D)
+GL_FUNCTION(FramebufferTextureLayer)
+GL_FUNCTION(GenFramebuffers)
+GL_FUNCTION(GenRenderbuffers)
+GL_FUNCTION(GenVertexArrays)
+GL_FUNCTION(GenerateMipmap)
+GL_FUNCTION(GetBooleani_v)
+GL_FUNCTION(GetFragDataLocation)
+GL_FUNCTION(GetFramebufferAttachmentParameteriv)
+GL_FUNCTION(GetIntegeri_v)
+GL_FUNCTION(GetRenderbufferParameteriv)
+GL_FUNCTION(GetStringi)
+GL_FUNCTION(GetTexParameterIiv)
+GL_FUNCTION(GetTexParameterIuiv)
+GL_FUNCTION(GetTransformFeedbackVarying)
+GL_FUNCTION(GetUniformuiv)
+GL_FUNCTION(GetVertexAttribIiv)
+GL_FUNCTION(GetVertexAttribIuiv)
+GL_FUNCTION(IsEnabledi)
+GL_FUNCTION(IsFramebuffer)
+GL_FUNCTION(IsRenderbuffer)
+GL_FUNCTION(IsVertexArray)
+GL_FUNCTION(MapBufferRange)
+GL_FUNCTION(RenderbufferStorage)
+GL_FUNCTION(RenderbufferStorageMultisample)
+GL_FUNCTION(TexParameterIiv)
+GL_FUNCTION(TexParameterIuiv)
+GL_FUNCTION(TransformFeedbackVaryings)
+GL_FUNCTION(Uniform1ui)
+GL_FUNCTION(Uniform1uiv)
+GL_FUNCTION(Uniform2ui)
+GL_FUNCTION(Uniform2uiv)
+GL_FUNCTION(Uniform3ui)
+GL_FUNCTION(Uniform3uiv)
+GL_FUNCTION(Uniform4ui)
+GL_FUNCTION(Uniform4uiv)
+GL_FUNCTION(VertexAttribI1i)
+GL_FUNCTION(VertexAttribI1iv)
+GL_FUNCTION(VertexAttribI1ui)
+GL_FUNCTION(VertexAttribI1uiv)
+GL_FUNCTION(VertexAttribI2i)
+GL_FUNCTION(VertexAttribI2iv)
+GL_FUNCTION(VertexAttribI2ui)
+GL_FUNCTION(VertexAttribI2uiv)
+GL_FUNCTION(VertexAttribI3i)
+GL_FUNCTION(VertexAttribI3iv)
+GL_FUNCTION(VertexAttribI3ui)
+GL_FUNCTION(VertexAttribI3uiv)
+GL_FUNCTION(VertexAttribI4bv)
+GL_FUNCTION(VertexAttribI4i)
+GL_FUNCTION(VertexAttribI4iv)
+GL_FUNCTION(VertexAttribI4sv)
+GL_FUNCTION(VertexAttribI4ubv)
+GL_FUNCTION(VertexAttribI4ui)
+GL_FUNCTION(VertexAttribI4uiv)
+GL_FUNCTION(VertexAttribI4usv)
+GL_FUNCTION(VertexAttribIPointer)
+
+// Extension: 3.1
+GL_FUNCTION(CopyBufferSubData)
+GL_FUNCTION(DrawArraysInstanced)
+GL_FUNCTION(DrawElementsInstanced)
+GL_FUNCTION(GetActiveUniformBlockName)
+GL_FUNCTION(GetActiveUniformBlockiv)
+GL_FUNCTION(GetActiveUniformName)
+GL_FUNCTION(GetActiveUniformsiv)
+GL_FUNCTION(GetUniformBlockIndex)
+GL_FUNCTION(GetUniformIndices)
+GL_FUNCTION(PrimitiveRestartIndex)
+GL_FUNCTION(TexBuffer)
+GL_FUNCTION(UniformBlockBinding)
+
+// Extension: 3.2
+GL_FUNCTION(ClientWaitSync)
+GL_FUNCTION(DeleteSync)
+GL_FUNCTION(DrawElementsBaseVertex)
+GL_FUNCTION(DrawElementsInstancedBaseVertex)
+GL_FUNCTION(DrawRangeElementsBaseVertex)
+GL_FUNCTION(FenceSync)
+GL_FUNCTION(FramebufferTexture)
+GL_FUNCTION(GetBufferParameteri64v)
+GL_FUNCTION(GetInteger64i_v)
+GL_FUNCTION(GetInteger64v)
+GL_FUNCTION(GetMultisamplefv)
+GL_FUNCTION(GetSynciv)
+GL_FUNCTION(IsSync)
+GL_FUNCTION(MultiDrawElementsBaseVertex)
+GL_FUNCTION(ProvokingVertex)
+GL_FUNCTION(SampleMaski)
+GL_FUNCTION(TexImage2DMultisample)
+GL_FUNCTION(TexImage3DMultisample)
+GL_FUNCTION(WaitSync)
+
+// Extension: 3.3
+GL_FUNCTION(BindFragDataLocationIndexed)
+GL_FUNCTION(BindSampler)
+GL_FUNCTION(DeleteSamplers)
+GL_FUNCTION(GenSamplers)
+GL_FUNCTION(GetFragDataIndex)
+GL_FUNCTION(GetQueryObjecti64v)
+GL_FUNCTION(GetQueryObjectui64v)
+GL_FUNCTION(GetSamplerParameterIiv)
+GL_FUNCTION(GetSamplerParameterIuiv)
+GL_FUNCTION(GetSamplerParameterfv)
+GL_FUNCTION(GetSamplerParameteriv)
+GL_FUNCTION(IsSampler)
+GL_FUNCTION(QueryCounter)
+GL_FUNCTION(SamplerParameterIiv)
+GL_FUNCTION(SamplerParameterIuiv)
+GL_FUNCTION(SamplerParameterf)
+GL_FUNCTION(SamplerParameterfv)
+GL_FUNCTION(SamplerParameteri)
+GL_FUNCTION(SamplerParameteriv)
+GL_FUNCTION(VertexAttribDivisor)
+GL_FUNCTION(VertexAttribP1ui)
+GL_FUNCTION(VertexAttribP1uiv)
+GL_FUNCTION(VertexAttribP2ui)
+GL_FUNCTION(VertexAttribP2uiv)
+GL_FUNCTION(VertexAttribP3ui)
+GL_FUNCTION(VertexAttribP3uiv)
+GL_FUNCTION(VertexAttribP4ui)
+GL_FUNCTION(VertexAttribP4uiv)
+
+// Extension: 4.0
+GL_FUNCTION(BeginQueryIndexed)
+GL_FUNCTION(BindTransformFeedback)
+GL_FUNCTION(BlendEquationSeparatei)
+GL_FUNCTION(BlendEquationi)
+GL_FUNCTION(BlendFuncSeparatei)
+GL_FUNCTION(BlendFunci)
+GL_FUNCTION(DeleteTransformFeedbacks)
+GL_FUNCTION(DrawArraysIndirect)
+GL_FUNCTION(DrawElementsIndirect)
+GL_FUNCTION(DrawTransformFeedback)
+GL_FUNCTION(DrawTransformFeedbackStream)
+GL_FUNCTION(EndQueryIndexed)
+GL_FUNCTION(GenTransformFeedbacks)
+GL_FUNCTION(GetActiveSubroutineName)
+GL_FUNCTION(GetActiveSubroutineUniformName)
+GL_FUNCTION(GetActiveSubroutineUniformiv)
+GL_FUNCTION(GetProgramStageiv)
+GL_FUNCTION(GetQueryIndexediv)
+GL_FUNCTION(GetSubroutineIndex)
+GL_FUNCTION(GetSubroutineUniformLocation)
+GL_FUNCTION(GetUniformSubroutineuiv)
+GL_FUNCTION(GetUniformdv)
+GL_FUNCTION(IsTransformFeedback)
+GL_FUNCTION(MinSampleShading)
+GL_FUNCTION(PatchParameterfv)
+GL_FUNCTION(PatchParameteri)
+GL_FUNCTION(PauseTransformFeedback)
+GL_FUNCTION(ResumeTransformFeedback)
+GL_FUNCTION(Uniform1d)
+GL_FUNCTION(Uniform1dv)
+GL_FUNCTION(Uniform2d)
+GL_FUNCTION(Uniform2dv)
+GL_FUNCTION(Uniform3d)
+GL_FUNCTION(Uniform3dv)
+GL_FUNCTION(Uniform4d)
+GL_FUNCTION(Uniform4dv)
+GL_FUNCTION(UniformMatrix2dv)
+GL_FUNCTION(UniformMatrix2x3dv)
+GL_FUNCTION(UniformMatrix2x4dv)
+GL_FUNCTION(UniformMatrix3dv)
+GL_FUNCTION(UniformMatrix3x2dv)
+GL_FUNCTION(UniformMatrix3x4dv)
+GL_FUNCTION(UniformMatrix4dv)
+GL_FUNCTION(UniformMatrix4x2dv)
+GL_FUNCTION(UniformMatrix4x3dv)
+GL_FUNCTION(UniformSubroutinesuiv)
+
+// Extension: 4.1
+GL_FUNCTION(ActiveShaderProgram)
+GL_FUNCTION(BindProgramPipeline)
+GL_FUNCTION(ClearDepthf)
+GL_FUNCTION(CreateShaderProgramv)
+GL_FUNCTION(DeleteProgramPipelines)
+GL_FUNCTION(DepthRangeArrayv)
+GL_FUNCTION(DepthRangeIndexed)
+GL_FUNCTION(DepthRangef)
+GL_FUNCTION(GenProgramPipelines)
+GL_FUNCTION(GetDoublei_v)
+GL_FUNCTION(GetFloati_v)
+GL_FUNCTION(GetProgramBinary)
+GL_FUNCTION(GetProgramPipelineInfoLog)
+GL_FUNCTION(GetProgramPipelineiv)
+GL_FUNCTION(GetShaderPrecisionFormat)
+GL_FUNCTION(GetVertexAttribLdv)
+GL_FUNCTION(IsProgramPipeline)
+GL_FUNCTION(ProgramBinary)
+GL_FUNCTION(ProgramParameteri)
+GL_FUNCTION(ProgramUniform1d)
+GL_FUNCTION(ProgramUniform1dv)
+GL_FUNCTION(ProgramUniform1f)
+GL_FUNCTION(ProgramUniform1fv)
+GL_FUNCTION(ProgramUniform1i)
+GL_FUNCTION(ProgramUniform1iv)
+GL_FUNCTION(ProgramUniform1ui)
+GL_FUNCTION(ProgramUniform1uiv)
+GL_FUNCTION(ProgramUniform2d)
+GL_FUNCTION(ProgramUniform2dv)
+GL_FUNCTION(ProgramUniform2f)
+GL_FUNCTION(ProgramUniform2fv)
+GL_FUNCTION(ProgramUniform2i)
+GL_FUNCTION(ProgramUniform2iv)
+GL_FUNCTION(ProgramUniform2ui)
+GL_FUNCTION(ProgramUniform2uiv)
+GL_FUNCTION(ProgramUniform3d)
+GL_FUNCTION(ProgramUniform3dv)
+GL_FUNCTION(ProgramUniform3f)
+GL_FUNCTION(ProgramUniform3fv)
+GL_FUNCTION(ProgramUniform3i)
+GL_FUNCTION(ProgramUniform3iv)
+GL_FUNCTION(ProgramUniform3ui)
+GL_FUNCTION(ProgramUniform3uiv)
+GL_FUNCTION(ProgramUniform4d)
+GL_FUNCTION(ProgramUniform4dv)
+GL_FUNCTION(ProgramUniform4f)
+GL_FUNCTION(ProgramUniform4fv)
+GL_FUNCTION(ProgramUniform4i)
+GL_FUNCTION(ProgramUniform4iv)
+GL_FUNCTION(ProgramUniform4ui)
+GL_FUNCTION(ProgramUniform4uiv)
+GL_FUNCTION(ProgramUniformMatrix2dv)
+GL_FUNCTION(ProgramUniformMatrix2fv)
+GL_FUNCTION(ProgramUniformMatrix2x3dv)
+GL_FUNCTION(ProgramUniformMatrix2x3fv)
+GL_FUNCTION(ProgramUniformMatrix2x4dv)
+GL_FUNCTION(ProgramUniformMatrix2x4fv)
+GL_FUNCTION(ProgramUniformMatrix3dv)
+GL_FUNCTION(ProgramUniformMatrix3fv)
+GL_FUNCTION(ProgramUniformMatrix3x2dv)
+GL_FUNCTION(ProgramUniformMatrix3x2fv)
+GL_FUNCTION(ProgramUniformMatrix3x4dv)
+GL_FUNCTION(ProgramUniformMatrix3x4fv)
+GL_FUNCTION(ProgramUniformMatrix4dv)
+GL_FUNCTION(ProgramUniformMatrix4fv)
+GL_FUNCTION(ProgramUniformMatrix4x2dv)
+GL_FUNCTION(ProgramUniformMatrix4x2fv)
+GL_FUNCTION(ProgramUniformMatrix4x3dv)
+GL_FUNCTION(ProgramUniformMatrix4x3fv)
+GL_FUNCTION(ReleaseShaderCompiler)
+GL_FUNCTION(ScissorArrayv)
+GL_FUNCTION(ScissorIndexed)
+GL_FUNCTION(ScissorIndexedv)
+GL_FUNCTION(ShaderBinary)
+GL_FUNCTION(UseProgramStages)
+GL_FUNCTION(ValidateProgramPipeline)
+GL_FUNCTION(VertexAttribL1d)
+GL_FUNCTION(VertexAttribL1dv)
+GL_FUNCTION(VertexAttribL2d)
+GL_FUNCTION(VertexAttribL2dv)
+GL_FUNCTION(VertexAttribL3d)
+GL_FUNCTION(VertexAttribL3dv)
+GL_FUNCTION(VertexAttribL4d)
+GL_FUNCTION(VertexAttribL4dv)
+GL_FUNCTION(VertexAttribLPointer)
+GL_FUNCTION(ViewportArrayv)
+GL_FUNCTION(ViewportIndexedf)
+GL_FUNCTION(ViewportIndexedfv)
+
+// Extension: 4.2
+GL_FUNCTION(BindImageTexture)
+GL_FUNCTION(DrawArraysInstancedBaseInstance)
+GL_FUNCTION(DrawElementsInstancedBaseInstance)
+GL_FUNCTION(DrawElementsInstancedBaseVertexBaseInstance)
+GL_FUNCTION(DrawTransformFeedbackInstanced)
+GL_FUNCTION(DrawTransformFeedbackStreamInstanced)
+GL_FUNCTION(GetActiveAtomicCounterBufferiv)
+GL_FUNCTION(GetInternalformativ)
+GL_FUNCTION(MemoryBarrier)
+GL_FUNCTION(TexStorage1D)
+GL_FUNCTION(TexStorage2D)
+GL_FUNCTION(TexStorage3D)
+
+// Extension: 4.3
+GL_FUNCTION(BindVertexBuffer)
+GL_FUNCTION(ClearBufferData)
+GL_FUNCTION(ClearBufferSubData)
+GL_FUNCTION(CopyImageSubData)
+GL_FUNCTION(DebugMessageCallback)
+GL_FUNCTION(DebugMessageControl)
+GL_FUNCTION(DebugMessageInsert)
+GL_FUNCTION(DispatchCompute)
+GL_FUNCTION(DispatchComputeIndirect)
+GL_FUNCTION(FramebufferParameteri)
+GL_FUNCTION(GetDebugMessageLog)
+GL_FUNCTION(GetFramebufferParameteriv)
+GL_FUNCTION(GetInternalformati64v)
+GL_FUNCTION(GetObjectLabel)
+GL_FUNCTION(GetObjectPtrLabel)
+GL_FUNCTION(GetProgramInterfaceiv)
+GL_FUNCTION(GetProgramResourceIndex)
+GL_FUNCTION(GetProgramResourceLocation)
+GL_FUNCTION(GetProgramResourceLocationIndex)
+GL_FUNCTION(GetProgramResourceName)
+GL_FUNCTION(GetProgramResourceiv)
+GL_FUNCTION(InvalidateBufferData)
+GL_FUNCTION(InvalidateBufferSubData)
+GL_FUNCTION(InvalidateFramebuffer)
+GL_FUNCTION(InvalidateSubFramebuffer)
+GL_FUNCTION(InvalidateTexImage)
+GL_FUNCTION(InvalidateTexSubImage)
+GL_FUNCTION(MultiDrawArraysIndirect)
+GL_FUNCTION(MultiDrawElementsIndirect)
+GL_FUNCTION(ObjectLabel)
+GL_FUNCTION(ObjectPtrLabel)
+GL_FUNCTION(PopDebugGroup)
+GL_FUNCTION(PushDebugGroup)
+GL_FUNCTION(ShaderStorageBlockBinding)
+GL_FUNCTION(TexBufferRange)
+GL_FUNCTION(TexStorage2DMultisample)
+GL_FUNCTION(TexStorage3DMultisample)
+GL_FUNCTION(TextureView)
+GL_FUNCTION(VertexAttribBinding)
+GL_FUNCTION(VertexAttribFormat)
+GL_FUNCTION(VertexAttribIFormat)
+GL_FUNCTION(VertexAttribLFormat)
+GL_FUNCTION(VertexBindingDivisor)
+
+// Extension: 4.4
+GL_FUNCTION(BindBuffersBase)
+GL_FUNCTION(BindBuffersRange)
+GL_FUNCTION(BindImageTextures)
+GL_FUNCTION(BindSamplers)
+GL_FUNCTION(BindTextures)
+GL_FUNCTION(BindVertexBuffers)
+GL_FUNCTION(BufferStorage)
+GL_FUNCTION(ClearTexImage)
+GL_FUNCTION(ClearTexSubImage)
+
+// Extension: 4.5
+GL_FUNCTION(BindTextureUnit)
+GL_FUNCTION(BlitNamedFramebuffer)
+GL_FUNCTION(CheckNamedFramebufferStatus)
+GL_FUNCTION(ClearNamedBufferData)
+GL_FUNCTION(ClearNamedBufferSubData)
+GL_FUNCTION(ClearNamedFramebufferfi)
+GL_FUNCTION(ClearNamedFramebufferfv)
+GL_FUNCTION(ClearNamedFramebufferiv)
+GL_FUNCTION(ClearNamedFramebufferuiv)
+GL_FUNCTION(ClipControl)
+GL_FUNCTION(CompressedTextureSubImage1D)
+GL_FUNCTION(CompressedTextureSubImage2D)
+GL_FUNCTION(CompressedTextureSubImage3D)
+GL_FUNCTION(CopyNamedBufferSubData)
+GL_FUNCTION(CopyTextureSubImage1D)
+GL_FUNCTION(CopyTextureSubImage2D)
+GL_FUNCTION(CopyTextureSubImage3D)
+GL_FUNCTION(CreateBuffers)
+GL_FUNCTION(CreateFramebuffers)
+GL_FUNCTION(CreateProgramPipelines)
+GL_FUNCTION(CreateQueries)
+GL_FUNCTION(CreateRenderbuffers)
+GL_FUNCTION(CreateSamplers)
+GL_FUNCTION(CreateTextures)
+GL_FUNCTION(CreateTransformFeedbacks)
+GL_FUNCTION(CreateVertexArrays)
+GL_FUNCTION(DisableVertexArrayAttrib)
+GL_FUNCTION(EnableVertexArrayAttrib)
+GL_FUNCTION(FlushMappedNamedBufferRange)
+GL_FUNCTION(GenerateTextureMipmap)
+GL_FUNCTION(GetCompressedTextureImage)
+GL_FUNCTION(GetCompressedTextureSubImage)
+GL_FUNCTION(GetGraphicsResetStatus)
+GL_FUNCTION(GetNamedBufferParameteri64v)
+GL_FUNCTION(GetNamedBufferParameteriv)
+GL_FUNCTION(GetNamedBufferPointerv)
+GL_FUNCTION(GetNamedBufferSubData)
+GL_FUNCTION(GetNamedFramebufferAttachmentParameteriv)
+GL_FUNCTION(GetNamedFramebufferParameteriv)
+GL_FUNCTION(GetNamedRenderbufferParameteriv)
+GL_FUNCTION(GetQueryBufferObjecti64v)
+GL_FUNCTION(GetQueryBufferObjectiv)
+GL_FUNCTION(GetQueryBufferObjectui64v)
+GL_FUNCTION(GetQueryBufferObjectuiv)
+GL_FUNCTION(GetTextureImage)
+GL_FUNCTION(GetTextureLevelParameterfv)
+GL_FUNCTION(GetTextureLevelParameteriv)
+GL_FUNCTION(GetTextureParameterIiv)
+GL_FUNCTION(GetTextureParameterIuiv)
+GL_FUNCTION(GetTextureParameterfv)
+GL_FUNCTION(GetTextureParameteriv)
+GL_FUNCTION(GetTextureSubImage)
+GL_FUNCTION(GetTransformFeedbacki64_v)
+GL_FUNCTION(GetTransformFeedbacki_v)
+GL_FUNCTION(GetTransformFeedbackiv)
+GL_FUNCTION(GetVertexArrayIndexed64iv)
+GL_FUNCTION(GetVertexArrayIndexediv)
+GL_FUNCTION(GetVertexArrayiv)
+GL_FUNCTION(GetnCompressedTexImage)
+GL_FUNCTION(GetnTexImage)
+GL_FUNCTION(GetnUniformdv)
+GL_FUNCTION(GetnUniformfv)
+GL_FUNCTION(GetnUniformiv)
+GL_FUNCTION(GetnUniformuiv)
+GL_FUNCTION(InvalidateNamedFramebufferData)
+GL_FUNCTION(InvalidateNamedFramebufferSubData)
+GL_FUNCTION(MapNamedBuffer)
+GL_FUNCTION(MapNamedBufferRange)
+GL_FUNCTION(MemoryBarrierByRegion)
+GL_FUNCTION(NamedBufferData)
+GL_FUNCTION(NamedBufferStorage)
+GL_FUNCTION(NamedBufferSubData)
+GL_FUNCTION(NamedFramebufferDrawBuffer)
+GL_FUNCTION(NamedFramebufferDrawBuffers)
+GL_FUNCTION(NamedFramebufferParameteri)
+GL_FUNCTION(NamedFramebufferReadBuffer)
+GL_FUNCTION(NamedFramebufferRenderbuffer)
+GL_FUNCTION(NamedFramebufferTexture)
+GL_FUNCTION(NamedFramebufferTextureLayer)
+GL_FUNCTION(NamedRenderbufferStorage)
+GL_FUNCTION(NamedRenderbufferStorageMultisample)
+GL_FUNCTION(ReadnPixels)
+GL_FUNCTION(TextureBarrier)
+GL_FUNCTION(TextureBuffer)
+GL_FUNCTION(TextureBufferRange)
+GL_FUNCTION(TextureParameterIiv)
+GL_FUNCTION(TextureParameterIuiv)
+GL_FUNCTION(TextureParameterf)
+GL_FUNCTION(TextureParameterfv)
+GL_FUNCTION(TextureParameteri)
+GL_FUNCTION(TextureParameteriv)
+GL_FUNCTION(TextureStorage1D)
+GL_FUNCTION(TextureStorage2D)
+GL_FUNCTION(TextureStorage2DMultisample)
+GL_FUNCTION(TextureStorage3D)
+GL_FUNCTION(TextureStorage3DMultisample)
+GL_FUNCTION(TextureSubImage1D)
+GL_FUNCTION(TextureSubImage2D)
+GL_FUNCTION(TextureSubImage3D)
+GL_FUNCTION(TransformFeedbackBufferBase)
+GL_FUNCTION(TransformFeedbackBufferRange)
+GL_FUNCTION(UnmapNamedBuffer)
+GL_FUNCTION(VertexArrayAttribBinding)
+GL_FUNCTION(VertexArrayAttribFormat)
+GL_FUNCTION(VertexArrayAttribIFormat)
+GL_FUNCTION(VertexArrayAttribLFormat)
+GL_FUNCTION(VertexArrayBindingDivisor)
+GL_FUNCTION(VertexArrayElementBuffer)
+GL_FUNCTION(VertexArrayVertexBuffer)
+GL_FUNCTION(VertexArrayVertexBuffers)
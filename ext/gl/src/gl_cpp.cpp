@@ -70,21 +70,34 @@ static PROC WinGetProcAddress(const char *name)
 	return (PROC)GetProcAddress(glMod, (LPCSTR)name);
 }
 	
-#define IntGetProcAddress(name) WinGetProcAddress(name)
+#define PlatformGetProcAddress(name) WinGetProcAddress(name)
 #else
 	#if defined(__APPLE__)
-		#define IntGetProcAddress(name) AppleGLGetProcAddress(name)
+		#define PlatformGetProcAddress(name) AppleGLGetProcAddress(name)
 	#else
 		#if defined(__sgi) || defined(__sun)
-			#define IntGetProcAddress(name) SunGetProcAddress(name)
+			#define PlatformGetProcAddress(name) SunGetProcAddress(name)
 		#else /* GLX */
 		    #include <GL/glx.h>
 
-			#define IntGetProcAddress(name) (*glXGetProcAddressARB)((const GLubyte*)name)
+			#define PlatformGetProcAddress(name) (*glXGetProcAddressARB)((const GLubyte*)name)
 		#endif
 	#endif
 #endif
 
+/* Set with gl::sys::SetProcAddressLoader for contexts the platform loader does not know (e.g. EGL) */
+static void* (*g_procAddressLoader)(const char *name) = NULL;
+
+static void* LoadProcAddress(const char *name)
+{
+	if (g_procAddressLoader)
+		return g_procAddressLoader(name);
+
+	return (void*)PlatformGetProcAddress(name);
+}
+
+#define IntGetProcAddress(name) LoadProcAddress(name)
+
 namespace gl
 {
 	namespace exts
@@ -6177,6 +6190,11 @@ namespace gl
 				}
 			}
 		}
+		void SetProcAddressLoader(void* (*loader)(const char *name))
+		{
+			g_procAddressLoader = loader;
+		}
+
 		void CheckExtensions()
 		{
 			ClearExtensionVariables();
@@ -55,43 +55,153 @@ static GLuint       g_FontTexture = 0;
 static int          g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 static int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
 static int          g_AttribLocationPosition = 0, g_AttribLocationUV = 0, g_AttribLocationColor = 0;
-static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
+static GLuint       g_VaoHandle = 0;
+
+// Streaming buffer: Persistently mapped, split in one region per frame in flight. Each region holds
+// the vertices of all command lists followed by their indices.
+enum { IMGUI_STREAM_REGIONS = 3 };
+static GLuint       g_StreamHandle = 0;
+static char*        g_StreamMapped = NULL;
+static GLsizeiptr   g_StreamRegionSize = 0;
+static int          g_StreamRegion = 0;
+static GLsync       g_StreamFences[IMGUI_STREAM_REGIONS] = { 0 };
+
+// Set by the application to skip the GL state backup / restore (see ImGui_ImplGlfwGL3_SetRestoreStateCallback)
+static ImGui_ImplGlfwGL3_RestoreStateFn g_RestoreStateFn = NULL;
+static void*        g_RestoreStateUserData = NULL;
+
+// GL state modified while rendering, queried before and restored after rendering
+struct ImGui_ImplGlfwGL3_StateBackup
+{
+    GLenum active_texture;
+    GLint program, texture, sampler, array_buffer, element_array_buffer, vertex_array;
+    GLint polygon_mode[2], viewport[4], scissor_box[4];
+    GLenum blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha, blend_equation_rgb, blend_equation_alpha;
+    GLboolean enable_blend, enable_cull_face, enable_depth_test, enable_scissor_test, enable_primitive_restart;
+
+    void Backup()
+    {
+        gl::GetIntegerv(gl::ACTIVE_TEXTURE, (GLint*)&active_texture);
+        gl::ActiveTexture(gl::TEXTURE0);
+        gl::GetIntegerv(gl::CURRENT_PROGRAM, &program);
+        gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &texture);
+        gl::GetIntegerv(gl::SAMPLER_BINDING, &sampler);
+        gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &array_buffer);
+        gl::GetIntegerv(gl::ELEMENT_ARRAY_BUFFER_BINDING, &element_array_buffer);
+        gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &vertex_array);
+        gl::GetIntegerv(gl::POLYGON_MODE, polygon_mode);
+        gl::GetIntegerv(gl::VIEWPORT, viewport);
+        gl::GetIntegerv(gl::SCISSOR_BOX, scissor_box);
+        gl::GetIntegerv(gl::BLEND_SRC_RGB, (GLint*)&blend_src_rgb);
+        gl::GetIntegerv(gl::BLEND_DST_RGB, (GLint*)&blend_dst_rgb);
+        gl::GetIntegerv(gl::BLEND_SRC_ALPHA, (GLint*)&blend_src_alpha);
+        gl::GetIntegerv(gl::BLEND_DST_ALPHA, (GLint*)&blend_dst_alpha);
+        gl::GetIntegerv(gl::BLEND_EQUATION_RGB, (GLint*)&blend_equation_rgb);
+        gl::GetIntegerv(gl::BLEND_EQUATION_ALPHA, (GLint*)&blend_equation_alpha);
+        enable_blend = gl::IsEnabled(gl::BLEND);
+        enable_cull_face = gl::IsEnabled(gl::CULL_FACE);
+        enable_depth_test = gl::IsEnabled(gl::DEPTH_TEST);
+        enable_scissor_test = gl::IsEnabled(gl::SCISSOR_TEST);
+        enable_primitive_restart = gl::IsEnabled(gl::PRIMITIVE_RESTART_FIXED_INDEX);
+    }
+
+    void Restore() const
+    {
+        gl::UseProgram(program);
+        gl::BindTexture(gl::TEXTURE_2D, texture);
+        gl::BindSampler(0, sampler);
+        gl::ActiveTexture(active_texture);
+        gl::BindVertexArray(vertex_array);
+        gl::BindBuffer(gl::ARRAY_BUFFER, array_buffer);
+        gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, element_array_buffer);
+        gl::BlendEquationSeparate(blend_equation_rgb, blend_equation_alpha);
+        gl::BlendFuncSeparate(blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha);
+        if (enable_blend) gl::Enable(gl::BLEND); else gl::Disable(gl::BLEND);
+        if (enable_cull_face) gl::Enable(gl::CULL_FACE); else gl::Disable(gl::CULL_FACE);
+        if (enable_depth_test) gl::Enable(gl::DEPTH_TEST); else gl::Disable(gl::DEPTH_TEST);
+        if (enable_scissor_test) gl::Enable(gl::SCISSOR_TEST); else gl::Disable(gl::SCISSOR_TEST);
+        if (enable_primitive_restart) gl::Enable(gl::PRIMITIVE_RESTART_FIXED_INDEX); else gl::Disable(gl::PRIMITIVE_RESTART_FIXED_INDEX);
+        gl::PolygonMode(gl::FRONT_AND_BACK, (GLenum)polygon_mode[0]);
+        gl::Viewport(viewport[0], viewport[1], (GLsizei)viewport[2], (GLsizei)viewport[3]);
+        gl::Scissor(scissor_box[0], scissor_box[1], (GLsizei)scissor_box[2], (GLsizei)scissor_box[3]);
+    }
+};
+
+// Block until the GPU has finished reading a region of the streaming buffer
+static void ImGui_ImplGlfwGL3_WaitForStreamRegion(int region)
+{
+    if (!g_StreamFences[region])
+        return;
+
+    GLenum result;
+    do
+    {
+        result = gl::ClientWaitSync(g_StreamFences[region], gl::SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    } while (result == gl::TIMEOUT_EXPIRED);
+
+    gl::DeleteSync(g_StreamFences[region]);
+    g_StreamFences[region] = 0;
+}
+
+static void ImGui_ImplGlfwGL3_DestroyStreamBuffer()
+{
+    for (int region = 0; region < IMGUI_STREAM_REGIONS; region++)
+        ImGui_ImplGlfwGL3_WaitForStreamRegion(region);
+
+    if (g_StreamHandle)
+    {
+        gl::UnmapNamedBuffer(g_StreamHandle);
+        gl::DeleteBuffers(1, &g_StreamHandle);
+    }
+    g_StreamHandle = 0;
+    g_StreamMapped = NULL;
+    g_StreamRegionSize = 0;
+    g_StreamRegion = 0;
+}
+
+// (Re)create the streaming buffer with regions of at least region_size bytes and attach it to the VAO
+static void ImGui_ImplGlfwGL3_CreateStreamBuffer(GLsizeiptr region_size)
+{
+    ImGui_ImplGlfwGL3_DestroyStreamBuffer();
+
+    // Regions start on a whole vertex, so vertices can be addressed with a base vertex from the start of the buffer
+    const GLsizeiptr granularity = (GLsizeiptr)sizeof(ImDrawVert) * 4;
+    g_StreamRegionSize = (region_size + granularity - 1) / granularity * granularity;
+
+    const GLbitfield flags = gl::MAP_WRITE_BIT | gl::MAP_PERSISTENT_BIT | gl::MAP_COHERENT_BIT;
+    gl::CreateBuffers(1, &g_StreamHandle);
+    gl::NamedBufferStorage(g_StreamHandle, g_StreamRegionSize * IMGUI_STREAM_REGIONS, NULL, flags);
+    g_StreamMapped = (char*)gl::MapNamedBufferRange(g_StreamHandle, 0, g_StreamRegionSize * IMGUI_STREAM_REGIONS, flags);
+
+    gl::VertexArrayVertexBuffer(g_VaoHandle, 0, g_StreamHandle, 0, sizeof(ImDrawVert));
+    gl::VertexArrayElementBuffer(g_VaoHandle, g_StreamHandle);
+}
+
+void ImGui_ImplGlfwGL3_SetRestoreStateCallback(ImGui_ImplGlfwGL3_RestoreStateFn restore_fn, void* user_data)
+{
+    g_RestoreStateFn = restore_fn;
+    g_RestoreStateUserData = user_data;
+}
 
 // OpenGL3 Render function.
 // (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
 // Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
+// The backup is skipped when the application provides a restore state callback.
 void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
 {
     // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
     ImGuiIO& io = ImGui::GetIO();
     int fb_width = (int)(io.DisplaySize.x * io.DisplayFramebufferScale.x);
     int fb_height = (int)(io.DisplaySize.y * io.DisplayFramebufferScale.y);
-    if (fb_width == 0 || fb_height == 0)
+    if (fb_width == 0 || fb_height == 0 || draw_data->TotalIdxCount == 0)
         return;
     draw_data->ScaleClipRects(io.DisplayFramebufferScale);
 
     // Backup GL state
-    GLenum last_active_texture; gl::GetIntegerv(gl::ACTIVE_TEXTURE, (GLint*)&last_active_texture);
+    ImGui_ImplGlfwGL3_StateBackup backup;
+    if (!g_RestoreStateFn)
+        backup.Backup();
     gl::ActiveTexture(gl::TEXTURE0);
-    GLint last_program; gl::GetIntegerv(gl::CURRENT_PROGRAM, &last_program);
-    GLint last_texture; gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &last_texture);
-    GLint last_sampler; gl::GetIntegerv(gl::SAMPLER_BINDING, &last_sampler);
-    GLint last_array_buffer; gl::GetIntegerv(gl::ARRAY_BUFFER_BINDING, &last_array_buffer);
-    GLint last_element_array_buffer; gl::GetIntegerv(gl::ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    GLint last_vertex_array; gl::GetIntegerv(gl::VERTEX_ARRAY_BINDING, &last_vertex_array);
-    GLint last_polygon_mode[2]; gl::GetIntegerv(gl::POLYGON_MODE, last_polygon_mode);
-    GLint last_viewport[4]; gl::GetIntegerv(gl::VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; gl::GetIntegerv(gl::SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; gl::GetIntegerv(gl::BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; gl::GetIntegerv(gl::BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; gl::GetIntegerv(gl::BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; gl::GetIntegerv(gl::BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; gl::GetIntegerv(gl::BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; gl::GetIntegerv(gl::BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = gl::IsEnabled(gl::BLEND);
-    GLboolean last_enable_cull_face = gl::IsEnabled(gl::CULL_FACE);
-    GLboolean last_enable_depth_test = gl::IsEnabled(gl::DEPTH_TEST);
-    GLboolean last_enable_scissor_test = gl::IsEnabled(gl::SCISSOR_TEST);
 
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
     gl::Enable(gl::BLEND);
@@ -100,6 +210,7 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
     gl::Disable(gl::CULL_FACE);
     gl::Disable(gl::DEPTH_TEST);
     gl::Enable(gl::SCISSOR_TEST);
+    gl::Disable(gl::PRIMITIVE_RESTART_FIXED_INDEX); // 16-bit draw lists may use index 0xFFFF
     gl::PolygonMode(gl::FRONT_AND_BACK, gl::FILL);
 
     // Setup viewport, orthographic projection matrix
@@ -116,31 +227,34 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
     gl::UniformMatrix4fv(g_AttribLocationProjMtx, 1, gl::FALSE_, &ortho_projection[0][0]);
     gl::BindSampler(0, 0); // Rely on combined texture/sampler state.
 
-    // Recreate the VAO every time
-    // (This is to easily allow multiple GL contexts. VAO are not shared among GL contexts, and we don't track creation/deletion of windows so we don't have an obvious key to use to cache them.)
-    GLuint vao_handle = 0;
-    gl::GenVertexArrays(1, &vao_handle);
-    gl::BindVertexArray(vao_handle);
-    gl::BindBuffer(gl::ARRAY_BUFFER, g_VboHandle);
-    gl::EnableVertexAttribArray(g_AttribLocationPosition);
-    gl::EnableVertexAttribArray(g_AttribLocationUV);
-    gl::EnableVertexAttribArray(g_AttribLocationColor);
-    gl::VertexAttribPointer(g_AttribLocationPosition, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-    gl::VertexAttribPointer(g_AttribLocationUV, 2, gl::FLOAT, gl::FALSE_, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-    gl::VertexAttribPointer(g_AttribLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    // Upload all command lists into the current region of the streaming buffer: vertices first, then indices
+    const GLsizeiptr vtx_bytes = (GLsizeiptr)draw_data->TotalVtxCount * sizeof(ImDrawVert);
+    const GLsizeiptr idx_start = (vtx_bytes + 3) & ~(GLsizeiptr)3;
+    const GLsizeiptr needed = idx_start + (GLsizeiptr)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+    if (needed > g_StreamRegionSize)
+        ImGui_ImplGlfwGL3_CreateStreamBuffer(needed * 2);
 
-    // Draw
+    ImGui_ImplGlfwGL3_WaitForStreamRegion(g_StreamRegion);
+    const GLsizeiptr region_offset = g_StreamRegionSize * g_StreamRegion;
+    char* region = g_StreamMapped + region_offset;
+
+    GLsizeiptr vtx_offset = 0, idx_offset = idx_start;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        const ImDrawIdx* idx_buffer_offset = 0;
-
-        gl::BindBuffer(gl::ARRAY_BUFFER, g_VboHandle);
-        gl::BufferData(gl::ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, gl::STREAM_DRAW);
-
-        gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-        gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, gl::STREAM_DRAW);
+        memcpy(region + vtx_offset, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        memcpy(region + idx_offset, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        vtx_offset += (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert);
+        idx_offset += (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx);
+    }
 
+    // Draw
+    gl::BindVertexArray(g_VaoHandle);
+    GLint base_vertex = (GLint)(region_offset / (GLsizeiptr)sizeof(ImDrawVert));
+    GLsizeiptr idx_buffer_offset = region_offset + idx_start;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
             const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
@@ -152,30 +266,22 @@ void ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data)
             {
                 gl::BindTexture(gl::TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
                 gl::Scissor((int)pcmd->ClipRect.x, (int)(fb_height - pcmd->ClipRect.w), (int)(pcmd->ClipRect.z - pcmd->ClipRect.x), (int)(pcmd->ClipRect.w - pcmd->ClipRect.y));
-                gl::DrawElements(gl::TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? gl::UNSIGNED_SHORT : gl::UNSIGNED_INT, idx_buffer_offset);
+                gl::DrawElementsBaseVertex(gl::TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? gl::UNSIGNED_SHORT : gl::UNSIGNED_INT, (const GLvoid*)(intptr_t)idx_buffer_offset, base_vertex);
             }
-            idx_buffer_offset += pcmd->ElemCount;
+            idx_buffer_offset += pcmd->ElemCount * sizeof(ImDrawIdx);
         }
+        base_vertex += cmd_list->VtxBuffer.Size;
     }
-    gl::DeleteVertexArrays(1, &vao_handle);
+
+    // The region can be written again once the GPU is done with these draws
+    g_StreamFences[g_StreamRegion] = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+    g_StreamRegion = (g_StreamRegion + 1) % IMGUI_STREAM_REGIONS;
 
     // Restore modified GL state
-    gl::UseProgram(last_program);
-    gl::BindTexture(gl::TEXTURE_2D, last_texture);
-    gl::BindSampler(0, last_sampler);
-    gl::ActiveTexture(last_active_texture);
-    gl::BindVertexArray(last_vertex_array);
-    gl::BindBuffer(gl::ARRAY_BUFFER, last_array_buffer);
-    gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    gl::BlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    gl::BlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) gl::Enable(gl::BLEND); else gl::Disable(gl::BLEND);
-    if (last_enable_cull_face) gl::Enable(gl::CULL_FACE); else gl::Disable(gl::CULL_FACE);
-    if (last_enable_depth_test) gl::Enable(gl::DEPTH_TEST); else gl::Disable(gl::DEPTH_TEST);
-    if (last_enable_scissor_test) gl::Enable(gl::SCISSOR_TEST); else gl::Disable(gl::SCISSOR_TEST);
-    gl::PolygonMode(gl::FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-    gl::Viewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    gl::Scissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    if (g_RestoreStateFn)
+        g_RestoreStateFn(g_RestoreStateUserData);
+    else
+        backup.Restore();
 }
 
 static const char* ImGui_ImplGlfwGL3_GetClipboardText(void* user_data)
@@ -273,8 +379,18 @@ bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
     g_AttribLocationUV = gl::GetAttribLocation(g_ShaderHandle, "UV");
     g_AttribLocationColor = gl::GetAttribLocation(g_ShaderHandle, "Color");
 
-    gl::GenBuffers(1, &g_VboHandle);
-    gl::GenBuffers(1, &g_ElementsHandle);
+    // Persistent VAO, the streaming buffer is attached on the first frame
+    // (VAOs are not shared among GL contexts, so the backend must be used from a single context)
+    gl::CreateVertexArrays(1, &g_VaoHandle);
+    gl::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationPosition);
+    gl::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationUV);
+    gl::EnableVertexArrayAttrib(g_VaoHandle, g_AttribLocationColor);
+    gl::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationPosition, 2, gl::FLOAT, gl::FALSE_, IM_OFFSETOF(ImDrawVert, pos));
+    gl::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationUV, 2, gl::FLOAT, gl::FALSE_, IM_OFFSETOF(ImDrawVert, uv));
+    gl::VertexArrayAttribFormat(g_VaoHandle, g_AttribLocationColor, 4, gl::UNSIGNED_BYTE, gl::TRUE_, IM_OFFSETOF(ImDrawVert, col));
+    gl::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationPosition, 0);
+    gl::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationUV, 0);
+    gl::VertexArrayAttribBinding(g_VaoHandle, g_AttribLocationColor, 0);
 
     ImGui_ImplGlfwGL3_CreateFontsTexture();
 
@@ -288,9 +404,9 @@ bool ImGui_ImplGlfwGL3_CreateDeviceObjects()
 
 void    ImGui_ImplGlfwGL3_InvalidateDeviceObjects()
 {
-    if (g_VboHandle) gl::DeleteBuffers(1, &g_VboHandle);
-    if (g_ElementsHandle) gl::DeleteBuffers(1, &g_ElementsHandle);
-    g_VboHandle = g_ElementsHandle = 0;
+    ImGui_ImplGlfwGL3_DestroyStreamBuffer();
+    if (g_VaoHandle) gl::DeleteVertexArrays(1, &g_VaoHandle);
+    g_VaoHandle = 0;
 
     if (g_ShaderHandle && g_VertHandle) gl::DetachShader(g_ShaderHandle, g_VertHandle);
     if (g_VertHandle) gl::DeleteShader(g_VertHandle);
@@ -18,6 +18,13 @@ void        ImGui_ImplGlfwGL3_Shutdown();
 void        ImGui_ImplGlfwGL3_NewFrame();
 void        ImGui_ImplGlfwGL3_RenderDrawData(ImDrawData* draw_data);
 
+// Called after rendering instead of restoring the GL state queried before rendering. Set it when the application
+// tracks its own GL state, so the ~20 state queries per frame are skipped. ImGui leaves its program, VAO, font/user
+// texture on unit 0 and blend / scissor enabled, depth test / face culling / primitive restart disabled for the
+// callback to undo.
+typedef void (*ImGui_ImplGlfwGL3_RestoreStateFn)(void* user_data);
+void        ImGui_ImplGlfwGL3_SetRestoreStateCallback(ImGui_ImplGlfwGL3_RestoreStateFn restore_fn, void* user_data);
+
 // Use if you want to reset your rendering device without losing ImGui state.
 void        ImGui_ImplGlfwGL3_InvalidateDeviceObjects();
 bool        ImGui_ImplGlfwGL3_CreateDeviceObjects();
@@ -0,0 +1,64 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Bounding volumes used to describe the extent
+ * of drawable objects. Used by the frustum and
+ * the culling list to reject objects that are
+ * not visible before they are submitted.
+ */
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+// Axis aligned bounding box
+struct AABB
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Bounding sphere
+struct BoundingSphere
+{
+    glm::vec3 center;
+    float radius;
+};
+
+// Ray with an origin and a (normalized) direction
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// Compute the tightest AABB around count points
+AABB makeAABB(const glm::vec3* points, unsigned count);
+
+// Make a bounding sphere that encloses the given AABB
+BoundingSphere makeBoundingSphere(const AABB& box);
+
+// Transform an AABB by the given matrix and return the AABB around the result
+AABB transformAABB(const AABB& box, const glm::mat4& transform);
+
+// Return the smallest AABB that encloses both a and b
+AABB mergeAABB(const AABB& a, const AABB& b);
+
+// Get the surface area of the box
+float surfaceArea(const AABB& box);
+
+// True if the two boxes overlap
+bool overlaps(const AABB& a, const AABB& b);
+
+// True if the sphere and the box overlap
+bool overlaps(const BoundingSphere& sphere, const AABB& box);
+
+// Slab test. True if the ray hits the box before maxDistance. The entry distance is written to distance
+bool intersectRay(const Ray& ray, const glm::vec3& inverseDirection, const AABB& box, float maxDistance, float& distance);
+
+// Transform a bounding sphere by the given matrix (radius is scaled by the largest axis scale)
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& transform);
+
+#endif // BOUNDS_H
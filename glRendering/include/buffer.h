@@ -10,9 +10,16 @@
 #define BUFFER_H
 
 #include "shader.h"
+#include "enums.h"
+#include "logging.h"
+#include "renderStats.h"
 
 #include <string>
+#include <vector>
 #include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
 #include <unordered_map>
 
 #include "gl_cpp.hpp"
@@ -26,15 +33,25 @@ public:
         gl::CreateBuffers(1, &mName);
     }
 
-    // Construct from known data of size
-    VertexBuffer(const void* data, ptrdiff_t dataSize)
+    // Construct from known data of size. Pass gl::DYNAMIC_STORAGE_BIT as storage flags to update it with setData
+    VertexBuffer(const void* data, ptrdiff_t dataSize, unsigned storageFlags = 0)
     {
         gl::CreateBuffers(1, &mName);
-        gl::NamedBufferStorage(mName, dataSize, data, 0);
+        gl::NamedBufferStorage(mName, dataSize, data, storageFlags);
+        if (data) RenderStats::addUpload(dataSize);
+    }
+
+    // Construct from vertices, remembering the size of VertexT as the stride
+    template<typename VertexT>
+    explicit VertexBuffer(const std::vector<VertexT>& vertices) : mStride(static_cast<int>(sizeof(VertexT)))
+    {
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, sizeof(VertexT) * vertices.size(), vertices.data(), 0);
+        RenderStats::addUpload(sizeof(VertexT) * vertices.size());
     }
 
     // Copy Ctor
-    VertexBuffer(const VertexBuffer& other)
+    VertexBuffer(const VertexBuffer& other) : mStride(other.mStride)
     {
         resetBufferDataFromCopy(other);
     }
@@ -44,12 +61,13 @@ public:
     {
         if (this == &other) return *this;
         resetBufferDataFromCopy(other);
+        mStride = other.mStride;
 
         return *this;
     }
 
     // Move Ctor
-    VertexBuffer(VertexBuffer&& other) : mName(other.mName)
+    VertexBuffer(VertexBuffer&& other) : mName(other.mName), mStride(other.mStride)
     {
         other.mName = 0;
     }
@@ -64,6 +82,7 @@ public:
         
         // Steal Resources
         mName = other.mName;
+        mStride = other.mStride;
         other.mName = 0;        
         
         return *this;
@@ -86,12 +105,25 @@ public:
         gl::BindBuffer(gl::ARRAY_BUFFER, 0);
     }
 
+    // Overwrite size bytes at offset, the buffer must be created with gl::DYNAMIC_STORAGE_BIT
+    void setData(const void* data, ptrdiff_t size, ptrdiff_t offset = 0)
+    {
+        gl::NamedBufferSubData(mName, offset, size, data);
+        RenderStats::addUpload(size);
+    }
+
     // Return the OpenGL name of the buffer
     const unsigned name() const
     {
         return mName;
     }
 
+    // Get the size of a vertex in the buffer, 0 if created from untyped data
+    const int getStride() const
+    {
+        return mStride;
+    }
+
 private:
     // Clear current buffer data and re-initialize with data copied from source
     void resetBufferDataFromCopy(const VertexBuffer& source)
@@ -109,9 +141,63 @@ private:
     // The OpenGL Name
     unsigned mName = 0;
 
+    // Size of a vertex in bytes, 0 if unknown
+    int mStride = 0;
+
 };
 
 
+// Index that ends a strip and starts the next one. Primitive restart uses the fixed index, the largest
+// value of the index type, so indices are stored with RestartIndex converted to the largest value
+constexpr unsigned RestartIndex = 0xFFFFFFFFu;
+
+// Get the size of one index of the type in bytes
+inline unsigned indexSize(EIndexType type)
+{
+    switch (type)
+    {
+    case EIndexType::UnsignedByte: return 1;
+    case EIndexType::UnsignedShort: return 2;
+    default: return 4;
+    }
+}
+
+// Get the smallest index type that can store indices up to maxIndex. The largest value is kept free for restarts
+inline EIndexType chooseIndexType(unsigned maxIndex)
+{
+    if (maxIndex < 0xFFu) return EIndexType::UnsignedByte;
+    if (maxIndex < 0xFFFFu) return EIndexType::UnsignedShort;
+    return EIndexType::UnsignedInt;
+}
+
+// Get the largest index in the list, ignoring restarts
+inline unsigned maxIndex(const unsigned* indices, unsigned count)
+{
+    unsigned result = 0;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (indices[i] != RestartIndex) result = std::max(result, indices[i]);
+    }
+    return result;
+}
+
+// Convert count indices to the type, writing count * indexSize(type) bytes to out
+inline void packIndices(const unsigned* indices, unsigned count, EIndexType type, void* out)
+{
+    switch (type)
+    {
+    case EIndexType::UnsignedByte:
+        std::transform(indices, indices + count, static_cast<uint8_t*>(out), [](unsigned i) { return static_cast<uint8_t>(i); });
+        break;
+    case EIndexType::UnsignedShort:
+        std::transform(indices, indices + count, static_cast<uint16_t*>(out), [](unsigned i) { return static_cast<uint16_t>(i); });
+        break;
+    default:
+        std::memcpy(out, indices, static_cast<size_t>(count) * sizeof(unsigned));
+        break;
+    }
+}
+
 class IndexBuffer
 {
 public:
@@ -120,13 +206,31 @@ public:
         gl::CreateBuffers(1, &mName);
     }
     
-    IndexBuffer(const void* data, ptrdiff_t dataSize, unsigned count) : mCount(count)
+    // Create from data already stored as the given type. Pass gl::DYNAMIC_STORAGE_BIT as storage flags to update it with setData
+    IndexBuffer(const void* data, ptrdiff_t dataSize, unsigned count, EIndexType type = EIndexType::UnsignedInt, unsigned storageFlags = 0) :
+        mCount(count), mType(type)
     {
         gl::CreateBuffers(1, &mName);
-        gl::NamedBufferStorage(mName, dataSize, data, 0);
+        gl::NamedBufferStorage(mName, dataSize, data, storageFlags);
+        if (data) RenderStats::addUpload(dataSize);
     };
 
-    IndexBuffer(IndexBuffer&& other) : mName(other.mName), mCount(other.mCount)
+    // Create from 32-bit indices, stored in the smallest type that fits the largest index
+    IndexBuffer(const unsigned* indices, unsigned count) : mCount(count), mType(chooseIndexType(maxIndex(indices, count)))
+    {
+        std::vector<uint8_t> packed(static_cast<size_t>(count) * indexSize(mType));
+        packIndices(indices, count, mType, packed.data());
+
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, static_cast<ptrdiff_t>(packed.size()), packed.data(), 0);
+        RenderStats::addUpload(static_cast<ptrdiff_t>(packed.size()));
+    }
+
+    explicit IndexBuffer(const std::vector<unsigned>& indices) : IndexBuffer(indices.data(), static_cast<unsigned>(indices.size()))
+    {
+    }
+
+    IndexBuffer(IndexBuffer&& other) : mName(other.mName), mCount(other.mCount), mType(other.mType)
     {
         other.mName = 0;
     }
@@ -141,6 +245,7 @@ public:
         // Steal Resources
         mCount = other.mCount;
         mName = other.mName;
+        mType = other.mType;
         other.mName = 0;      
         other.mCount = 0;
         
@@ -164,6 +269,23 @@ public:
         return mCount;
     }
 
+    // Get the type the indices are stored as, pass it to the draw call
+    const EIndexType getType() const
+    {
+        return mType;
+    }
+
+    // Overwrite count indices starting at firstIndex, converted to the stored type. The buffer must be created with
+    // gl::DYNAMIC_STORAGE_BIT and the indices must fit the type
+    void setData(const unsigned* indices, unsigned count, unsigned firstIndex = 0)
+    {
+        const unsigned size = indexSize(mType);
+        std::vector<uint8_t> packed(static_cast<size_t>(count) * size);
+        packIndices(indices, count, mType, packed.data());
+        gl::NamedBufferSubData(mName, static_cast<ptrdiff_t>(firstIndex) * size, static_cast<ptrdiff_t>(packed.size()), packed.data());
+        RenderStats::addUpload(static_cast<ptrdiff_t>(packed.size()));
+    }
+
     // Bind to the element array buffer
     void bind() const
     {
@@ -182,6 +304,9 @@ private:
 
     // Number of indices
     unsigned mCount = 0;
+
+    // Type of the stored indices
+    EIndexType mType = EIndexType::UnsignedInt;
 };
 
 class UniformBuffer
@@ -229,6 +354,7 @@ public:
     void setBlockData(const void* data, ptrdiff_t dataSize)
     {
         gl::NamedBufferSubData(mName, 0, dataSize, data);
+        RenderStats::addUpload(dataSize);
     }
 
     // Set the data for a subset of the uniform with the given name
@@ -253,6 +379,7 @@ public:
 
         // Make OpenGL Write the data to that location
         gl::NamedBufferSubData(mName, mUniformOffsetCache.at(uniformName), dataSize, data);
+        RenderStats::addUpload(dataSize);
     }
 
     // Bind uniform buffer to given bind point, default = 1
@@ -287,6 +414,8 @@ public:
     // Construct a buffer with size amount of atomic counters
     AtomicCounterBuffer(const unsigned size) : mSize(size)
     {
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, sizeof(unsigned) * mSize, nullptr, gl::DYNAMIC_STORAGE_BIT);
         reset();
     }
 
@@ -295,15 +424,23 @@ public:
         gl::DeleteBuffers(1, &mName);
     }
 
-    // Reset the counter to 0
+    // Return the OpenGL name of the buffer
+    const unsigned name() const
+    {
+        return mName;
+    }
+
+    // Get the number of counters in the buffer
+    const unsigned getSize() const
+    {
+        return mSize;
+    }
+
+    // Reset all counters to 0
     void reset()
-    {   // #TODO Do this more elegantly, as this feels awkward
-        unbind();
-        gl::DeleteBuffers(1, &mName);
-        gl::CreateBuffers(1, &mName);
-        std::unique_ptr<unsigned[]> data = std::make_unique<unsigned[]>(mSize);
-        for (int i = 0; i != mSize; ++i) data[i] = 0u;
-        gl::NamedBufferStorage(mName, sizeof(unsigned) * mSize, data.get(), 0);
+    {
+        const unsigned zero = 0u;
+        gl::ClearNamedBufferData(mName, gl::R32UI, gl::RED_INTEGER, gl::UNSIGNED_INT, &zero);
     }
 
     // Bind to the given Atomic Counter Binding
@@ -312,6 +449,12 @@ public:
         gl::BindBufferBase(gl::ATOMIC_COUNTER_BUFFER, bindingPoint, mName);
     }
 
+    // Bind a single counter to the given Atomic Counter Binding
+    const void bindCounter(const unsigned counter, const unsigned bindingPoint = 0) const
+    {
+        gl::BindBufferRange(gl::ATOMIC_COUNTER_BUFFER, bindingPoint, mName, sizeof(unsigned) * counter, sizeof(unsigned));
+    }
+
     // Unbind from the given Atomic Counter Binding
     const void unbind(const unsigned bindingPoint = 0) const
     {
@@ -326,4 +469,273 @@ private:
     const unsigned mSize;
 };
 
+class ShaderStorageBuffer
+{
+public:
+    // Create a shader storage buffer of size bytes, optionally initialized with data
+    ShaderStorageBuffer(ptrdiff_t size, const void* data = nullptr) : mSize(size)
+    {
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, size, data, gl::DYNAMIC_STORAGE_BIT);
+        if (data) RenderStats::addUpload(size);
+    }
+
+    ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+    ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+    ~ShaderStorageBuffer()
+    {
+        gl::DeleteBuffers(1, &mName);
+    }
+
+    // Return the OpenGL name of the buffer
+    const unsigned name() const
+    {
+        return mName;
+    }
+
+    // Get the size of the buffer in bytes
+    const ptrdiff_t getSize() const
+    {
+        return mSize;
+    }
+
+    // Write dataSize bytes of data to the buffer at offset
+    void setData(const void* data, ptrdiff_t dataSize, ptrdiff_t offset = 0)
+    {
+        gl::NamedBufferSubData(mName, offset, dataSize, data);
+        RenderStats::addUpload(dataSize);
+    }
+
+    // Bind to the given shader storage binding point
+    void bind(const unsigned bindingPoint) const
+    {
+        gl::BindBufferBase(gl::SHADER_STORAGE_BUFFER, bindingPoint, mName);
+    }
+
+    // Unbind from the given shader storage binding point
+    void unbind(const unsigned bindingPoint) const
+    {
+        gl::BindBufferBase(gl::SHADER_STORAGE_BUFFER, bindingPoint, 0);
+    }
+
+private:
+    // The OpenGL Name
+    unsigned mName = 0;
+
+    // Size in bytes
+    ptrdiff_t mSize = 0;
+};
+
+// Layout of a single indirect indexed draw, as consumed by DrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    unsigned count;
+    unsigned instanceCount;
+    unsigned firstIndex;
+    int baseVertex;
+    unsigned baseInstance;
+};
+
+class IndirectBuffer
+{
+public:
+    // Create a buffer with room for commandCount indirect draw commands
+    IndirectBuffer(unsigned commandCount) : mCommandCount(commandCount)
+    {
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, sizeof(DrawElementsIndirectCommand) * commandCount, nullptr, gl::DYNAMIC_STORAGE_BIT);
+    }
+
+    IndirectBuffer(const IndirectBuffer&) = delete;
+    IndirectBuffer& operator=(const IndirectBuffer&) = delete;
+
+    ~IndirectBuffer()
+    {
+        gl::DeleteBuffers(1, &mName);
+    }
+
+    // Return the OpenGL name of the buffer
+    const unsigned name() const
+    {
+        return mName;
+    }
+
+    // Get the number of commands the buffer can hold
+    const unsigned getCommandCount() const
+    {
+        return mCommandCount;
+    }
+
+    // Overwrite the command at the given index
+    void setCommand(unsigned index, const DrawElementsIndirectCommand& command)
+    {
+        gl::NamedBufferSubData(mName, sizeof(DrawElementsIndirectCommand) * index, sizeof(DrawElementsIndirectCommand), &command);
+        RenderStats::addUpload(sizeof(DrawElementsIndirectCommand));
+    }
+
+    // Bind to the draw indirect target
+    void bind() const
+    {
+        gl::BindBuffer(gl::DRAW_INDIRECT_BUFFER, mName);
+    }
+
+    // Unbind from the draw indirect target
+    void unbind() const
+    {
+        gl::BindBuffer(gl::DRAW_INDIRECT_BUFFER, 0);
+    }
+
+private:
+    // The OpenGL Name
+    unsigned mName = 0;
+
+    // Number of commands
+    unsigned mCommandCount = 0;
+};
+
+/*
+ * Per-instance vertex attributes that are rewritten every frame.
+ * The buffer is persistently mapped and split in regions, one per
+ * frame in flight, so writing the next frame never stalls on draws
+ * that still read the previous one. Attach it to a VertexArray binding
+ * with VertexArray::setBuffer(InstanceBuffer) and draw with the base
+ * instance from getBaseInstance() to read from the current region.
+ */
+class InstanceBuffer
+{
+public:
+    // Room for maxInstances instances of instanceSize bytes per frame, with regionCount frames in flight
+    InstanceBuffer(unsigned instanceSize, unsigned maxInstances, unsigned regionCount = 3) :
+        mInstanceSize(instanceSize), mMaxInstances(maxInstances), mFences(regionCount, nullptr)
+    {
+        const unsigned flags = gl::MAP_WRITE_BIT | gl::MAP_PERSISTENT_BIT | gl::MAP_COHERENT_BIT;
+        const ptrdiff_t size = static_cast<ptrdiff_t>(mInstanceSize) * mMaxInstances * regionCount;
+
+        gl::CreateBuffers(1, &mName);
+        gl::NamedBufferStorage(mName, size, nullptr, flags);
+        mMapped = static_cast<char*>(gl::MapNamedBufferRange(mName, 0, size, flags));
+    }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    ~InstanceBuffer()
+    {
+        for (auto fence : mFences)
+        {
+            if (fence) gl::DeleteSync(fence);
+        }
+
+        gl::UnmapNamedBuffer(mName);
+        gl::DeleteBuffers(1, &mName);
+    }
+
+    // Return the OpenGL name of the buffer
+    const unsigned name() const
+    {
+        return mName;
+    }
+
+    // Get the size of a single instance in bytes
+    const unsigned getInstanceSize() const
+    {
+        return mInstanceSize;
+    }
+
+    // Get the maximum number of instances per frame
+    const unsigned getMaxInstances() const
+    {
+        return mMaxInstances;
+    }
+
+    // Get the number of instances written this frame
+    const unsigned getInstanceCount() const
+    {
+        return mInstanceCount;
+    }
+
+    // Get the first instance of the current region, pass as base instance when drawing
+    const unsigned getBaseInstance() const
+    {
+        return mRegion * mMaxInstances;
+    }
+
+    // Get a pointer to the current region to write instanceCount instances into directly
+    void* map(unsigned instanceCount)
+    {
+        waitForRegion();
+        mInstanceCount = std::min(instanceCount, mMaxInstances);
+        return mMapped + static_cast<ptrdiff_t>(getBaseInstance()) * mInstanceSize;
+    }
+
+    // Copy instanceCount instances into the current region. Returns the number of instances written
+    unsigned setData(const void* data, unsigned instanceCount)
+    {
+        if (instanceCount > mMaxInstances)
+        {
+            logWarn("InstanceBuffer: {} instances exceeds the capacity of {}, extra instances are ignored", instanceCount, mMaxInstances);
+        }
+
+        void* region = map(instanceCount);
+        std::memcpy(region, data, static_cast<size_t>(mInstanceCount) * mInstanceSize);
+        RenderStats::addUpload(static_cast<ptrdiff_t>(mInstanceCount) * mInstanceSize);
+        return mInstanceCount;
+    }
+
+    // Call after the draws reading this frame's instances are submitted, moves on to the next region
+    void finishFrame()
+    {
+        // A frame that wrote no instances never waited on the fence of its region, the new one covers it
+        if (mFences[mRegion]) gl::DeleteSync(mFences[mRegion]);
+        mFences[mRegion] = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mRegion = (mRegion + 1) % static_cast<unsigned>(mFences.size());
+        mInstanceCount = 0;
+    }
+
+private:
+    // Block until the GPU is done reading the current region
+    void waitForRegion()
+    {
+        GLsync& fence = mFences[mRegion];
+        if (!fence) return;
+
+        while (true)
+        {
+            const auto result = gl::ClientWaitSync(fence, gl::SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+            if (result == gl::ALREADY_SIGNALED || result == gl::CONDITION_SATISFIED) break;
+            if (result == gl::WAIT_FAILED_)
+            {
+                logErr("InstanceBuffer: Failed to wait for the GPU to release a region!");
+                break;
+            }
+        }
+
+        gl::DeleteSync(fence);
+        fence = nullptr;
+    }
+
+private:
+    // The OpenGL Name
+    unsigned mName = 0;
+
+    // Persistently mapped pointer to the start of the buffer
+    char* mMapped = nullptr;
+
+    // Size of an instance in bytes
+    const unsigned mInstanceSize;
+
+    // Instances per region
+    const unsigned mMaxInstances;
+
+    // Instances written to the current region
+    unsigned mInstanceCount = 0;
+
+    // The region being written this frame
+    unsigned mRegion = 0;
+
+    // Fence per region, signaled when the GPU is done reading it
+    std::vector<GLsync> mFences;
+};
+
 #endif // BUFFER_H
@@ -0,0 +1,83 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * A bounding volume hierarchy over the world space
+ * bounds of a set of objects. Built top-down with the
+ * surface area heuristic and stored as a flat array of
+ * nodes in depth-first order, so the left child always
+ * follows its parent directly in memory. Objects that
+ * move can update their bounds and the tree can then be
+ * refit without a full rebuild. Accelerates frustum culling,
+ * ray picking and range queries over large scenes.
+ */
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "bounds.h"
+#include "frustum.h"
+
+#include <vector>
+
+class BVH
+{
+public:
+    // Build the hierarchy over the bounds of all objects. Object ids are indices into bounds
+    void build(const std::vector<AABB>& bounds);
+
+    // Update the bounds of an object. Call refit() once all moved objects are updated
+    void update(unsigned object, const AABB& bounds);
+
+    // Recompute the bounds of all nodes bottom-up to match updated object bounds
+    void refit();
+
+    // Write the ids of all objects whose bounds are (partially) inside the frustum to visible
+    void queryFrustum(const Frustum& frustum, std::vector<unsigned>& visible) const;
+
+    // Write the ids of all objects whose bounds overlap the range to result
+    void queryRange(const AABB& range, std::vector<unsigned>& result) const;
+    void queryRange(const BoundingSphere& range, std::vector<unsigned>& result) const;
+
+    // Find the closest object whose bounds are hit by the ray. Returns false if nothing was hit
+    bool raycast(const Ray& ray, unsigned& hitObject, float& hitDistance, float maxDistance = 1e30f) const;
+
+    // Get the number of objects in the hierarchy
+    const unsigned size() const;
+
+    // Get the number of nodes in the hierarchy
+    const unsigned nodeCount() const;
+
+private:
+    // A node is 32 bytes so two nodes fit in a cache line
+    struct Node
+    {
+        AABB bounds;
+
+        // Leaf: Index of the first object in mObjectIndices. Interior: Index of the right child
+        unsigned offset;
+
+        // Number of objects in the leaf, 0 for interior nodes
+        unsigned count;
+    };
+
+    // Recursively build the subtree over mObjectIndices[first, first + count)
+    void buildRecursive(unsigned first, unsigned count, unsigned depth);
+
+    // Add all objects below the node to result without further testing
+    void collectSubtree(unsigned nodeIndex, std::vector<unsigned>& result) const;
+
+private:
+    // Flattened nodes in depth-first order. Node 0 is the root
+    std::vector<Node> mNodes;
+
+    // Object ids, grouped so every leaf references a contiguous range
+    std::vector<unsigned> mObjectIndices;
+
+    // World space bounds of every object
+    std::vector<AABB> mObjectBounds;
+
+    // Centroids of the object bounds, used during the build
+    std::vector<glm::vec3> mCentroids;
+};
+
+#endif // BVH_H
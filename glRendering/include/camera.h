@@ -9,6 +9,9 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include "frustum.h"
+
+#include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/mat4x4.hpp"
 
@@ -39,6 +42,12 @@ public:
 
     // Return the viewMatrix produced by this camera
     glm::mat4 getViewMatrix() const;
+
+    // Return the view frustum of this camera when used with the given projection
+    Frustum getFrustum(const glm::mat4& projection) const;
+
+    // Return a world space ray going from the camera through the cursor position (in window coordinates)
+    Ray getPickingRay(const glm::dvec2& cursor, const glm::ivec2& viewportSize, const glm::mat4& projection) const;
 };
 
 
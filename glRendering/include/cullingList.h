@@ -0,0 +1,60 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * A list of bounding spheres stored as a structure
+ * of arrays so that many objects can be tested against
+ * the frustum at once with SIMD instructions (4 objects
+ * per instruction with SSE, 8 with AVX). Fill it with the
+ * world space bounds of your draw list, cull it and then
+ * only submit the objects whose indices are returned.
+ */
+
+#ifndef CULLINGLIST_H
+#define CULLINGLIST_H
+
+#include "bounds.h"
+#include "frustum.h"
+
+#include <vector>
+
+class JobSystem;
+
+class CullingList
+{
+public:
+    // Remove all objects from the list
+    void clear();
+
+    // Reserve space for count objects
+    void reserve(unsigned count);
+
+    // Add a world space sphere to the list, returns the index of the object
+    unsigned add(const BoundingSphere& sphere);
+
+    // Update the sphere of an object that is already in the list
+    void set(unsigned index, const BoundingSphere& sphere);
+
+    // Get the number of objects in the list
+    const unsigned size() const;
+
+    // Cull the list against the frustum. The indices of all visible objects are written to visible
+    void cull(const Frustum& frustum, std::vector<unsigned>& visible) const;
+
+    // Cull a range [first, last) of the list. Useful for splitting the work across threads
+    void cull(const Frustum& frustum, unsigned first, unsigned last, std::vector<unsigned>& visible) const;
+
+    // Cull the list in blocks spread over the job system. The indices are written in the same order as cull
+    void cull(const Frustum& frustum, std::vector<unsigned>& visible, JobSystem& jobs) const;
+
+private:
+    // Number of objects (the arrays are padded beyond this)
+    unsigned mCount = 0;
+
+    // Sphere centers and radii. Always padded to a multiple of the SIMD width
+    std::vector<float> mX;
+    std::vector<float> mY;
+    std::vector<float> mZ;
+    std::vector<float> mRadius;
+};
+
+#endif // CULLINGLIST_H
@@ -30,4 +30,42 @@ enum class EImageMode
     ReadWrite = 0x88BA
 };
 
+// Shader stage of a single shader source
+enum class EShaderType
+{
+    Vertex = 0x8B31,    // Maps directly to the OpenGL shader type
+    Fragment = 0x8B30,
+    Compute = 0x91B9
+};
+
+// Memory layout of the vertices uploaded to OpenGL
+enum class EVertexFormat
+{
+    Standard,   // Vertex: 32 bytes of floats
+    Compact     // CompactVertex: 16 bytes of half floats and normalized integers
+};
+
+// Type of the indices in an index buffer
+enum class EIndexType
+{
+    UnsignedByte = 0x1401,  // Maps directly to the OpenGL type
+    UnsignedShort = 0x1403,
+    UnsignedInt = 0x1405
+};
+
+// How indices are assembled into triangles
+enum class EPrimitiveType
+{
+    Triangles = 0x0004,     // Maps directly to the OpenGL primitive mode
+    TriangleStrip = 0x0005  // Split into several strips with RestartIndex
+};
+
+// How two segments of a thick polyline are connected
+enum class ELineJoin
+{
+    Miter,      // Extend the edges until they meet, falls back to Bevel for sharp angles
+    Bevel,      // Cut the corner with a single triangle
+    Round       // Fill the corner with a circle segment
+};
+
 #endif // ENUMS_H
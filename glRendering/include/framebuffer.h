@@ -3,8 +3,9 @@
 /*
  * Abstracts an OpenGL framebuffer. Currently
  * has a fixed layout. Texture attached to the
- * Color0 attachment, and a renderbuffer attached
- * to the depth/stencil attachment.
+ * Color0 attachment, and a depth/stencil texture
+ * attached to the depth/stencil attachment so the
+ * depth can be sampled (e.g. for a Hi-Z pyramid).
  */
 
 #ifndef FRAMEBUFFER_H
@@ -23,8 +24,14 @@ private:
     // Texture for Color Attachment 0
     uint32_t m_texture = 0;
 
-    // Renderbuffer for Depth / Stencil
-    uint32_t m_renderbuffer = 0;
+    // Texture for Depth / Stencil
+    uint32_t m_depthTexture = 0;
+
+    // Size of the attachments
+    glm::ivec2 m_size{};
+
+    // GPU profiler zone of the pass from bind to unbind, -1 if none
+    int m_gpuZone = -1;
 
 public:
     // Ctor from a size
@@ -63,6 +70,15 @@ public:
     // Unbind the framebuffer color texture from a texture binding point
     void unbindTexture(unsigned bindingPoint);
 
+    // Bind the framebuffer depth texture to a texture binding point
+    void bindDepthTexture(unsigned bindingPoint) const;
+
+    // Get the OpenGL name of the depth texture
+    uint32_t getDepthTexture() const;
+
+    // Get the size of the framebuffer attachments
+    const glm::ivec2& getSize() const;
+
     // Recreate the framebuffer with a new size
     void resetToNewSize(const glm::ivec2& size);
 
@@ -76,11 +92,15 @@ private:
     // Create the texture attachment
     void createTexture(const glm::ivec2& size);
 
-    // Create the renderbuffer for depth/stencil
-    void createRenderbuffer(const glm::ivec2& size);
+    // Create the texture for depth/stencil
+    void createDepthTexture(const glm::ivec2& size);
 
     // Reset this framebuffer to be a copy of the other
     void resetFromCopy(const Framebuffer& other);
+
+    // Start / end timing the pass drawn into the framebuffer on the GPU profiler, if one is provided
+    void beginPass();
+    void endPass();
 };
 
 #endif // FRAMEBUFFER_H
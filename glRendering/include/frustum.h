@@ -0,0 +1,51 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * A view frustum described by six planes
+ * extracted from a view-projection matrix.
+ * Can be used to test whether bounding volumes
+ * are (partially) visible to the camera.
+ */
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "bounds.h"
+
+#include <array>
+
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+class Frustum
+{
+public:
+    // Indices of the planes in the plane array
+    enum EPlane
+    {
+        Left, Right, Bottom, Top, Near, Far, PlaneCount
+    };
+
+    Frustum() = default;
+
+    // Extract the frustum planes from a projection * view matrix
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // True if any part of the sphere is inside the frustum
+    const bool intersects(const BoundingSphere& sphere) const;
+
+    // True if any part of the box is inside the frustum
+    const bool intersects(const AABB& box) const;
+
+    // True if the box is completely inside the frustum
+    const bool contains(const AABB& box) const;
+
+    // Get a plane as (normal.xyz, distance). Normals point into the frustum
+    const glm::vec4& getPlane(EPlane plane) const;
+
+private:
+    // The normalized planes of the frustum
+    std::array<glm::vec4, PlaneCount> mPlanes;
+};
+
+#endif // FRUSTUM_H
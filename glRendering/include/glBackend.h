@@ -0,0 +1,193 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Swaps what the gl:: functions of the loader call.
+ * The Driver backend is the GL of the current context.
+ * The Null backend needs no context at all: Calls do
+ * nothing but count, objects get made up names, and
+ * buffers are plain memory so mapping and reading back
+ * work. Shaders compile, framebuffers are complete and
+ * fences are signalled right away. The Recording
+ * backend appends every call with its arguments to a
+ * GLCommandStream before passing it on to the driver
+ * or the null backend. The Tracing backend writes every
+ * call to a GLTraceWriter and calls the driver (see
+ * glTrace.h).
+ *
+ * This makes it possible to measure what submitting a
+ * frame costs the CPU without the driver, and to check
+ * the calls Renderer or RenderBatch make on machines
+ * without a GPU. Switch backends on the thread that
+ * makes the GL calls, while no GL call is in progress.
+ */
+
+#ifndef GLBACKEND_H
+#define GLBACKEND_H
+
+#include "gl_cpp.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+class GLTraceWriter;
+
+// Every function of the loader
+enum class EGLFunction : uint16_t
+{
+#define GL_FUNCTION(name) name,
+#include "gl_cpp_functions.hpp"
+#undef GL_FUNCTION
+    Count
+};
+
+enum class EGLBackend
+{
+    Driver,
+    Null,
+    Recording,
+    Tracing
+};
+
+// The loader's function pointer of a function
+template<EGLFunction F>
+struct GLFunctionTraits;
+
+#define GL_FUNCTION(name)                                      \
+    template<>                                                 \
+    struct GLFunctionTraits<EGLFunction::name>                 \
+    {                                                          \
+        using Type = decltype(gl::name);                       \
+        static Type& pointer() { return gl::name; }            \
+    };
+#include "gl_cpp_functions.hpp"
+#undef GL_FUNCTION
+
+// Return and argument types of a function pointer of the loader
+template<typename Function>
+struct GLSignature;
+
+template<typename R, typename... Args>
+struct GLSignature<R (CODEGEN_FUNCPTR *)(Args...)>
+{
+    using Result = R;
+    using Arguments = std::tuple<std::decay_t<Args>...>;
+};
+
+// Get the name of a function without the gl prefix, e.g. "DrawElements"
+const char* getGLFunctionName(EGLFunction function);
+
+// A recorded call
+struct GLCommand
+{
+    EGLFunction function;
+
+    // The arguments packed back to back as they were passed
+    const unsigned char* arguments;
+    unsigned size;
+
+    // Unpack the arguments of a call of F. Pointers are the addresses the caller passed, not what they pointed to
+    template<EGLFunction F>
+    typename GLSignature<typename GLFunctionTraits<F>::Type>::Arguments getArguments() const;
+};
+
+// Calls in the order they were made, written by the Recording backend
+class GLCommandStream final
+{
+public:
+    // Append a call
+    template<typename... Args>
+    void write(EGLFunction function, const Args&... args);
+
+    // Remove every call
+    void clear();
+
+    // Get every call in the order they were made, valid until the stream changes
+    std::vector<GLCommand> getCommands() const;
+
+    // Get the number of calls of a function in the stream
+    const unsigned count(EGLFunction function) const;
+
+    // Get the number of calls in the stream
+    const unsigned size() const;
+
+    // Get the size of the stream in bytes
+    const size_t byteSize() const;
+
+private:
+    // Header of every call in mData, followed by the arguments
+    struct Header
+    {
+        EGLFunction function;
+        uint16_t size;
+    };
+
+    std::vector<unsigned char> mData;
+    unsigned mCount = 0;
+};
+
+class GLBackend final
+{
+public:
+    GLBackend() = delete;
+
+    // Call the GL of the current context, the default
+    static void useDriver();
+
+    // Call nothing, no context is needed
+    static void useNull();
+
+    // Append every call to the stream, then call the driver or the null backend. The stream must outlive the backend
+    static void useRecording(GLCommandStream& stream, EGLBackend target = EGLBackend::Null);
+
+    // Write every call to the trace, then call the driver. The writer must outlive the backend
+    static void useTracing(GLTraceWriter& writer);
+
+    // Get the backend the gl:: functions call
+    static const EGLBackend get();
+
+    // Get the calls of a function made through a backend other than the driver since the last reset
+    static const uint64_t getCallCount(EGLFunction function);
+
+    // Get the calls of every function made through a backend other than the driver since the last reset
+    static const uint64_t getTotalCallCount();
+
+    static void resetCallCounts();
+};
+
+template<EGLFunction F>
+typename GLSignature<typename GLFunctionTraits<F>::Type>::Arguments GLCommand::getArguments() const
+{
+    assert(function == F && "GLCommand: Arguments unpacked as the wrong function");
+
+    typename GLSignature<typename GLFunctionTraits<F>::Type>::Arguments result;
+    size_t offset = 0;
+    std::apply([&](auto&... values)
+    {
+        ((std::memcpy(&values, arguments + offset, sizeof(values)), offset += sizeof(values)), ...);
+    }, result);
+
+    return result;
+}
+
+template<typename... Args>
+void GLCommandStream::write(EGLFunction function, const Args&... args)
+{
+    constexpr size_t argumentSize = (sizeof(Args) + ... + 0);
+    static_assert(argumentSize <= UINT16_MAX, "GLCommandStream: Arguments too large to record");
+
+    const Header header{ function, static_cast<uint16_t>(argumentSize) };
+    size_t offset = mData.size();
+    mData.resize(offset + sizeof(Header) + argumentSize);
+
+    std::memcpy(mData.data() + offset, &header, sizeof(Header));
+    offset += sizeof(Header);
+    ((std::memcpy(mData.data() + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+
+    ++mCount;
+}
+
+#endif // GLBACKEND_H
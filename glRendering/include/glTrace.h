@@ -0,0 +1,226 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Traces of every GL call made through the loader, to
+ * reproduce a slow frame offline (see tools/glReplay).
+ * The Tracing backend of GLBackend hands each call to
+ * a GLTraceWriter before calling the driver, which
+ * writes the arguments and whatever the pointers among
+ * them point at: Buffer and texture uploads, shader
+ * sources, name and uniform arrays. Names the driver
+ * hands out are written after the call, so a replay can
+ * tell when its driver handed out different ones.
+ *
+ * Writes through MapNamedBufferRange mappings do not go
+ * through GL. The writer compares every mapping with a
+ * copy of what it last wrote before each call that may
+ * read it (draws, dispatches, copies, fences, flushes
+ * and unmaps) and writes the changed ranges. Persistent
+ * mappings are read back that way, which is slow on
+ * some drivers but only while tracing.
+ *
+ * Start tracing right after the context is created: A
+ * trace holds calls, not the state the context had when
+ * it started, so a replay of a trace started later is
+ * missing the objects made before it.
+ */
+
+#ifndef GLTRACE_H
+#define GLTRACE_H
+
+#include "files.h"
+#include "glBackend.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum class EGLTraceRecord : uint8_t
+{
+    // A GL call, with the payloads of its pointer arguments and its result
+    Call = 1,
+
+    // Memory of a mapped buffer changed by the application
+    MappedWrite = 2,
+
+    // The application finished a frame
+    FrameEnd = 3
+};
+
+// What a pointer argument pointed at when it was traced
+struct GLTracePayload
+{
+    // Flags of a payload
+    static constexpr uint8_t Output = 1;  // Written by the call, e.g. the names of CreateBuffers
+    static constexpr uint8_t Strings = 2; // Strings one after the other, each ended by a zero
+
+    uint8_t argument;
+    uint8_t flags;
+    const unsigned char* data;
+    uint32_t size;
+};
+
+// A record read back from a trace, valid until the next record is read
+struct GLTraceRecord
+{
+    EGLTraceRecord type;
+
+    // Call: The function is Count when this build of the loader does not have it
+    EGLFunction function;
+    const unsigned char* arguments;
+    unsigned argumentSize;
+    std::vector<GLTracePayload> payloads;
+    const unsigned char* result;
+    unsigned resultSize;
+
+    // MappedWrite: Bytes at an offset into a buffer
+    GLuint buffer;
+    uint64_t offset;
+    const unsigned char* data;
+    uint32_t size;
+
+    // Get the payload of an argument, nullptr if it has none
+    const GLTracePayload* findPayload(unsigned argument) const;
+};
+
+class GLTraceWriter final
+{
+public:
+    // Create the trace file, check isValid for failure
+    explicit GLTraceWriter(const std::string& filepath);
+    ~GLTraceWriter();
+
+    GLTraceWriter(const GLTraceWriter& other) = delete;
+    GLTraceWriter& operator=(const GLTraceWriter& other) = delete;
+
+    // Whether the file was created and every write so far succeeded
+    const bool isValid() const;
+
+    // Write a call before it is made, then endCall once it returned
+    template<typename... Args>
+    void beginCall(EGLFunction function, const Args&... args);
+
+    // Write what the call wrote back and its result, nullptr for void
+    void endCall(const void* result = nullptr, unsigned size = 0);
+
+    // Mark the end of a frame, replays time frames from one mark to the next
+    void endFrame();
+
+    // Get the number of calls written
+    const uint64_t getCallCount() const;
+
+    // Get the number of frames ended
+    const uint64_t getFrameCount() const;
+
+    // Get the size of the trace so far in bytes
+    const uint64_t byteSize() const;
+
+private:
+    // A buffer range mapped by the application, with what the trace last wrote of it
+    struct Mapping
+    {
+        GLuint buffer;
+        GLintptr offset;
+        const unsigned char* pointer;
+        std::vector<unsigned char> written;
+        bool bWrittenOnce;
+    };
+
+    // Write the call in mArguments with the payloads of its pointer arguments
+    void writeCall();
+
+    // Write what changed in every mapping since it was last written
+    void writeMappings();
+
+    void writePayload(unsigned argument, const void* data, size_t size, uint8_t flags = 0);
+    template<typename T>
+    void writeArray(unsigned argument, const T* values, GLsizei count, uint8_t flags = 0);
+    void writeString(unsigned argument, const GLchar* string, GLsizei length);
+    void writeStrings(unsigned argument, GLsizei count, const GLchar* const* strings, const GLint* lengths);
+    void writeImage(unsigned argument, const void* pixels, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type);
+
+    // Unpack the arguments of the current call
+    template<EGLFunction F>
+    typename GLSignature<typename GLFunctionTraits<F>::Type>::Arguments arguments() const;
+
+    template<typename T>
+    void write(const T& value);
+    void write(const void* data, size_t size);
+
+    // Pad the file to a multiple of the alignment of payloads
+    void align();
+
+    std::FILE* mFile = nullptr;
+    bool bValid = false;
+    uint64_t mByteSize = 0;
+    uint64_t mCallCount = 0;
+    uint64_t mFrameCount = 0;
+
+    // The call between beginCall and endCall
+    EGLFunction mFunction = EGLFunction::Count;
+    std::vector<unsigned char> mArguments;
+
+    // Per function, whether the driver may read mapped memory during the call
+    std::vector<bool> mReadsMappings;
+    std::vector<Mapping> mMappings;
+
+    // Pixel unpack state images are read with
+    GLint mUnpackAlignment = 4;
+    GLint mUnpackRowLength = 0;
+    GLuint mUnpackBuffer = 0;
+};
+
+class GLTraceReader final
+{
+public:
+    // Open a trace, check isValid for failure
+    explicit GLTraceReader(const std::string& filepath);
+
+    // Whether the trace was opened and read without errors so far
+    const bool isValid() const;
+
+    // Read the next record, false at the end of the trace or on an error
+    bool next(GLTraceRecord& record);
+
+private:
+    bool read(void* data, size_t size);
+    const unsigned char* skip(size_t size);
+    void align();
+
+    FileView mFile;
+    size_t mOffset = 0;
+    bool bValid = false;
+
+    // The functions of this build of the loader, by their index in the trace
+    std::vector<EGLFunction> mFunctions;
+};
+
+template<typename... Args>
+void GLTraceWriter::beginCall(EGLFunction function, const Args&... args)
+{
+    constexpr size_t argumentSize = (sizeof(Args) + ... + 0);
+    static_assert(argumentSize <= UINT16_MAX, "GLTraceWriter: Arguments too large to trace");
+
+    mFunction = function;
+    mArguments.resize(argumentSize);
+    size_t offset = 0;
+    ((std::memcpy(mArguments.data() + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+
+    writeCall();
+}
+
+template<EGLFunction F>
+typename GLSignature<typename GLFunctionTraits<F>::Type>::Arguments GLTraceWriter::arguments() const
+{
+    return GLCommand{ F, mArguments.data(), static_cast<unsigned>(mArguments.size()) }.getArguments<F>();
+}
+
+template<typename T>
+void GLTraceWriter::write(const T& value)
+{
+    write(&value, sizeof(T));
+}
+
+#endif // GLTRACE_H
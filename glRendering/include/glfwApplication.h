@@ -6,28 +6,73 @@
  * order for construction/destruction of
  * GL objects. Where the main loop is and
  * most of the testing is performed.
+ *
+ * Headless, the application renders the same scene
+ * into a Framebuffer through an EGL context for a fixed
+ * number of frames as fast as it can, then writes the
+ * frame times out (for benchmarking on servers and CI).
+ *
+ * Given a trace file, every GL call from the creation of
+ * the context on is written to it for tools/glReplay.
  */
 
 
 #ifndef GLFWAPPLICATION_H
 #define GLFWAPPLICATION_H
 
+#include "asyncIO.h"
 #include "inputManager.h"
 #include "renderer.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 struct GLFWwindow;
 struct ImGuiContext;
+class HeadlessContext;
+class GLTraceWriter;
+
+// How a headless run renders and where its results go
+struct HeadlessSettings
+{
+    unsigned frameCount = 1000;
+    int width = 1280;
+    int height = 720;
+    std::string resultsPath = "headless_results.json";
+};
 
 
 class GLFWApplication
 {
 public:
-	GLFWApplication();
+    // Trace every GL call to the file when a path is given
+	explicit GLFWApplication(const std::string& tracePath = "");
+
+    // Render without a window, see HeadlessSettings
+    explicit GLFWApplication(const HeadlessSettings& settings, const std::string& tracePath = "");
+
 	~GLFWApplication();
 
 	void run();
 
+    // Whether a context was created, only fails headless
+    const bool isValid() const;
+
 private:
+    // GL state the scene expects, in both modes
+    void setupGL();
+
+    // Trace the GL calls from here on, right after the context is made current
+    void startTrace(const std::string& tracePath);
+
+    // Write the frame times of a headless run to the results file
+    void writeHeadlessResults(const std::vector<float>& frameTimes, float totalSeconds) const;
+
+private:
+    // Reads resources in the background while the window and context are created
+    AsyncIO mAsyncIO;
+
 	// Application Window
 	GLFWwindow* mWindow = nullptr;
 
@@ -40,6 +85,13 @@ private:
     // Renderer
     Renderer mRenderer;
 
+    // Context and settings of a headless run, null with a window
+    std::unique_ptr<HeadlessContext> mHeadless;
+    HeadlessSettings mHeadlessSettings;
+
+    // Trace of the GL calls, null when not tracing
+    std::unique_ptr<GLTraceWriter> mTrace;
+
 };
 
 
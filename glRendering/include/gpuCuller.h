@@ -0,0 +1,94 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Culls instances of a single mesh on the GPU.
+ * A compute shader tests the bounding sphere of every
+ * instance against the view frustum, and optionally against
+ * a Hi-Z pyramid of the previous frame, then compacts the
+ * transforms of the visible instances with an atomic counter.
+ * The counter is copied into the instance count of an indirect
+ * draw command, so the CPU never reads anything back. Draw the
+ * result with Renderer::drawIndirect and a vertex shader that
+ * reads the VisibleTransforms buffer (see res/culled.vert).
+ */
+
+#ifndef GPUCULLER_H
+#define GPUCULLER_H
+
+#include "buffer.h"
+#include "shader.h"
+
+#include <vector>
+
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+class Frustum;
+class HiZPyramid;
+
+// A single instance as laid out in the std430 Instances buffer of cull.comp
+struct GpuInstance
+{
+    glm::mat4 transform;
+
+    // Center (xyz) and radius (w) of the bounding sphere in local space
+    glm::vec4 boundingSphere;
+};
+
+class GpuCuller final
+{
+public:
+    // Create a culler with room for maxInstances instances
+    GpuCuller(unsigned maxInstances);
+
+    GpuCuller(const GpuCuller& other) = delete;
+    GpuCuller& operator=(const GpuCuller& other) = delete;
+
+    // Upload the instances to cull. Extra instances beyond the capacity are ignored
+    void setInstances(const std::vector<GpuInstance>& instances);
+
+    // Set the part of the bound index buffer to draw for each visible instance
+    void setMesh(unsigned indexCount, unsigned firstIndex = 0, int baseVertex = 0);
+
+    // Cull all instances and write the indirect draw command. Pass a pyramid for occlusion culling
+    void cull(const Frustum& frustum, const HiZPyramid* hiZ = nullptr);
+
+    // Bind the compacted transforms of the visible instances for the vertex shader
+    void bindVisibleTransforms(const unsigned bindingPoint = 1) const;
+
+    // Get the indirect buffer holding the draw command of the visible instances
+    const IndirectBuffer& getCommands() const;
+
+    // Get the number of instances that are culled
+    const unsigned getInstanceCount() const;
+
+private:
+    // Culling compute shader
+    Shader mCullShader;
+
+    // Input instances
+    ShaderStorageBuffer mInstances;
+
+    // Output transforms of the visible instances
+    ShaderStorageBuffer mVisibleTransforms;
+
+    // Frustum planes and Hi-Z parameters
+    UniformBuffer mCullingData;
+
+    // Number of visible instances
+    AtomicCounterBuffer mVisibleCounter;
+
+    // The draw command, instanceCount is written by the GPU
+    IndirectBuffer mCommands;
+
+    // CPU copy of the command with the mesh parameters
+    DrawElementsIndirectCommand mCommand{ 0u, 0u, 0u, 0, 0u };
+
+    // Number of instances to cull
+    unsigned mInstanceCount = 0;
+
+    // Capacity of the instance buffers
+    const unsigned mMaxInstances;
+};
+
+#endif // GPUCULLER_H
@@ -0,0 +1,142 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Times GPU work with timestamp queries. A zone writes a
+ * timestamp before and after the commands issued inside
+ * it. Every frame uses its own slice of a ring of query
+ * objects, so the results are read back a few frames
+ * later once the GPU has got there, without stalling.
+ * The times are converted to CPU time and handed to the
+ * Profiler, so GPU zones show on the "GPU" track of the
+ * frame that submitted them next to its CPU zones.
+ *
+ * GPU_PROFILE_SCOPE finds the profiler through the
+ * ServiceLocator and does nothing when none is provided.
+ */
+
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "profiler.h"
+#include "serviceLocator.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#if defined(ENABLE_PROFILER)
+// Time the GPU commands issued in the rest of the scope. The name must outlive the profiler
+#define GPU_PROFILE_SCOPE(name) GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(name)
+#else
+#define GPU_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+class GpuProfiler final
+{
+public:
+    // Create the query objects, needs a current context
+    GpuProfiler();
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler& other) = delete;
+    GpuProfiler& operator=(const GpuProfiler& other) = delete;
+
+    // Start a zone, returns its handle or -1 if the frame ran out of queries
+    int beginZone(const char* name);
+
+    // End a zone started with beginZone
+    void endZone(int zone);
+
+    // Finish the frame and read back earlier frames the GPU has finished. Call before Profiler::endFrame
+    void endFrame();
+
+    // Get the number of zones the last frame had beyond the queries of a frame, which were not timed
+    const unsigned getDroppedZones() const;
+
+private:
+    // Frames a result may take to come back before its queries are reused
+    static constexpr unsigned FramesInFlight = 4;
+
+    // Zones per frame, further zones are not timed
+    static constexpr unsigned MaxZonesPerFrame = 256;
+
+    // Frames between measurements of the GPU clock against the CPU clock
+    static constexpr unsigned CalibrationInterval = 60;
+
+    struct Zone
+    {
+        const char* name;
+        uint32_t depth;
+        bool bEnded;
+    };
+
+    // Zones of one frame, timed by its slice of the queries
+    struct FrameQueries
+    {
+        uint64_t frameIndex = 0;
+        std::vector<Zone> zones;
+        bool bPending = false;
+
+        // The last query written, results become available in order
+        int lastQuery = -1;
+    };
+
+private:
+    // Get the query of the start (or end) of a zone in a frame slot
+    unsigned query(unsigned slot, unsigned zone, bool end) const;
+
+    // Read the results of a finished frame and pass them to the Profiler
+    void readBack(FrameQueries& frame, unsigned slot);
+
+    // Measure the offset between the GPU and CPU clocks
+    void calibrate();
+
+private:
+    std::vector<unsigned> mQueries;
+    std::array<FrameQueries, FramesInFlight> mFrames;
+    unsigned mCurrent = 0;
+    uint32_t mDepth = 0;
+
+    // Profiler track the GPU zones are added to
+    uint32_t mTrack;
+
+    // CPU time minus GPU time, in nanoseconds
+    int64_t mClockOffset = 0;
+    unsigned mFramesSinceCalibration = 0;
+
+    // Frames whose results did not come back in time
+    unsigned mDroppedFrames = 0;
+
+    // Zones past MaxZonesPerFrame in the current and the last frame, warned about once per capture
+    unsigned mDroppedZones = 0;
+    unsigned mLastDroppedZones = 0;
+    bool bWarnedDroppedZones = false;
+    bool bWasCapturing = false;
+};
+
+// Times the GPU commands of its scope, see GPU_PROFILE_SCOPE
+class GpuProfileZone final
+{
+public:
+    explicit GpuProfileZone(const char* name)
+    {
+        if (!Profiler::isEnabled()) return;
+
+        mProfiler = ServiceLocator<GpuProfiler>::get();
+        if (mProfiler) mZone = mProfiler->beginZone(name);
+    }
+
+    ~GpuProfileZone()
+    {
+        if (mZone >= 0) mProfiler->endZone(mZone);
+    }
+
+    GpuProfileZone(const GpuProfileZone& other) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone& other) = delete;
+
+private:
+    GpuProfiler* mProfiler = nullptr;
+    int mZone = -1;
+};
+
+#endif // GPUPROFILER_H
@@ -0,0 +1,39 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * An OpenGL 4.5 core context without a window, created
+ * through EGL so it works on machines without a display
+ * (e.g. CI servers rendering with Mesa's llvmpipe). A
+ * surfaceless context is preferred, drivers that lack
+ * EGL_MESA_platform_surfaceless get a small pbuffer. As
+ * there is no default framebuffer to speak of, render
+ * into a Framebuffer.
+ */
+
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+class HeadlessContext final
+{
+public:
+    // Create the context and make it current, check isValid for failure
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext& other) = delete;
+    HeadlessContext& operator=(const HeadlessContext& other) = delete;
+
+    // Whether the context was created and is current
+    const bool isValid() const;
+
+    // Whether headless contexts are compiled in (they need EGL)
+    static bool isSupported();
+
+private:
+    // EGL handles, kept opaque so users do not need the EGL headers
+    void* mDisplay = nullptr;
+    void* mSurface = nullptr;
+    void* mContext = nullptr;
+};
+
+#endif // HEADLESSCONTEXT_H
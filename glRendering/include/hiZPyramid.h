@@ -0,0 +1,75 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * A hierarchical depth (Hi-Z) pyramid. Every mip
+ * level stores the farthest depth of the 2x2 texels
+ * below it, so a single fetch at the right level gives
+ * a conservative depth for a whole screen rectangle.
+ * Built on the GPU from the depth texture of a Framebuffer
+ * and used by the GpuCuller to reject occluded instances.
+ * The pyramid remembers the view projection it was
+ * rendered with, since it is tested against in the
+ * frame after it was built.
+ */
+
+#ifndef HIZPYRAMID_H
+#define HIZPYRAMID_H
+
+#include "shader.h"
+
+#include "glm/vec2.hpp"
+#include "glm/mat4x4.hpp"
+
+class Framebuffer;
+
+class HiZPyramid final
+{
+public:
+    // Create a pyramid for a depth buffer of the given size
+    HiZPyramid(const glm::ivec2& size);
+
+    HiZPyramid(const HiZPyramid& other) = delete;
+    HiZPyramid& operator=(const HiZPyramid& other) = delete;
+
+    ~HiZPyramid();
+
+    // Build the pyramid from the depth of the framebuffer, which was rendered with viewProjection
+    void build(const Framebuffer& framebuffer, const glm::mat4& viewProjection);
+
+    // Bind the pyramid to a texture binding point
+    void bind(unsigned bindingPoint) const;
+
+    // Get the view projection the depth was rendered with
+    const glm::mat4& getViewProjection() const;
+
+    // Get the size of level 0
+    const glm::ivec2& getSize() const;
+
+    // Get the number of mip levels
+    const unsigned getLevelCount() const;
+
+    // Get the OpenGL name of the pyramid texture
+    const unsigned name() const;
+
+private:
+    // (Re)create the pyramid texture with a full mip chain
+    void createTexture(const glm::ivec2& size);
+
+private:
+    // Reduction compute shader
+    Shader mReduceShader;
+
+    // OpenGL name of the R32F pyramid texture
+    unsigned mName = 0;
+
+    // Number of mip levels in the pyramid
+    unsigned mLevelCount = 0;
+
+    // Size of level 0
+    glm::ivec2 mSize{};
+
+    // View projection of the frame the pyramid was built from
+    glm::mat4 mViewProjection{ 1.f };
+};
+
+#endif // HIZPYRAMID_H
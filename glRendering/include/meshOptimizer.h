@@ -0,0 +1,86 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Reorders static meshes for faster drawing, at load
+ * time or offline. Triangles are reordered to reuse the
+ * post-transform vertex cache (Forsyth's linear-speed
+ * algorithm), optionally grouped so outward-facing
+ * clusters draw first to reduce overdraw, and vertices
+ * are reordered to the order they are first used so
+ * fetches stream through memory. The cache behaviour is
+ * measured with a simulated FIFO cache, so improvements
+ * can be checked without a GPU. Indexed triangle lists
+ * only, strips must be converted first.
+ */
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Cache behaviour of an index order in a simulated FIFO vertex cache
+struct VertexCacheStatistics
+{
+    // Vertices transformed
+    unsigned misses = 0;
+
+    // Average cache miss ratio: Vertices transformed per triangle, 0.5 is ideal for large grids, 3 is the worst
+    float acmr = 0.f;
+
+    // Average transform to vertex ratio: Vertices transformed per vertex, 1 is ideal
+    float atvr = 0.f;
+};
+
+// Simulate drawing the triangles with a FIFO vertex cache of cacheSize entries
+VertexCacheStatistics analyzeVertexCache(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize = 16);
+
+// Reorder the triangles in place to reuse the vertex cache
+void optimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount);
+
+// Reorder clusters of triangles (after optimizeVertexCache) so those facing away from the center of the mesh draw first.
+// Clusters are only split where the ACMR stays within threshold times the current one. Positions are 3 floats
+// at the start of every vertex, positionStride bytes apart
+void optimizeOverdraw(unsigned* indices, unsigned indexCount, const void* positions, unsigned positionStride, unsigned vertexCount,
+                      float threshold = 1.05f);
+
+// Reorder the vertices (vertexSize bytes each) to the order the indices first use them, and remap the indices.
+// Unused vertices are removed. Returns the new vertex count
+unsigned optimizeVertexFetch(void* vertices, unsigned vertexCount, unsigned vertexSize, unsigned* indices, unsigned indexCount);
+
+// Whether VertexT starts with a position of 3 floats x, y and z, as optimizeOverdraw reads it
+template<typename VertexT>
+constexpr bool hasFloatPosition = std::is_same<decltype(VertexT::x), float>::value && std::is_same<decltype(VertexT::y), float>::value &&
+                                  std::is_same<decltype(VertexT::z), float>::value && offsetof(VertexT, x) == 0 &&
+                                  offsetof(VertexT, y) == sizeof(float) && offsetof(VertexT, z) == 2 * sizeof(float);
+
+// Run the vertex cache and vertex fetch optimizations on a mesh of any vertex type
+template<typename VertexT>
+void optimizeMesh(std::vector<VertexT>& vertices, std::vector<unsigned>& indices)
+{
+    const auto vertexCount = static_cast<unsigned>(vertices.size());
+    const auto indexCount = static_cast<unsigned>(indices.size());
+
+    optimizeVertexCache(indices.data(), indexCount, vertexCount);
+    vertices.resize(optimizeVertexFetch(vertices.data(), vertexCount, sizeof(VertexT), indices.data(), indexCount));
+}
+
+// Run the vertex cache, optional overdraw and vertex fetch optimizations on a mesh with a float position at the start
+// of VertexT. Quantized positions (CompactVertex) would cluster garbage, use the overload without overdraw for them
+template<typename VertexT>
+void optimizeMesh(std::vector<VertexT>& vertices, std::vector<unsigned>& indices, bool reduceOverdraw)
+{
+    static_assert(hasFloatPosition<VertexT>, "Overdraw reduction needs a position of 3 floats at the start of the vertex");
+
+    const auto vertexCount = static_cast<unsigned>(vertices.size());
+    const auto indexCount = static_cast<unsigned>(indices.size());
+
+    optimizeVertexCache(indices.data(), indexCount, vertexCount);
+    if (reduceOverdraw)
+        optimizeOverdraw(indices.data(), indexCount, vertices.data(), sizeof(VertexT), vertexCount);
+
+    vertices.resize(optimizeVertexFetch(vertices.data(), vertexCount, sizeof(VertexT), indices.data(), indexCount));
+}
+
+#endif // MESHOPTIMIZER_H
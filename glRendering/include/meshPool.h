@@ -0,0 +1,96 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Packs the vertices and indices of many meshes
+ * into a few large buffers (pages) of one vertex format.
+ * All meshes in a page share a single vertex array from
+ * the VertexArrayCache and are drawn with a base vertex
+ * and first index, so drawing many small shapes no longer
+ * switches vertex arrays between every draw. Allocation
+ * only bumps forward, space is reclaimed by destroying
+ * the pool. Shape2D allocates from the pool provided to
+ * ServiceLocator<MeshPool> when the formats match.
+ */
+
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include "enums.h"
+#include "vertexArray.h"
+
+#include <vector>
+
+class VertexArrayCache;
+
+// Location of a mesh inside its vertex array and index buffer
+struct MeshRange
+{
+    const VertexArray* vao = nullptr;
+    unsigned firstIndex = 0;
+    int baseVertex = 0;
+    unsigned indexCount = 0;
+
+    // How to draw the range
+    EIndexType indexType = EIndexType::UnsignedInt;
+    EPrimitiveType primitive = EPrimitiveType::Triangles;
+
+    // The buffers the range lives in and the format of its vertices, to attach them to other vertex arrays
+    unsigned vertexBuffer = 0;
+    unsigned indexBuffer = 0;
+    EVertexFormat format = EVertexFormat::Standard;
+};
+
+class MeshPool final
+{
+public:
+    // Create a pool of pages with room for vertexCapacity vertices and indexCapacity indices each.
+    // Indices are stored as 16-bit unless a mesh has more vertices than that can address
+    MeshPool(VertexArrayCache& cache, EVertexFormat format, unsigned vertexCapacity = 65536, unsigned indexCapacity = 196608);
+
+    MeshPool(const MeshPool& other) = delete;
+    MeshPool& operator=(const MeshPool& other) = delete;
+
+    ~MeshPool();
+
+    // Upload a mesh with vertices in the format of the pool. Meshes larger than a page get their own page
+    MeshRange allocate(const void* vertices, unsigned vertexCount, const unsigned* indices, unsigned indexCount,
+                       EPrimitiveType primitive = EPrimitiveType::Triangles);
+
+    // Get the vertex format of the pool
+    const EVertexFormat getFormat() const;
+
+    // Get the number of pages (and so vertex arrays) in use
+    const unsigned getPageCount() const;
+
+private:
+    struct Page
+    {
+        unsigned vbo;
+        unsigned ibo;
+        unsigned vertexCapacity;
+        unsigned indexCapacity;
+        unsigned vertexCount;
+        unsigned indexCount;
+        EIndexType indexType;
+        const VertexArray* vao;
+    };
+
+    // Create a page with at least the given capacity
+    Page& addPage(unsigned vertexCapacity, unsigned indexCapacity, EIndexType indexType);
+
+private:
+    // Source of the vertex arrays of the pages
+    VertexArrayCache& mCache;
+
+    // Format of all vertices in the pool
+    const EVertexFormat mFormat;
+
+    // Default page capacity
+    const unsigned mVertexCapacity;
+    const unsigned mIndexCapacity;
+
+    // Pages, the last one is filled first
+    std::vector<Page> mPages;
+};
+
+#endif // MESHPOOL_H
@@ -0,0 +1,47 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * ImGui window showing what the profiler recorded. A
+ * histogram of the recent frame times picks a frame and
+ * the timeline below it draws that frame's zones as a
+ * flame graph per thread, nested zones stacked beneath
+ * the zone that contains them. Captures are started and
+ * saved as Chrome trace JSON from here as well.
+ */
+
+#ifndef PROFILERPANEL_H
+#define PROFILERPANEL_H
+
+#include "profiler.h"
+
+#include <deque>
+#include <string>
+
+class ProfilerPanel final
+{
+public:
+    // Draw the window, between ImGui's NewFrame and Render
+    void draw();
+
+    // Set the file captures are saved to
+    void setTracePath(const std::string& filepath) { mTracePath = filepath; }
+
+private:
+    // Draw the zones of a frame as one flame graph per track
+    void drawTimeline(const ProfileFrame& frame);
+
+private:
+    // Frames shown while paused, the live history keeps moving
+    std::deque<ProfileFrame> mPausedHistory;
+    bool bPaused = false;
+
+    // Frame shown in the timeline, counted from the newest (0)
+    int mSelectedFrame = 0;
+
+    // Horizontal zoom of the timeline
+    float mZoom = 1.f;
+
+    std::string mTracePath = "profile.json";
+};
+
+#endif // PROFILERPANEL_H
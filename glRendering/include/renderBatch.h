@@ -6,7 +6,13 @@
  * Parameters for use with a renderer.
  * A batch can be submitted, and everything
  * in the render batch will only use a single
- * draw call.
+ * draw call. The batch is templated on the vertex
+ * type it uploads, shapes are converted on push
+ * through VertexFormat<VertexT>::fromVertex.
+ * Elements added with add() instead of push() are
+ * retained: They keep a handle to update or remove
+ * them later, and commit() only uploads the ranges
+ * that changed since the last commit.
  */
 
 #ifndef BATCHRENDERER_H
@@ -14,34 +20,67 @@
 
 #include "buffer.h"
 #include "shapes.h"
+#include "tessellation.h"
 #include "vertexArray.h"
+#include "vertexLayout.h"
 
 #include <vector>
 #include <memory>
 
-class RenderBatch final
+// Handle of an element added to a retained batch, stays valid until the element is removed
+using BatchHandle = unsigned;
+constexpr BatchHandle InvalidBatchHandle = ~0u;
+
+template<typename VertexT>
+class BasicRenderBatch final
 {
 public:
+    // Create a batch with a vao configured from the layout of VertexT
+    BasicRenderBatch();
+
     // Take control of a vao that already has attributes added to it
-    RenderBatch(VertexArray&& vao);
+    BasicRenderBatch(VertexArray&& vao);
 
-    RenderBatch(RenderBatch&& other);
+    BasicRenderBatch(BasicRenderBatch&& other);
 
-    RenderBatch& operator=(RenderBatch&& other);
+    BasicRenderBatch& operator=(BasicRenderBatch&& other);
 
-    RenderBatch(const RenderBatch&) = delete;
+    BasicRenderBatch(const BasicRenderBatch&) = delete;
     // #TODO Copy a render batch (Requires VAO, VBO and IBO to be copyable, if possible)
 
-    RenderBatch& operator=(const RenderBatch&) = delete;
+    BasicRenderBatch& operator=(const BasicRenderBatch&) = delete;
 
     // Clear the batched data and draw data
     void clear();
 
     // Push vertex and index data to the batch
-    void push(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices);
+    void push(const std::vector<VertexT>& vertices, const std::vector<unsigned>& indices);
     void push(const Shape2D& shape);
 
-    // Commit the batch, finalizing it for rendering (must call before passing to a renderer)
+    // Add an element to the batch, making it retained. Can be called after commit, the next commit uploads it
+    BatchHandle add(const std::vector<VertexT>& vertices, const std::vector<unsigned>& indices);
+    BatchHandle add(const Shape2D& shape);
+
+    // Replace the vertices of an element of a retained batch in place. The vertex count must stay the same
+    void update(BatchHandle handle, const std::vector<VertexT>& vertices);
+
+    // Replace the vertices and indices of an element of a retained batch. Elements keep their place if the counts
+    // are the same, otherwise they move to the end of the batch
+    void update(BatchHandle handle, const std::vector<VertexT>& vertices, const std::vector<unsigned>& indices);
+
+    // Remove an element of a retained batch. Its space is reclaimed when enough of the batch is unused
+    void remove(BatchHandle handle);
+
+    // Get a tessellator that generates primitives straight into the batch. Retained batches refuse it,
+    // what it generates is discarded, tessellate into a Shape2D and add that instead
+    Tessellator<VertexT> makeTessellator();
+
+    // Reorder the batched data for the vertex cache and vertex fetches (see meshOptimizer.h), call before commit on
+    // batches that stay committed for many frames. Overdraw reduction needs full precision positions (Vertex)
+    void optimize(bool reduceOverdraw = false);
+
+    // Commit the batch, finalizing it for rendering (must call before passing to a renderer).
+    // Retained batches upload the changes since the last commit
     void commit();
     
     // Bind the batch to the context
@@ -53,20 +92,77 @@ public:
     // Get number of indices in batch
     const unsigned getIndexCount() const;
 
+    // Get the type the committed indices are stored as, the smallest that fits the batch
+    const EIndexType getIndexType() const;
+
+private:
+    // Location of an element added to a retained batch
+    struct Element
+    {
+        unsigned firstVertex;
+        unsigned vertexCount;
+        unsigned firstIndex;
+        unsigned indexCount;
+        bool alive;
+    };
+
+    // Range of vertices or indices [begin, end)
+    struct Range
+    {
+        unsigned begin;
+        unsigned end;
+    };
+
+    struct RetainedState
+    {
+        // Elements by handle
+        std::vector<Element> elements;
+
+        // Handles of removed elements to reuse
+        std::vector<BatchHandle> freeHandles;
+
+        // Ranges changed since the last commit
+        std::vector<Range> dirtyVertices;
+        std::vector<Range> dirtyIndices;
+
+        // Vertices of removed elements still in the batch
+        unsigned deadVertices = 0;
+
+        // Room in the buffers
+        unsigned vertexCapacity = 0;
+        unsigned indexCapacity = 0;
+
+        // Whether the batch is retained, set by the first add
+        bool active = false;
+
+        // Where refused tessellators write, never committed
+        std::vector<VertexT> discardedVertices;
+        std::vector<unsigned> discardedIndices;
+
+        // Whether the buffers must be recreated on the next commit
+        bool fullUpload = true;
+    };
+
 private:
     // Create a VBO/IBO from the provided draw data
     void makeDrawData() const;
 
+    // Upload what changed in a retained batch, recreating the buffers when they are too small
+    void commitRetained();
+
+    // Remove the space of removed elements from a retained batch
+    void compact();
+
+    // Turn the indices of an element into degenerate triangles so it draws nothing
+    void hideElement(const Element& element);
+
 private:
     // Vertices
-    std::vector<Vertex> mVertices;
+    std::vector<VertexT> mVertices;
 
     // Indices
     std::vector<unsigned> mIndices;
 
-    // Offset of next index
-    unsigned mIndexOffset = 0;
-
     // Cleared since last draw
     bool bCommited = false;
 
@@ -78,6 +174,18 @@ private:
 
     // The temporary IBO used between draw and clear calls  (mutable since created before draw, but no logical difference)
     mutable std::unique_ptr<IndexBuffer> mIbo = nullptr;
+
+    // Elements and dirty ranges of a retained batch
+    RetainedState mRetained;
 };
 
+// Batch of full precision vertices
+using RenderBatch = BasicRenderBatch<Vertex>;
+
+// Batch of quantized vertices, half the upload size of a RenderBatch
+using CompactRenderBatch = BasicRenderBatch<CompactVertex>;
+
+extern template class BasicRenderBatch<Vertex>;
+extern template class BasicRenderBatch<CompactVertex>;
+
 #endif // BATCHRENDERER_H
@@ -0,0 +1,73 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Counts the work submitted to the GPU each frame. The
+ * Renderer counts draws, the buffer, texture, shader and
+ * vertex array wrappers count uploads, binds and state
+ * changes into the counters of the current frame. At the
+ * end of a frame the counters and the frame time go into
+ * a rolling history that percentiles and averages are
+ * taken over, so batching regressions show up as counts
+ * rather than as a vaguely slower frame.
+ */
+
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Work submitted during one frame
+struct FrameCounters
+{
+    unsigned drawCalls = 0;
+    uint64_t instances = 0;
+    uint64_t indices = 0;
+    uint64_t triangles = 0;
+    uint64_t bytesUploaded = 0;
+    unsigned textureBinds = 0;
+    unsigned programSwitches = 0;
+
+    // Vertex array and framebuffer binds
+    unsigned stateChanges = 0;
+};
+
+// Counters and time of a finished frame
+struct FrameStats
+{
+    float frameMs;
+    FrameCounters counters;
+};
+
+class RenderStats final
+{
+public:
+    // Frames kept in the history
+    static constexpr size_t HistorySize = 240;
+
+    // Get the counters of the frame being recorded. Counting is only done on the GL thread
+    static FrameCounters& counters() { return mCounters; }
+
+    // Count bytes written to a buffer
+    static void addUpload(ptrdiff_t bytes) { mCounters.bytesUploaded += static_cast<uint64_t>(bytes); }
+
+    // Store the counters and time of the frame in the history and start counting the next frame
+    void endFrame(float frameMs);
+
+    // Get the recorded frames, oldest first
+    const std::deque<FrameStats>& getHistory() const { return mHistory; }
+
+    // Get the frame time below which the fraction of recorded frames fall, e.g. 0.99 for the 99th percentile
+    const float getFrameTimePercentile(float fraction) const;
+
+    // Get the average of the counters over the recorded frames
+    const FrameCounters getAverageCounters() const;
+
+private:
+    inline static FrameCounters mCounters{};
+
+    std::deque<FrameStats> mHistory;
+};
+
+#endif // RENDERSTATS_H
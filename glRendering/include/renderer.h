@@ -7,16 +7,26 @@
  * and it will draw the entire batch. You can
  * also pass a single shape, which will just draw
  * the one shape. It's purpose is to streamline draw
- * calls.
+ * calls. Shapes and batches pass the primitive and
+ * index type they were stored with to the draw call.
+ * It also keeps the frame statistics, counting every
+ * draw it submits (see RenderStats).
  */
 
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "enums.h"
+#include "renderStats.h"
+
 class Curve;
 class Shape2D;
-class RenderBatch;
 class VertexArray;
+class IndirectBuffer;
+class ShapeInstances;
+
+template<typename VertexT>
+class BasicRenderBatch;
 
 class Renderer
 {
@@ -24,13 +34,33 @@ public:
 
     // Draw the provided data
     void draw(const Shape2D& shape) const;
-    void draw(const RenderBatch& batch) const;
-    void draw(const VertexArray& vao, const unsigned indexCount) const;
+    template<typename VertexT>
+    void draw(const BasicRenderBatch<VertexT>& batch) const;
+    void draw(const VertexArray& vao, const unsigned indexCount, const EIndexType indexType = EIndexType::UnsignedInt) const;
+
+    // Draw all committed copies of a shape in one instanced draw
+    void draw(const ShapeInstances& instances) const;
+
+    // Draw the provided data with n instances. Per-instance attributes start at baseInstance
+    void drawInstanced(const Shape2D& shape, const int instanceCount, const unsigned baseInstance = 0);
+    template<typename VertexT>
+    void drawInstanced(const BasicRenderBatch<VertexT>& batch, const int instanceCount, const unsigned baseInstance = 0);
+    void drawInstanced(const VertexArray& vao, const unsigned indexCount, const int instanceCount, const unsigned baseInstance = 0,
+                       const EIndexType indexType = EIndexType::UnsignedInt);
+
+    // Draw the provided data with draw commands sourced from a buffer (e.g. written by the GpuCuller)
+    void drawIndirect(const Shape2D& shape, const IndirectBuffer& commands, const unsigned drawCount = 1) const;
+    void drawIndirect(const VertexArray& vao, const IndirectBuffer& commands, const unsigned drawCount = 1,
+                      const EIndexType indexType = EIndexType::UnsignedInt) const;
+
+    // Record the counters of the frame with its time and start counting the next one
+    void endFrame(float frameMs);
+
+    // Get the counters and times of the recent frames
+    const RenderStats& getStats() const;
 
-    // Draw the provided data with n instances
-    void drawInstanced(const Shape2D& shape, const int instanceCount);
-    void drawInstanced(const RenderBatch& batch, const int instanceCount);
-    void drawInstanced(const VertexArray& vao, const unsigned indexCount, const int instanceCount);
+private:
+    RenderStats mStats;
 
 };
 
@@ -3,14 +3,18 @@
 /*
  * Shader contains an abstraction of 
  * an OpenGL program with a vertex and
- * fragment shader component.
+ * fragment shader component, or a single
+ * stage such as a compute shader.
  */
 
 #ifndef SHADER_H
 #define SHADER_H
 
+#include "enums.h"
+
 #include <map>
 #include <string>
+#include <initializer_list>
 
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
@@ -24,6 +28,9 @@ class Shader final
 public:
     Shader(const std::string& shaderName);
     Shader(const std::string& vertexShader, const std::string& fragmentShader);
+
+    // Create a program from a single shader stage (typically a compute shader)
+    Shader(const std::string& shaderFile, EShaderType type);
     ~Shader();
 
     Shader(const Shader& other) = delete;
@@ -38,6 +45,8 @@ public:
     // Get the OpenGL name
     const unsigned name() const;
 
+    void setUniform1i(const std::string& uniformName, int value);
+
     void setUniform1f(const std::string& uniformName, float value);
 
     void setUniform2f(const std::string& uniformName, const glm::vec2& value);
@@ -61,7 +70,7 @@ private:
     const bool validateShaderCompilation(unsigned shader);
 
     // Attach shaders, link and validate the program
-    void makeProgramAndCleanup(const unsigned vertexShader, const unsigned fragmentShader);
+    void makeProgramAndCleanup(std::initializer_list<unsigned> shaders);
 
     // Validate linking, true if all is good
     const bool validateProgramLinkage(const unsigned program);
@@ -0,0 +1,73 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Draws many copies of one shape with a single
+ * instanced draw. The mesh of the shape is shared,
+ * only the transform and color of each copy is written
+ * per frame, into an InstanceBuffer that is attached to
+ * a vertex array next to the mesh buffers. Draw them
+ * with Renderer::draw and the instanced.vert shader.
+ */
+
+#ifndef SHAPEINSTANCES_H
+#define SHAPEINSTANCES_H
+
+#include "shapes.h"
+#include "vertex.h"
+#include "buffer.h"
+#include "vertexArray.h"
+
+#include <vector>
+#include <memory>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
+
+class ShapeInstances final
+{
+public:
+    // Prepare to draw up to maxInstances copies of the shape per frame
+    ShapeInstances(const Shape2D& shape, unsigned maxInstances);
+
+    ShapeInstances(const ShapeInstances& other) = delete;
+    ShapeInstances& operator=(const ShapeInstances& other) = delete;
+
+    // Remove all instances
+    void clear();
+
+    // Add a copy of the shape. The color is multiplied with the vertex color. Returns false when full
+    bool add(const glm::mat4& transform, const glm::vec4& color = glm::vec4(1.f));
+
+    // Write the instances to the GPU, call once per frame before drawing
+    void commit();
+
+    // Bind to render
+    void bind() const;
+
+    // Get the index range of the shared mesh
+    const MeshRange& getMesh() const;
+
+    // Get the number of instances written by the last commit
+    const unsigned getInstanceCount() const;
+
+    // Get the first instance written by the last commit, pass as base instance when drawing
+    const unsigned getBaseInstance() const;
+
+private:
+    // Keeps the shared mesh alive
+    std::shared_ptr<const ShapeGeometry> mGeometry;
+
+    // Instances added since the last clear
+    std::vector<InstanceData> mInstances;
+
+    // Instance attributes on the GPU
+    InstanceBuffer mInstanceBuffer;
+
+    // Mesh buffers in binding 0, instance buffer in binding 1
+    VertexArray mVao;
+
+    // Whether the last commit still needs to be fenced off
+    bool bCommitted = false;
+};
+
+#endif // SHAPEINSTANCES_H
@@ -2,19 +2,28 @@
 
 /* 
  * Shapes contains classes to easily create
- * various shape primitives in OpenGL.
+ * various shape primitives in OpenGL. The generated
+ * geometry is cached by shape type and parameters, so
+ * identical shapes share one mesh. Draw many copies of
+ * one shape with ShapeInstances.
  */
 
 #ifndef SHAPES_H
 #define SHAPES_H
 
 #include "vertex.h"
+#include "enums.h"
+#include "bounds.h"
 #include "buffer.h"
+#include "meshPool.h"
 #include "vertexArray.h"
+#include "tessellation.h"
 
 #include <vector>
 #include <memory>
 #include <utility>
+#include <optional>
+#include <typeindex>
 
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
@@ -28,13 +37,49 @@ struct ShapeGLData
     VertexArray vao;
 };
 
+// Identifies generated geometry: The shape type, the parameters it was generated from and the vertex format
+struct ShapeKey
+{
+    std::type_index type;
+    std::vector<float> parameters;
+    EVertexFormat format;
+
+    bool operator==(const ShapeKey& other) const;
+};
+
+// Geometry of a shape, shared by all shapes generated from the same ShapeKey
+struct ShapeGeometry
+{
+    // Vertices
+    std::vector<Vertex> vertices;
+
+    // Indices
+    std::vector<unsigned> indices;
+
+    // How the indices form triangles
+    EPrimitiveType primitive = EPrimitiveType::Triangles;
+
+    // Local space bounds, computed in init()
+    AABB aabb{};
+    BoundingSphere boundingSphere{};
+
+    // GL Data, only when not allocated from a MeshPool
+    std::unique_ptr<ShapeGLData> glData = nullptr;
+
+    // Where the shape is drawn from
+    MeshRange mesh{};
+};
+
 class Shape2D
 {
 public:
+    Shape2D();
+
     virtual ~Shape2D() noexcept = default;
 
     // Batch renderer wants to access vertices / indices
-    friend class RenderBatch;
+    template<typename VertexT>
+    friend class BasicRenderBatch;
 
     // Bind to render
     void bind() const;
@@ -45,7 +90,26 @@ public:
     // Get the number of indices this shape requires
     const unsigned getIndexCount() const;
 
+    // Get the vertex array and index range of the shape, shared with other shapes when pooled
+    const MeshRange& getMesh() const;
+
+    // Get the local space bounding box of the shape
+    const AABB& getAABB() const;
+
+    // Get the local space bounding sphere of the shape
+    const BoundingSphere& getBoundingSphere() const;
+
+    // Get the geometry of the shape, shared with identical shapes
+    const std::shared_ptr<const ShapeGeometry> getGeometry() const;
+
+    // Get the number of distinct geometries currently shared by live shapes
+    static const unsigned getCachedGeometryCount();
+
 protected:
+    // Look up the geometry generated for the key. Returns true if it was found and is now used by this shape.
+    // Otherwise the key is remembered, generate the geometry as usual and init() with the same format caches it
+    bool findGeometry(std::type_index type, std::vector<float> parameters, EVertexFormat format = EVertexFormat::Standard);
+
     // Add a vertex to the shape
     void addVertex(const glm::vec2& pos, const glm::vec3& col, const glm::vec2& tc);
 
@@ -56,24 +120,28 @@ protected:
     template<typename... Is>
     void addIndices(const Is... i);
 
-    // Call after vertices/indices are added to commit data to OpenGL
-    void init();
+    // Get a tessellator that adds generated primitives to the shape
+    Tessellator<Vertex> makeTessellator();
 
-private:
-    // Vertices
-    std::vector<Vertex> mVertices;
+    // Set how the indices form triangles. Separate strips with RestartIndex
+    void setPrimitiveType(EPrimitiveType primitive);
 
-    // Indices
-    std::vector<unsigned> mIndices;
+    // Call after vertices/indices are added to commit data to OpenGL in the given vertex format.
+    // Uses the MeshPool service if one with the same format is provided
+    void init(EVertexFormat format = EVertexFormat::Standard);
+
+private:
+    // The geometry, only written to while the shape is generated
+    std::shared_ptr<ShapeGeometry> mGeometry;
 
-    // GL Data
-    std::unique_ptr<ShapeGLData> mGLData = nullptr;
+    // Key to cache the geometry under in init(), set when findGeometry() missed
+    std::optional<ShapeKey> mPendingKey;
 };
 
 template<typename... Is>
 void Shape2D::addIndices(const Is... i)
 {
-    (mIndices.push_back(i), ...);
+    (mGeometry->indices.push_back(i), ...);
 }
 
 class Quad : public Shape2D
@@ -0,0 +1,26 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Small ImGui overlay in the corner of the window with
+ * the frame time percentiles and the counters of the
+ * Renderer's frame statistics, last frame next to the
+ * average over the history.
+ */
+
+#ifndef STATSOVERLAY_H
+#define STATSOVERLAY_H
+
+class RenderStats;
+
+class StatsOverlay final
+{
+public:
+    // Draw the overlay, between ImGui's NewFrame and Render
+    void draw(const RenderStats& stats);
+
+private:
+    // Whether the counters are shown, the frame times always are
+    bool bShowCounters = true;
+};
+
+#endif // STATSOVERLAY_H
@@ -0,0 +1,88 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Generates the triangles of procedural 2D primitives:
+ * Circles, arcs, rounded rectangles, thick lines and
+ * polylines with joins. Points on circles are found with
+ * a rotation recurrence, four at a time with SIMD, instead
+ * of a sin/cos pair per point, and the vertices are written
+ * straight into the vertex and index storage of a RenderBatch
+ * (or a shape) without intermediate copies. All primitives
+ * lie in the z = 0 plane and are wound counter-clockwise.
+ */
+
+#ifndef TESSELLATION_H
+#define TESSELLATION_H
+
+#include "enums.h"
+#include "vertex.h"
+
+#include <vector>
+
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+
+template<typename VertexT>
+class Tessellator final
+{
+public:
+    // Append to the given storage. Indices refer to the whole vertex vector.
+    // Use RenderBatch::makeTessellator or Shape2D::makeTessellator to add to a batch or shape
+    Tessellator(std::vector<VertexT>& vertices, std::vector<unsigned>& indices);
+
+    // Filled circle made of segments triangles around the center
+    void circle(const glm::vec2& center, float radius, unsigned segments, const glm::vec3& col);
+
+    // Band of the given thickness along a circle from startAngle to endAngle (radians)
+    void arc(const glm::vec2& center, float radius, float thickness, float startAngle, float endAngle, unsigned segments, const glm::vec3& col);
+
+    // Filled rectangle with corners rounded by cornerRadius, each made of cornerSegments triangles
+    void roundedRect(const glm::vec2& center, const glm::vec2& size, float cornerRadius, unsigned cornerSegments, const glm::vec3& col);
+
+    // Straight line of the given thickness
+    void line(const glm::vec2& from, const glm::vec2& to, float thickness, const glm::vec3& col);
+
+    // Connected line through count points. Closed polylines also connect the last point to the first
+    void polyline(const glm::vec2* points, unsigned count, float thickness, ELineJoin join, bool closed, const glm::vec3& col);
+
+private:
+    // Space for new vertices and indices. Indices must be offset by first
+    struct Allocation
+    {
+        VertexT* vertices;
+        unsigned* indices;
+        unsigned first;
+    };
+
+    // Grow the storage and return the new space to write into
+    Allocation allocate(unsigned vertexCount, unsigned indexCount);
+
+    // Fill the direction scratch with count unit vectors, starting at startAngle and step radians apart
+    void makeDirections(unsigned count, float startAngle, float step);
+
+    // Add a quad from a to b, offset to both sides by the normal n
+    void segment(const glm::vec2& a, const glm::vec2& b, const glm::vec2& n, const glm::vec3& col);
+
+    // Add the join between two segments meeting at point, with left normals (scaled to half the thickness) n0 and n1
+    void join(const glm::vec2& point, const glm::vec2& n0, const glm::vec2& n1, ELineJoin type, const glm::vec3& col);
+
+private:
+    // Storage written to
+    std::vector<VertexT>& mVertices;
+    std::vector<unsigned>& mIndices;
+
+    // Unit directions on a circle (see makeDirections), kept to reuse the allocation
+    std::vector<float> mDirX;
+    std::vector<float> mDirY;
+
+    // Segment normals of the current polyline
+    std::vector<glm::vec2> mNormals;
+};
+
+// Generate count cos / sin pairs of startAngle + i * step with the rotation recurrence
+void makeCircleDirections(float* cosines, float* sines, unsigned count, float startAngle, float step);
+
+extern template class Tessellator<Vertex>;
+extern template class Tessellator<CompactVertex>;
+
+#endif // TESSELLATION_H
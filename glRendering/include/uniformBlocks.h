@@ -11,6 +11,7 @@
 #define UNIFORMBLOCKS_H
 
 #include "glm/vec2.hpp"
+#include "glm/vec4.hpp"
 #include "glm/mat4x4.hpp"
 
 /// Each struct in this file prefixed with U correspond to a uniform layout in
@@ -28,4 +29,13 @@ struct UAppData
     float timeSinceStart;       // Offset 16
 };
 
+struct UCullingData
+{
+    glm::vec4 frustumPlanes[6];     // Offset 0
+    glm::mat4 hiZViewProjection;    // Offset 96
+    glm::vec2 hiZSize;              // Offset 160
+    unsigned instanceCount;         // Offset 168
+    unsigned useHiZ;                // Offset 172
+};
+
 #endif // UNIFORMBLOCKS_H
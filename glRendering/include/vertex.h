@@ -3,6 +3,17 @@
 #ifndef VERTEX_H
 #define VERTEX_H
 
+#include <cstdint>
+
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+
+// Half float component, stored as the raw IEEE 754 bits (see floatToHalf)
+struct Half
+{
+    uint16_t bits;
+};
+
 struct Vertex
 {
     float x;
@@ -17,4 +28,28 @@ struct Vertex
     float v;
 };
 
+// Quantized vertex of 16 bytes: Half float position, RGBA8 color and 16-bit normalized UV in [0, 1]
+struct CompactVertex
+{
+    Half x;
+    Half y;
+    Half z;
+    Half padding;
+
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+
+    uint16_t u;
+    uint16_t v;
+};
+
+// Per-instance attributes, matches locations 3-7 in instanced.vert
+struct InstanceData
+{
+    glm::mat4 transform;
+    glm::vec4 color;
+};
+
 #endif // VERTEX_H
@@ -4,10 +4,16 @@
 #define VERTEXARRAY_H
 
 #include "buffer.h"
+#include "vertexLayout.h"
+
+#include <array>
 
 class VertexArray
 {
 public:
+    // Minimum number of buffer bindings OpenGL guarantees
+    static constexpr unsigned MaxBufferBindings = 16;
+
     VertexArray();
     VertexArray(const VertexBuffer& vbo);
     VertexArray(const VertexBuffer& vbo, const IndexBuffer& ibo);
@@ -18,7 +24,7 @@ public:
 
     ~VertexArray();
 
-    // Bind Vertex Array
+    // Bind Vertex Array. Does nothing if it is already bound
     void bind() const;
 
     // Unbind Vertex Array
@@ -27,25 +33,54 @@ public:
     // Get the OpenGL name of the Vertex Array
     const unsigned name() const;
 
+    // Forget the tracked binding. Call after binding vertex arrays without this class (e.g. raw gl calls)
+    static void invalidateBinding();
+
     // Add an attribute to the vertex array. For a vec4, you would add(4, gl::FLOAT, ...)
     void addAttribute(int size, unsigned type, unsigned offset, bool normalize = false);
     
     // Add a NOT normalized integral vertex attribute. Type must be of an integral type.
     void addIntegerAttribute(int size, unsigned type, unsigned offset);
 
+    // Attach vbo to a binding and configure its attributes, stride and divisor from the layout of VertexT
+    template<typename VertexT>
+    void setVertexFormat(const VertexBuffer& vbo, unsigned binding = 0, unsigned divisor = 0);
+
+    // Add all attributes of the layout to the current buffer binding, and use its stride for that binding
+    void setLayout(const VertexLayout& layout);
+
+    // Add a mat4 attribute. Occupies four consecutive attribute locations, one per column
+    void addMatrixAttribute(unsigned offset);
+
     // Remove and disable the last attribute
     void removeLastAttribute();
 
     // Set the vertex buffer that has the Vertex Array attribute data
     void setBuffer(const VertexBuffer& vbo);
+
+    // Set a vertex buffer with a custom stride between elements to the current buffer binding
+    void setBuffer(const VertexBuffer& vbo, int stride, ptrdiff_t offset = 0);
+
+    // Set a buffer by OpenGL name to the current buffer binding
+    void setBuffer(unsigned bufferName, int stride, ptrdiff_t offset = 0);
+
+    // Set a per-instance buffer to the current buffer binding. Also sets the binding divisor to 1
+    void setBuffer(const InstanceBuffer& instances);
+
+    // Advance the attributes of the current buffer binding once every divisor instances (0 = per vertex)
+    void setBindingDivisor(unsigned divisor);
     
     // Set the index buffer to use for indexed drawing
     void setIndexBuffer(const IndexBuffer& ibo);
+    void setIndexBuffer(unsigned bufferName);
 
     // Set the binding id to use for the next attribute / buffer binding
     void setBufferBinding(unsigned binding);
 
 private:
+    // The vertex array currently bound to the context, to skip redundant binds
+    inline static unsigned sBoundName = 0;
+
     // The OpenGL Name
     unsigned mName = 0;
 
@@ -55,7 +90,18 @@ private:
     // The current buffer binding to use
     unsigned mBufferBinding = 0;
 
+    // Stride of each buffer binding, used when setting a buffer without an explicit stride
+    std::array<int, MaxBufferBindings> mStrides;
+
 };
 
+template<typename VertexT>
+void VertexArray::setVertexFormat(const VertexBuffer& vbo, unsigned binding, unsigned divisor)
+{
+    setBufferBinding(binding);
+    setLayout(VertexFormat<VertexT>::layout);
+    setBuffer(vbo);
+    setBindingDivisor(divisor);
+}
 
 #endif // VERTEXARRAY_H
@@ -0,0 +1,78 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Deduplicates vertex array objects. A VAO is fully
+ * described by the layout, buffer, offset and divisor of
+ * each of its buffer bindings plus its index buffer, so
+ * everything that shares those (e.g. all meshes in a page
+ * of a MeshPool) can share one VAO instead of owning one each.
+ * That means fewer GL objects and fewer VAO switches per frame.
+ */
+
+#ifndef VERTEXARRAYCACHE_H
+#define VERTEXARRAYCACHE_H
+
+#include "vertexArray.h"
+#include "vertexLayout.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <unordered_map>
+
+// A single buffer binding of a cached vertex array
+struct VertexBinding
+{
+    // Layout of the buffer, the stride is taken from here
+    VertexLayout layout;
+
+    // OpenGL name of the buffer
+    unsigned buffer;
+
+    // Byte offset of the first vertex
+    ptrdiff_t offset;
+
+    // 0 = per vertex, n = advance once every n instances
+    unsigned divisor;
+};
+
+class VertexArrayCache final
+{
+public:
+    VertexArrayCache() = default;
+
+    VertexArrayCache(const VertexArrayCache& other) = delete;
+    VertexArrayCache& operator=(const VertexArrayCache& other) = delete;
+
+    // Get the vertex array for the bindings (binding i = bindings[i]) and index buffer, created on first use
+    const VertexArray& get(const std::vector<VertexBinding>& bindings, unsigned indexBuffer = 0);
+
+    // Destroy all vertex arrays referencing the buffer. Call before deleting a buffer used with the cache
+    void evict(unsigned buffer);
+
+    // Destroy all vertex arrays
+    void clear();
+
+    // Get the number of cached vertex arrays
+    const unsigned size() const;
+
+private:
+    struct Key
+    {
+        std::vector<VertexBinding> bindings;
+        unsigned indexBuffer;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+private:
+    // The cached vertex arrays, stored by pointer so references stay valid on rehash
+    std::unordered_map<Key, std::unique_ptr<VertexArray>, KeyHash> mVertexArrays;
+};
+
+#endif // VERTEXARRAYCACHE_H
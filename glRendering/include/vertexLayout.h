@@ -0,0 +1,164 @@
+/// OpenGL - by Carl Findahl - 2018
+
+/*
+ * Describes how the vertices of a buffer map to
+ * shader attributes: Format and offset of every
+ * attribute and the stride between vertices. Layouts
+ * are built at compile time from the vertex structs by
+ * specializing VertexFormat, so a VertexArray can be
+ * configured for any vertex type in one call and custom
+ * compact vertex types cost nothing at runtime. Also
+ * contains the packing of vertices to compact formats.
+ */
+
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#include "enums.h"
+#include "vertex.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "gl_cpp.hpp"
+
+struct VertexAttribute
+{
+    // Number of components
+    int size;
+
+    // OpenGL component type (gl::FLOAT, gl::HALF_FLOAT, ...)
+    unsigned type;
+
+    // Byte offset of the attribute within a vertex
+    unsigned offset;
+
+    // Map integer types to [0, 1] / [-1, 1]
+    bool normalize;
+};
+
+struct VertexLayout
+{
+    static constexpr unsigned MaxAttributes = 8;
+
+    VertexAttribute attributes[MaxAttributes];
+
+    // Number of used attributes
+    unsigned attributeCount;
+
+    // Bytes between consecutive vertices
+    unsigned stride;
+};
+
+// Maps a C++ component type to the OpenGL type enum
+template<typename T> struct ComponentType;
+template<> struct ComponentType<float>    { static constexpr unsigned value = gl::FLOAT; };
+template<> struct ComponentType<Half>     { static constexpr unsigned value = gl::HALF_FLOAT; };
+template<> struct ComponentType<int8_t>   { static constexpr unsigned value = gl::BYTE; };
+template<> struct ComponentType<uint8_t>  { static constexpr unsigned value = gl::UNSIGNED_BYTE; };
+template<> struct ComponentType<int16_t>  { static constexpr unsigned value = gl::SHORT; };
+template<> struct ComponentType<uint16_t> { static constexpr unsigned value = gl::UNSIGNED_SHORT; };
+template<> struct ComponentType<int32_t>  { static constexpr unsigned value = gl::INT; };
+template<> struct ComponentType<uint32_t> { static constexpr unsigned value = gl::UNSIGNED_INT; };
+
+// Make an attribute of size components of type ComponentT starting at offset
+template<typename ComponentT>
+constexpr VertexAttribute makeAttribute(int size, unsigned offset, bool normalize = false)
+{
+    return VertexAttribute{ size, ComponentType<ComponentT>::value, offset, normalize };
+}
+
+// Make the layout of VertexT from its attributes, in attribute location order
+template<typename VertexT, typename... Attributes>
+constexpr VertexLayout makeLayout(Attributes... attributes)
+{
+    static_assert(sizeof...(Attributes) <= VertexLayout::MaxAttributes, "Too many attributes in vertex layout");
+    return VertexLayout{ { attributes... }, sizeof...(Attributes), sizeof(VertexT) };
+}
+
+// Check that every attribute of the layout starts inside the vertex
+constexpr bool isValidLayout(const VertexLayout& layout)
+{
+    for (unsigned i = 0; i < layout.attributeCount; ++i)
+    {
+        if (layout.attributes[i].offset >= layout.stride || layout.attributes[i].size < 1 || layout.attributes[i].size > 4)
+            return false;
+    }
+    return true;
+}
+
+// Attribute of size components starting at member. The component type is taken from the member
+#define VERTEX_ATTRIBUTE(VertexT, member, size) \
+    makeAttribute<decltype(VertexT::member)>(size, offsetof(VertexT, member))
+
+// Same as VERTEX_ATTRIBUTE, but integer components are normalized
+#define VERTEX_ATTRIBUTE_NORMALIZED(VertexT, member, size) \
+    makeAttribute<decltype(VertexT::member)>(size, offsetof(VertexT, member), true)
+
+// Convert a float to an IEEE 754 half float, rounding to nearest even
+uint16_t floatToHalf(float value);
+
+// Convert an IEEE 754 half float to a float
+float halfToFloat(uint16_t value);
+
+// Quantize a vertex to the compact format
+CompactVertex packVertex(const Vertex& vertex);
+
+// Quantize all vertices to the compact format
+void packVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& out);
+
+/*
+ * Specialize for every type uploaded as vertex data. Provides
+ * the compile time layout, and for vertex types, how shape
+ * vertices are converted to it (see BasicRenderBatch).
+ */
+template<typename VertexT> struct VertexFormat;
+
+template<> struct VertexFormat<Vertex>
+{
+    static constexpr VertexLayout layout = makeLayout<Vertex>(
+        VERTEX_ATTRIBUTE(Vertex, x, 3),
+        VERTEX_ATTRIBUTE(Vertex, r, 3),
+        VERTEX_ATTRIBUTE(Vertex, u, 2));
+
+    static Vertex fromVertex(const Vertex& vertex) { return vertex; }
+};
+
+template<> struct VertexFormat<CompactVertex>
+{
+    static constexpr VertexLayout layout = makeLayout<CompactVertex>(
+        VERTEX_ATTRIBUTE(CompactVertex, x, 3),
+        VERTEX_ATTRIBUTE_NORMALIZED(CompactVertex, r, 4),
+        VERTEX_ATTRIBUTE_NORMALIZED(CompactVertex, u, 2));
+
+    static CompactVertex fromVertex(const Vertex& vertex) { return packVertex(vertex); }
+};
+
+template<> struct VertexFormat<InstanceData>
+{
+    // The transform takes one vec4 attribute per column
+    static constexpr VertexLayout layout = makeLayout<InstanceData>(
+        makeAttribute<float>(4, offsetof(InstanceData, transform)),
+        makeAttribute<float>(4, offsetof(InstanceData, transform) + sizeof(float) * 4),
+        makeAttribute<float>(4, offsetof(InstanceData, transform) + sizeof(float) * 8),
+        makeAttribute<float>(4, offsetof(InstanceData, transform) + sizeof(float) * 12),
+        makeAttribute<float>(4, offsetof(InstanceData, color)));
+};
+
+static_assert(isValidLayout(VertexFormat<Vertex>::layout), "Invalid Vertex layout");
+static_assert(isValidLayout(VertexFormat<CompactVertex>::layout), "Invalid CompactVertex layout");
+static_assert(isValidLayout(VertexFormat<InstanceData>::layout), "Invalid InstanceData layout");
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay half the size of Vertex");
+
+// Get the layout of the given vertex format, for choosing the format at runtime
+const VertexLayout& getVertexLayout(EVertexFormat format);
+
+// Compare the used attributes and stride of two layouts
+bool operator==(const VertexLayout& lhs, const VertexLayout& rhs);
+bool operator!=(const VertexLayout& lhs, const VertexLayout& rhs);
+
+// Hash the used attributes and stride of a layout
+size_t hashLayout(const VertexLayout& layout);
+
+#endif // VERTEXLAYOUT_H
@@ -0,0 +1,108 @@
+#include "bounds.h"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "glm/glm.hpp"
+
+AABB makeAABB(const glm::vec3* points, unsigned count)
+{
+    if (count == 0)
+    {
+        return AABB{ glm::vec3(0.f), glm::vec3(0.f) };
+    }
+
+    AABB out{ points[0], points[0] };
+    for (unsigned i = 1; i < count; ++i)
+    {
+        out.min = glm::min(out.min, points[i]);
+        out.max = glm::max(out.max, points[i]);
+    }
+
+    return out;
+}
+
+BoundingSphere makeBoundingSphere(const AABB& box)
+{
+    const glm::vec3 center = (box.min + box.max) * 0.5f;
+    return BoundingSphere{ center, glm::length(box.max - center) };
+}
+
+AABB mergeAABB(const AABB& a, const AABB& b)
+{
+    return AABB{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+float surfaceArea(const AABB& box)
+{
+    const glm::vec3 extent = box.max - box.min;
+    return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+bool overlaps(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+bool overlaps(const BoundingSphere& sphere, const AABB& box)
+{
+    // Distance from the sphere center to the closest point on the box
+    const glm::vec3 closest = glm::min(glm::max(sphere.center, box.min), box.max);
+    const glm::vec3 delta = closest - sphere.center;
+    return glm::dot(delta, delta) <= sphere.radius * sphere.radius;
+}
+
+bool intersectRay(const Ray& ray, const glm::vec3& inverseDirection, const AABB& box, float maxDistance, float& distance)
+{
+    float tMin = 0.f;
+    float tMax = maxDistance;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float t0 = (box.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+        float t1 = (box.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+        if (t0 > t1) std::swap(t0, t1);
+
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+            return false;
+    }
+
+    distance = tMin;
+    return true;
+}
+
+AABB transformAABB(const AABB& box, const glm::mat4& transform)
+{
+    // Arvo's method: Accumulate the min / max contribution of each matrix element
+    AABB out{ glm::vec3(transform[3]), glm::vec3(transform[3]) };
+
+    for (int col = 0; col < 3; ++col)
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            const float a = transform[col][row] * box.min[col];
+            const float b = transform[col][row] * box.max[col];
+            out.min[row] += std::min(a, b);
+            out.max[row] += std::max(a, b);
+        }
+    }
+
+    return out;
+}
+
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& transform)
+{
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(sphere.center, 1.f));
+
+    // The radius must grow with the largest scale along any of the axes
+    const float scale = std::max({ glm::length(glm::vec3(transform[0])),
+                                   glm::length(glm::vec3(transform[1])),
+                                   glm::length(glm::vec3(transform[2])) });
+
+    return BoundingSphere{ center, sphere.radius * scale };
+}
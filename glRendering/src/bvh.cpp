@@ -0,0 +1,413 @@
+#include "bvh.h"
+#include "logging.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "glm/glm.hpp"
+
+namespace
+{
+    // Number of bins used to evaluate split candidates per axis
+    constexpr unsigned BinCount = 16;
+
+    // Leaves with this many objects or fewer are never split
+    constexpr unsigned MinLeafSize = 2;
+
+    // Leaves are forced to split when they hold more objects than this
+    constexpr unsigned MaxLeafSize = 8;
+
+    // Below this depth the build stops using the SAH and splits in half, bounding the total depth
+    constexpr unsigned MaxSahDepth = 24;
+
+    // Size of the traversal stacks. Enough for MaxSahDepth plus 32 levels of median splits
+    constexpr unsigned StackSize = 64;
+
+    // Inverse of a direction, keeping the sign of zero components so the slab test stays valid
+    glm::vec3 inverse(const glm::vec3& direction)
+    {
+        constexpr float huge = std::numeric_limits<float>::max();
+        return glm::vec3(direction.x != 0.f ? 1.f / direction.x : (std::signbit(direction.x) ? -huge : huge),
+                         direction.y != 0.f ? 1.f / direction.y : (std::signbit(direction.y) ? -huge : huge),
+                         direction.z != 0.f ? 1.f / direction.z : (std::signbit(direction.z) ? -huge : huge));
+    }
+}
+
+void BVH::build(const std::vector<AABB>& bounds)
+{
+    mNodes.clear();
+    mObjectBounds = bounds;
+    mObjectIndices.resize(bounds.size());
+    mCentroids.resize(bounds.size());
+
+    for (unsigned i = 0; i != bounds.size(); ++i)
+    {
+        mObjectIndices[i] = i;
+        mCentroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+    }
+
+    if (bounds.empty()) return;
+
+    // A binary tree with n leaves has at most 2n - 1 nodes
+    mNodes.reserve(bounds.size() * 2);
+    buildRecursive(0, static_cast<unsigned>(bounds.size()), 0);
+}
+
+void BVH::update(unsigned object, const AABB& bounds)
+{
+    if (object >= mObjectBounds.size())
+    {
+        logWarn("Attempted to update object {} in a BVH of size {}!", object, mObjectBounds.size());
+        return;
+    }
+
+    mObjectBounds[object] = bounds;
+}
+
+void BVH::refit()
+{
+    // Children are always stored after their parents, so walking backwards visits children first
+    for (auto i = mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+        if (node.count > 0)
+        {
+            node.bounds = mObjectBounds[mObjectIndices[node.offset]];
+            for (unsigned j = 1; j < node.count; ++j)
+            {
+                node.bounds = mergeAABB(node.bounds, mObjectBounds[mObjectIndices[node.offset + j]]);
+            }
+        }
+        else
+        {
+            node.bounds = mergeAABB(mNodes[i + 1].bounds, mNodes[node.offset].bounds);
+        }
+    }
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<unsigned>& visible) const
+{
+    if (mNodes.empty()) return;
+
+    std::array<unsigned, StackSize> stack;
+    unsigned stackTop = 0;
+    stack[stackTop++] = 0;
+
+    while (stackTop > 0)
+    {
+        const unsigned nodeIndex = stack[--stackTop];
+        const Node& node = mNodes[nodeIndex];
+
+        if (!frustum.intersects(node.bounds))
+            continue;
+
+        // Entire subtree is visible, no need to test anything below this node
+        if (frustum.contains(node.bounds))
+        {
+            collectSubtree(nodeIndex, visible);
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (unsigned i = 0; i != node.count; ++i)
+            {
+                const unsigned object = mObjectIndices[node.offset + i];
+                if (frustum.intersects(mObjectBounds[object]))
+                    visible.push_back(object);
+            }
+        }
+        else
+        {
+            stack[stackTop++] = node.offset;
+            stack[stackTop++] = nodeIndex + 1;
+        }
+    }
+}
+
+void BVH::queryRange(const AABB& range, std::vector<unsigned>& result) const
+{
+    if (mNodes.empty()) return;
+
+    std::array<unsigned, StackSize> stack;
+    unsigned stackTop = 0;
+    stack[stackTop++] = 0;
+
+    while (stackTop > 0)
+    {
+        const unsigned nodeIndex = stack[--stackTop];
+        const Node& node = mNodes[nodeIndex];
+
+        if (!overlaps(range, node.bounds))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (unsigned i = 0; i != node.count; ++i)
+            {
+                const unsigned object = mObjectIndices[node.offset + i];
+                if (overlaps(range, mObjectBounds[object]))
+                    result.push_back(object);
+            }
+        }
+        else
+        {
+            stack[stackTop++] = node.offset;
+            stack[stackTop++] = nodeIndex + 1;
+        }
+    }
+}
+
+void BVH::queryRange(const BoundingSphere& range, std::vector<unsigned>& result) const
+{
+    if (mNodes.empty()) return;
+
+    std::array<unsigned, StackSize> stack;
+    unsigned stackTop = 0;
+    stack[stackTop++] = 0;
+
+    while (stackTop > 0)
+    {
+        const unsigned nodeIndex = stack[--stackTop];
+        const Node& node = mNodes[nodeIndex];
+
+        if (!overlaps(range, node.bounds))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (unsigned i = 0; i != node.count; ++i)
+            {
+                const unsigned object = mObjectIndices[node.offset + i];
+                if (overlaps(range, mObjectBounds[object]))
+                    result.push_back(object);
+            }
+        }
+        else
+        {
+            stack[stackTop++] = node.offset;
+            stack[stackTop++] = nodeIndex + 1;
+        }
+    }
+}
+
+bool BVH::raycast(const Ray& ray, unsigned& hitObject, float& hitDistance, float maxDistance) const
+{
+    if (mNodes.empty()) return false;
+
+    const glm::vec3 inverseDirection = inverse(ray.direction);
+    float closest = maxDistance;
+    bool hit = false;
+
+    std::array<unsigned, StackSize> stack;
+    unsigned stackTop = 0;
+    stack[stackTop++] = 0;
+
+    while (stackTop > 0)
+    {
+        const unsigned nodeIndex = stack[--stackTop];
+        const Node& node = mNodes[nodeIndex];
+
+        float distance;
+        if (!intersectRay(ray, inverseDirection, node.bounds, closest, distance))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (unsigned i = 0; i != node.count; ++i)
+            {
+                const unsigned object = mObjectIndices[node.offset + i];
+                if (intersectRay(ray, inverseDirection, mObjectBounds[object], closest, distance))
+                {
+                    closest = distance;
+                    hitObject = object;
+                    hit = true;
+                }
+            }
+        }
+        else
+        {
+            // Visit the nearer child first so the closest hit shrinks the search as early as possible
+            const unsigned left = nodeIndex + 1;
+            const unsigned right = node.offset;
+            float leftDistance = 0.f, rightDistance = 0.f;
+            const bool hitLeft = intersectRay(ray, inverseDirection, mNodes[left].bounds, closest, leftDistance);
+            const bool hitRight = intersectRay(ray, inverseDirection, mNodes[right].bounds, closest, rightDistance);
+
+            if (hitLeft && hitRight)
+            {
+                stack[stackTop++] = leftDistance < rightDistance ? right : left;
+                stack[stackTop++] = leftDistance < rightDistance ? left : right;
+            }
+            else if (hitLeft)
+            {
+                stack[stackTop++] = left;
+            }
+            else if (hitRight)
+            {
+                stack[stackTop++] = right;
+            }
+        }
+    }
+
+    if (hit) hitDistance = closest;
+    return hit;
+}
+
+const unsigned BVH::size() const
+{
+    return static_cast<unsigned>(mObjectBounds.size());
+}
+
+const unsigned BVH::nodeCount() const
+{
+    return static_cast<unsigned>(mNodes.size());
+}
+
+void BVH::buildRecursive(unsigned first, unsigned count, unsigned depth)
+{
+    const unsigned nodeIndex = static_cast<unsigned>(mNodes.size());
+    mNodes.push_back(Node{});
+
+    // Bounds of the node and of the centroids (used for binning)
+    AABB bounds = mObjectBounds[mObjectIndices[first]];
+    AABB centroidBounds{ mCentroids[mObjectIndices[first]], mCentroids[mObjectIndices[first]] };
+    for (unsigned i = first + 1; i != first + count; ++i)
+    {
+        const unsigned object = mObjectIndices[i];
+        bounds = mergeAABB(bounds, mObjectBounds[object]);
+        centroidBounds.min = glm::min(centroidBounds.min, mCentroids[object]);
+        centroidBounds.max = glm::max(centroidBounds.max, mCentroids[object]);
+    }
+    mNodes[nodeIndex].bounds = bounds;
+
+    auto makeLeaf = [&]()
+    {
+        mNodes[nodeIndex].offset = first;
+        mNodes[nodeIndex].count = count;
+    };
+
+    if (count <= MinLeafSize)
+    {
+        makeLeaf();
+        return;
+    }
+
+    // Evaluate the SAH for every bin boundary along every axis
+    int bestAxis = -1;
+    unsigned bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.f) continue;
+
+        std::array<unsigned, BinCount> binCounts{};
+        std::array<AABB, BinCount> binBounds;
+        const float scale = BinCount / extent;
+
+        for (unsigned i = first; i != first + count; ++i)
+        {
+            const unsigned object = mObjectIndices[i];
+            const auto bin = std::min(BinCount - 1, static_cast<unsigned>((mCentroids[object][axis] - centroidBounds.min[axis]) * scale));
+            binBounds[bin] = binCounts[bin] == 0 ? mObjectBounds[object] : mergeAABB(binBounds[bin], mObjectBounds[object]);
+            ++binCounts[bin];
+        }
+
+        // Sweep from the right to get the area and count of everything right of each split
+        std::array<float, BinCount> rightArea{};
+        std::array<unsigned, BinCount> rightCount{};
+        AABB accumulated{};
+        unsigned accumulatedCount = 0;
+        for (unsigned bin = BinCount - 1; bin > 0; --bin)
+        {
+            if (binCounts[bin] > 0)
+                accumulated = accumulatedCount == 0 ? binBounds[bin] : mergeAABB(accumulated, binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+            rightArea[bin] = accumulatedCount > 0 ? surfaceArea(accumulated) : 0.f;
+            rightCount[bin] = accumulatedCount;
+        }
+
+        // Sweep from the left and evaluate the cost of splitting before each bin
+        accumulatedCount = 0;
+        for (unsigned split = 1; split < BinCount; ++split)
+        {
+            const unsigned bin = split - 1;
+            if (binCounts[bin] > 0)
+                accumulated = accumulatedCount == 0 ? binBounds[bin] : mergeAABB(accumulated, binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+
+            if (accumulatedCount == 0 || rightCount[split] == 0) continue;
+
+            const float cost = surfaceArea(accumulated) * accumulatedCount + rightArea[split] * rightCount[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    // Splitting must be cheaper than intersecting every object in a leaf (traversal cost relative to 1)
+    const float leafCost = surfaceArea(bounds) * count;
+    unsigned leftCount = 0;
+
+    if (depth >= MaxSahDepth)
+    {
+        // Deep in a degenerate tree, fall back to splitting in half which halves the count each level
+        leftCount = count / 2;
+    }
+    else if (bestAxis >= 0 && (bestCost < leafCost || count > MaxLeafSize))
+    {
+        const float extent = centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis];
+        const float scale = BinCount / extent;
+        auto* begin = mObjectIndices.data() + first;
+        auto* middle = std::partition(begin, begin + count, [&](unsigned object)
+        {
+            const auto bin = std::min(BinCount - 1, static_cast<unsigned>((mCentroids[object][bestAxis] - centroidBounds.min[bestAxis]) * scale));
+            return bin < bestSplit;
+        });
+        leftCount = static_cast<unsigned>(middle - begin);
+    }
+    else if (count > MaxLeafSize)
+    {
+        // All centroids coincide, so just split the objects in half
+        leftCount = count / 2;
+    }
+    else
+    {
+        makeLeaf();
+        return;
+    }
+
+    // Left child directly follows this node, the right child comes after the left subtree
+    mNodes[nodeIndex].count = 0;
+    buildRecursive(first, leftCount, depth + 1);
+    mNodes[nodeIndex].offset = static_cast<unsigned>(mNodes.size());
+    buildRecursive(first + leftCount, count - leftCount, depth + 1);
+}
+
+void BVH::collectSubtree(unsigned nodeIndex, std::vector<unsigned>& result) const
+{
+    std::array<unsigned, StackSize> stack;
+    unsigned stackTop = 0;
+    stack[stackTop++] = nodeIndex;
+
+    while (stackTop > 0)
+    {
+        const Node& node = mNodes[stack[--stackTop]];
+        if (node.count > 0)
+        {
+            result.insert(result.end(), mObjectIndices.begin() + node.offset, mObjectIndices.begin() + node.offset + node.count);
+        }
+        else
+        {
+            stack[stackTop++] = node.offset;
+            stack[stackTop++] = static_cast<unsigned>(&node - mNodes.data()) + 1;
+        }
+    }
+}
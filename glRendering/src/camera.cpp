@@ -1,5 +1,6 @@
 #include "camera.h"
 
+#include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
 Camera::Camera(const glm::vec3& position, const glm::vec3& anchorPoint) : mAnchorPoint(anchorPoint), mPosition(position)
@@ -34,3 +35,24 @@ glm::mat4 Camera::getViewMatrix() const
 {
     return glm::lookAt(mPosition, mAnchorPoint, glm::vec3(0.f, 1.f, 0.f));
 }
+
+Frustum Camera::getFrustum(const glm::mat4& projection) const
+{
+    return Frustum(projection * getViewMatrix());
+}
+
+Ray Camera::getPickingRay(const glm::dvec2& cursor, const glm::ivec2& viewportSize, const glm::mat4& projection) const
+{
+    // Window coordinates have their origin in the upper left corner, NDC in the center
+    const float x = static_cast<float>(2.0 * cursor.x / viewportSize.x - 1.0);
+    const float y = static_cast<float>(1.0 - 2.0 * cursor.y / viewportSize.y);
+
+    // Unproject points on the near and far plane
+    const glm::mat4 inverseViewProjection = glm::inverse(projection * getViewMatrix());
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.f, 1.f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.f, 1.f);
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    return Ray{ glm::vec3(nearPoint), glm::normalize(glm::vec3(farPoint - nearPoint)) };
+}
@@ -0,0 +1,221 @@
+#include "cullingList.h"
+#include "jobSystem.h"
+#include "logging.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CULLING_SSE
+#endif
+
+namespace
+{
+    // Number of spheres tested per instruction
+#if defined(CULLING_AVX)
+    constexpr unsigned SimdWidth = 8;
+#elif defined(CULLING_SSE)
+    constexpr unsigned SimdWidth = 4;
+#else
+    constexpr unsigned SimdWidth = 1;
+#endif
+
+    // Objects culled per job, large enough to amortize scheduling and a multiple of every SIMD width
+    constexpr unsigned JobBlockSize = 16384;
+
+    // Round n up to the closest multiple of the SIMD width
+    unsigned roundUp(unsigned n)
+    {
+        return (n + SimdWidth - 1) / SimdWidth * SimdWidth;
+    }
+
+    // Test a single sphere against all planes of the frustum
+    bool scalarIntersects(const Frustum& frustum, float x, float y, float z, float radius)
+    {
+        for (int p = 0; p != Frustum::PlaneCount; ++p)
+        {
+            const auto& plane = frustum.getPlane(static_cast<Frustum::EPlane>(p));
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    // Push the index of every set lane in mask to the output
+    void appendVisible(int mask, unsigned base, std::vector<unsigned>& visible)
+    {
+        for (unsigned lane = 0; mask != 0; ++lane, mask >>= 1)
+        {
+            if (mask & 1)
+                visible.push_back(base + lane);
+        }
+    }
+}
+
+void CullingList::clear()
+{
+    mCount = 0;
+    mX.clear();
+    mY.clear();
+    mZ.clear();
+    mRadius.clear();
+}
+
+void CullingList::reserve(unsigned count)
+{
+    const auto padded = roundUp(count);
+    mX.reserve(padded);
+    mY.reserve(padded);
+    mZ.reserve(padded);
+    mRadius.reserve(padded);
+}
+
+unsigned CullingList::add(const BoundingSphere& sphere)
+{
+    // Grow by a full SIMD block at a time so the kernel never reads out of bounds
+    if (mCount >= mX.size())
+    {
+        const auto padded = roundUp(mCount + 1);
+        mX.resize(padded, 0.f);
+        mY.resize(padded, 0.f);
+        mZ.resize(padded, 0.f);
+        mRadius.resize(padded, 0.f);
+    }
+
+    mX[mCount] = sphere.center.x;
+    mY[mCount] = sphere.center.y;
+    mZ[mCount] = sphere.center.z;
+    mRadius[mCount] = sphere.radius;
+
+    return mCount++;
+}
+
+void CullingList::set(unsigned index, const BoundingSphere& sphere)
+{
+    if (index >= mCount)
+    {
+        logWarn("Attempted to set sphere {} in a culling list of size {}!", index, mCount);
+        return;
+    }
+
+    mX[index] = sphere.center.x;
+    mY[index] = sphere.center.y;
+    mZ[index] = sphere.center.z;
+    mRadius[index] = sphere.radius;
+}
+
+const unsigned CullingList::size() const
+{
+    return mCount;
+}
+
+void CullingList::cull(const Frustum& frustum, std::vector<unsigned>& visible) const
+{
+    cull(frustum, 0, mCount, visible);
+}
+
+void CullingList::cull(const Frustum& frustum, std::vector<unsigned>& visible, JobSystem& jobs) const
+{
+    // Every block writes its own list, appended in order afterwards
+    const unsigned blockCount = (mCount + JobBlockSize - 1) / JobBlockSize;
+    std::vector<std::vector<unsigned>> blockVisible(blockCount);
+
+    jobs.parallelFor(0, blockCount, 1, [&](unsigned begin, unsigned end)
+    {
+        for (unsigned block = begin; block < end; ++block)
+        {
+            cull(frustum, block * JobBlockSize, (block + 1) * JobBlockSize, blockVisible[block]);
+        }
+    });
+
+    for (const auto& block : blockVisible)
+    {
+        visible.insert(visible.end(), block.begin(), block.end());
+    }
+}
+
+void CullingList::cull(const Frustum& frustum, unsigned first, unsigned last, std::vector<unsigned>& visible) const
+{
+    if (last > mCount) last = mCount;
+    unsigned i = first;
+
+    // Scalar head until the start is aligned to a SIMD block
+    for (; i < last && i % SimdWidth != 0; ++i)
+    {
+        if (scalarIntersects(frustum, mX[i], mY[i], mZ[i], mRadius[i]))
+            visible.push_back(i);
+    }
+
+#if defined(CULLING_AVX)
+    __m256 planes[Frustum::PlaneCount][4];
+    for (int p = 0; p != Frustum::PlaneCount; ++p)
+    {
+        const auto& plane = frustum.getPlane(static_cast<Frustum::EPlane>(p));
+        planes[p][0] = _mm256_set1_ps(plane.x);
+        planes[p][1] = _mm256_set1_ps(plane.y);
+        planes[p][2] = _mm256_set1_ps(plane.z);
+        planes[p][3] = _mm256_set1_ps(plane.w);
+    }
+
+    // Blocks are padded, so the last block may safely read past the last object
+    for (; i < last; i += SimdWidth)
+    {
+        const __m256 x = _mm256_loadu_ps(&mX[i]);
+        const __m256 y = _mm256_loadu_ps(&mY[i]);
+        const __m256 z = _mm256_loadu_ps(&mZ[i]);
+        const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&mRadius[i]));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p != Frustum::PlaneCount; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(planes[p][0], x), planes[p][3]);
+            distance = _mm256_add_ps(_mm256_mul_ps(planes[p][1], y), distance);
+            distance = _mm256_add_ps(_mm256_mul_ps(planes[p][2], z), distance);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+        if (last - i < SimdWidth) mask &= (1 << (last - i)) - 1;
+        appendVisible(mask, i, visible);
+    }
+#elif defined(CULLING_SSE)
+    __m128 planes[Frustum::PlaneCount][4];
+    for (int p = 0; p != Frustum::PlaneCount; ++p)
+    {
+        const auto& plane = frustum.getPlane(static_cast<Frustum::EPlane>(p));
+        planes[p][0] = _mm_set1_ps(plane.x);
+        planes[p][1] = _mm_set1_ps(plane.y);
+        planes[p][2] = _mm_set1_ps(plane.z);
+        planes[p][3] = _mm_set1_ps(plane.w);
+    }
+
+    // Blocks are padded, so the last block may safely read past the last object
+    for (; i < last; i += SimdWidth)
+    {
+        const __m128 x = _mm_loadu_ps(&mX[i]);
+        const __m128 y = _mm_loadu_ps(&mY[i]);
+        const __m128 z = _mm_loadu_ps(&mZ[i]);
+        const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&mRadius[i]));
+
+        __m128 inside = _mm_cmpeq_ps(x, x); // All bits set (centers are never NaN)
+        for (int p = 0; p != Frustum::PlaneCount; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(planes[p][0], x), planes[p][3]);
+            distance = _mm_add_ps(_mm_mul_ps(planes[p][1], y), distance);
+            distance = _mm_add_ps(_mm_mul_ps(planes[p][2], z), distance);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        if (last - i < SimdWidth) mask &= (1 << (last - i)) - 1;
+        appendVisible(mask, i, visible);
+    }
+#else
+    for (; i < last; ++i)
+    {
+        if (scalarIntersects(frustum, mX[i], mY[i], mZ[i], mRadius[i]))
+            visible.push_back(i);
+    }
+#endif
+}
@@ -1,5 +1,7 @@
 #include "framebuffer.h"
 #include "logging.h"
+#include "gpuProfiler.h"
+#include "renderStats.h"
 
 #include "gl_cpp.hpp"
 
@@ -23,11 +25,13 @@ Framebuffer& Framebuffer::operator=(const Framebuffer& other)
     return *this;
 }
 
-Framebuffer::Framebuffer(Framebuffer&& other) noexcept : m_name(other.m_name), m_texture(other.m_texture), m_renderbuffer(other.m_renderbuffer)
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept : m_name(other.m_name), m_texture(other.m_texture), m_depthTexture(other.m_depthTexture),
+                                                         m_size(other.m_size), m_gpuZone(other.m_gpuZone)
 {
     other.m_name = 0;
+    other.m_gpuZone = -1;
     other.m_texture = 0;
-    other.m_renderbuffer = 0;
+    other.m_depthTexture = 0;
 }
 
 Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
@@ -36,17 +40,20 @@ Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
     if (this == &other) return *this;
     gl::DeleteFramebuffers(1, &m_name);
     gl::DeleteTextures(1, &m_texture);
-    gl::DeleteRenderbuffers(1, &m_renderbuffer);
+    gl::DeleteTextures(1, &m_depthTexture);
 
     // Steal
     m_name = other.m_name;
     m_texture = other.m_texture;
-    m_renderbuffer = other.m_renderbuffer;
+    m_depthTexture = other.m_depthTexture;
+    m_size = other.m_size;
+    m_gpuZone = other.m_gpuZone;
 
     // Clean up
     other.m_name = 0;
     other.m_texture = 0;
-    other.m_renderbuffer = 0;
+    other.m_depthTexture = 0;
+    other.m_gpuZone = -1;
 
     return *this;
 }
@@ -55,32 +62,40 @@ Framebuffer::~Framebuffer()
 {
     gl::DeleteFramebuffers(1, &m_name);
     gl::DeleteTextures(1, &m_texture);
-    gl::DeleteRenderbuffers(1, &m_renderbuffer);
+    gl::DeleteTextures(1, &m_depthTexture);
 }
 
 void Framebuffer::bind()
 {
+    beginPass();
     gl::BindFramebuffer(gl::FRAMEBUFFER, m_name);
+    ++RenderStats::counters().stateChanges;
 }
 
 void Framebuffer::bindReadonly()
 {
     gl::BindFramebuffer(gl::READ_FRAMEBUFFER, m_name);
+    ++RenderStats::counters().stateChanges;
 }
 
 void Framebuffer::bindWriteonly()
 {
+    beginPass();
     gl::BindFramebuffer(gl::DRAW_FRAMEBUFFER, m_name);
+    ++RenderStats::counters().stateChanges;
 }
 
 void Framebuffer::unbind()
 {
+    endPass();
     gl::BindFramebuffer(gl::FRAMEBUFFER, 0);
+    ++RenderStats::counters().stateChanges;
 }
 
 void Framebuffer::bindTexture(unsigned bindingPoint)
 {
     gl::BindTextureUnit(bindingPoint, m_texture);
+    ++RenderStats::counters().textureBinds;
 }
 
 void Framebuffer::unbindTexture(unsigned bindingPoint)
@@ -88,16 +103,33 @@ void Framebuffer::unbindTexture(unsigned bindingPoint)
     gl::BindTextureUnit(bindingPoint, 0);
 }
 
+void Framebuffer::bindDepthTexture(unsigned bindingPoint) const
+{
+    gl::BindTextureUnit(bindingPoint, m_depthTexture);
+    ++RenderStats::counters().textureBinds;
+}
+
+uint32_t Framebuffer::getDepthTexture() const
+{
+    return m_depthTexture;
+}
+
+const glm::ivec2& Framebuffer::getSize() const
+{
+    return m_size;
+}
+
 void Framebuffer::resetToNewSize(const glm::ivec2& size)
 {
     // Assume that we have valid objects and just delete them by default
     gl::DeleteFramebuffers(1, &m_name);
     gl::DeleteTextures(1, &m_texture);
-    gl::DeleteRenderbuffers(1, &m_renderbuffer);
+    gl::DeleteTextures(1, &m_depthTexture);
 
     // Then start re-creating them
+    m_size = size;
     createTexture(size);
-    createRenderbuffer(size);
+    createDepthTexture(size);
     createFramebuffer(size);
 
     // Ensure everything is in order
@@ -107,7 +139,7 @@ void Framebuffer::resetToNewSize(const glm::ivec2& size)
 
         gl::DeleteFramebuffers(1, &m_name);
         gl::DeleteTextures(1, &m_texture);
-        gl::DeleteRenderbuffers(1, &m_renderbuffer);
+        gl::DeleteTextures(1, &m_depthTexture);
     }
 }
 
@@ -116,7 +148,7 @@ void Framebuffer::createFramebuffer(const glm::ivec2& size)
     // Simply Attach the stuff created in the earlier steps
     gl::CreateFramebuffers(1, &m_name);
     gl::NamedFramebufferTexture(m_name, gl::COLOR_ATTACHMENT0, m_texture, 0);
-    gl::NamedFramebufferRenderbuffer(m_name, gl::DEPTH_STENCIL_ATTACHMENT, gl::RENDERBUFFER, m_renderbuffer);
+    gl::NamedFramebufferTexture(m_name, gl::DEPTH_STENCIL_ATTACHMENT, m_depthTexture, 0);
 }
 
 void Framebuffer::createTexture(const glm::ivec2& size)
@@ -132,10 +164,17 @@ void Framebuffer::createTexture(const glm::ivec2& size)
     gl::TextureParameteri(m_texture, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
 }
 
-void Framebuffer::createRenderbuffer(const glm::ivec2& size)
+void Framebuffer::createDepthTexture(const glm::ivec2& size)
 {
-    gl::CreateRenderbuffers(1, &m_renderbuffer);
-    gl::NamedRenderbufferStorage(m_renderbuffer, gl::DEPTH24_STENCIL8, size.x, size.y);
+    gl::CreateTextures(gl::TEXTURE_2D, 1, &m_depthTexture);
+    gl::TextureStorage2D(m_depthTexture, 1, gl::DEPTH24_STENCIL8, size.x, size.y);
+
+    // Sample the depth component, without filtering
+    gl::TextureParameteri(m_depthTexture, gl::DEPTH_STENCIL_TEXTURE_MODE, gl::DEPTH_COMPONENT);
+    gl::TextureParameteri(m_depthTexture, gl::TEXTURE_MIN_FILTER, gl::NEAREST);
+    gl::TextureParameteri(m_depthTexture, gl::TEXTURE_MAG_FILTER, gl::NEAREST);
+    gl::TextureParameteri(m_depthTexture, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE);
+    gl::TextureParameteri(m_depthTexture, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
 }
 
 bool Framebuffer::validateFramebuffer() const
@@ -146,9 +185,7 @@ bool Framebuffer::validateFramebuffer() const
 void Framebuffer::resetFromCopy(const Framebuffer& other)
 {
     // Get the size of the other one
-    glm::ivec2 size;
-    gl::GetNamedFramebufferParameteriv(other.m_name, gl::MAX_FRAMEBUFFER_WIDTH, &size.x);
-    gl::GetNamedFramebufferParameteriv(other.m_name, gl::MAX_FRAMEBUFFER_HEIGHT, &size.y);
+    const glm::ivec2 size = other.m_size;
 
     // Create a framebuffer of the same size
     resetToNewSize(size);
@@ -159,3 +196,26 @@ void Framebuffer::resetFromCopy(const Framebuffer& other)
                              0, 0, size.x, size.y,
                              gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT | gl::STENCIL_BUFFER_BIT, gl::NEAREST);
 }
+
+void Framebuffer::beginPass()
+{
+#if defined(ENABLE_PROFILER)
+    auto* profiler = ServiceLocator<GpuProfiler>::get();
+    if (m_gpuZone < 0 && profiler && Profiler::isEnabled())
+    {
+        m_gpuZone = profiler->beginZone("Framebuffer Pass");
+    }
+#endif
+}
+
+void Framebuffer::endPass()
+{
+#if defined(ENABLE_PROFILER)
+    auto* profiler = ServiceLocator<GpuProfiler>::get();
+    if (m_gpuZone >= 0 && profiler)
+    {
+        profiler->endZone(m_gpuZone);
+    }
+    m_gpuZone = -1;
+#endif
+}
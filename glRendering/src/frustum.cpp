@@ -0,0 +1,74 @@
+#include "frustum.h"
+
+#include "glm/glm.hpp"
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    // Gribb / Hartmann extraction. glm is column major so gather the rows first
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    mPlanes[Left] = rows[3] + rows[0];
+    mPlanes[Right] = rows[3] - rows[0];
+    mPlanes[Bottom] = rows[3] + rows[1];
+    mPlanes[Top] = rows[3] - rows[1];
+    mPlanes[Near] = rows[3] + rows[2];
+    mPlanes[Far] = rows[3] - rows[2];
+
+    // Normalize so distances to the planes are in world units
+    for (auto& plane : mPlanes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+const bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    for (const auto& plane : mPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+            return false;
+    }
+
+    return true;
+}
+
+const bool Frustum::intersects(const AABB& box) const
+{
+    for (const auto& plane : mPlanes)
+    {
+        // Test the corner that is furthest along the plane normal (the positive vertex)
+        const glm::vec3 positive{ plane.x >= 0.f ? box.max.x : box.min.x,
+                                  plane.y >= 0.f ? box.max.y : box.min.y,
+                                  plane.z >= 0.f ? box.max.z : box.min.z };
+
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.f)
+            return false;
+    }
+
+    return true;
+}
+
+const bool Frustum::contains(const AABB& box) const
+{
+    for (const auto& plane : mPlanes)
+    {
+        // Test the corner that is furthest against the plane normal (the negative vertex)
+        const glm::vec3 negative{ plane.x >= 0.f ? box.min.x : box.max.x,
+                                  plane.y >= 0.f ? box.min.y : box.max.y,
+                                  plane.z >= 0.f ? box.min.z : box.max.z };
+
+        if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.f)
+            return false;
+    }
+
+    return true;
+}
+
+const glm::vec4& Frustum::getPlane(EPlane plane) const
+{
+    return mPlanes[plane];
+}
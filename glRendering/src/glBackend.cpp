@@ -0,0 +1,582 @@
+#include "glBackend.h"
+#include "glTrace.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+namespace
+{
+    constexpr size_t FunctionCount = static_cast<size_t>(EGLFunction::Count);
+
+    struct BackendState
+    {
+        EGLBackend backend = EGLBackend::Driver;
+        std::array<uint64_t, FunctionCount> callCounts{};
+
+        // Recording backend
+        GLCommandStream* stream = nullptr;
+        bool bRecordToDriver = false;
+
+        // Tracing backend
+        GLTraceWriter* trace = nullptr;
+
+        // Null backend: Names handed out so far, memory of buffers and sizes of textures
+        GLuint lastName = 0;
+        std::unordered_map<GLuint, std::vector<unsigned char>> buffers;
+        std::unordered_map<GLuint, std::array<GLint, 3>> textureSizes;
+    };
+
+    BackendState& backendState()
+    {
+        static BackendState state;
+        return state;
+    }
+
+    // The hooks of one function, from its function pointer type
+    template<EGLFunction F, typename Function = typename GLFunctionTraits<F>::Type>
+    struct Hooks;
+
+    template<EGLFunction F, typename R, typename... Args>
+    struct Hooks<F, R (CODEGEN_FUNCPTR *)(Args...)>
+    {
+        using Function = R (CODEGEN_FUNCPTR *)(Args...);
+
+        // What the loader pointed to before the first switch away from the driver
+        static inline Function driver = nullptr;
+
+        // Null backend implementation, functions without one do nothing and return zero
+        static inline Function fake = nullptr;
+
+        static R CODEGEN_FUNCPTR nullCall(Args... args)
+        {
+            ++backendState().callCounts[static_cast<size_t>(F)];
+            return fakeCall(args...);
+        }
+
+        static R CODEGEN_FUNCPTR recordCall(Args... args)
+        {
+            auto& state = backendState();
+            ++state.callCounts[static_cast<size_t>(F)];
+            state.stream->write(F, args...);
+
+            if (!state.bRecordToDriver) return fakeCall(args...);
+
+            if constexpr (std::is_void_v<R>)
+            {
+                driver(args...);
+                keepHook(&recordCall);
+            }
+            else
+            {
+                R result = driver(args...);
+                keepHook(&recordCall);
+                return result;
+            }
+        }
+
+        static R CODEGEN_FUNCPTR traceCall(Args... args)
+        {
+            auto& state = backendState();
+            ++state.callCounts[static_cast<size_t>(F)];
+            state.trace->beginCall(F, args...);
+
+            if constexpr (std::is_void_v<R>)
+            {
+                driver(args...);
+                keepHook(&traceCall);
+                state.trace->endCall();
+            }
+            else
+            {
+                R result = driver(args...);
+                keepHook(&traceCall);
+                state.trace->endCall(&result, sizeof(R));
+                return result;
+            }
+        }
+
+        static R fakeCall(Args... args)
+        {
+            if (fake) return fake(args...);
+            if constexpr (!std::is_void_v<R>) return R{};
+        }
+
+        // The loader resolves a function on its first call and writes it over the hook, keep it and put the hook back
+        static void keepHook(Function hook)
+        {
+            Function& pointer = GLFunctionTraits<F>::pointer();
+            if (pointer != hook)
+            {
+                driver = pointer;
+                pointer = hook;
+            }
+        }
+
+        static void install(EGLBackend backend, bool saveDriver)
+        {
+            Function& pointer = GLFunctionTraits<F>::pointer();
+            if (saveDriver) driver = pointer;
+
+            switch (backend)
+            {
+            case EGLBackend::Driver:
+                pointer = driver;
+                break;
+            case EGLBackend::Null:
+                pointer = &nullCall;
+                break;
+            case EGLBackend::Recording:
+                pointer = &recordCall;
+                break;
+            case EGLBackend::Tracing:
+                pointer = &traceCall;
+                break;
+            }
+        }
+    };
+
+    template<EGLFunction F>
+    void setFake(typename GLFunctionTraits<F>::Type fake)
+    {
+        Hooks<F>::fake = fake;
+    }
+
+    /// Null backend implementations
+
+    void CODEGEN_FUNCPTR fakeGenNames(GLsizei n, GLuint* names)
+    {
+        auto& state = backendState();
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            names[i] = ++state.lastName;
+        }
+    }
+
+    void CODEGEN_FUNCPTR fakeCreateTargetNames(GLenum, GLsizei n, GLuint* names)
+    {
+        fakeGenNames(n, names);
+    }
+
+    GLuint CODEGEN_FUNCPTR fakeCreateShader(GLenum)
+    {
+        return ++backendState().lastName;
+    }
+
+    GLuint CODEGEN_FUNCPTR fakeCreateProgram()
+    {
+        return ++backendState().lastName;
+    }
+
+    GLuint CODEGEN_FUNCPTR fakeCreateShaderProgramv(GLenum, GLsizei, const GLchar* const*)
+    {
+        return ++backendState().lastName;
+    }
+
+    void CODEGEN_FUNCPTR fakeDeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            backendState().buffers.erase(buffers[i]);
+        }
+    }
+
+    void CODEGEN_FUNCPTR fakeDeleteTextures(GLsizei n, const GLuint* textures)
+    {
+        for (GLsizei i = 0; i < n; ++i)
+        {
+            backendState().textureSizes.erase(textures[i]);
+        }
+    }
+
+    void CODEGEN_FUNCPTR fakeNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield)
+    {
+        auto& memory = backendState().buffers[buffer];
+        memory.assign(static_cast<size_t>(size), 0);
+        if (data) std::memcpy(memory.data(), data, static_cast<size_t>(size));
+    }
+
+    void CODEGEN_FUNCPTR fakeNamedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum)
+    {
+        fakeNamedBufferStorage(buffer, size, data, 0);
+    }
+
+    // Get the memory of a buffer range, nullptr if it is not in the buffer
+    unsigned char* bufferRange(GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        auto& buffers = backendState().buffers;
+        const auto it = buffers.find(buffer);
+        if (it == buffers.end() || offset < 0 || size < 0 || static_cast<size_t>(offset + size) > it->second.size())
+        {
+            return nullptr;
+        }
+
+        return it->second.data() + offset;
+    }
+
+    void CODEGEN_FUNCPTR fakeNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        if (auto* memory = bufferRange(buffer, offset, size)) std::memcpy(memory, data, static_cast<size_t>(size));
+    }
+
+    void CODEGEN_FUNCPTR fakeGetNamedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, void* data)
+    {
+        if (auto* memory = bufferRange(buffer, offset, size)) std::memcpy(data, memory, static_cast<size_t>(size));
+    }
+
+    void CODEGEN_FUNCPTR fakeCopyNamedBufferSubData(GLuint source, GLuint destination, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+    {
+        auto* from = bufferRange(source, readOffset, size);
+        auto* to = bufferRange(destination, writeOffset, size);
+        if (from && to) std::memmove(to, from, static_cast<size_t>(size));
+    }
+
+    void* CODEGEN_FUNCPTR fakeMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield)
+    {
+        return bufferRange(buffer, offset, length);
+    }
+
+    void* CODEGEN_FUNCPTR fakeMapNamedBuffer(GLuint buffer, GLenum)
+    {
+        auto& buffers = backendState().buffers;
+        const auto it = buffers.find(buffer);
+        return it != buffers.end() ? it->second.data() : nullptr;
+    }
+
+    GLboolean CODEGEN_FUNCPTR fakeUnmapNamedBuffer(GLuint)
+    {
+        return gl::TRUE_;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetNamedBufferParameteriv(GLuint buffer, GLenum pname, GLint* params)
+    {
+        const auto& buffers = backendState().buffers;
+        const auto it = buffers.find(buffer);
+        *params = pname == gl::BUFFER_SIZE && it != buffers.end() ? static_cast<GLint>(it->second.size()) : 0;
+    }
+
+    void CODEGEN_FUNCPTR fakeTextureStorage1D(GLuint texture, GLsizei, GLenum, GLsizei width)
+    {
+        backendState().textureSizes[texture] = { width, 1, 1 };
+    }
+
+    void CODEGEN_FUNCPTR fakeTextureStorage2D(GLuint texture, GLsizei, GLenum, GLsizei width, GLsizei height)
+    {
+        backendState().textureSizes[texture] = { width, height, 1 };
+    }
+
+    void CODEGEN_FUNCPTR fakeTextureStorage3D(GLuint texture, GLsizei, GLenum, GLsizei width, GLsizei height, GLsizei depth)
+    {
+        backendState().textureSizes[texture] = { width, height, depth };
+    }
+
+    void CODEGEN_FUNCPTR fakeGetTextureLevelParameteriv(GLuint texture, GLint level, GLenum pname, GLint* params)
+    {
+        const auto& sizes = backendState().textureSizes;
+        const auto it = sizes.find(texture);
+        if (it == sizes.end())
+        {
+            *params = 0;
+            return;
+        }
+
+        // Every level is half the size of the one above it
+        const auto levelSize = [&](unsigned axis) { return std::max(it->second[axis] >> level, 1); };
+        switch (pname)
+        {
+        case gl::TEXTURE_WIDTH: *params = levelSize(0); break;
+        case gl::TEXTURE_HEIGHT: *params = levelSize(1); break;
+        case gl::TEXTURE_DEPTH: *params = it->second[2]; break;
+        default: *params = 0; break;
+        }
+    }
+
+    // Compiling and linking always succeed, logs are empty
+    void CODEGEN_FUNCPTR fakeGetShaderiv(GLuint, GLenum pname, GLint* params)
+    {
+        *params = pname == gl::COMPILE_STATUS ? static_cast<GLint>(gl::TRUE_) : 0;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetProgramiv(GLuint, GLenum pname, GLint* params)
+    {
+        *params = pname == gl::LINK_STATUS || pname == gl::VALIDATE_STATUS ? static_cast<GLint>(gl::TRUE_) : 0;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        if (length) *length = 0;
+        if (bufSize > 0) infoLog[0] = '\0';
+    }
+
+    void CODEGEN_FUNCPTR fakeGetUniformIndices(GLuint, GLsizei uniformCount, const GLchar* const*, GLuint* uniformIndices)
+    {
+        for (GLsizei i = 0; i < uniformCount; ++i)
+        {
+            uniformIndices[i] = static_cast<GLuint>(i);
+        }
+    }
+
+    void CODEGEN_FUNCPTR fakeGetActiveUniformsiv(GLuint, GLsizei uniformCount, const GLuint*, GLenum, GLint* params)
+    {
+        for (GLsizei i = 0; i < uniformCount; ++i)
+        {
+            params[i] = 0;
+        }
+    }
+
+    GLenum CODEGEN_FUNCPTR fakeCheckNamedFramebufferStatus(GLuint, GLenum)
+    {
+        return gl::FRAMEBUFFER_COMPLETE;
+    }
+
+    // Queries of several values, the rest is one value
+    void CODEGEN_FUNCPTR fakeGetIntegerv(GLenum pname, GLint* data)
+    {
+        const int count = pname == gl::VIEWPORT || pname == gl::SCISSOR_BOX ? 4 : pname == gl::POLYGON_MODE ? 2 : 1;
+        std::fill(data, data + count, 0);
+    }
+
+    void CODEGEN_FUNCPTR fakeGetInteger64v(GLenum, GLint64* data)
+    {
+        *data = 0;
+    }
+
+    // Queries finish right away and measured nothing
+    void CODEGEN_FUNCPTR fakeGetQueryObjectiv(GLuint, GLenum pname, GLint* params)
+    {
+        *params = pname == gl::QUERY_RESULT_AVAILABLE ? static_cast<GLint>(gl::TRUE_) : 0;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetQueryObjectuiv(GLuint, GLenum pname, GLuint* params)
+    {
+        *params = pname == gl::QUERY_RESULT_AVAILABLE ? static_cast<GLuint>(gl::TRUE_) : 0u;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetQueryObjecti64v(GLuint, GLenum pname, GLint64* params)
+    {
+        *params = pname == gl::QUERY_RESULT_AVAILABLE ? static_cast<GLint64>(gl::TRUE_) : 0;
+    }
+
+    void CODEGEN_FUNCPTR fakeGetQueryObjectui64v(GLuint, GLenum pname, GLuint64* params)
+    {
+        *params = pname == gl::QUERY_RESULT_AVAILABLE ? static_cast<GLuint64>(gl::TRUE_) : 0u;
+    }
+
+    // Fences are signalled as soon as they are made
+    GLsync CODEGEN_FUNCPTR fakeFenceSync(GLenum, GLbitfield)
+    {
+        return reinterpret_cast<GLsync>(static_cast<uintptr_t>(++backendState().lastName));
+    }
+
+    GLenum CODEGEN_FUNCPTR fakeClientWaitSync(GLsync, GLbitfield, GLuint64)
+    {
+        return gl::ALREADY_SIGNALED;
+    }
+
+    const GLubyte* CODEGEN_FUNCPTR fakeGetString(GLenum name)
+    {
+        const char* value = "";
+        switch (name)
+        {
+        case gl::VENDOR: value = "None"; break;
+        case gl::RENDERER: value = "Null GL backend"; break;
+        case gl::VERSION: value = "4.5 Null"; break;
+        case gl::SHADING_LANGUAGE_VERSION: value = "4.50"; break;
+        }
+        return reinterpret_cast<const GLubyte*>(value);
+    }
+
+    void installFakes()
+    {
+        setFake<EGLFunction::GenBuffers>(&fakeGenNames);
+        setFake<EGLFunction::GenTextures>(&fakeGenNames);
+        setFake<EGLFunction::GenVertexArrays>(&fakeGenNames);
+        setFake<EGLFunction::GenFramebuffers>(&fakeGenNames);
+        setFake<EGLFunction::GenRenderbuffers>(&fakeGenNames);
+        setFake<EGLFunction::GenQueries>(&fakeGenNames);
+        setFake<EGLFunction::GenSamplers>(&fakeGenNames);
+        setFake<EGLFunction::GenProgramPipelines>(&fakeGenNames);
+        setFake<EGLFunction::GenTransformFeedbacks>(&fakeGenNames);
+        setFake<EGLFunction::CreateBuffers>(&fakeGenNames);
+        setFake<EGLFunction::CreateVertexArrays>(&fakeGenNames);
+        setFake<EGLFunction::CreateFramebuffers>(&fakeGenNames);
+        setFake<EGLFunction::CreateRenderbuffers>(&fakeGenNames);
+        setFake<EGLFunction::CreateSamplers>(&fakeGenNames);
+        setFake<EGLFunction::CreateProgramPipelines>(&fakeGenNames);
+        setFake<EGLFunction::CreateTransformFeedbacks>(&fakeGenNames);
+        setFake<EGLFunction::CreateTextures>(&fakeCreateTargetNames);
+        setFake<EGLFunction::CreateQueries>(&fakeCreateTargetNames);
+        setFake<EGLFunction::CreateShader>(&fakeCreateShader);
+        setFake<EGLFunction::CreateProgram>(&fakeCreateProgram);
+        setFake<EGLFunction::CreateShaderProgramv>(&fakeCreateShaderProgramv);
+
+        setFake<EGLFunction::DeleteBuffers>(&fakeDeleteBuffers);
+        setFake<EGLFunction::NamedBufferStorage>(&fakeNamedBufferStorage);
+        setFake<EGLFunction::NamedBufferData>(&fakeNamedBufferData);
+        setFake<EGLFunction::NamedBufferSubData>(&fakeNamedBufferSubData);
+        setFake<EGLFunction::GetNamedBufferSubData>(&fakeGetNamedBufferSubData);
+        setFake<EGLFunction::CopyNamedBufferSubData>(&fakeCopyNamedBufferSubData);
+        setFake<EGLFunction::MapNamedBufferRange>(&fakeMapNamedBufferRange);
+        setFake<EGLFunction::MapNamedBuffer>(&fakeMapNamedBuffer);
+        setFake<EGLFunction::UnmapNamedBuffer>(&fakeUnmapNamedBuffer);
+        setFake<EGLFunction::GetNamedBufferParameteriv>(&fakeGetNamedBufferParameteriv);
+
+        setFake<EGLFunction::DeleteTextures>(&fakeDeleteTextures);
+        setFake<EGLFunction::TextureStorage1D>(&fakeTextureStorage1D);
+        setFake<EGLFunction::TextureStorage2D>(&fakeTextureStorage2D);
+        setFake<EGLFunction::TextureStorage3D>(&fakeTextureStorage3D);
+        setFake<EGLFunction::GetTextureLevelParameteriv>(&fakeGetTextureLevelParameteriv);
+
+        setFake<EGLFunction::GetShaderiv>(&fakeGetShaderiv);
+        setFake<EGLFunction::GetProgramiv>(&fakeGetProgramiv);
+        setFake<EGLFunction::GetShaderInfoLog>(&fakeGetInfoLog);
+        setFake<EGLFunction::GetProgramInfoLog>(&fakeGetInfoLog);
+        setFake<EGLFunction::GetUniformIndices>(&fakeGetUniformIndices);
+        setFake<EGLFunction::GetActiveUniformsiv>(&fakeGetActiveUniformsiv);
+
+        setFake<EGLFunction::CheckNamedFramebufferStatus>(&fakeCheckNamedFramebufferStatus);
+        setFake<EGLFunction::GetIntegerv>(&fakeGetIntegerv);
+        setFake<EGLFunction::GetInteger64v>(&fakeGetInteger64v);
+        setFake<EGLFunction::GetQueryObjectiv>(&fakeGetQueryObjectiv);
+        setFake<EGLFunction::GetQueryObjectuiv>(&fakeGetQueryObjectuiv);
+        setFake<EGLFunction::GetQueryObjecti64v>(&fakeGetQueryObjecti64v);
+        setFake<EGLFunction::GetQueryObjectui64v>(&fakeGetQueryObjectui64v);
+        setFake<EGLFunction::FenceSync>(&fakeFenceSync);
+        setFake<EGLFunction::ClientWaitSync>(&fakeClientWaitSync);
+        setFake<EGLFunction::GetString>(&fakeGetString);
+    }
+
+    // Point every function of the loader at the backend
+    void install(EGLBackend backend)
+    {
+        static const bool fakesInstalled = (installFakes(), true);
+        (void)fakesInstalled;
+
+        // The driver functions are saved when leaving the driver, so they can be restored and recorded to
+        const bool saveDriver = backendState().backend == EGLBackend::Driver;
+
+#define GL_FUNCTION(name) Hooks<EGLFunction::name>::install(backend, saveDriver);
+#include "gl_cpp_functions.hpp"
+#undef GL_FUNCTION
+
+        backendState().backend = backend;
+    }
+}
+
+const char* getGLFunctionName(EGLFunction function)
+{
+    static const char* const names[] = {
+#define GL_FUNCTION(name) #name,
+#include "gl_cpp_functions.hpp"
+#undef GL_FUNCTION
+    };
+
+    const auto index = static_cast<size_t>(function);
+    return index < FunctionCount ? names[index] : "Unknown";
+}
+
+void GLCommandStream::clear()
+{
+    mData.clear();
+    mCount = 0;
+}
+
+std::vector<GLCommand> GLCommandStream::getCommands() const
+{
+    std::vector<GLCommand> commands;
+    commands.reserve(mCount);
+
+    size_t offset = 0;
+    while (offset < mData.size())
+    {
+        Header header;
+        std::memcpy(&header, mData.data() + offset, sizeof(Header));
+        offset += sizeof(Header);
+
+        commands.push_back(GLCommand{ header.function, mData.data() + offset, header.size });
+        offset += header.size;
+    }
+
+    return commands;
+}
+
+const unsigned GLCommandStream::count(EGLFunction function) const
+{
+    unsigned result = 0;
+    for (const auto& command : getCommands())
+    {
+        if (command.function == function) ++result;
+    }
+    return result;
+}
+
+const unsigned GLCommandStream::size() const
+{
+    return mCount;
+}
+
+const size_t GLCommandStream::byteSize() const
+{
+    return mData.size();
+}
+
+void GLBackend::useDriver()
+{
+    if (backendState().backend == EGLBackend::Driver) return;
+
+    install(EGLBackend::Driver);
+    backendState().stream = nullptr;
+    backendState().trace = nullptr;
+}
+
+void GLBackend::useNull()
+{
+    install(EGLBackend::Null);
+}
+
+void GLBackend::useRecording(GLCommandStream& stream, EGLBackend target)
+{
+    if (target == EGLBackend::Recording)
+    {
+        logErr("GLBackend: Can not record to the recording backend, recording to the null backend");
+        target = EGLBackend::Null;
+    }
+
+    auto& state = backendState();
+    state.stream = &stream;
+    state.bRecordToDriver = target == EGLBackend::Driver;
+    install(EGLBackend::Recording);
+}
+
+void GLBackend::useTracing(GLTraceWriter& writer)
+{
+    backendState().trace = &writer;
+    install(EGLBackend::Tracing);
+}
+
+const EGLBackend GLBackend::get()
+{
+    return backendState().backend;
+}
+
+const uint64_t GLBackend::getCallCount(EGLFunction function)
+{
+    const auto index = static_cast<size_t>(function);
+    return index < FunctionCount ? backendState().callCounts[index] : 0;
+}
+
+const uint64_t GLBackend::getTotalCallCount()
+{
+    uint64_t total = 0;
+    for (const auto count : backendState().callCounts)
+    {
+        total += count;
+    }
+    return total;
+}
+
+void GLBackend::resetCallCounts()
+{
+    backendState().callCounts.fill(0);
+}
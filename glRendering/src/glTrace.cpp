@@ -0,0 +1,1009 @@
+#include "glTrace.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    constexpr char TraceMagic[4] = { 'G', 'L', 'T', 'R' };
+    constexpr uint32_t TraceVersion = 1;
+
+    // Payloads start on a multiple of this in the file, so a replay can pass them to GL where they are
+    constexpr size_t PayloadAlignment = 8;
+
+    // Marks the end of the payloads of a call
+    constexpr uint8_t PayloadsEnd = 0xFF;
+
+    // Mappings are compared in blocks, runs of changed blocks are written as one range
+    constexpr size_t MappingBlockSize = 256;
+
+    // Whether the driver may read mapped buffer memory during a call of the function
+    bool readsMappings(const char* name)
+    {
+        for (const char* prefix : { "Draw", "MultiDraw", "Dispatch", "Copy", "Flush", "Finish", "FenceSync", "Unmap" })
+        {
+            if (std::strncmp(name, prefix, std::strlen(prefix)) == 0) return true;
+        }
+        return false;
+    }
+
+    // Get the bytes of one pixel in client memory, 0 if the format or type is unknown
+    size_t pixelSize(GLenum format, GLenum type)
+    {
+        switch (type)
+        {
+        case gl::UNSIGNED_BYTE_3_3_2:
+        case gl::UNSIGNED_BYTE_2_3_3_REV:
+            return 1;
+        case gl::UNSIGNED_SHORT_5_6_5:
+        case gl::UNSIGNED_SHORT_5_6_5_REV:
+        case gl::UNSIGNED_SHORT_4_4_4_4:
+        case gl::UNSIGNED_SHORT_4_4_4_4_REV:
+        case gl::UNSIGNED_SHORT_5_5_5_1:
+        case gl::UNSIGNED_SHORT_1_5_5_5_REV:
+            return 2;
+        case gl::UNSIGNED_INT_8_8_8_8:
+        case gl::UNSIGNED_INT_8_8_8_8_REV:
+        case gl::UNSIGNED_INT_10_10_10_2:
+        case gl::UNSIGNED_INT_2_10_10_10_REV:
+        case gl::UNSIGNED_INT_24_8:
+        case gl::UNSIGNED_INT_10F_11F_11F_REV:
+        case gl::UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+        case gl::FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+        }
+
+        size_t components = 0;
+        switch (format)
+        {
+        case gl::RED: case gl::GREEN: case gl::BLUE: case gl::ALPHA:
+        case gl::RED_INTEGER: case gl::GREEN_INTEGER: case gl::BLUE_INTEGER:
+        case gl::DEPTH_COMPONENT: case gl::STENCIL_INDEX:
+            components = 1;
+            break;
+        case gl::RG: case gl::RG_INTEGER:
+            components = 2;
+            break;
+        case gl::RGB: case gl::BGR: case gl::RGB_INTEGER: case gl::BGR_INTEGER:
+            components = 3;
+            break;
+        case gl::RGBA: case gl::BGRA: case gl::RGBA_INTEGER: case gl::BGRA_INTEGER:
+            components = 4;
+            break;
+        }
+
+        switch (type)
+        {
+        case gl::UNSIGNED_BYTE: case gl::BYTE:
+            return components;
+        case gl::UNSIGNED_SHORT: case gl::SHORT: case gl::HALF_FLOAT:
+            return components * 2;
+        case gl::UNSIGNED_INT: case gl::INT: case gl::FLOAT:
+            return components * 4;
+        }
+        return 0;
+    }
+
+    // Values a texture or sampler parameter has
+    GLsizei parameterCount(GLenum pname)
+    {
+        return pname == gl::TEXTURE_BORDER_COLOR || pname == gl::TEXTURE_SWIZZLE_RGBA ? 4 : 1;
+    }
+
+    // Values a framebuffer clear takes, colors have four and depth or stencil one
+    GLsizei clearValueCount(GLenum buffer)
+    {
+        return buffer == gl::COLOR ? 4 : 1;
+    }
+}
+
+const GLTracePayload* GLTraceRecord::findPayload(unsigned argument) const
+{
+    for (const auto& payload : payloads)
+    {
+        if (payload.argument == argument) return &payload;
+    }
+    return nullptr;
+}
+
+GLTraceWriter::GLTraceWriter(const std::string& filepath)
+{
+    mFile = std::fopen(filepath.c_str(), "wb");
+    if (!mFile)
+    {
+        logErr("GLTrace: Failed to create {}", filepath);
+        return;
+    }
+
+    // Calls are small and many, write them in large chunks
+    std::setvbuf(mFile, nullptr, _IOFBF, 1 << 20);
+    bValid = true;
+
+    // The names of the functions, so traces survive the loader being regenerated
+    constexpr auto functionCount = static_cast<uint32_t>(EGLFunction::Count);
+    write(TraceMagic, sizeof(TraceMagic));
+    write(TraceVersion);
+    write(static_cast<uint32_t>(sizeof(void*)));
+    write(functionCount);
+
+    mReadsMappings.resize(functionCount);
+    for (uint32_t i = 0; i != functionCount; ++i)
+    {
+        const char* name = getGLFunctionName(static_cast<EGLFunction>(i));
+        const auto length = static_cast<uint8_t>(std::strlen(name));
+        write(length);
+        write(name, length);
+
+        mReadsMappings[i] = readsMappings(name);
+    }
+}
+
+GLTraceWriter::~GLTraceWriter()
+{
+    if (!mFile) return;
+
+    std::fclose(mFile);
+    logInfo("GLTrace: Wrote {} calls in {} frames, {:.1f} MB", mCallCount, mFrameCount, static_cast<double>(mByteSize) / (1024.0 * 1024.0));
+}
+
+const bool GLTraceWriter::isValid() const
+{
+    return bValid;
+}
+
+template<typename T>
+void GLTraceWriter::writeArray(unsigned argument, const T* values, GLsizei count, uint8_t flags)
+{
+    if (count > 0) writePayload(argument, values, static_cast<size_t>(count) * sizeof(T), flags);
+}
+
+void GLTraceWriter::writeCall()
+{
+    if (mReadsMappings[static_cast<size_t>(mFunction)]) writeMappings();
+
+    write(EGLTraceRecord::Call);
+    write(static_cast<uint16_t>(mFunction));
+    write(static_cast<uint16_t>(mArguments.size()));
+    write(mArguments.data(), mArguments.size());
+    ++mCallCount;
+
+#define TRACE_ARRAY(name, countArgument, arrayArgument, components)                                            \
+    case EGLFunction::name:                                                                                     \
+    {                                                                                                           \
+        const auto args = arguments<EGLFunction::name>();                                                       \
+        writeArray(arrayArgument, std::get<arrayArgument>(args), std::get<countArgument>(args) * (components)); \
+        break;                                                                                                  \
+    }
+
+    // Whatever the pointer arguments point at, pointers without a payload are offsets into bound buffers or outputs
+    switch (mFunction)
+    {
+    // Buffers
+    case EGLFunction::NamedBufferStorage:
+    {
+        const auto args = arguments<EGLFunction::NamedBufferStorage>();
+        writePayload(2, std::get<2>(args), static_cast<size_t>(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::NamedBufferData:
+    {
+        const auto args = arguments<EGLFunction::NamedBufferData>();
+        writePayload(2, std::get<2>(args), static_cast<size_t>(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::NamedBufferSubData:
+    {
+        const auto args = arguments<EGLFunction::NamedBufferSubData>();
+        writePayload(3, std::get<3>(args), static_cast<size_t>(std::get<2>(args)));
+        break;
+    }
+    case EGLFunction::BufferStorage:
+    {
+        const auto args = arguments<EGLFunction::BufferStorage>();
+        writePayload(2, std::get<2>(args), static_cast<size_t>(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::BufferData:
+    {
+        const auto args = arguments<EGLFunction::BufferData>();
+        writePayload(2, std::get<2>(args), static_cast<size_t>(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::BufferSubData:
+    {
+        const auto args = arguments<EGLFunction::BufferSubData>();
+        writePayload(3, std::get<3>(args), static_cast<size_t>(std::get<2>(args)));
+        break;
+    }
+    case EGLFunction::ClearNamedBufferData:
+    {
+        const auto args = arguments<EGLFunction::ClearNamedBufferData>();
+        writePayload(4, std::get<4>(args), pixelSize(std::get<2>(args), std::get<3>(args)));
+        break;
+    }
+    case EGLFunction::ClearNamedBufferSubData:
+    {
+        const auto args = arguments<EGLFunction::ClearNamedBufferSubData>();
+        writePayload(6, std::get<6>(args), pixelSize(std::get<4>(args), std::get<5>(args)));
+        break;
+    }
+    case EGLFunction::BindBuffer:
+    {
+        const auto args = arguments<EGLFunction::BindBuffer>();
+        if (std::get<0>(args) == gl::PIXEL_UNPACK_BUFFER) mUnpackBuffer = std::get<1>(args);
+        break;
+    }
+    case EGLFunction::MapBuffer:
+    case EGLFunction::MapBufferRange:
+    case EGLFunction::MapNamedBuffer:
+    {
+        static bool bWarned = false;
+        if (!bWarned) logWarn("GLTrace: Writes through {} are not traced, use MapNamedBufferRange", getGLFunctionName(mFunction));
+        bWarned = true;
+        break;
+    }
+
+    // Textures
+    case EGLFunction::PixelStorei:
+    {
+        const auto args = arguments<EGLFunction::PixelStorei>();
+        if (std::get<0>(args) == gl::UNPACK_ALIGNMENT) mUnpackAlignment = std::get<1>(args);
+        if (std::get<0>(args) == gl::UNPACK_ROW_LENGTH) mUnpackRowLength = std::get<1>(args);
+        break;
+    }
+    case EGLFunction::TextureSubImage1D:
+    {
+        const auto args = arguments<EGLFunction::TextureSubImage1D>();
+        writeImage(6, std::get<6>(args), std::get<3>(args), 1, 1, std::get<4>(args), std::get<5>(args));
+        break;
+    }
+    case EGLFunction::TextureSubImage2D:
+    {
+        const auto args = arguments<EGLFunction::TextureSubImage2D>();
+        writeImage(8, std::get<8>(args), std::get<4>(args), std::get<5>(args), 1, std::get<6>(args), std::get<7>(args));
+        break;
+    }
+    case EGLFunction::TextureSubImage3D:
+    {
+        const auto args = arguments<EGLFunction::TextureSubImage3D>();
+        writeImage(10, std::get<10>(args), std::get<5>(args), std::get<6>(args), std::get<7>(args), std::get<8>(args), std::get<9>(args));
+        break;
+    }
+    case EGLFunction::TexImage1D:
+    {
+        const auto args = arguments<EGLFunction::TexImage1D>();
+        writeImage(7, std::get<7>(args), std::get<3>(args), 1, 1, std::get<5>(args), std::get<6>(args));
+        break;
+    }
+    case EGLFunction::TexImage2D:
+    {
+        const auto args = arguments<EGLFunction::TexImage2D>();
+        writeImage(8, std::get<8>(args), std::get<3>(args), std::get<4>(args), 1, std::get<6>(args), std::get<7>(args));
+        break;
+    }
+    case EGLFunction::TexImage3D:
+    {
+        const auto args = arguments<EGLFunction::TexImage3D>();
+        writeImage(9, std::get<9>(args), std::get<3>(args), std::get<4>(args), std::get<5>(args), std::get<7>(args), std::get<8>(args));
+        break;
+    }
+    case EGLFunction::TexSubImage1D:
+    {
+        const auto args = arguments<EGLFunction::TexSubImage1D>();
+        writeImage(6, std::get<6>(args), std::get<3>(args), 1, 1, std::get<4>(args), std::get<5>(args));
+        break;
+    }
+    case EGLFunction::TexSubImage2D:
+    {
+        const auto args = arguments<EGLFunction::TexSubImage2D>();
+        writeImage(8, std::get<8>(args), std::get<4>(args), std::get<5>(args), 1, std::get<6>(args), std::get<7>(args));
+        break;
+    }
+    case EGLFunction::TexSubImage3D:
+    {
+        const auto args = arguments<EGLFunction::TexSubImage3D>();
+        writeImage(10, std::get<10>(args), std::get<5>(args), std::get<6>(args), std::get<7>(args), std::get<8>(args), std::get<9>(args));
+        break;
+    }
+    case EGLFunction::CompressedTextureSubImage2D:
+    {
+        const auto args = arguments<EGLFunction::CompressedTextureSubImage2D>();
+        if (!mUnpackBuffer) writePayload(8, std::get<8>(args), static_cast<size_t>(std::get<7>(args)));
+        break;
+    }
+    case EGLFunction::CompressedTextureSubImage3D:
+    {
+        const auto args = arguments<EGLFunction::CompressedTextureSubImage3D>();
+        if (!mUnpackBuffer) writePayload(10, std::get<10>(args), static_cast<size_t>(std::get<9>(args)));
+        break;
+    }
+    case EGLFunction::CompressedTexImage2D:
+    {
+        const auto args = arguments<EGLFunction::CompressedTexImage2D>();
+        if (!mUnpackBuffer) writePayload(7, std::get<7>(args), static_cast<size_t>(std::get<6>(args)));
+        break;
+    }
+    case EGLFunction::CompressedTexImage3D:
+    {
+        const auto args = arguments<EGLFunction::CompressedTexImage3D>();
+        if (!mUnpackBuffer) writePayload(8, std::get<8>(args), static_cast<size_t>(std::get<7>(args)));
+        break;
+    }
+    case EGLFunction::ClearTexImage:
+    {
+        const auto args = arguments<EGLFunction::ClearTexImage>();
+        writePayload(4, std::get<4>(args), pixelSize(std::get<2>(args), std::get<3>(args)));
+        break;
+    }
+    case EGLFunction::ClearTexSubImage:
+    {
+        const auto args = arguments<EGLFunction::ClearTexSubImage>();
+        writePayload(10, std::get<10>(args), pixelSize(std::get<8>(args), std::get<9>(args)));
+        break;
+    }
+    case EGLFunction::TextureParameterfv:
+    {
+        const auto args = arguments<EGLFunction::TextureParameterfv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TextureParameteriv:
+    {
+        const auto args = arguments<EGLFunction::TextureParameteriv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TextureParameterIiv:
+    {
+        const auto args = arguments<EGLFunction::TextureParameterIiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TextureParameterIuiv:
+    {
+        const auto args = arguments<EGLFunction::TextureParameterIuiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TexParameterfv:
+    {
+        const auto args = arguments<EGLFunction::TexParameterfv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TexParameteriv:
+    {
+        const auto args = arguments<EGLFunction::TexParameteriv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TexParameterIiv:
+    {
+        const auto args = arguments<EGLFunction::TexParameterIiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::TexParameterIuiv:
+    {
+        const auto args = arguments<EGLFunction::TexParameterIuiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::SamplerParameterfv:
+    {
+        const auto args = arguments<EGLFunction::SamplerParameterfv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::SamplerParameteriv:
+    {
+        const auto args = arguments<EGLFunction::SamplerParameteriv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::SamplerParameterIiv:
+    {
+        const auto args = arguments<EGLFunction::SamplerParameterIiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::SamplerParameterIuiv:
+    {
+        const auto args = arguments<EGLFunction::SamplerParameterIuiv>();
+        writeArray(2, std::get<2>(args), parameterCount(std::get<1>(args)));
+        break;
+    }
+
+    // Shaders and programs
+    case EGLFunction::ShaderSource:
+    {
+        const auto args = arguments<EGLFunction::ShaderSource>();
+        const GLsizei count = std::get<1>(args);
+        const GLchar* const* strings = std::get<2>(args);
+        const GLint* lengths = std::get<3>(args);
+        writeStrings(2, count, strings, lengths);
+
+        // Lengths are always written, strings that ended with a zero get theirs counted
+        std::vector<GLint> sourceLengths(static_cast<size_t>(std::max(count, 0)));
+        for (size_t i = 0; i != sourceLengths.size(); ++i)
+        {
+            sourceLengths[i] = lengths && lengths[i] >= 0 ? lengths[i] : static_cast<GLint>(std::strlen(strings[i]));
+        }
+        writeArray(3, sourceLengths.data(), count);
+        break;
+    }
+    case EGLFunction::CreateShaderProgramv:
+    {
+        const auto args = arguments<EGLFunction::CreateShaderProgramv>();
+        writeStrings(2, std::get<1>(args), std::get<2>(args), nullptr);
+        break;
+    }
+    case EGLFunction::TransformFeedbackVaryings:
+    {
+        const auto args = arguments<EGLFunction::TransformFeedbackVaryings>();
+        writeStrings(2, std::get<1>(args), std::get<2>(args), nullptr);
+        break;
+    }
+    case EGLFunction::BindAttribLocation:
+    {
+        const auto args = arguments<EGLFunction::BindAttribLocation>();
+        writeString(2, std::get<2>(args), -1);
+        break;
+    }
+    case EGLFunction::BindFragDataLocation:
+    {
+        const auto args = arguments<EGLFunction::BindFragDataLocation>();
+        writeString(2, std::get<2>(args), -1);
+        break;
+    }
+    case EGLFunction::BindFragDataLocationIndexed:
+    {
+        const auto args = arguments<EGLFunction::BindFragDataLocationIndexed>();
+        writeString(3, std::get<3>(args), -1);
+        break;
+    }
+    case EGLFunction::ProgramBinary:
+    {
+        const auto args = arguments<EGLFunction::ProgramBinary>();
+        writePayload(2, std::get<2>(args), static_cast<size_t>(std::get<3>(args)));
+        break;
+    }
+    case EGLFunction::ShaderBinary:
+    {
+        const auto args = arguments<EGLFunction::ShaderBinary>();
+        writeArray(1, std::get<1>(args), std::get<0>(args));
+        writePayload(3, std::get<3>(args), static_cast<size_t>(std::get<4>(args)));
+        break;
+    }
+    TRACE_ARRAY(UniformSubroutinesuiv, 1, 2, 1)
+
+    // Uniforms
+    TRACE_ARRAY(Uniform1fv, 1, 2, 1)
+    TRACE_ARRAY(Uniform2fv, 1, 2, 2)
+    TRACE_ARRAY(Uniform3fv, 1, 2, 3)
+    TRACE_ARRAY(Uniform4fv, 1, 2, 4)
+    TRACE_ARRAY(Uniform1iv, 1, 2, 1)
+    TRACE_ARRAY(Uniform2iv, 1, 2, 2)
+    TRACE_ARRAY(Uniform3iv, 1, 2, 3)
+    TRACE_ARRAY(Uniform4iv, 1, 2, 4)
+    TRACE_ARRAY(Uniform1uiv, 1, 2, 1)
+    TRACE_ARRAY(Uniform2uiv, 1, 2, 2)
+    TRACE_ARRAY(Uniform3uiv, 1, 2, 3)
+    TRACE_ARRAY(Uniform4uiv, 1, 2, 4)
+    TRACE_ARRAY(Uniform1dv, 1, 2, 1)
+    TRACE_ARRAY(Uniform2dv, 1, 2, 2)
+    TRACE_ARRAY(Uniform3dv, 1, 2, 3)
+    TRACE_ARRAY(Uniform4dv, 1, 2, 4)
+    TRACE_ARRAY(UniformMatrix2fv, 1, 3, 4)
+    TRACE_ARRAY(UniformMatrix3fv, 1, 3, 9)
+    TRACE_ARRAY(UniformMatrix4fv, 1, 3, 16)
+    TRACE_ARRAY(UniformMatrix2x3fv, 1, 3, 6)
+    TRACE_ARRAY(UniformMatrix3x2fv, 1, 3, 6)
+    TRACE_ARRAY(UniformMatrix2x4fv, 1, 3, 8)
+    TRACE_ARRAY(UniformMatrix4x2fv, 1, 3, 8)
+    TRACE_ARRAY(UniformMatrix3x4fv, 1, 3, 12)
+    TRACE_ARRAY(UniformMatrix4x3fv, 1, 3, 12)
+    TRACE_ARRAY(UniformMatrix2dv, 1, 3, 4)
+    TRACE_ARRAY(UniformMatrix3dv, 1, 3, 9)
+    TRACE_ARRAY(UniformMatrix4dv, 1, 3, 16)
+    TRACE_ARRAY(UniformMatrix2x3dv, 1, 3, 6)
+    TRACE_ARRAY(UniformMatrix3x2dv, 1, 3, 6)
+    TRACE_ARRAY(UniformMatrix2x4dv, 1, 3, 8)
+    TRACE_ARRAY(UniformMatrix4x2dv, 1, 3, 8)
+    TRACE_ARRAY(UniformMatrix3x4dv, 1, 3, 12)
+    TRACE_ARRAY(UniformMatrix4x3dv, 1, 3, 12)
+    TRACE_ARRAY(ProgramUniform1fv, 2, 3, 1)
+    TRACE_ARRAY(ProgramUniform2fv, 2, 3, 2)
+    TRACE_ARRAY(ProgramUniform3fv, 2, 3, 3)
+    TRACE_ARRAY(ProgramUniform4fv, 2, 3, 4)
+    TRACE_ARRAY(ProgramUniform1iv, 2, 3, 1)
+    TRACE_ARRAY(ProgramUniform2iv, 2, 3, 2)
+    TRACE_ARRAY(ProgramUniform3iv, 2, 3, 3)
+    TRACE_ARRAY(ProgramUniform4iv, 2, 3, 4)
+    TRACE_ARRAY(ProgramUniform1uiv, 2, 3, 1)
+    TRACE_ARRAY(ProgramUniform2uiv, 2, 3, 2)
+    TRACE_ARRAY(ProgramUniform3uiv, 2, 3, 3)
+    TRACE_ARRAY(ProgramUniform4uiv, 2, 3, 4)
+    TRACE_ARRAY(ProgramUniform1dv, 2, 3, 1)
+    TRACE_ARRAY(ProgramUniform2dv, 2, 3, 2)
+    TRACE_ARRAY(ProgramUniform3dv, 2, 3, 3)
+    TRACE_ARRAY(ProgramUniform4dv, 2, 3, 4)
+    TRACE_ARRAY(ProgramUniformMatrix2fv, 2, 4, 4)
+    TRACE_ARRAY(ProgramUniformMatrix3fv, 2, 4, 9)
+    TRACE_ARRAY(ProgramUniformMatrix4fv, 2, 4, 16)
+    TRACE_ARRAY(ProgramUniformMatrix2x3fv, 2, 4, 6)
+    TRACE_ARRAY(ProgramUniformMatrix3x2fv, 2, 4, 6)
+    TRACE_ARRAY(ProgramUniformMatrix2x4fv, 2, 4, 8)
+    TRACE_ARRAY(ProgramUniformMatrix4x2fv, 2, 4, 8)
+    TRACE_ARRAY(ProgramUniformMatrix3x4fv, 2, 4, 12)
+    TRACE_ARRAY(ProgramUniformMatrix4x3fv, 2, 4, 12)
+    TRACE_ARRAY(ProgramUniformMatrix2dv, 2, 4, 4)
+    TRACE_ARRAY(ProgramUniformMatrix3dv, 2, 4, 9)
+    TRACE_ARRAY(ProgramUniformMatrix4dv, 2, 4, 16)
+    TRACE_ARRAY(ProgramUniformMatrix2x3dv, 2, 4, 6)
+    TRACE_ARRAY(ProgramUniformMatrix3x2dv, 2, 4, 6)
+    TRACE_ARRAY(ProgramUniformMatrix2x4dv, 2, 4, 8)
+    TRACE_ARRAY(ProgramUniformMatrix4x2dv, 2, 4, 8)
+    TRACE_ARRAY(ProgramUniformMatrix3x4dv, 2, 4, 12)
+    TRACE_ARRAY(ProgramUniformMatrix4x3dv, 2, 4, 12)
+
+    // Names
+    TRACE_ARRAY(DeleteBuffers, 0, 1, 1)
+    TRACE_ARRAY(DeleteTextures, 0, 1, 1)
+    TRACE_ARRAY(DeleteVertexArrays, 0, 1, 1)
+    TRACE_ARRAY(DeleteFramebuffers, 0, 1, 1)
+    TRACE_ARRAY(DeleteRenderbuffers, 0, 1, 1)
+    TRACE_ARRAY(DeleteQueries, 0, 1, 1)
+    TRACE_ARRAY(DeleteSamplers, 0, 1, 1)
+    TRACE_ARRAY(DeleteProgramPipelines, 0, 1, 1)
+    TRACE_ARRAY(DeleteTransformFeedbacks, 0, 1, 1)
+    TRACE_ARRAY(BindTextures, 1, 2, 1)
+    TRACE_ARRAY(BindSamplers, 1, 2, 1)
+    TRACE_ARRAY(BindImageTextures, 1, 2, 1)
+    TRACE_ARRAY(BindBuffersBase, 2, 3, 1)
+    TRACE_ARRAY(BindBuffersRange, 2, 3, 1)
+    TRACE_ARRAY(BindVertexBuffers, 1, 2, 1)
+    TRACE_ARRAY(VertexArrayVertexBuffers, 2, 3, 1)
+    TRACE_ARRAY(DebugMessageControl, 3, 4, 1)
+
+    // Framebuffers and draws
+    TRACE_ARRAY(DrawBuffers, 0, 1, 1)
+    TRACE_ARRAY(NamedFramebufferDrawBuffers, 1, 2, 1)
+    TRACE_ARRAY(InvalidateFramebuffer, 1, 2, 1)
+    TRACE_ARRAY(InvalidateNamedFramebufferData, 1, 2, 1)
+    TRACE_ARRAY(MultiDrawArrays, 3, 1, 1)
+    case EGLFunction::ClearNamedFramebufferfv:
+    {
+        const auto args = arguments<EGLFunction::ClearNamedFramebufferfv>();
+        writeArray(3, std::get<3>(args), clearValueCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::ClearNamedFramebufferiv:
+    {
+        const auto args = arguments<EGLFunction::ClearNamedFramebufferiv>();
+        writeArray(3, std::get<3>(args), clearValueCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::ClearNamedFramebufferuiv:
+    {
+        const auto args = arguments<EGLFunction::ClearNamedFramebufferuiv>();
+        writeArray(3, std::get<3>(args), clearValueCount(std::get<1>(args)));
+        break;
+    }
+    case EGLFunction::ClearBufferfv:
+    {
+        const auto args = arguments<EGLFunction::ClearBufferfv>();
+        writeArray(2, std::get<2>(args), clearValueCount(std::get<0>(args)));
+        break;
+    }
+    case EGLFunction::ClearBufferiv:
+    {
+        const auto args = arguments<EGLFunction::ClearBufferiv>();
+        writeArray(2, std::get<2>(args), clearValueCount(std::get<0>(args)));
+        break;
+    }
+    case EGLFunction::ClearBufferuiv:
+    {
+        const auto args = arguments<EGLFunction::ClearBufferuiv>();
+        writeArray(2, std::get<2>(args), clearValueCount(std::get<0>(args)));
+        break;
+    }
+    case EGLFunction::PatchParameterfv:
+    {
+        const auto args = arguments<EGLFunction::PatchParameterfv>();
+        writeArray(1, std::get<1>(args), std::get<0>(args) == gl::PATCH_DEFAULT_OUTER_LEVEL ? 4 : 2);
+        break;
+    }
+
+    // Debug labels and messages
+    case EGLFunction::ObjectLabel:
+    {
+        const auto args = arguments<EGLFunction::ObjectLabel>();
+        writeString(3, std::get<3>(args), std::get<2>(args));
+        break;
+    }
+    case EGLFunction::PushDebugGroup:
+    {
+        const auto args = arguments<EGLFunction::PushDebugGroup>();
+        writeString(3, std::get<3>(args), std::get<2>(args));
+        break;
+    }
+    case EGLFunction::DebugMessageInsert:
+    {
+        const auto args = arguments<EGLFunction::DebugMessageInsert>();
+        writeString(5, std::get<5>(args), std::get<4>(args));
+        break;
+    }
+    default:
+        break;
+    }
+
+    // The other arrays of calls that take several
+    switch (mFunction)
+    {
+    case EGLFunction::BindBuffersRange:
+    {
+        const auto args = arguments<EGLFunction::BindBuffersRange>();
+        writeArray(4, std::get<4>(args), std::get<2>(args));
+        writeArray(5, std::get<5>(args), std::get<2>(args));
+        break;
+    }
+    case EGLFunction::BindVertexBuffers:
+    {
+        const auto args = arguments<EGLFunction::BindVertexBuffers>();
+        writeArray(3, std::get<3>(args), std::get<1>(args));
+        writeArray(4, std::get<4>(args), std::get<1>(args));
+        break;
+    }
+    case EGLFunction::VertexArrayVertexBuffers:
+    {
+        const auto args = arguments<EGLFunction::VertexArrayVertexBuffers>();
+        writeArray(4, std::get<4>(args), std::get<2>(args));
+        writeArray(5, std::get<5>(args), std::get<2>(args));
+        break;
+    }
+    case EGLFunction::MultiDrawArrays:
+    {
+        const auto args = arguments<EGLFunction::MultiDrawArrays>();
+        writeArray(2, std::get<2>(args), std::get<3>(args));
+        break;
+    }
+    default:
+        break;
+    }
+
+#undef TRACE_ARRAY
+}
+
+void GLTraceWriter::endCall(const void* result, unsigned size)
+{
+#define TRACE_NAMES(name, countArgument, namesArgument)                                                                          \
+    case EGLFunction::name:                                                                                                      \
+    {                                                                                                                            \
+        const auto args = arguments<EGLFunction::name>();                                                                        \
+        writeArray(namesArgument, std::get<namesArgument>(args), std::get<countArgument>(args), GLTracePayload::Output);         \
+        break;                                                                                                                   \
+    }
+
+    // Names handed out by the driver, a replay compares them with the ones its driver hands out
+    switch (mFunction)
+    {
+    TRACE_NAMES(GenBuffers, 0, 1)
+    TRACE_NAMES(GenTextures, 0, 1)
+    TRACE_NAMES(GenVertexArrays, 0, 1)
+    TRACE_NAMES(GenFramebuffers, 0, 1)
+    TRACE_NAMES(GenRenderbuffers, 0, 1)
+    TRACE_NAMES(GenQueries, 0, 1)
+    TRACE_NAMES(GenSamplers, 0, 1)
+    TRACE_NAMES(GenProgramPipelines, 0, 1)
+    TRACE_NAMES(GenTransformFeedbacks, 0, 1)
+    TRACE_NAMES(CreateBuffers, 0, 1)
+    TRACE_NAMES(CreateVertexArrays, 0, 1)
+    TRACE_NAMES(CreateFramebuffers, 0, 1)
+    TRACE_NAMES(CreateRenderbuffers, 0, 1)
+    TRACE_NAMES(CreateSamplers, 0, 1)
+    TRACE_NAMES(CreateProgramPipelines, 0, 1)
+    TRACE_NAMES(CreateTransformFeedbacks, 0, 1)
+    TRACE_NAMES(CreateTextures, 1, 2)
+    TRACE_NAMES(CreateQueries, 1, 2)
+    case EGLFunction::MapNamedBufferRange:
+    {
+        const auto args = arguments<EGLFunction::MapNamedBufferRange>();
+        const auto* pointer = static_cast<const unsigned char*>(*static_cast<void* const*>(result));
+        if (!pointer) break;
+
+        // Written in full before the first call that reads it, what a mapping holds at first is up to the driver
+        const GLuint buffer = std::get<0>(args);
+        mMappings.erase(std::remove_if(mMappings.begin(), mMappings.end(), [&](const Mapping& mapping) { return mapping.buffer == buffer; }),
+                        mMappings.end());
+        mMappings.push_back(Mapping{ buffer, std::get<1>(args), pointer, std::vector<unsigned char>(static_cast<size_t>(std::get<2>(args))), false });
+        break;
+    }
+    case EGLFunction::UnmapNamedBuffer:
+    {
+        const GLuint buffer = std::get<0>(arguments<EGLFunction::UnmapNamedBuffer>());
+        mMappings.erase(std::remove_if(mMappings.begin(), mMappings.end(), [&](const Mapping& mapping) { return mapping.buffer == buffer; }),
+                        mMappings.end());
+        break;
+    }
+    default:
+        break;
+    }
+
+#undef TRACE_NAMES
+
+    write(PayloadsEnd);
+    write(static_cast<uint8_t>(size));
+    if (size) write(result, size);
+}
+
+void GLTraceWriter::endFrame()
+{
+    write(EGLTraceRecord::FrameEnd);
+    ++mFrameCount;
+}
+
+const uint64_t GLTraceWriter::getCallCount() const
+{
+    return mCallCount;
+}
+
+const uint64_t GLTraceWriter::getFrameCount() const
+{
+    return mFrameCount;
+}
+
+const uint64_t GLTraceWriter::byteSize() const
+{
+    return mByteSize;
+}
+
+void GLTraceWriter::writeMappings()
+{
+    for (auto& mapping : mMappings)
+    {
+        const size_t size = mapping.written.size();
+        size_t block = 0;
+        while (block < size)
+        {
+            // Find the next run of changed blocks
+            const auto changed = [&](size_t start)
+            {
+                const size_t length = std::min(MappingBlockSize, size - start);
+                return !mapping.bWrittenOnce || std::memcmp(mapping.pointer + start, mapping.written.data() + start, length) != 0;
+            };
+
+            if (!changed(block))
+            {
+                block += MappingBlockSize;
+                continue;
+            }
+
+            size_t end = block + MappingBlockSize;
+            while (end < size && changed(end))
+            {
+                end += MappingBlockSize;
+            }
+            end = std::min(end, size);
+
+            std::memcpy(mapping.written.data() + block, mapping.pointer + block, end - block);
+            write(EGLTraceRecord::MappedWrite);
+            write(mapping.buffer);
+            write(static_cast<uint64_t>(mapping.offset) + block);
+            write(static_cast<uint32_t>(end - block));
+            write(mapping.written.data() + block, end - block);
+            block = end;
+        }
+        mapping.bWrittenOnce = true;
+    }
+}
+
+void GLTraceWriter::writePayload(unsigned argument, const void* data, size_t size, uint8_t flags)
+{
+    if (!data || size == 0) return;
+    if (size > UINT32_MAX)
+    {
+        logErr("GLTrace: Payload of {} too large, the trace will not replay", getGLFunctionName(mFunction));
+        return;
+    }
+
+    write(static_cast<uint8_t>(argument));
+    write(flags);
+    write(static_cast<uint32_t>(size));
+    align();
+    write(data, size);
+}
+
+void GLTraceWriter::writeString(unsigned argument, const GLchar* string, GLsizei length)
+{
+    if (!string) return;
+
+    // Strings without a length end with a zero, which is written too
+    writePayload(argument, string, length >= 0 ? static_cast<size_t>(length) : std::strlen(string) + 1);
+}
+
+void GLTraceWriter::writeStrings(unsigned argument, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+    if (!strings || count <= 0) return;
+
+    std::vector<unsigned char> joined;
+    for (GLsizei i = 0; i != count; ++i)
+    {
+        const size_t length = lengths && lengths[i] >= 0 ? static_cast<size_t>(lengths[i]) : std::strlen(strings[i]);
+        joined.insert(joined.end(), strings[i], strings[i] + length);
+        joined.push_back(0);
+    }
+    writePayload(argument, joined.data(), joined.size(), GLTracePayload::Strings);
+}
+
+void GLTraceWriter::writeImage(unsigned argument, const void* pixels, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type)
+{
+    // With an unpack buffer bound the pointer is an offset into it
+    if (!pixels || mUnpackBuffer || width <= 0 || height <= 0 || depth <= 0) return;
+
+    const size_t pixel = pixelSize(format, type);
+    if (pixel == 0)
+    {
+        logWarn("GLTrace: Unknown pixel format {:#x} or type {:#x} in {}, the image is not traced", format, type, getGLFunctionName(mFunction));
+        return;
+    }
+
+    // Rows are padded to the unpack alignment, the last one is only read up to its last pixel
+    const auto alignment = static_cast<size_t>(std::max(mUnpackAlignment, 1));
+    const size_t rowPixels = mUnpackRowLength > 0 ? static_cast<size_t>(mUnpackRowLength) : static_cast<size_t>(width);
+    const size_t rowSize = (rowPixels * pixel + alignment - 1) / alignment * alignment;
+    const size_t rows = static_cast<size_t>(height) * static_cast<size_t>(depth);
+    writePayload(argument, pixels, rowSize * (rows - 1) + static_cast<size_t>(width) * pixel);
+}
+
+void GLTraceWriter::write(const void* data, size_t size)
+{
+    if (!bValid) return;
+
+    if (std::fwrite(data, 1, size, mFile) != size)
+    {
+        logErr("GLTrace: Failed to write the trace, the rest of it is lost");
+        bValid = false;
+        return;
+    }
+    mByteSize += size;
+}
+
+void GLTraceWriter::align()
+{
+    static constexpr unsigned char padding[PayloadAlignment] = {};
+    const size_t remainder = mByteSize % PayloadAlignment;
+    if (remainder) write(padding, PayloadAlignment - remainder);
+}
+
+GLTraceReader::GLTraceReader(const std::string& filepath) : mFile(filepath)
+{
+    if (mFile.empty())
+    {
+        logErr("GLTrace: Failed to read {}", filepath);
+        return;
+    }
+
+    char magic[4];
+    uint32_t version = 0, pointerSize = 0, functionCount = 0;
+    bValid = true;
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, TraceMagic, sizeof(magic)) != 0 ||
+        !read(&version, sizeof(version)) || !read(&pointerSize, sizeof(pointerSize)) || !read(&functionCount, sizeof(functionCount)))
+    {
+        logErr("GLTrace: {} is not a trace", filepath);
+        bValid = false;
+        return;
+    }
+
+    if (version != TraceVersion || pointerSize != sizeof(void*))
+    {
+        logErr("GLTrace: {} is version {} with {} byte pointers, can only read version {} with {} byte pointers",
+               filepath, version, pointerSize, TraceVersion, sizeof(void*));
+        bValid = false;
+        return;
+    }
+
+    std::unordered_map<std::string, EGLFunction> functions;
+    for (size_t i = 0; i != static_cast<size_t>(EGLFunction::Count); ++i)
+    {
+        functions.emplace(getGLFunctionName(static_cast<EGLFunction>(i)), static_cast<EGLFunction>(i));
+    }
+
+    // Functions this build does not have are read as Count
+    mFunctions.reserve(functionCount);
+    for (uint32_t i = 0; i != functionCount && bValid; ++i)
+    {
+        uint8_t length = 0;
+        read(&length, sizeof(length));
+        const auto* name = skip(length);
+        if (!name) break;
+
+        const auto it = functions.find(std::string(reinterpret_cast<const char*>(name), length));
+        mFunctions.push_back(it != functions.end() ? it->second : EGLFunction::Count);
+    }
+}
+
+const bool GLTraceReader::isValid() const
+{
+    return bValid;
+}
+
+bool GLTraceReader::next(GLTraceRecord& record)
+{
+    if (!bValid || mOffset == mFile.size()) return false;
+
+    read(&record.type, sizeof(record.type));
+    switch (record.type)
+    {
+    case EGLTraceRecord::Call:
+    {
+        uint16_t function = 0, argumentSize = 0;
+        read(&function, sizeof(function));
+        read(&argumentSize, sizeof(argumentSize));
+        record.function = function < mFunctions.size() ? mFunctions[function] : EGLFunction::Count;
+        record.argumentSize = argumentSize;
+        record.arguments = skip(argumentSize);
+
+        record.payloads.clear();
+        uint8_t argument = 0;
+        while (read(&argument, sizeof(argument)) && argument != PayloadsEnd)
+        {
+            GLTracePayload payload{ argument, 0, nullptr, 0 };
+            read(&payload.flags, sizeof(payload.flags));
+            read(&payload.size, sizeof(payload.size));
+            align();
+            payload.data = skip(payload.size);
+            record.payloads.push_back(payload);
+        }
+
+        uint8_t resultSize = 0;
+        read(&resultSize, sizeof(resultSize));
+        record.resultSize = resultSize;
+        record.result = skip(resultSize);
+        break;
+    }
+    case EGLTraceRecord::MappedWrite:
+        read(&record.buffer, sizeof(record.buffer));
+        read(&record.offset, sizeof(record.offset));
+        read(&record.size, sizeof(record.size));
+        record.data = skip(record.size);
+        break;
+    case EGLTraceRecord::FrameEnd:
+        break;
+    default:
+        logErr("GLTrace: Unknown record at byte {}, the trace is damaged", mOffset - 1);
+        bValid = false;
+        break;
+    }
+
+    return bValid;
+}
+
+bool GLTraceReader::read(void* data, size_t size)
+{
+    const auto* source = skip(size);
+    if (source) std::memcpy(data, source, size);
+    return source != nullptr;
+}
+
+const unsigned char* GLTraceReader::skip(size_t size)
+{
+    if (!bValid) return nullptr;
+    if (size > mFile.size() - mOffset)
+    {
+        logErr("GLTrace: The trace ends in the middle of a record");
+        bValid = false;
+        return nullptr;
+    }
+
+    const auto* data = reinterpret_cast<const unsigned char*>(mFile.data()) + mOffset;
+    mOffset += size;
+    return data;
+}
+
+void GLTraceReader::align()
+{
+    mOffset = std::min((mOffset + PayloadAlignment - 1) / PayloadAlignment * PayloadAlignment, mFile.size());
+}
@@ -10,13 +10,33 @@
 #include "interpolation.h"
 #include "randomEngine.h"
 #include "files.h"
+#include "json.h"
 #include "clock.h"
 #include "shapes.h"
+#include "shapeInstances.h"
 #include "renderBatch.h"
 #include "glfwCallbacks.h"
 #include "camera.h"
+#include "bvh.h"
+#include "meshPool.h"
+#include "vertexArrayCache.h"
+#include "profiler.h"
+#include "profilerPanel.h"
+#include "gpuProfiler.h"
+#include "statsOverlay.h"
+#include "headlessContext.h"
+#include "framebuffer.h"
+#include "gpuCuller.h"
+#include "hiZPyramid.h"
+#include "glBackend.h"
+#include "glTrace.h"
 
 #include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
 
 #include "gl_cpp.hpp"
 #include "imgui.h"
@@ -26,9 +46,51 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "GLFW/glfw3.h"
 
+namespace
+{
+    // The state the application draws with, re-applied after ImGui instead of ImGui querying and restoring it
+    struct AppRenderState
+    {
+        const Shader* shader;
+        const Texture* texture;
+    };
+
+    void restoreAppRenderState(void* userData)
+    {
+        const auto* state = static_cast<const AppRenderState*>(userData);
+
+        // ImGui bound its own vertex array behind the back of VertexArray
+        VertexArray::invalidateBinding();
+
+        gl::Disable(gl::BLEND);
+        gl::Disable(gl::SCISSOR_TEST);
+        gl::Enable(gl::DEPTH_TEST);
+        gl::Enable(gl::PRIMITIVE_RESTART_FIXED_INDEX);
+        state->shader->bind();
+        state->texture->bind();
+    }
 
-GLFWApplication::GLFWApplication()
+    // Frames the CPU may run ahead of the GPU in a headless run, which has no swap to hold it back
+    constexpr unsigned HeadlessFramesInFlight = 2;
+
+    // Squares along each side of the GPU culled field and the distance between them
+    constexpr int FieldSize = 32;
+    constexpr float FieldSpacing = 60.f;
+}
+
+GLFWApplication::GLFWApplication(const std::string& tracePath)
 {
+    Profiler::setThreadName("Main");
+
+    // Start reading what startup loads, openFile picks the files up when they are needed
+    mAsyncIO.prefetch(getResourcePath("ProggyTiny.ttf"), EIOPriority::High);
+    mAsyncIO.prefetch(getResourcePath("vertex.vert"), EIOPriority::High);
+    mAsyncIO.prefetch(getResourcePath("frag.frag"), EIOPriority::High);
+    mAsyncIO.prefetch(getResourcePath("instanced.vert"));
+    mAsyncIO.prefetch(getResourcePath("culled.vert"));
+    mAsyncIO.prefetch(getResourcePath("cull.comp"));
+    mAsyncIO.prefetch(getResourcePath("concrete.png"));
+
     ServiceLocator<InputManager>::provide(&mInputManager);
     glfwInit();
 
@@ -45,6 +107,7 @@ GLFWApplication::GLFWApplication()
     mWindow = glfwCreateWindow(1280, 720, "Open GL Rendering", nullptr, nullptr);
     glfwMakeContextCurrent(mWindow);
     glfwSwapInterval(1);
+    startTrace(tracePath);
 
     // GLFW Callbacks
 #ifndef NDEBUG
@@ -55,10 +118,7 @@ GLFWApplication::GLFWApplication()
     glfwSetCursorPosCallback(mWindow, cursor_position_callback);
     glfwSetScrollCallback(mWindow, scroll_callback);
 
-    // GL Setup
-    gl::Enable(gl::DEPTH_TEST);
-    gl::DepthFunc(gl::LEQUAL);
-    gl::PointSize(2.f);
+    setupGL();
 
     // ImGui Setup
     mImGuiContext = ImGui::CreateContext();
@@ -66,22 +126,99 @@ GLFWApplication::GLFWApplication()
     ImGui_ImplGlfwGL3_Init(mWindow);
     ImGui::StyleColorsDark();
 
-    auto fontPath = getResourcePath("ProggyTiny.ttf");
-    io.Fonts->AddFontFromFileTTF(fontPath.c_str(), 10.f);
+    // Read the font through the resource packs, the atlas takes ownership of the copy
+    const auto fontPath = getResourcePath("ProggyTiny.ttf");
+    const FileView font = openFile(fontPath);
+    if (!font.empty())
+    {
+        void* fontData = ImGui::MemAlloc(font.size());
+        std::memcpy(fontData, font.data(), font.size());
+        io.Fonts->AddFontFromMemoryTTF(fontData, static_cast<int>(font.size()), 10.f);
+    }
+    else
+    {
+        logWarn("Failed to load font: {}", fontPath);
+    }
+}
 
-    gl::ClearColor(.2f, 0.3f, 0.3f, 1.0f);
+GLFWApplication::GLFWApplication(const HeadlessSettings& settings, const std::string& tracePath) : mHeadlessSettings(settings)
+{
+    Profiler::setThreadName("Main");
+
+    mAsyncIO.prefetch(getResourcePath("vertex.vert"), EIOPriority::High);
+    mAsyncIO.prefetch(getResourcePath("frag.frag"), EIOPriority::High);
+    mAsyncIO.prefetch(getResourcePath("instanced.vert"));
+    mAsyncIO.prefetch(getResourcePath("culled.vert"));
+    mAsyncIO.prefetch(getResourcePath("cull.comp"));
+    mAsyncIO.prefetch(getResourcePath("concrete.png"));
+
+    ServiceLocator<InputManager>::provide(&mInputManager);
+
+    mHeadless = std::make_unique<HeadlessContext>();
+    if (!mHeadless->isValid()) return;
+
+    startTrace(tracePath);
+    setupGL();
+    gl::Viewport(0, 0, settings.width, settings.height);
 }
 
 GLFWApplication::~GLFWApplication()
 {
+    // Objects destroyed from here on are not traced, the trace ends with the last frame
+    if (mTrace)
+    {
+        GLBackend::useDriver();
+        mTrace.reset();
+    }
+
+    ServiceLocator<InputManager>::provide(nullptr);
+    if (mHeadless) return;
+
     ImGui_ImplGlfwGL3_Shutdown();
     ImGui::DestroyContext(mImGuiContext);
     glfwDestroyWindow(mWindow);
     glfwTerminate();
 }
 
+const bool GLFWApplication::isValid() const
+{
+    return mHeadless ? mHeadless->isValid() : mWindow != nullptr;
+}
+
+void GLFWApplication::setupGL()
+{
+    gl::Enable(gl::DEPTH_TEST);
+    gl::DepthFunc(gl::LEQUAL);
+    gl::PointSize(2.f);
+    gl::ClearColor(.2f, 0.3f, 0.3f, 1.0f);
+
+    // Strips are split at RestartIndex, stored as the largest value of each index type
+    gl::Enable(gl::PRIMITIVE_RESTART_FIXED_INDEX);
+}
+
+void GLFWApplication::startTrace(const std::string& tracePath)
+{
+    if (tracePath.empty()) return;
+
+    mTrace = std::make_unique<GLTraceWriter>(tracePath);
+    if (!mTrace->isValid())
+    {
+        mTrace.reset();
+        return;
+    }
+
+    GLBackend::useTracing(*mTrace);
+    logInfo("Tracing GL calls to {}", tracePath);
+}
+
 void GLFWApplication::run()
 {
+    if (!isValid())
+    {
+        logErr("GLFWApplication: No OpenGL context, not running");
+        return;
+    }
+
     Clock deltaClock;
     auto updateDelta = Clock::TimeUnit{ 1.f / 144.f };
     auto timeSinceUpdate = Clock::TimeUnit{};
@@ -89,26 +226,103 @@ void GLFWApplication::run()
     Shader basicShader(getResourcePath("vertex.vert"), getResourcePath("frag.frag"));
     basicShader.bind();
 
+    // Shapes share pooled buffers and vertex arrays
+    VertexArrayCache vertexArrayCache;
+    MeshPool meshPool(vertexArrayCache, EVertexFormat::Standard);
+    ServiceLocator<MeshPool>::provide(&meshPool);
+
     Quad square({ 50.f, 50.f }, { 0.88f, 0.4f, 0.1f });
 
+    // A ring of markers around the square, all sharing one circle mesh and drawn in one instanced draw
+    Shader instancedShader(getResourcePath("instanced.vert"), getResourcePath("frag.frag"));
+    Circle marker(1.f, 24, { 1.f, 1.f, 1.f });
+    ShapeInstances markers(marker, 32);
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        const float angle = glm::radians(360.f / 32.f * i);
+        const glm::vec3 offset(std::cos(angle) * 40.f, 0.f, std::sin(angle) * 40.f);
+        markers.add(glm::translate(glm::mat4(1.f), offset) * glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f)));
+    }
+
+    // A field of squares below the scene, culled on the GPU and drawn with one indirect draw. G toggles it
+    Shader culledShader(getResourcePath("culled.vert"), getResourcePath("frag.frag"));
+    GpuCuller fieldCuller(FieldSize * FieldSize);
+    {
+        const auto& bounds = square.getBoundingSphere();
+        std::vector<GpuInstance> field;
+        field.reserve(FieldSize * FieldSize);
+        for (int z = 0; z < FieldSize; ++z)
+        {
+            for (int x = 0; x < FieldSize; ++x)
+            {
+                const glm::vec3 position((x - FieldSize / 2) * FieldSpacing, -10.f, (z - FieldSize / 2) * FieldSpacing);
+                const glm::mat4 transform = glm::translate(glm::mat4(1.f), position) * glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f));
+                field.push_back({ transform, glm::vec4(bounds.center, bounds.radius) });
+            }
+        }
+        fieldCuller.setInstances(field);
+
+        const auto& mesh = square.getMesh();
+        fieldCuller.setMesh(mesh.indexCount, mesh.firstIndex, mesh.baseVertex);
+    }
+    bool bGpuCulling = true;
+
     Camera camera(glm::vec3(0.f, 50.f, 10.f));
 
     Texture example(getResourcePath("concrete.png"));
     example.bind();
 
+    // The viewport, polygon mode and face culling ImGui sets match the application's, so they need no restore
+    AppRenderState renderState{ &basicShader, &example };
+    if (!mHeadless) ImGui_ImplGlfwGL3_SetRestoreStateCallback(restoreAppRenderState, &renderState);
+
     glm::mat4 model = glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f));
     glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 512.f);
 
-    while (!glfwWindowShouldClose(mWindow))
+    // Scene hierarchy used for culling and picking. Object ids are indices into the bounds
+    BVH sceneHierarchy;
+    sceneHierarchy.build({ transformAABB(square.getAABB(), model) });
+    std::vector<unsigned> visibleObjects;
+
+    ProfilerPanel profilerPanel;
+    StatsOverlay statsOverlay;
+    GpuProfiler gpuProfiler;
+    ServiceLocator<GpuProfiler>::provide(&gpuProfiler);
+
+    // Headless frames go to an offscreen framebuffer, paced by fences instead of the swap
+    std::unique_ptr<Framebuffer> offscreen;
+    std::array<GLsync, HeadlessFramesInFlight> frameFences{};
+    std::vector<float> frameTimes;
+    if (mHeadless)
+    {
+        offscreen = std::make_unique<Framebuffer>(glm::ivec2(mHeadlessSettings.width, mHeadlessSettings.height));
+        frameTimes.reserve(mHeadlessSettings.frameCount);
+    }
+
+    // The depth of offscreen frames also culls the field squares hidden behind the scene in the next frame
+    std::unique_ptr<HiZPyramid> hiZ;
+    bool bHiZBuilt = false;
+    if (offscreen) hiZ = std::make_unique<HiZPyramid>(offscreen->getSize());
+    Clock runClock;
+
+    while (mHeadless ? frameTimes.size() < mHeadlessSettings.frameCount : !glfwWindowShouldClose(mWindow))
     {
+        Profiler::beginFrame();
+
         // Clock Update
         const auto deltaTime = deltaClock.restart().count();
         timeSinceUpdate += Clock::TimeUnit{ deltaTime };
 
         // Event Processing
-        mInputManager.clear();
-        glfwPollEvents();
-        ImGui_ImplGlfwGL3_NewFrame();
+        {
+            PROFILE_SCOPE("Events");
+            mInputManager.clear();
+            if (!mHeadless)
+            {
+                glfwPollEvents();
+                ImGui_ImplGlfwGL3_NewFrame();
+            }
+        }
 
         // Input Handling
         if (mInputManager.wasPressed(GLFW_KEY_ESCAPE))
@@ -121,6 +335,31 @@ void GLFWApplication::run()
             camera.move(glm::vec3(0.f, -1.f, 0.f));
         if (mInputManager.arePressed(GLFW_KEY_D))
             camera.move(glm::vec3(1.f, 0.f, 0.f));
+        if (mInputManager.wasPressed(GLFW_KEY_G))
+        {
+            bGpuCulling = !bGpuCulling;
+            bHiZBuilt = false;
+            logInfo("GPU culled field {}", bGpuCulling ? "enabled" : "disabled");
+        }
+        if (mInputManager.wasPressed(GLFW_MOUSE_BUTTON_LEFT))
+        {
+            // The cursor is in window coordinates, which differ from framebuffer pixels on high DPI screens
+            glm::ivec2 viewportSize(mHeadlessSettings.width, mHeadlessSettings.height);
+            glm::dvec2 cursor = mInputManager.getCursorPosition();
+            if (!mHeadless)
+            {
+                glm::ivec2 windowSize;
+                glfwGetFramebufferSize(mWindow, &viewportSize.x, &viewportSize.y);
+                glfwGetWindowSize(mWindow, &windowSize.x, &windowSize.y);
+                if (windowSize.x > 0 && windowSize.y > 0) cursor *= glm::dvec2(viewportSize) / glm::dvec2(windowSize);
+            }
+
+            const Ray ray = camera.getPickingRay(cursor, viewportSize, proj);
+            unsigned hitObject;
+            float hitDistance;
+            if (sceneHierarchy.raycast(ray, hitObject, hitDistance))
+                logInfo("Picked object {} at distance {}", hitObject, hitDistance);
+        }
 //         if (mInputManager.arePressed(GLFW_KEY_UP))
 //             view = glm::rotate(view, 0.05f, glm::vec3{ 1.f, 0.f, 0.f });
 //         if (mInputManager.arePressed(GLFW_KEY_DOWN))
@@ -133,16 +372,145 @@ void GLFWApplication::run()
         }
 
         // Application Drawing
-        gl::Clear(gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT);
+        const glm::mat4 viewProjection = proj * camera.getViewMatrix();
+        {
+            PROFILE_SCOPE("Draw");
+            if (offscreen) offscreen->bind();
+            gl::Clear(gl::COLOR_BUFFER_BIT | gl::DEPTH_BUFFER_BIT);
 
-        glm::mat4 mvpMatrix = proj * camera.getViewMatrix() * model;
-        basicShader.setUniformMat4("mvpMatrix", mvpMatrix);
-        mRenderer.draw(square);
+            // Only submit the square if it is inside the view frustum
+            {
+                PROFILE_SCOPE("Culling");
+                visibleObjects.clear();
+                sceneHierarchy.queryFrustum(camera.getFrustum(proj), visibleObjects);
+            }
+            if (!visibleObjects.empty())
+            {
+                glm::mat4 mvpMatrix = proj * camera.getViewMatrix() * model;
+                basicShader.setUniformMat4("mvpMatrix", mvpMatrix);
+                mRenderer.draw(square);
+            }
+
+            markers.commit();
+            instancedShader.bind();
+            instancedShader.setUniformMat4("viewProjection", viewProjection);
+            mRenderer.draw(markers);
+
+            // The culler writes the instance count of the draw, the CPU never learns how many squares are visible
+            if (bGpuCulling)
+            {
+                fieldCuller.cull(camera.getFrustum(proj), bHiZBuilt ? hiZ.get() : nullptr);
+                culledShader.bind();
+                culledShader.setUniformMat4("viewProjection", viewProjection);
+                fieldCuller.bindVisibleTransforms();
+                mRenderer.drawIndirect(square, fieldCuller.getCommands());
+            }
+            basicShader.bind();
+        }
 
         // ImGui Drawing
-        ImGui::Render();
-        ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
+        if (!mHeadless)
+        {
+            PROFILE_SCOPE("ImGui");
+            profilerPanel.draw();
+            statsOverlay.draw(mRenderer.getStats());
+            ImGui::Render();
 
-        glfwSwapBuffers(mWindow);
+            GPU_PROFILE_SCOPE("ImGui");
+            ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+
+        if (!mHeadless)
+        {
+            PROFILE_SCOPE("Swap");
+            glfwSwapBuffers(mWindow);
+        }
+        else
+        {
+            PROFILE_SCOPE("Fence");
+            offscreen->unbind();
+
+            if (bGpuCulling)
+            {
+                // The reduction samples the depth through texture unit 0, which the scene draws with
+                hiZ->build(*offscreen, viewProjection);
+                example.bind();
+                bHiZBuilt = true;
+            }
+
+            // Wait for the frame that used this slot before queueing another one
+            GLsync& fence = frameFences[frameTimes.size() % HeadlessFramesInFlight];
+            if (fence)
+            {
+                gl::ClientWaitSync(fence, gl::SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+                gl::DeleteSync(fence);
+            }
+            fence = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+            frameTimes.push_back(deltaClock.timeSinceStart().count() * 1000.f);
+        }
+
+        gpuProfiler.endFrame();
+        Profiler::endFrame();
+        mRenderer.endFrame(deltaClock.timeSinceStart().count() * 1000.f);
+        if (mTrace) mTrace->endFrame();
     }
+
+    if (mHeadless)
+    {
+        // Count the frames still in flight towards the total
+        gl::Finish();
+        for (GLsync fence : frameFences)
+        {
+            if (fence) gl::DeleteSync(fence);
+        }
+        writeHeadlessResults(frameTimes, runClock.timeSinceStart().count());
+    }
+
+    if (!mHeadless) ImGui_ImplGlfwGL3_SetRestoreStateCallback(nullptr, nullptr);
+    ServiceLocator<GpuProfiler>::provide(nullptr);
+    ServiceLocator<MeshPool>::provide(nullptr);
+}
+
+void GLFWApplication::writeHeadlessResults(const std::vector<float>& frameTimes, float totalSeconds) const
+{
+    if (frameTimes.empty()) return;
+
+    std::vector<float> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float fraction)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    const float average = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.f) / frameTimes.size();
+    const auto* renderer = reinterpret_cast<const char*>(gl::GetString(gl::RENDERER));
+    logInfo("Headless: {} frames in {:.2f} s, {:.3f} ms average, {:.1f} FPS", frameTimes.size(), totalSeconds, average,
+            frameTimes.size() / totalSeconds);
+
+    std::FILE* file = std::fopen(mHeadlessSettings.resultsPath.c_str(), "w");
+    if (!file)
+    {
+        logErr("Headless: Failed to write results to {}", mHeadlessSettings.resultsPath);
+        return;
+    }
+
+    const auto counters = mRenderer.getStats().getAverageCounters();
+    std::fputs("{\n  \"renderer\": ", file);
+    writeJsonString(file, renderer ? renderer : "unknown");
+    std::fprintf(file, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %zu,\n",
+                 mHeadlessSettings.width, mHeadlessSettings.height, frameTimes.size());
+    std::fprintf(file, "  \"totalSeconds\": %.6f,\n  \"fps\": %.3f,\n", totalSeconds, frameTimes.size() / totalSeconds);
+    std::fprintf(file, "  \"averageMs\": %.6f,\n  \"minMs\": %.6f,\n  \"p50Ms\": %.6f,\n  \"p95Ms\": %.6f,\n  \"p99Ms\": %.6f,\n  \"maxMs\": %.6f,\n",
+                 average, sorted.front(), percentile(0.5f), percentile(0.95f), percentile(0.99f), sorted.back());
+    std::fprintf(file, "  \"drawCalls\": %u,\n  \"triangles\": %llu,\n  \"frameTimesMs\": [",
+                 counters.drawCalls, static_cast<unsigned long long>(counters.triangles));
+    for (size_t i = 0; i != frameTimes.size(); ++i)
+    {
+        std::fprintf(file, "%s%.4f", i == 0 ? "" : ", ", frameTimes[i]);
+    }
+    std::fputs("]\n}\n", file);
+    std::fclose(file);
+
+    logInfo("Headless: Results written to {}", mHeadlessSettings.resultsPath);
 }
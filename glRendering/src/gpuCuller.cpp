@@ -0,0 +1,108 @@
+#include "gpuCuller.h"
+#include "frustum.h"
+#include "hiZPyramid.h"
+#include "uniformBlocks.h"
+#include "files.h"
+#include "gpuProfiler.h"
+#include "logging.h"
+
+#include <cstddef>
+#include <algorithm>
+
+namespace
+{
+    // Must match local_size_x in cull.comp
+    constexpr unsigned GroupSize = 64;
+
+    // Binding points used by cull.comp
+    constexpr unsigned InstanceBinding = 0;
+    constexpr unsigned VisibleBinding = 1;
+    constexpr unsigned CullingDataBinding = 3;
+    constexpr unsigned HiZBinding = 3;
+}
+
+GpuCuller::GpuCuller(unsigned maxInstances) :
+    mCullShader(getResourcePath("cull.comp"), EShaderType::Compute),
+    mInstances(sizeof(GpuInstance) * maxInstances),
+    mVisibleTransforms(sizeof(glm::mat4) * maxInstances),
+    mCullingData(sizeof(UCullingData)),
+    mVisibleCounter(1),
+    mCommands(1),
+    mMaxInstances(maxInstances)
+{
+    mCommands.setCommand(0, mCommand);
+}
+
+void GpuCuller::setInstances(const std::vector<GpuInstance>& instances)
+{
+    if (instances.size() > mMaxInstances)
+    {
+        logWarn("GpuCuller: {} instances exceeds the capacity of {}, extra instances are ignored", instances.size(), mMaxInstances);
+    }
+
+    mInstanceCount = static_cast<unsigned>(std::min<size_t>(instances.size(), mMaxInstances));
+    mInstances.setData(instances.data(), sizeof(GpuInstance) * mInstanceCount);
+}
+
+void GpuCuller::setMesh(unsigned indexCount, unsigned firstIndex, int baseVertex)
+{
+    mCommand.count = indexCount;
+    mCommand.firstIndex = firstIndex;
+    mCommand.baseVertex = baseVertex;
+    mCommands.setCommand(0, mCommand);
+}
+
+void GpuCuller::cull(const Frustum& frustum, const HiZPyramid* hiZ)
+{
+    GPU_PROFILE_SCOPE("GPU Culling");
+    UCullingData data{};
+    for (int i = 0; i < Frustum::PlaneCount; ++i)
+    {
+        data.frustumPlanes[i] = frustum.getPlane(static_cast<Frustum::EPlane>(i));
+    }
+    data.instanceCount = mInstanceCount;
+
+    if (hiZ)
+    {
+        data.hiZViewProjection = hiZ->getViewProjection();
+        data.hiZSize = glm::vec2(hiZ->getSize());
+        data.useHiZ = 1u;
+        hiZ->bind(HiZBinding);
+    }
+
+    mCullingData.setBlockData(&data, sizeof(UCullingData));
+    mVisibleCounter.reset();
+
+    mCullShader.bind();
+    mInstances.bind(InstanceBinding);
+    mVisibleTransforms.bind(VisibleBinding);
+    mCullingData.bind(CullingDataBinding);
+    mVisibleCounter.bind(0);
+
+    gl::DispatchCompute((mInstanceCount + GroupSize - 1) / GroupSize, 1, 1);
+
+    // The counter becomes the instance count of the draw, without a round trip to the CPU
+    gl::MemoryBarrier(gl::ATOMIC_COUNTER_BARRIER_BIT | gl::BUFFER_UPDATE_BARRIER_BIT);
+    gl::CopyNamedBufferSubData(mVisibleCounter.name(), mCommands.name(), 0,
+                               offsetof(DrawElementsIndirectCommand, instanceCount), sizeof(unsigned));
+
+    // Make the command and transforms visible to the following draw
+    gl::MemoryBarrier(gl::COMMAND_BARRIER_BIT | gl::SHADER_STORAGE_BARRIER_BIT);
+
+    mCullShader.unbind();
+}
+
+void GpuCuller::bindVisibleTransforms(const unsigned bindingPoint) const
+{
+    mVisibleTransforms.bind(bindingPoint);
+}
+
+const IndirectBuffer& GpuCuller::getCommands() const
+{
+    return mCommands;
+}
+
+const unsigned GpuCuller::getInstanceCount() const
+{
+    return mInstanceCount;
+}
@@ -0,0 +1,151 @@
+#include "gpuProfiler.h"
+#include "logging.h"
+
+#include "gl_cpp.hpp"
+
+GpuProfiler::GpuProfiler() : mTrack(Profiler::addTrack("GPU"))
+{
+    mQueries.resize(FramesInFlight * MaxZonesPerFrame * 2);
+    gl::CreateQueries(gl::TIMESTAMP, static_cast<int>(mQueries.size()), mQueries.data());
+
+    for (auto& frame : mFrames)
+    {
+        frame.zones.reserve(MaxZonesPerFrame);
+    }
+
+    calibrate();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    gl::DeleteQueries(static_cast<int>(mQueries.size()), mQueries.data());
+}
+
+int GpuProfiler::beginZone(const char* name)
+{
+    auto& frame = mFrames[mCurrent];
+    if (frame.zones.size() == MaxZonesPerFrame)
+    {
+        ++mDroppedZones;
+        if (!bWarnedDroppedZones)
+        {
+            logWarn("GpuProfiler: More than {} zones in a frame, the rest are not timed", MaxZonesPerFrame);
+            bWarnedDroppedZones = true;
+        }
+        return -1;
+    }
+
+    const auto zone = static_cast<unsigned>(frame.zones.size());
+    frame.zones.push_back(Zone{ name, mDepth++, false });
+    gl::QueryCounter(query(mCurrent, zone, false), gl::TIMESTAMP);
+    frame.lastQuery = static_cast<int>(zone * 2);
+
+    // The slot is part of the handle so a zone left open across endFrame is not ended in the wrong frame
+    return static_cast<int>(mCurrent * MaxZonesPerFrame + zone);
+}
+
+void GpuProfiler::endZone(int zone)
+{
+    const unsigned slot = static_cast<unsigned>(zone) / MaxZonesPerFrame;
+    const unsigned index = static_cast<unsigned>(zone) % MaxZonesPerFrame;
+
+    // The zone was started before the frame ended, it is not timed
+    if (slot != mCurrent) return;
+
+    auto& frame = mFrames[mCurrent];
+    gl::QueryCounter(query(mCurrent, index, true), gl::TIMESTAMP);
+    frame.zones[index].bEnded = true;
+    frame.lastQuery = static_cast<int>(index * 2 + 1);
+    --mDepth;
+}
+
+void GpuProfiler::endFrame()
+{
+    mFrames[mCurrent].frameIndex = Profiler::getFrameIndex();
+    mFrames[mCurrent].bPending = !mFrames[mCurrent].zones.empty();
+    mCurrent = (mCurrent + 1) % FramesInFlight;
+
+    // Oldest first, the GPU finishes frames in order so stop at the first that is not done
+    for (unsigned i = 0; i != FramesInFlight; ++i)
+    {
+        const unsigned slot = (mCurrent + i) % FramesInFlight;
+        auto& frame = mFrames[slot];
+        if (!frame.bPending) continue;
+
+        int available = 0;
+        gl::GetQueryObjectiv(mQueries[slot * MaxZonesPerFrame * 2 + frame.lastQuery], gl::QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        readBack(frame, slot);
+    }
+
+    // The queries of the oldest frame are reused now, its results are lost if they are still not there
+    auto& reused = mFrames[mCurrent];
+    if (reused.bPending)
+    {
+        if (mDroppedFrames++ == 0)
+        {
+            logWarn("GpuProfiler: Results took more than {} frames, dropping them", FramesInFlight);
+        }
+    }
+    reused.zones.clear();
+    reused.lastQuery = -1;
+    reused.bPending = false;
+    mDepth = 0;
+
+    // Every capture warns again, so a capture with untimed zones says so
+    const bool bCapturing = Profiler::isCapturing();
+    if (bCapturing && !bWasCapturing) bWarnedDroppedZones = false;
+    bWasCapturing = bCapturing;
+    mLastDroppedZones = mDroppedZones;
+    mDroppedZones = 0;
+
+    if (++mFramesSinceCalibration == CalibrationInterval)
+    {
+        calibrate();
+    }
+}
+
+const unsigned GpuProfiler::getDroppedZones() const
+{
+    return mLastDroppedZones;
+}
+
+unsigned GpuProfiler::query(unsigned slot, unsigned zone, bool end) const
+{
+    return mQueries[(slot * MaxZonesPerFrame + zone) * 2 + (end ? 1 : 0)];
+}
+
+void GpuProfiler::readBack(FrameQueries& frame, unsigned slot)
+{
+    std::vector<ProfileEvent> events;
+    events.reserve(frame.zones.size());
+    for (unsigned zone = 0; zone != frame.zones.size(); ++zone)
+    {
+        if (!frame.zones[zone].bEnded) continue;
+
+        uint64_t start = 0;
+        uint64_t end = 0;
+        gl::GetQueryObjectui64v(query(slot, zone, false), gl::QUERY_RESULT, &start);
+        gl::GetQueryObjectui64v(query(slot, zone, true), gl::QUERY_RESULT, &end);
+
+        events.push_back(ProfileEvent{ frame.zones[zone].name,
+                                       static_cast<uint64_t>(static_cast<int64_t>(start) + mClockOffset),
+                                       static_cast<uint64_t>(static_cast<int64_t>(end) + mClockOffset),
+                                       mTrack, frame.zones[zone].depth });
+    }
+
+    Profiler::addEvents(frame.frameIndex, events);
+    frame.zones.clear();
+    frame.lastQuery = -1;
+    frame.bPending = false;
+}
+
+void GpuProfiler::calibrate()
+{
+    // The GL timestamp is the time the commands issued so far reached the GPU, close to now
+    int64_t gpuTime = 0;
+    gl::GetInteger64v(gl::TIMESTAMP, &gpuTime);
+    mClockOffset = static_cast<int64_t>(Clock::nanoseconds()) - gpuTime;
+    mFramesSinceCalibration = 0;
+}
@@ -0,0 +1,172 @@
+#include "headlessContext.h"
+#include "logging.h"
+
+#include "gl_cpp.hpp"
+
+#if defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+
+namespace
+{
+    void* eglLoader(const char* name)
+    {
+        return reinterpret_cast<void*>(eglGetProcAddress(name));
+    }
+
+    // Whether the space separated extension string contains the extension
+    bool hasExtension(const char* extensions, const char* extension)
+    {
+        if (!extensions) return false;
+
+        const size_t length = std::strlen(extension);
+        for (const char* found = std::strstr(extensions, extension); found; found = std::strstr(found + length, extension))
+        {
+            if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) return true;
+        }
+        return false;
+    }
+
+    // Surfaceless display if the driver offers one, the default display otherwise
+    EGLDisplay openDisplay(bool& surfaceless)
+    {
+        surfaceless = false;
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        {
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay)
+            {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+                {
+                    surfaceless = true;
+                    return display;
+                }
+            }
+        }
+
+        EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+
+        return EGL_NO_DISPLAY;
+    }
+}
+
+HeadlessContext::HeadlessContext()
+{
+    bool surfaceless = false;
+    EGLDisplay display = openDisplay(surfaceless);
+    if (display == EGL_NO_DISPLAY)
+    {
+        logErr("HeadlessContext: No EGL display available");
+        return;
+    }
+    mDisplay = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        logErr("HeadlessContext: EGL does not support desktop OpenGL");
+        return;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        logErr("HeadlessContext: No EGL config for OpenGL");
+        return;
+    }
+
+    // The default framebuffer is never drawn to, a tiny pbuffer only satisfies drivers that need a surface
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!surfaceless)
+    {
+        const EGLint surfaceAttributes[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+        if (surface == EGL_NO_SURFACE)
+        {
+            logErr("HeadlessContext: Failed to create a pbuffer surface");
+            return;
+        }
+        mSurface = surface;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        logErr("HeadlessContext: Failed to create an OpenGL 4.5 core context");
+        return;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        logErr("HeadlessContext: Failed to make the context current");
+        eglDestroyContext(display, context);
+        return;
+    }
+    mContext = context;
+
+    // Functions resolve on first call, through EGL now
+    gl::sys::SetProcAddressLoader(eglLoader);
+    logInfo("HeadlessContext: {} context on {}", surfaceless ? "Surfaceless" : "Pbuffer",
+            reinterpret_cast<const char*>(gl::GetString(gl::RENDERER)));
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    if (!mDisplay) return;
+
+    eglMakeCurrent(mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (mContext) eglDestroyContext(mDisplay, mContext);
+    if (mSurface) eglDestroySurface(mDisplay, mSurface);
+    eglTerminate(mDisplay);
+    gl::sys::SetProcAddressLoader(nullptr);
+}
+
+const bool HeadlessContext::isValid() const
+{
+    return mContext != nullptr;
+}
+
+bool HeadlessContext::isSupported()
+{
+    return true;
+}
+#else
+HeadlessContext::HeadlessContext()
+{
+    logErr("HeadlessContext: Built without EGL, headless rendering is not available");
+}
+
+HeadlessContext::~HeadlessContext()
+{
+}
+
+const bool HeadlessContext::isValid() const
+{
+    return false;
+}
+
+bool HeadlessContext::isSupported()
+{
+    return false;
+}
+#endif
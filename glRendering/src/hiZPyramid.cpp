@@ -0,0 +1,119 @@
+#include "hiZPyramid.h"
+#include "framebuffer.h"
+#include "files.h"
+#include "gpuProfiler.h"
+#include "renderStats.h"
+
+#include <algorithm>
+
+#include "gl_cpp.hpp"
+
+namespace
+{
+    // Must match local_size_x / local_size_y in hiz.comp
+    constexpr unsigned GroupSize = 8;
+
+    unsigned groupCount(int texels)
+    {
+        return (static_cast<unsigned>(texels) + GroupSize - 1) / GroupSize;
+    }
+
+    glm::ivec2 levelSize(const glm::ivec2& size, unsigned level)
+    {
+        return glm::ivec2(std::max(size.x >> level, 1), std::max(size.y >> level, 1));
+    }
+}
+
+HiZPyramid::HiZPyramid(const glm::ivec2& size) :
+    mReduceShader(getResourcePath("hiz.comp"), EShaderType::Compute)
+{
+    createTexture(size);
+}
+
+HiZPyramid::~HiZPyramid()
+{
+    gl::DeleteTextures(1, &mName);
+}
+
+void HiZPyramid::build(const Framebuffer& framebuffer, const glm::mat4& viewProjection)
+{
+    GPU_PROFILE_SCOPE("HiZ Build");
+    if (framebuffer.getSize() != mSize)
+    {
+        createTexture(framebuffer.getSize());
+    }
+
+    mViewProjection = viewProjection;
+    mReduceShader.bind();
+
+    // Level 0 is a straight copy of the depth texture
+    framebuffer.bindDepthTexture(0);
+    gl::BindImageTexture(0, mName, 0, gl::FALSE_, 0, gl::WRITE_ONLY, gl::R32F);
+    mReduceShader.setUniform1i("sourceLevel", -1);
+    gl::DispatchCompute(groupCount(mSize.x), groupCount(mSize.y), 1);
+
+    // Every following level takes the max of the 2x2 texels above it
+    for (unsigned level = 1; level < mLevelCount; ++level)
+    {
+        gl::MemoryBarrier(gl::SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        const auto size = levelSize(mSize, level);
+        gl::BindImageTexture(1, mName, level - 1, gl::FALSE_, 0, gl::READ_ONLY, gl::R32F);
+        gl::BindImageTexture(0, mName, level, gl::FALSE_, 0, gl::WRITE_ONLY, gl::R32F);
+        mReduceShader.setUniform1i("sourceLevel", static_cast<int>(level - 1));
+        gl::DispatchCompute(groupCount(size.x), groupCount(size.y), 1);
+    }
+
+    gl::MemoryBarrier(gl::TEXTURE_FETCH_BARRIER_BIT);
+    mReduceShader.unbind();
+}
+
+void HiZPyramid::bind(unsigned bindingPoint) const
+{
+    gl::BindTextureUnit(bindingPoint, mName);
+    ++RenderStats::counters().textureBinds;
+}
+
+const glm::mat4& HiZPyramid::getViewProjection() const
+{
+    return mViewProjection;
+}
+
+const glm::ivec2& HiZPyramid::getSize() const
+{
+    return mSize;
+}
+
+const unsigned HiZPyramid::getLevelCount() const
+{
+    return mLevelCount;
+}
+
+const unsigned HiZPyramid::name() const
+{
+    return mName;
+}
+
+void HiZPyramid::createTexture(const glm::ivec2& size)
+{
+    if (mName)
+    {
+        gl::DeleteTextures(1, &mName);
+    }
+
+    mSize = glm::ivec2(std::max(size.x, 1), std::max(size.y, 1));
+
+    // Full chain down to 1x1
+    mLevelCount = 1;
+    for (int largest = std::max(mSize.x, mSize.y); largest > 1; largest >>= 1)
+    {
+        ++mLevelCount;
+    }
+
+    gl::CreateTextures(gl::TEXTURE_2D, 1, &mName);
+    gl::TextureStorage2D(mName, mLevelCount, gl::R32F, mSize.x, mSize.y);
+    gl::TextureParameteri(mName, gl::TEXTURE_MIN_FILTER, gl::NEAREST_MIPMAP_NEAREST);
+    gl::TextureParameteri(mName, gl::TEXTURE_MAG_FILTER, gl::NEAREST);
+    gl::TextureParameteri(mName, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE);
+    gl::TextureParameteri(mName, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
+}
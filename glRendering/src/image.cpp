@@ -1,4 +1,5 @@
 #include "image.h"
+#include "renderStats.h"
 
 #include <memory>
 
@@ -64,6 +65,7 @@ const glm::ivec2 Image::getSize() const {
 void Image::bind(const unsigned bindingPoint /*= 0*/) const
 {
     gl::BindImageTexture(bindingPoint, mName, 0, gl::FALSE_, 0, static_cast<GLenum>(mMode), gl::RGBA8);
+    ++RenderStats::counters().textureBinds;
 }
 
 void Image::unbind(const unsigned bindingPoint /*= 0*/) const
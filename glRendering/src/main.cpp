@@ -1,8 +1,13 @@
+#include "files.h"
 #include "glfwApplication.h"
 #include "logging.h"
 
 #include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
 #include <iostream>
+#include <charconv>
 
 #include "gl_cpp.hpp"
 #include "spdlog/spdlog.h"
@@ -27,12 +32,57 @@ void APIENTRY cppGLDebug(GLenum source, GLenum type, GLuint id, GLenum severity,
 	}
 }
 
-int main() {
-	auto debugLog = spdlog::stdout_color_st("DEBUG");
+// Usage: OpenGLRendering [--headless [frames] [results.json]] [--trace trace.bin]
+int main(int argc, char** argv) {
+	auto debugLog = initLogging();
 	debugLog->set_pattern("[%H:%M:%S.%e] >> %v");
     debugLog->info("Application Start Entry");
 
-	GLFWApplication application;
+    // Resources come from the pack when the build made one, loose files in res/ otherwise
+    if (!mountResourcePack("res.pack")) debugLog->info("No resource pack, loading resources from res/");
+
+    // Tracing writes every GL call to a file for tools/glReplay, in either mode
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string tracePath;
+    const auto trace = std::find(args.begin(), args.end(), "--trace");
+    if (trace != args.end() && trace + 1 != args.end())
+    {
+        tracePath = *(trace + 1);
+        args.erase(trace, trace + 2);
+    }
+
+    // Headless renders offscreen for a fixed number of frames and writes the frame times
+    std::unique_ptr<GLFWApplication> app;
+    if (!args.empty() && args[0] == "--headless")
+    {
+        HeadlessSettings settings;
+        if (args.size() > 1)
+        {
+            const char* first = args[1].data();
+            const char* last = first + args[1].size();
+            const auto [end, error] = std::from_chars(first, last, settings.frameCount);
+            if (error != std::errc() || end != last || settings.frameCount == 0)
+            {
+                std::cerr << "Invalid frame count " << args[1] << "\n"
+                          << "Usage: OpenGLRendering [--headless [frames] [results.json]] [--trace trace.bin]\n";
+                shutdownLogging();
+                return 1;
+            }
+        }
+        if (args.size() > 2) settings.resultsPath = args[2];
+        app = std::make_unique<GLFWApplication>(settings, tracePath);
+    }
+    else
+    {
+        app = std::make_unique<GLFWApplication>(tracePath);
+    }
+    GLFWApplication& application = *app;
+
+    if (!application.isValid())
+    {
+        shutdownLogging();
+        return 1;
+    }
 
 #ifndef NDEBUG
 	// OpenGL Debug Messages
@@ -45,5 +95,6 @@ int main() {
 	application.run();
 	
     debugLog->info("Application Terminate Entry");
+    shutdownLogging();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,418 @@
+#include "meshOptimizer.h"
+#include "logging.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace
+{
+    // Size of the cache modelled by the vertex scores
+    constexpr unsigned MaxCacheSize = 32;
+
+    // Scoring parameters from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    // Cache size used to find cluster boundaries for overdraw optimization
+    constexpr unsigned ClusterCacheSize = 16;
+
+    // Valences with a precomputed boost, higher ones are computed on demand
+    constexpr unsigned MaxTableValence = 32;
+
+    // Score tables for the cache position and the valence boost
+    struct ScoreTables
+    {
+        float cache[MaxCacheSize];
+        float valence[MaxTableValence];
+
+        ScoreTables()
+        {
+            // The last triangle's vertices get a fixed score, so that one triangle is not favoured over the others
+            for (unsigned position = 0; position < MaxCacheSize; ++position)
+            {
+                const float scaler = 1.f / (MaxCacheSize - 3);
+                cache[position] = position < 3 ? LastTriangleScore : std::pow(1.f - (position - 3) * scaler, CacheDecayPower);
+            }
+
+            // Favour vertices with few triangles left, so they are finished and do not linger
+            valence[0] = 0.f;
+            for (unsigned count = 1; count < MaxTableValence; ++count)
+            {
+                valence[count] = ValenceBoostScale * std::pow(static_cast<float>(count), -ValenceBoostPower);
+            }
+        }
+    };
+
+    // Score of a vertex at the cache position (-1 if not cached) with the given number of triangles left to draw
+    float vertexScore(const ScoreTables& tables, int cachePosition, unsigned remainingValence)
+    {
+        if (remainingValence == 0) return -1.f;
+
+        const float cacheScore = cachePosition >= 0 ? tables.cache[cachePosition] : 0.f;
+        const float valenceScore = remainingValence < MaxTableValence ? tables.valence[remainingValence]
+                                                                      : ValenceBoostScale * std::pow(static_cast<float>(remainingValence), -ValenceBoostPower);
+        return cacheScore + valenceScore;
+    }
+
+    bool validIndices(const unsigned* indices, unsigned indexCount, unsigned vertexCount, const char* function)
+    {
+        if (indexCount % 3 != 0)
+        {
+            logWarn("{}: Index count {} is not a triangle list", function, indexCount);
+            return false;
+        }
+
+        for (unsigned i = 0; i < indexCount; ++i)
+        {
+            if (indices[i] >= vertexCount)
+            {
+                logWarn("{}: Index {} is out of range of the {} vertices", function, indices[i], vertexCount);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 readPosition(const void* positions, unsigned stride, unsigned vertex)
+    {
+        Vec3 position;
+        std::memcpy(&position, static_cast<const char*>(positions) + static_cast<size_t>(vertex) * stride, sizeof(Vec3));
+        return position;
+    }
+}
+
+VertexCacheStatistics analyzeVertexCache(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize)
+{
+    VertexCacheStatistics statistics;
+    if (indexCount < 3 || !validIndices(indices, indexCount, vertexCount, "analyzeVertexCache")) return statistics;
+
+    // A vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<unsigned> loadedAt(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    unsigned time = cacheSize + 1;
+    unsigned usedCount = 0;
+
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        const unsigned vertex = indices[i];
+        if (time - loadedAt[vertex] > cacheSize)
+        {
+            loadedAt[vertex] = time++;
+            ++statistics.misses;
+        }
+
+        if (!used[vertex])
+        {
+            used[vertex] = true;
+            ++usedCount;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(statistics.misses) / (indexCount / 3);
+    statistics.atvr = static_cast<float>(statistics.misses) / usedCount;
+    return statistics;
+}
+
+void optimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount)
+{
+    if (indexCount < 3 || !validIndices(indices, indexCount, vertexCount, "optimizeVertexCache")) return;
+
+    const unsigned triangleCount = indexCount / 3;
+
+    // Triangles using every vertex. The first remaining[v] entries of a vertex are not drawn yet
+    std::vector<unsigned> offsets(vertexCount + 1, 0);
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        ++offsets[indices[i] + 1];
+    }
+    for (unsigned v = 0; v < vertexCount; ++v)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<unsigned> remaining(vertexCount, 0);
+    std::vector<unsigned> adjacency(indexCount);
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        const unsigned vertex = indices[i];
+        adjacency[offsets[vertex] + remaining[vertex]++] = i / 3;
+    }
+
+    static const ScoreTables tables;
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (unsigned v = 0; v < vertexCount; ++v)
+    {
+        score[v] = vertexScore(tables, -1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (unsigned t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned> output;
+    output.reserve(indexCount);
+
+    // The cache holds up to MaxCacheSize vertices, plus room for the three of a new triangle while it is updated
+    unsigned cache[MaxCacheSize + 3];
+    unsigned cacheCount = 0;
+    std::vector<unsigned> addedInStep(vertexCount, 0);
+
+    unsigned best = static_cast<unsigned>(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+    unsigned cursor = 0;
+
+    for (unsigned drawn = 0; drawn < triangleCount; ++drawn)
+    {
+        // Nothing connected to the cache is left, continue with the next triangle in the input order
+        if (best == ~0u)
+        {
+            while (emitted[cursor]) ++cursor;
+            best = cursor;
+        }
+
+        const unsigned* triangle = indices + best * 3;
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // Remove the triangle from its vertices
+        for (unsigned k = 0; k < 3; ++k)
+        {
+            const unsigned vertex = triangle[k];
+            unsigned* begin = adjacency.data() + offsets[vertex];
+            unsigned* end = begin + remaining[vertex];
+            *std::find(begin, end, best) = *(end - 1);
+            --remaining[vertex];
+        }
+
+        // Move the triangle's vertices to the front of the cache, each vertex is added once per step
+        unsigned newCache[MaxCacheSize + 3];
+        unsigned newCount = 0;
+        for (unsigned k = 0; k < 3; ++k)
+        {
+            if (addedInStep[triangle[k]] != drawn + 1)
+            {
+                addedInStep[triangle[k]] = drawn + 1;
+                newCache[newCount++] = triangle[k];
+            }
+        }
+        for (unsigned c = 0; c < cacheCount; ++c)
+        {
+            if (addedInStep[cache[c]] != drawn + 1)
+            {
+                addedInStep[cache[c]] = drawn + 1;
+                newCache[newCount++] = cache[c];
+            }
+        }
+
+        // Rescore everything that moved in or fell out of the cache and find the best triangle among them
+        best = ~0u;
+        float bestScore = -1.f;
+        for (unsigned c = 0; c < newCount; ++c)
+        {
+            const unsigned vertex = newCache[c];
+            cachePosition[vertex] = c < MaxCacheSize ? static_cast<int>(c) : -1;
+
+            const float newScore = vertexScore(tables, cachePosition[vertex], remaining[vertex]);
+            const float delta = newScore - score[vertex];
+            score[vertex] = newScore;
+
+            for (unsigned a = 0; a < remaining[vertex]; ++a)
+            {
+                const unsigned t = adjacency[offsets[vertex] + a];
+                triangleScore[t] += delta;
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(newCount, MaxCacheSize);
+        std::copy(newCache, newCache + cacheCount, cache);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimizeOverdraw(unsigned* indices, unsigned indexCount, const void* positions, unsigned positionStride, unsigned vertexCount, float threshold)
+{
+    if (indexCount < 3 || !validIndices(indices, indexCount, vertexCount, "optimizeOverdraw")) return;
+
+    const unsigned triangleCount = indexCount / 3;
+
+    // Simulated FIFO cache, reset by moving time past every loaded vertex
+    std::vector<unsigned> loadedAt(vertexCount, 0);
+    unsigned time = ClusterCacheSize + 1;
+    const auto missesOf = [&](unsigned t)
+    {
+        unsigned misses = 0;
+        for (unsigned k = 0; k < 3; ++k)
+        {
+            const unsigned vertex = indices[t * 3 + k];
+            if (time - loadedAt[vertex] > ClusterCacheSize)
+            {
+                loadedAt[vertex] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+
+    // Hard boundaries: Triangles that miss on all their vertices start a new cluster anyway
+    std::vector<unsigned> hardStarts;
+    for (unsigned t = 0; t < triangleCount; ++t)
+    {
+        if (missesOf(t) == 3) hardStarts.push_back(t);
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Soft boundaries: Split hard clusters where the ACMR up to that point stays close to that of the whole cluster
+    std::vector<unsigned> starts;
+    for (size_t h = 0; h + 1 < hardStarts.size(); ++h)
+    {
+        const unsigned begin = hardStarts[h];
+        const unsigned end = hardStarts[h + 1];
+
+        time += ClusterCacheSize + 1;
+        unsigned clusterMisses = 0;
+        for (unsigned t = begin; t < end; ++t)
+        {
+            clusterMisses += missesOf(t);
+        }
+        const float clusterThreshold = threshold * clusterMisses / (end - begin);
+
+        time += ClusterCacheSize + 1;
+        starts.push_back(begin);
+        unsigned misses = 0;
+        unsigned start = begin;
+        for (unsigned t = begin; t < end; ++t)
+        {
+            misses += missesOf(t);
+            if (t + 1 < end && static_cast<float>(misses) / (t + 1 - start) <= clusterThreshold)
+            {
+                starts.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                time += ClusterCacheSize + 1;
+            }
+        }
+    }
+    const unsigned clusterCount = static_cast<unsigned>(starts.size());
+    starts.push_back(triangleCount);
+
+    // Area weighted center and normal of every cluster and of the whole mesh
+    std::vector<Vec3> centers(clusterCount, Vec3{ 0.f, 0.f, 0.f });
+    std::vector<Vec3> normals(clusterCount, Vec3{ 0.f, 0.f, 0.f });
+    Vec3 meshCenter{ 0.f, 0.f, 0.f };
+    float meshArea = 0.f;
+    for (unsigned c = 0; c < clusterCount; ++c)
+    {
+        float clusterArea = 0.f;
+        for (unsigned t = starts[c]; t < starts[c + 1]; ++t)
+        {
+            const Vec3 a = readPosition(positions, positionStride, indices[t * 3]);
+            const Vec3 b = readPosition(positions, positionStride, indices[t * 3 + 1]);
+            const Vec3 d = readPosition(positions, positionStride, indices[t * 3 + 2]);
+
+            const Vec3 ab{ b.x - a.x, b.y - a.y, b.z - a.z };
+            const Vec3 ad{ d.x - a.x, d.y - a.y, d.z - a.z };
+            const Vec3 normal{ ab.y * ad.z - ab.z * ad.y, ab.z * ad.x - ab.x * ad.z, ab.x * ad.y - ab.y * ad.x };
+            const float area = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+            centers[c].x += (a.x + b.x + d.x) / 3.f * area;
+            centers[c].y += (a.y + b.y + d.y) / 3.f * area;
+            centers[c].z += (a.z + b.z + d.z) / 3.f * area;
+            normals[c].x += normal.x;
+            normals[c].y += normal.y;
+            normals[c].z += normal.z;
+            clusterArea += area;
+        }
+
+        meshCenter.x += centers[c].x;
+        meshCenter.y += centers[c].y;
+        meshCenter.z += centers[c].z;
+        meshArea += clusterArea;
+
+        const float inverseArea = clusterArea == 0.f ? 0.f : 1.f / clusterArea;
+        centers[c].x *= inverseArea;
+        centers[c].y *= inverseArea;
+        centers[c].z *= inverseArea;
+    }
+
+    const float inverseMeshArea = meshArea == 0.f ? 0.f : 1.f / meshArea;
+    meshCenter.x *= inverseMeshArea;
+    meshCenter.y *= inverseMeshArea;
+    meshCenter.z *= inverseMeshArea;
+
+    // Clusters facing away from the center are more likely to occlude the others, draw them first
+    std::vector<float> sortKeys(clusterCount);
+    for (unsigned c = 0; c < clusterCount; ++c)
+    {
+        const Vec3& n = normals[c];
+        const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        const float inverseLength = length == 0.f ? 0.f : 1.f / length;
+        sortKeys[c] = ((centers[c].x - meshCenter.x) * n.x + (centers[c].y - meshCenter.y) * n.y + (centers[c].z - meshCenter.z) * n.z) * inverseLength;
+    }
+
+    std::vector<unsigned> order(clusterCount);
+    for (unsigned c = 0; c < clusterCount; ++c)
+    {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned> output;
+    output.reserve(indexCount);
+    for (const auto c : order)
+    {
+        output.insert(output.end(), indices + starts[c] * 3, indices + starts[c + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+unsigned optimizeVertexFetch(void* vertices, unsigned vertexCount, unsigned vertexSize, unsigned* indices, unsigned indexCount)
+{
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            logWarn("optimizeVertexFetch: Index {} is out of range of the {} vertices", indices[i], vertexCount);
+            return vertexCount;
+        }
+    }
+
+    // Number the vertices in the order they are first used
+    std::vector<unsigned> remap(vertexCount, ~0u);
+    unsigned next = 0;
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        unsigned& target = remap[indices[i]];
+        if (target == ~0u) target = next++;
+        indices[i] = target;
+    }
+
+    const auto* source = static_cast<const uint8_t*>(vertices);
+    std::vector<uint8_t> reordered(static_cast<size_t>(next) * vertexSize);
+    for (unsigned v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != ~0u)
+            std::memcpy(reordered.data() + static_cast<size_t>(remap[v]) * vertexSize, source + static_cast<size_t>(v) * vertexSize, vertexSize);
+    }
+
+    std::memcpy(vertices, reordered.data(), reordered.size());
+    return next;
+}
@@ -0,0 +1,102 @@
+#include "meshPool.h"
+#include "vertexArrayCache.h"
+#include "vertexLayout.h"
+#include "logging.h"
+#include "buffer.h"
+#include "renderStats.h"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "gl_cpp.hpp"
+
+MeshPool::MeshPool(VertexArrayCache& cache, EVertexFormat format, unsigned vertexCapacity, unsigned indexCapacity) :
+    mCache(cache), mFormat(format), mVertexCapacity(vertexCapacity), mIndexCapacity(indexCapacity)
+{
+}
+
+MeshPool::~MeshPool()
+{
+    for (auto& page : mPages)
+    {
+        mCache.evict(page.vbo);
+        gl::DeleteBuffers(1, &page.vbo);
+        gl::DeleteBuffers(1, &page.ibo);
+    }
+}
+
+MeshRange MeshPool::allocate(const void* vertices, unsigned vertexCount, const unsigned* indices, unsigned indexCount, EPrimitiveType primitive)
+{
+    if (vertexCount == 0 || indexCount == 0)
+    {
+        logWarn("MeshPool: Attempted to allocate an empty mesh!");
+        return MeshRange{};
+    }
+
+    // Indices are relative to the base vertex, so 16-bit indices fit all but very large meshes
+    const EIndexType indexType = std::max(chooseIndexType(maxIndex(indices, indexCount)), EIndexType::UnsignedShort);
+
+    // Only the last page has room, earlier pages are full enough to skip
+    Page* page = mPages.empty() ? nullptr : &mPages.back();
+    if (!page || page->vertexCount + vertexCount > page->vertexCapacity || page->indexCount + indexCount > page->indexCapacity ||
+        indexSize(page->indexType) < indexSize(indexType))
+    {
+        page = &addPage(std::max(vertexCount, mVertexCapacity), std::max(indexCount, mIndexCapacity), indexType);
+    }
+
+    const unsigned stride = getVertexLayout(mFormat).stride;
+    gl::NamedBufferSubData(page->vbo, static_cast<ptrdiff_t>(page->vertexCount) * stride, static_cast<ptrdiff_t>(vertexCount) * stride, vertices);
+    RenderStats::addUpload(static_cast<ptrdiff_t>(vertexCount) * stride);
+
+    const unsigned size = indexSize(page->indexType);
+    std::vector<uint8_t> packed(static_cast<size_t>(indexCount) * size);
+    packIndices(indices, indexCount, page->indexType, packed.data());
+    gl::NamedBufferSubData(page->ibo, static_cast<ptrdiff_t>(page->indexCount) * size, static_cast<ptrdiff_t>(packed.size()), packed.data());
+    RenderStats::addUpload(static_cast<ptrdiff_t>(packed.size()));
+
+    MeshRange range;
+    range.vao = page->vao;
+    range.firstIndex = page->indexCount;
+    range.baseVertex = static_cast<int>(page->vertexCount);
+    range.indexCount = indexCount;
+    range.indexType = page->indexType;
+    range.primitive = primitive;
+    range.vertexBuffer = page->vbo;
+    range.indexBuffer = page->ibo;
+    range.format = mFormat;
+
+    page->vertexCount += vertexCount;
+    page->indexCount += indexCount;
+    return range;
+}
+
+const EVertexFormat MeshPool::getFormat() const
+{
+    return mFormat;
+}
+
+const unsigned MeshPool::getPageCount() const
+{
+    return static_cast<unsigned>(mPages.size());
+}
+
+MeshPool::Page& MeshPool::addPage(unsigned vertexCapacity, unsigned indexCapacity, EIndexType indexType)
+{
+    const auto& layout = getVertexLayout(mFormat);
+
+    Page page{};
+    page.vertexCapacity = vertexCapacity;
+    page.indexCapacity = indexCapacity;
+    page.indexType = indexType;
+
+    gl::CreateBuffers(1, &page.vbo);
+    gl::NamedBufferStorage(page.vbo, static_cast<ptrdiff_t>(vertexCapacity) * layout.stride, nullptr, gl::DYNAMIC_STORAGE_BIT);
+    gl::CreateBuffers(1, &page.ibo);
+    gl::NamedBufferStorage(page.ibo, static_cast<ptrdiff_t>(indexCapacity) * indexSize(indexType), nullptr, gl::DYNAMIC_STORAGE_BIT);
+
+    page.vao = &mCache.get({ VertexBinding{ layout, page.vbo, 0, 0 } }, page.ibo);
+
+    mPages.push_back(page);
+    return mPages.back();
+}
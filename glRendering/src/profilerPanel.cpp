@@ -0,0 +1,172 @@
+#include "profilerPanel.h"
+#include "gpuProfiler.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "imgui.h"
+
+namespace
+{
+    // Stable colour per zone name, so a zone keeps its colour across frames
+    ImU32 zoneColour(const char* name)
+    {
+        uint32_t hash = 2166136261u;
+        for (; *name; ++name)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+        }
+
+        // Mid range channels keep the white text readable
+        return IM_COL32(80 + hash % 120, 80 + (hash >> 8) % 120, 80 + (hash >> 16) % 120, 255);
+    }
+
+    float frameMilliseconds(const ProfileFrame& frame)
+    {
+        return static_cast<float>(frame.end - frame.start) / 1e6f;
+    }
+}
+
+void ProfilerPanel::draw()
+{
+    ImGui::SetNextWindowSize(ImVec2(640.f, 360.f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler"))
+    {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::Checkbox("Pause", &bPaused) && bPaused)
+    {
+        mPausedHistory = Profiler::getHistory();
+    }
+
+    ImGui::SameLine();
+    if (!Profiler::isCapturing())
+    {
+        if (ImGui::Button("Start Capture")) Profiler::startCapture();
+    }
+    else if (ImGui::Button("Stop Capture"))
+    {
+        Profiler::stopCapture();
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Save Trace") && Profiler::writeChromeTrace(mTracePath))
+    {
+        logInfo("Profiler: Saved trace to {}", mTracePath);
+    }
+
+    const auto& history = bPaused ? mPausedHistory : Profiler::getHistory();
+    if (history.empty())
+    {
+        ImGui::Text("No frames recorded");
+        ImGui::End();
+        return;
+    }
+
+    // Frame times, clicking a bar selects the frame
+    std::vector<float> times;
+    times.reserve(history.size());
+    float slowest = 0.f;
+    for (const auto& frame : history)
+    {
+        times.push_back(frameMilliseconds(frame));
+        slowest = std::max(slowest, times.back());
+    }
+
+    const auto count = static_cast<int>(times.size());
+    mSelectedFrame = std::min(std::max(mSelectedFrame, 0), count - 1);
+    const ProfileFrame& selected = history[count - 1 - mSelectedFrame];
+
+    char overlay[64];
+    std::snprintf(overlay, sizeof(overlay), "Frame %llu: %.2f ms",
+                  static_cast<unsigned long long>(selected.index), frameMilliseconds(selected));
+    ImGui::PlotHistogram("##Frames", times.data(), count, 0, overlay, 0.f, slowest,
+                         ImVec2(ImGui::GetContentRegionAvailWidth(), 60.f));
+    if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(0))
+    {
+        const float x = (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+        const int clicked = std::min(static_cast<int>(x * count), count - 1);
+        mSelectedFrame = count - 1 - std::max(clicked, 0);
+    }
+
+    ImGui::SliderFloat("Zoom", &mZoom, 1.f, 50.f, "%.1fx", 2.f);
+
+    // GPU zones past the queries of a frame are missing from the GPU track
+    const GpuProfiler* gpuProfiler = ServiceLocator<GpuProfiler>::get();
+    if (gpuProfiler && gpuProfiler->getDroppedZones() > 0)
+    {
+        ImGui::TextColored(ImVec4(1.f, 0.8f, 0.f, 1.f), "%u GPU zones were not timed last frame", gpuProfiler->getDroppedZones());
+    }
+
+    drawTimeline(selected);
+
+    ImGui::End();
+}
+
+void ProfilerPanel::drawTimeline(const ProfileFrame& frame)
+{
+    ImGui::BeginChild("Timeline", ImVec2(0.f, 0.f), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+    const auto trackNames = Profiler::getTrackNames();
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.f;
+    const float width = ImGui::GetContentRegionAvailWidth() * mZoom;
+
+    // GPU zones run behind the CPU and may end after the frame, the view stretches to include them
+    uint64_t viewEnd = frame.end;
+    for (const auto& event : frame.events)
+    {
+        viewEnd = std::max(viewEnd, event.end);
+    }
+    const double duration = static_cast<double>(std::max<uint64_t>(viewEnd - frame.start, 1));
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 mouse = ImGui::GetMousePos();
+
+    // Events are sorted by track, every track gets a name row and as many rows as it nests deep
+    size_t i = 0;
+    while (i < frame.events.size())
+    {
+        const uint32_t track = frame.events[i].track;
+        size_t trackEnd = i;
+        uint32_t maxDepth = 0;
+        while (trackEnd < frame.events.size() && frame.events[trackEnd].track == track)
+        {
+            maxDepth = std::max(maxDepth, frame.events[trackEnd].depth);
+            ++trackEnd;
+        }
+
+        ImGui::Text("%s", track < trackNames.size() ? trackNames[track].c_str() : "Unknown");
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+        for (; i < trackEnd; ++i)
+        {
+            const auto& event = frame.events[i];
+
+            // Zones that started in an earlier frame are clamped to the frame start
+            const double start = event.start > frame.start ? static_cast<double>(event.start - frame.start) : 0.0;
+            const double end = event.end > frame.start ? static_cast<double>(event.end - frame.start) : 0.0;
+
+            const ImVec2 min(origin.x + static_cast<float>(start / duration) * width, origin.y + event.depth * rowHeight);
+            const ImVec2 max(std::max(origin.x + static_cast<float>(end / duration) * width, min.x + 1.f), min.y + rowHeight - 1.f);
+
+            drawList->AddRectFilled(min, max, zoneColour(event.name));
+            if (max.x - min.x > ImGui::CalcTextSize(event.name).x + 4.f)
+            {
+                drawList->AddText(ImVec2(min.x + 2.f, min.y + 2.f), IM_COL32(255, 255, 255, 255), event.name);
+            }
+
+            if (ImGui::IsWindowHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+            {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, static_cast<double>(event.end - event.start) / 1e6);
+            }
+        }
+
+        ImGui::Dummy(ImVec2(width, (maxDepth + 1) * rowHeight));
+    }
+
+    ImGui::EndChild();
+}
@@ -1,22 +1,66 @@
 #include "renderBatch.h"
+#include "meshOptimizer.h"
 #include "logging.h"
 
+#include <algorithm>
+#include <type_traits>
 
-RenderBatch::RenderBatch(VertexArray&& vao) : mVao(std::move(vao))
+namespace
 {
+    // Append the triangles of a triangle strip (with restarts) as a triangle list, keeping the winding
+    void appendStripAsTriangles(const std::vector<unsigned>& strip, unsigned indexOffset, std::vector<unsigned>& out)
+    {
+        unsigned stripStart = 0;
+        for (unsigned i = 0; i < strip.size(); ++i)
+        {
+            if (strip[i] == RestartIndex)
+            {
+                stripStart = i + 1;
+                continue;
+            }
+
+            // Every index after the second completes a triangle, every other one is flipped
+            const unsigned position = i - stripStart;
+            if (position < 2) continue;
+
+            const bool odd = (position & 1) != 0;
+            out.push_back(strip[odd ? i - 1 : i - 2] + indexOffset);
+            out.push_back(strip[odd ? i - 2 : i - 1] + indexOffset);
+            out.push_back(strip[i] + indexOffset);
+        }
+    }
+
+    // Ranges closer than this are uploaded as one, a few extra bytes are cheaper than another call
+    constexpr unsigned RangeMergeDistance = 64;
+
+    // Smallest buffers a retained batch creates
+    constexpr unsigned MinRetainedCapacity = 256;
+}
+
+template<typename VertexT>
+BasicRenderBatch<VertexT>::BasicRenderBatch()
+{
+    mVao.setLayout(VertexFormat<VertexT>::layout);
 }
 
-RenderBatch::RenderBatch(RenderBatch&& other) : mVertices(std::move(other.mVertices)),
-                                                mIndices(std::move(other.mIndices)),
-                                                mIndexOffset(other.mIndexOffset),
-                                                bCommited(other.bCommited),
-                                                mVao(std::move(other.mVao)),
-                                                mVbo(std::move(other.mVbo)),
-                                                mIbo(std::move(other.mIbo))
+template<typename VertexT>
+BasicRenderBatch<VertexT>::BasicRenderBatch(VertexArray&& vao) : mVao(std::move(vao))
 {
 }
 
-RenderBatch& RenderBatch::operator=(RenderBatch&& other)
+template<typename VertexT>
+BasicRenderBatch<VertexT>::BasicRenderBatch(BasicRenderBatch&& other) : mVertices(std::move(other.mVertices)),
+                                                                        mIndices(std::move(other.mIndices)),
+                                                                        bCommited(other.bCommited),
+                                                                        mVao(std::move(other.mVao)),
+                                                                        mVbo(std::move(other.mVbo)),
+                                                                        mIbo(std::move(other.mIbo)),
+                                                                        mRetained(std::move(other.mRetained))
+{
+}
+
+template<typename VertexT>
+BasicRenderBatch<VertexT>& BasicRenderBatch<VertexT>::operator=(BasicRenderBatch&& other)
 {
     if (this == &other) return *this;
 
@@ -25,75 +69,429 @@ RenderBatch& RenderBatch::operator=(RenderBatch&& other)
     // Steal Resources
     mVertices = std::move(other.mVertices);
     mIndices = std::move(other.mIndices);
-    mIndexOffset = other.mIndexOffset;
     bCommited = other.bCommited;
     mVao = std::move(other.mVao);
     mVbo = std::move(other.mVbo);
     mIbo = std::move(other.mIbo);
+    mRetained = std::move(other.mRetained);
 
     return *this;
 }
 
-void RenderBatch::clear()
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::clear()
 {
     mVertices.clear();
     mIndices.clear();
-    mIndexOffset = 0;
     bCommited = false;
+    mRetained = RetainedState();
 }
 
-void RenderBatch::push(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices)
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::push(const std::vector<VertexT>& vertices, const std::vector<unsigned>& indices)
 {
     if (bCommited) logWarn("Pushing to committed render batch has no effect! "
                            "Please clear the batch before pushing more.");
+    if (mRetained.active)
+    {
+        logWarn("RenderBatch: Cannot push to a retained batch! Please use add instead.");
+        return;
+    }
+
+    // Add indices, offset past the vertices already in the batch
+    const auto indexOffset = static_cast<unsigned>(mVertices.size());
+    for (auto& index : indices)
+    {
+        mIndices.push_back(index + indexOffset);
+    }
+
+    // Add vertices
+    mVertices.insert(mVertices.end(), vertices.begin(), vertices.end());
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::push(const Shape2D& shape)
+{
+    if (bCommited) logWarn("Pushing to committed render batch has no effect! "
+                           "Please clear the batch before pushing more.");
+    if (mRetained.active)
+    {
+        logWarn("RenderBatch: Cannot push to a retained batch! Please use add instead.");
+        return;
+    }
+
+    // Batches are drawn as one triangle list
+    const auto indexOffset = static_cast<unsigned>(mVertices.size());
+    if (shape.mGeometry->primitive == EPrimitiveType::TriangleStrip)
+    {
+        appendStripAsTriangles(shape.mGeometry->indices, indexOffset, mIndices);
+    }
+    else
+    {
+        for (auto& index : shape.mGeometry->indices)
+        {
+            mIndices.push_back(index + indexOffset);
+        }
+    }
+
+    // Shapes keep full precision vertices, convert them to the batch format
+    for (auto& vert : shape.mGeometry->vertices)
+    {
+        mVertices.push_back(VertexFormat<VertexT>::fromVertex(vert));
+    }
+}
+
+template<typename VertexT>
+BatchHandle BasicRenderBatch<VertexT>::add(const std::vector<VertexT>& vertices, const std::vector<unsigned>& indices)
+{
+    if (!mRetained.active && !mVertices.empty())
+    {
+        logWarn("RenderBatch: Cannot add to a batch filled with push! Please clear the batch first.");
+        return InvalidBatchHandle;
+    }
+    mRetained.active = true;
+
+    const Element element{ static_cast<unsigned>(mVertices.size()), static_cast<unsigned>(vertices.size()),
+                           static_cast<unsigned>(mIndices.size()), static_cast<unsigned>(indices.size()), true };
 
-    // Add indices
     for (auto& index : indices)
     {
-        mIndices.push_back(index + mIndexOffset);
+        mIndices.push_back(index + element.firstVertex);
     }
+    mVertices.insert(mVertices.end(), vertices.begin(), vertices.end());
 
-    // Add vertices and increment the offset
-    for (auto& vert : vertices)
+    mRetained.dirtyVertices.push_back(Range{ element.firstVertex, element.firstVertex + element.vertexCount });
+    mRetained.dirtyIndices.push_back(Range{ element.firstIndex, element.firstIndex + element.indexCount });
+
+    // Reuse the handle of a removed element if there is one
+    if (!mRetained.freeHandles.empty())
     {
-        mVertices.push_back(vert);
-        ++mIndexOffset;
+        const BatchHandle handle = mRetained.freeHandles.back();
+        mRetained.freeHandles.pop_back();
+        mRetained.elements[handle] = element;
+        return handle;
     }
+
+    mRetained.elements.push_back(element);
+    return static_cast<BatchHandle>(mRetained.elements.size() - 1);
 }
 
-void RenderBatch::push(const Shape2D& shape)
+template<typename VertexT>
+BatchHandle BasicRenderBatch<VertexT>::add(const Shape2D& shape)
 {
-    push(shape.mVertices, shape.mIndices);
+    std::vector<unsigned> indices;
+    if (shape.mGeometry->primitive == EPrimitiveType::TriangleStrip)
+    {
+        appendStripAsTriangles(shape.mGeometry->indices, 0, indices);
+    }
+    else
+    {
+        indices = shape.mGeometry->indices;
+    }
+
+    std::vector<VertexT> vertices;
+    vertices.reserve(shape.mGeometry->vertices.size());
+    for (auto& vert : shape.mGeometry->vertices)
+    {
+        vertices.push_back(VertexFormat<VertexT>::fromVertex(vert));
+    }
+
+    return add(vertices, indices);
 }
 
-void RenderBatch::commit()
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::update(BatchHandle handle, const std::vector<VertexT>& vertices)
 {
+    if (handle >= mRetained.elements.size() || !mRetained.elements[handle].alive)
+    {
+        logWarn("RenderBatch: Updating element {} which is not in the batch!", handle);
+        return;
+    }
+
+    auto& element = mRetained.elements[handle];
+    if (vertices.size() == element.vertexCount)
+    {
+        // Same size, overwrite in place so only the vertices are uploaded
+        std::copy(vertices.begin(), vertices.end(), mVertices.begin() + element.firstVertex);
+        mRetained.dirtyVertices.push_back(Range{ element.firstVertex, element.firstVertex + element.vertexCount });
+        return;
+    }
+
+    // The indices of the element only fit its current vertex count
+    logErr("RenderBatch: Updating element {} with {} vertices instead of {}! Please pass its new indices too.",
+           handle, vertices.size(), element.vertexCount);
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::update(BatchHandle handle, const std::vector<VertexT>& vertices,
+                                       const std::vector<unsigned>& indices)
+{
+    if (handle >= mRetained.elements.size() || !mRetained.elements[handle].alive)
+    {
+        logWarn("RenderBatch: Updating element {} which is not in the batch!", handle);
+        return;
+    }
+
+    auto& element = mRetained.elements[handle];
+    if (vertices.size() == element.vertexCount && indices.size() == element.indexCount)
+    {
+        // Same size, overwrite in place
+        std::copy(vertices.begin(), vertices.end(), mVertices.begin() + element.firstVertex);
+        std::transform(indices.begin(), indices.end(), mIndices.begin() + element.firstIndex,
+                       [&element](unsigned index) { return index + element.firstVertex; });
+        mRetained.dirtyVertices.push_back(Range{ element.firstVertex, element.firstVertex + element.vertexCount });
+        mRetained.dirtyIndices.push_back(Range{ element.firstIndex, element.firstIndex + element.indexCount });
+        return;
+    }
+
+    // Different size, move the element to the end with its new indices
+    hideElement(element);
+    mRetained.deadVertices += element.vertexCount;
+
+    element.firstVertex = static_cast<unsigned>(mVertices.size());
+    element.vertexCount = static_cast<unsigned>(vertices.size());
+    element.firstIndex = static_cast<unsigned>(mIndices.size());
+    element.indexCount = static_cast<unsigned>(indices.size());
+    for (auto& index : indices)
+    {
+        mIndices.push_back(index + element.firstVertex);
+    }
+    mVertices.insert(mVertices.end(), vertices.begin(), vertices.end());
+
+    mRetained.dirtyVertices.push_back(Range{ element.firstVertex, element.firstVertex + element.vertexCount });
+    mRetained.dirtyIndices.push_back(Range{ element.firstIndex, element.firstIndex + element.indexCount });
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::remove(BatchHandle handle)
+{
+    if (handle >= mRetained.elements.size() || !mRetained.elements[handle].alive)
+    {
+        logWarn("RenderBatch: Removing element {} which is not in the batch!", handle);
+        return;
+    }
+
+    auto& element = mRetained.elements[handle];
+    hideElement(element);
+    mRetained.deadVertices += element.vertexCount;
+    element.alive = false;
+    mRetained.freeHandles.push_back(handle);
+}
+
+template<typename VertexT>
+Tessellator<VertexT> BasicRenderBatch<VertexT>::makeTessellator()
+{
+    if (bCommited) logWarn("Tessellating into committed render batch has no effect! "
+                           "Please clear the batch before pushing more.");
+    if (mRetained.active)
+    {
+        // Geometry written straight into the batch would belong to no element
+        logErr("RenderBatch: Cannot tessellate into a retained batch! Please tessellate a shape and add it instead.");
+        mRetained.discardedVertices.clear();
+        mRetained.discardedIndices.clear();
+        return Tessellator<VertexT>(mRetained.discardedVertices, mRetained.discardedIndices);
+    }
+
+    return Tessellator<VertexT>(mVertices, mIndices);
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::optimize(bool reduceOverdraw)
+{
+    if (bCommited)
+    {
+        logWarn("Optimizing committed render batch has no effect! Please optimize before committing.");
+        return;
+    }
+
+    if (mRetained.active)
+    {
+        logWarn("RenderBatch: Optimizing a retained batch would move its elements, skipping.");
+        return;
+    }
+
+    if constexpr (hasFloatPosition<VertexT>)
+    {
+        optimizeMesh(mVertices, mIndices, reduceOverdraw);
+    }
+    else
+    {
+        if (reduceOverdraw)
+        {
+            logWarn("RenderBatch: Overdraw reduction needs full precision positions, only optimizing for the vertex cache");
+        }
+        optimizeMesh(mVertices, mIndices);
+    }
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::commit()
+{
+    if (mRetained.active)
+    {
+        commitRetained();
+        bCommited = true;
+        return;
+    }
+
     if (bCommited) return;
 
     makeDrawData();
     bCommited = true;
 }
 
-void RenderBatch::bind() const
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::bind() const
 {
     mVao.bind();
 }
 
-void RenderBatch::unbind() const
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::unbind() const
 {
     mVao.unbind();
 }
 
-const unsigned RenderBatch::getIndexCount() const
+template<typename VertexT>
+const unsigned BasicRenderBatch<VertexT>::getIndexCount() const
 {
     return static_cast<unsigned>(mIndices.size());
 }
 
-void RenderBatch::makeDrawData() const
+template<typename VertexT>
+const EIndexType BasicRenderBatch<VertexT>::getIndexType() const
+{
+    return mIbo ? mIbo->getType() : EIndexType::UnsignedInt;
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::makeDrawData() const
 {
-    mVbo = std::make_unique<VertexBuffer>(mVertices.data(), sizeof(Vertex) * mVertices.size());
-    mIbo = std::make_unique<IndexBuffer>(mIndices.data(), sizeof(unsigned) * mIndices.size(), static_cast<unsigned>(mIndices.size()));
+    mVbo = std::make_unique<VertexBuffer>(mVertices);
+    mIbo = std::make_unique<IndexBuffer>(mIndices);
 
     mVao.setBuffer(*mVbo);
     mVao.setIndexBuffer(*mIbo);
 }
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::commitRetained()
+{
+    // Reclaim removed elements once they make up half the batch
+    if (mRetained.deadVertices > 0 && mRetained.deadVertices * 2 >= mVertices.size())
+    {
+        compact();
+    }
+
+    auto& retained = mRetained;
+    if (retained.fullUpload || !mVbo || mVertices.size() > retained.vertexCapacity || mIndices.size() > retained.indexCapacity)
+    {
+        // Grow with headroom so that adding a few elements does not recreate the buffers every commit
+        retained.vertexCapacity = std::max(MinRetainedCapacity, static_cast<unsigned>(mVertices.size() + mVertices.size() / 2));
+        retained.indexCapacity = std::max(MinRetainedCapacity, static_cast<unsigned>(mIndices.size() + mIndices.size() / 2));
+
+        // The index type must fit every vertex the buffer can hold, not only the current ones
+        const EIndexType indexType = chooseIndexType(retained.vertexCapacity - 1);
+
+        mVbo = std::make_unique<VertexBuffer>(nullptr, static_cast<ptrdiff_t>(retained.vertexCapacity) * sizeof(VertexT),
+                                              gl::DYNAMIC_STORAGE_BIT);
+        mIbo = std::make_unique<IndexBuffer>(nullptr, static_cast<ptrdiff_t>(retained.indexCapacity) * indexSize(indexType),
+                                             retained.indexCapacity, indexType, gl::DYNAMIC_STORAGE_BIT);
+
+        if (!mVertices.empty()) mVbo->setData(mVertices.data(), static_cast<ptrdiff_t>(mVertices.size() * sizeof(VertexT)));
+        if (!mIndices.empty()) mIbo->setData(mIndices.data(), static_cast<unsigned>(mIndices.size()));
+
+        mVao.setBuffer(*mVbo, sizeof(VertexT));
+        mVao.setIndexBuffer(*mIbo);
+    }
+    else
+    {
+        // Sort and merge the changed ranges, then upload only those
+        auto merge = [](std::vector<Range>& ranges)
+        {
+            std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+            size_t merged = 0;
+            for (size_t i = 1; i < ranges.size(); ++i)
+            {
+                if (ranges[i].begin <= ranges[merged].end + RangeMergeDistance)
+                {
+                    ranges[merged].end = std::max(ranges[merged].end, ranges[i].end);
+                }
+                else
+                {
+                    ranges[++merged] = ranges[i];
+                }
+            }
+            if (!ranges.empty()) ranges.resize(merged + 1);
+        };
+
+        merge(retained.dirtyVertices);
+        merge(retained.dirtyIndices);
+
+        for (const auto& range : retained.dirtyVertices)
+        {
+            const unsigned end = std::min(range.end, static_cast<unsigned>(mVertices.size()));
+            if (range.begin >= end) continue;
+
+            mVbo->setData(&mVertices[range.begin], static_cast<ptrdiff_t>(end - range.begin) * sizeof(VertexT),
+                          static_cast<ptrdiff_t>(range.begin) * sizeof(VertexT));
+        }
+
+        for (const auto& range : retained.dirtyIndices)
+        {
+            const unsigned end = std::min(range.end, static_cast<unsigned>(mIndices.size()));
+            if (range.begin >= end) continue;
+
+            mIbo->setData(&mIndices[range.begin], end - range.begin, range.begin);
+        }
+    }
+
+    retained.dirtyVertices.clear();
+    retained.dirtyIndices.clear();
+    retained.fullUpload = false;
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::compact()
+{
+    std::vector<VertexT> vertices;
+    std::vector<unsigned> indices;
+    vertices.reserve(mVertices.size() - mRetained.deadVertices);
+    indices.reserve(mIndices.size());
+
+    // Handles index the elements, so they stay valid while the elements move
+    for (auto& element : mRetained.elements)
+    {
+        if (!element.alive) continue;
+
+        const auto firstVertex = static_cast<unsigned>(vertices.size());
+        const auto firstIndex = static_cast<unsigned>(indices.size());
+        vertices.insert(vertices.end(), mVertices.begin() + element.firstVertex,
+                        mVertices.begin() + element.firstVertex + element.vertexCount);
+        for (unsigned i = 0; i < element.indexCount; ++i)
+        {
+            indices.push_back(mIndices[element.firstIndex + i] - element.firstVertex + firstVertex);
+        }
+
+        element.firstVertex = firstVertex;
+        element.firstIndex = firstIndex;
+    }
+
+    mVertices = std::move(vertices);
+    mIndices = std::move(indices);
+    mRetained.deadVertices = 0;
+    mRetained.fullUpload = true;
+}
+
+template<typename VertexT>
+void BasicRenderBatch<VertexT>::hideElement(const Element& element)
+{
+    // Collapse every triangle onto the first vertex, the GPU discards them before rasterizing
+    std::fill(mIndices.begin() + element.firstIndex, mIndices.begin() + element.firstIndex + element.indexCount,
+              element.firstVertex);
+    mRetained.dirtyIndices.push_back(Range{ element.firstIndex, element.firstIndex + element.indexCount });
+}
+
+template class BasicRenderBatch<Vertex>;
+template class BasicRenderBatch<CompactVertex>;
@@ -0,0 +1,68 @@
+#include "renderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void RenderStats::endFrame(float frameMs)
+{
+    mHistory.push_back(FrameStats{ frameMs, mCounters });
+    if (mHistory.size() > HistorySize)
+    {
+        mHistory.pop_front();
+    }
+
+    mCounters = FrameCounters{};
+}
+
+const float RenderStats::getFrameTimePercentile(float fraction) const
+{
+    if (mHistory.empty()) return 0.f;
+
+    std::vector<float> times;
+    times.reserve(mHistory.size());
+    for (const auto& frame : mHistory)
+    {
+        times.push_back(frame.frameMs);
+    }
+
+    // Nearest rank, only the one element needs to be in place
+    const float clamped = std::min(std::max(fraction, 0.f), 1.f);
+    const auto rank = static_cast<size_t>(std::ceil(clamped * times.size()));
+    const size_t index = rank > 0 ? rank - 1 : 0;
+    std::nth_element(times.begin(), times.begin() + index, times.end());
+
+    return times[index];
+}
+
+const FrameCounters RenderStats::getAverageCounters() const
+{
+    FrameCounters average;
+    if (mHistory.empty()) return average;
+
+    FrameCounters sum;
+    for (const auto& frame : mHistory)
+    {
+        const auto& counters = frame.counters;
+        sum.drawCalls += counters.drawCalls;
+        sum.instances += counters.instances;
+        sum.indices += counters.indices;
+        sum.triangles += counters.triangles;
+        sum.bytesUploaded += counters.bytesUploaded;
+        sum.textureBinds += counters.textureBinds;
+        sum.programSwitches += counters.programSwitches;
+        sum.stateChanges += counters.stateChanges;
+    }
+
+    const auto count = static_cast<unsigned>(mHistory.size());
+    average.drawCalls = sum.drawCalls / count;
+    average.instances = sum.instances / count;
+    average.indices = sum.indices / count;
+    average.triangles = sum.triangles / count;
+    average.bytesUploaded = sum.bytesUploaded / count;
+    average.textureBinds = sum.textureBinds / count;
+    average.programSwitches = sum.programSwitches / count;
+    average.stateChanges = sum.stateChanges / count;
+
+    return average;
+}
@@ -1,40 +1,147 @@
 #include "renderer.h"
 #include "shapes.h"
+#include "shapeInstances.h"
 #include "renderBatch.h"
 #include "vertexArray.h"
+#include "buffer.h"
+#include "gpuProfiler.h"
+
+#include <cstdint>
+
+namespace
+{
+    // Byte offset of the first index in the bound index buffer
+    const void* indexOffset(unsigned firstIndex, EIndexType type)
+    {
+        return reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * indexSize(type));
+    }
+
+    unsigned glType(EIndexType type)
+    {
+        return static_cast<unsigned>(type);
+    }
+
+    unsigned glMode(EPrimitiveType primitive)
+    {
+        return static_cast<unsigned>(primitive);
+    }
+
+    // Count a draw of instanceCount copies of indexCount indices
+    void countDraw(EPrimitiveType primitive, unsigned indexCount, unsigned instanceCount)
+    {
+        auto& counters = RenderStats::counters();
+        ++counters.drawCalls;
+        counters.instances += instanceCount;
+        counters.indices += static_cast<uint64_t>(indexCount) * instanceCount;
+
+        // Restart indices are counted as strip vertices, close enough to spot regressions
+        const unsigned triangles = primitive == EPrimitiveType::Triangles ? indexCount / 3 : (indexCount > 2 ? indexCount - 2 : 0);
+        counters.triangles += static_cast<uint64_t>(triangles) * instanceCount;
+    }
+
+    // Count an indirect draw, what it draws is only known to the GPU
+    void countIndirectDraw(unsigned drawCount)
+    {
+        RenderStats::counters().drawCalls += drawCount;
+    }
+}
 
 void Renderer::draw(const Shape2D& shape) const
 {
+    GPU_PROFILE_SCOPE("Draw Shape");
+    const auto& mesh = shape.getMesh();
     shape.bind();
-    gl::DrawElements(gl::TRIANGLES, shape.getIndexCount(), gl::UNSIGNED_INT, nullptr);
+    gl::DrawElementsBaseVertex(glMode(mesh.primitive), mesh.indexCount, glType(mesh.indexType), indexOffset(mesh.firstIndex, mesh.indexType), mesh.baseVertex);
+    countDraw(mesh.primitive, mesh.indexCount, 1);
 }
 
-void Renderer::draw(const RenderBatch& batch) const
+template<typename VertexT>
+void Renderer::draw(const BasicRenderBatch<VertexT>& batch) const
 {
+    GPU_PROFILE_SCOPE("Draw Batch");
     batch.bind();
-    gl::DrawElements(gl::TRIANGLES, batch.getIndexCount(), gl::UNSIGNED_INT, nullptr);
+    gl::DrawElements(gl::TRIANGLES, batch.getIndexCount(), glType(batch.getIndexType()), nullptr);
+    countDraw(EPrimitiveType::Triangles, batch.getIndexCount(), 1);
 }
 
-void Renderer::draw(const VertexArray& vao, const unsigned indexCount) const
+void Renderer::draw(const VertexArray& vao, const unsigned indexCount, const EIndexType indexType) const
 {
+    GPU_PROFILE_SCOPE("Draw");
     vao.bind();
-    gl::DrawElements(gl::TRIANGLES, indexCount, gl::UNSIGNED_INT, nullptr);
+    gl::DrawElements(gl::TRIANGLES, indexCount, glType(indexType), nullptr);
+    countDraw(EPrimitiveType::Triangles, indexCount, 1);
 }
 
-void Renderer::drawInstanced(const Shape2D& shape, const int instanceCount)
+void Renderer::draw(const ShapeInstances& instances) const
 {
+    GPU_PROFILE_SCOPE("Draw Instances");
+    const auto& mesh = instances.getMesh();
+    if (instances.getInstanceCount() == 0) return;
+
+    instances.bind();
+    gl::DrawElementsInstancedBaseVertexBaseInstance(glMode(mesh.primitive), mesh.indexCount, glType(mesh.indexType), indexOffset(mesh.firstIndex, mesh.indexType),
+                                                    instances.getInstanceCount(), mesh.baseVertex, instances.getBaseInstance());
+    countDraw(mesh.primitive, mesh.indexCount, instances.getInstanceCount());
+}
+
+void Renderer::drawInstanced(const Shape2D& shape, const int instanceCount, const unsigned baseInstance)
+{
+    GPU_PROFILE_SCOPE("Draw Shape Instanced");
+    const auto& mesh = shape.getMesh();
     shape.bind();
-    gl::DrawElementsInstanced(gl::TRIANGLES, shape.getIndexCount(), gl::UNSIGNED_INT, nullptr, instanceCount);
+    gl::DrawElementsInstancedBaseVertexBaseInstance(glMode(mesh.primitive), mesh.indexCount, glType(mesh.indexType), indexOffset(mesh.firstIndex, mesh.indexType),
+                                                    instanceCount, mesh.baseVertex, baseInstance);
+    countDraw(mesh.primitive, mesh.indexCount, static_cast<unsigned>(instanceCount));
 }
 
-void Renderer::drawInstanced(const RenderBatch& batch, const int instanceCount)
+template<typename VertexT>
+void Renderer::drawInstanced(const BasicRenderBatch<VertexT>& batch, const int instanceCount, const unsigned baseInstance)
 {
+    GPU_PROFILE_SCOPE("Draw Batch Instanced");
     batch.bind();
-    gl::DrawElementsInstanced(gl::TRIANGLES, batch.getIndexCount(), gl::UNSIGNED_INT, nullptr, instanceCount);
+    gl::DrawElementsInstancedBaseInstance(gl::TRIANGLES, batch.getIndexCount(), glType(batch.getIndexType()), nullptr, instanceCount, baseInstance);
+    countDraw(EPrimitiveType::Triangles, batch.getIndexCount(), static_cast<unsigned>(instanceCount));
+}
+
+void Renderer::drawInstanced(const VertexArray& vao, const unsigned indexCount, const int instanceCount, const unsigned baseInstance,
+                             const EIndexType indexType)
+{
+    GPU_PROFILE_SCOPE("Draw Instanced");
+    vao.bind();
+    gl::DrawElementsInstancedBaseInstance(gl::TRIANGLES, indexCount, glType(indexType), nullptr, instanceCount, baseInstance);
+    countDraw(EPrimitiveType::Triangles, indexCount, static_cast<unsigned>(instanceCount));
+}
+
+void Renderer::drawIndirect(const Shape2D& shape, const IndirectBuffer& commands, const unsigned drawCount) const
+{
+    GPU_PROFILE_SCOPE("Draw Shape Indirect");
+    const auto& mesh = shape.getMesh();
+    shape.bind();
+    commands.bind();
+    gl::MultiDrawElementsIndirect(glMode(mesh.primitive), glType(mesh.indexType), nullptr, drawCount, 0);
+    countIndirectDraw(drawCount);
 }
 
-void Renderer::drawInstanced(const VertexArray& vao, const unsigned indexCount, const int instanceCount)
+void Renderer::drawIndirect(const VertexArray& vao, const IndirectBuffer& commands, const unsigned drawCount, const EIndexType indexType) const
 {
+    GPU_PROFILE_SCOPE("Draw Indirect");
     vao.bind();
-    gl::DrawElementsInstanced(gl::TRIANGLES, indexCount, gl::UNSIGNED_INT, nullptr, instanceCount);
+    commands.bind();
+    gl::MultiDrawElementsIndirect(gl::TRIANGLES, glType(indexType), nullptr, drawCount, 0);
+    countIndirectDraw(drawCount);
 }
+
+void Renderer::endFrame(float frameMs)
+{
+    mStats.endFrame(frameMs);
+}
+
+const RenderStats& Renderer::getStats() const
+{
+    return mStats;
+}
+
+template void Renderer::draw(const BasicRenderBatch<Vertex>& batch) const;
+template void Renderer::draw(const BasicRenderBatch<CompactVertex>& batch) const;
+template void Renderer::drawInstanced(const BasicRenderBatch<Vertex>& batch, const int instanceCount, const unsigned baseInstance);
+template void Renderer::drawInstanced(const BasicRenderBatch<CompactVertex>& batch, const int instanceCount, const unsigned baseInstance);
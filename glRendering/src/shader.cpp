@@ -1,6 +1,7 @@
 #include "shader.h"
 #include "files.h"
 #include "logging.h"
+#include "renderStats.h"
 #include "gl_cpp.hpp"
 
 #include <memory>
@@ -18,7 +19,7 @@ Shader::Shader(const std::string& shaderName)
     unsigned fShader = compileShader(fragFile, gl::FRAGMENT_SHADER);
 
     if (vShader != 0 && fShader != 0)
-        makeProgramAndCleanup(vShader, fShader);
+        makeProgramAndCleanup({ vShader, fShader });
 }
 
 
@@ -29,7 +30,15 @@ Shader::Shader(const std::string& vertexShader, const std::string& fragmentShade
     unsigned fShader = compileShader(fragmentShader, gl::FRAGMENT_SHADER);
 
     if (vShader != 0 && fShader != 0)
-        makeProgramAndCleanup(vShader, fShader);
+        makeProgramAndCleanup({ vShader, fShader });
+}
+
+Shader::Shader(const std::string& shaderFile, EShaderType type)
+{
+    unsigned shader = compileShader(shaderFile, static_cast<unsigned>(type));
+
+    if (shader != 0)
+        makeProgramAndCleanup({ shader });
 }
 
 Shader::~Shader()
@@ -40,6 +49,7 @@ Shader::~Shader()
 void Shader::bind() const
 {
     gl::UseProgram(mName);
+    ++RenderStats::counters().programSwitches;
 }
 
 void Shader::unbind() const
@@ -52,6 +62,13 @@ const unsigned Shader::name() const
     return mName;
 }
 
+void Shader::setUniform1i(const std::string& uniformName, int value)
+{
+    const auto location = getUniformLocation(uniformName);
+    if (location != -1)
+        gl::Uniform1i(location, value);
+}
+
 void Shader::setUniform1f(const std::string& uniformName, float value)
 {
     const auto location = getUniformLocation(uniformName);
@@ -103,12 +120,13 @@ void Shader::setUniformMat4(const std::string& uniformName, const glm::mat4& val
 
 const unsigned Shader::compileShader(const std::string& sourceFile, unsigned type)
 {
-    // Load source code
-    const auto& sourceStr = readFile(sourceFile);
-    const auto* source = sourceStr.data();
+    // Map source code, the length is passed since the view is not null terminated
+    const FileView sourceFileView = openFile(sourceFile);
+    const auto* source = sourceFileView.data();
+    const auto length = static_cast<int>(sourceFileView.size());
 
     // If there is no source code
-    if (sourceStr.empty())
+    if (sourceFileView.empty())
     {
         logErr("Failed to load empty shader source: {}", sourceFile);
         return 0;
@@ -116,7 +134,7 @@ const unsigned Shader::compileShader(const std::string& sourceFile, unsigned typ
 
     // Create Shader
     unsigned shader = gl::CreateShader(type);
-    gl::ShaderSource(shader, 1, &source, nullptr);
+    gl::ShaderSource(shader, 1, &source, &length);
     gl::CompileShader(shader);
 
     // If it failed to compile clean up
@@ -150,13 +168,13 @@ const bool Shader::validateShaderCompilation(unsigned shader)
     return true;
 }
 
-void Shader::makeProgramAndCleanup(const unsigned vertexShader, const unsigned fragmentShader)
+void Shader::makeProgramAndCleanup(std::initializer_list<unsigned> shaders)
 {
     mName = gl::CreateProgram();
 
     // Attach and link
-    gl::AttachShader(mName, vertexShader);
-    gl::AttachShader(mName, fragmentShader);
+    for (const auto shader : shaders)
+        gl::AttachShader(mName, shader);
     gl::LinkProgram(mName);
     gl::ValidateProgram(mName);
 
@@ -168,8 +186,8 @@ void Shader::makeProgramAndCleanup(const unsigned vertexShader, const unsigned f
     }
 
     // Cleanup
-    gl::DeleteShader(vertexShader);
-    gl::DeleteShader(fragmentShader);
+    for (const auto shader : shaders)
+        gl::DeleteShader(shader);
 }
 
 const bool Shader::validateProgramLinkage(const unsigned program)
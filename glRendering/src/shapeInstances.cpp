@@ -0,0 +1,73 @@
+#include "shapeInstances.h"
+#include "vertexLayout.h"
+#include "logging.h"
+
+ShapeInstances::ShapeInstances(const Shape2D& shape, unsigned maxInstances) : mGeometry(shape.getGeometry()),
+                                                                               mInstanceBuffer(sizeof(InstanceData), maxInstances)
+{
+    mInstances.reserve(maxInstances);
+
+    const auto& mesh = mGeometry->mesh;
+    if (!mesh.vao)
+    {
+        logErr("ShapeInstances: The shape does not have any data");
+        return;
+    }
+
+    // Vertex attributes in binding 0, instance attributes follow them (see instanced.vert)
+    const auto& layout = getVertexLayout(mesh.format);
+    mVao.setLayout(layout);
+    mVao.setBuffer(mesh.vertexBuffer, static_cast<int>(layout.stride));
+
+    mVao.setBufferBinding(1);
+    mVao.setLayout(VertexFormat<InstanceData>::layout);
+    mVao.setBuffer(mInstanceBuffer);
+
+    mVao.setIndexBuffer(mesh.indexBuffer);
+}
+
+void ShapeInstances::clear()
+{
+    mInstances.clear();
+}
+
+bool ShapeInstances::add(const glm::mat4& transform, const glm::vec4& color)
+{
+    if (mInstances.size() == mInstanceBuffer.getMaxInstances())
+    {
+        logWarn("ShapeInstances: Capacity of {} instances reached", mInstanceBuffer.getMaxInstances());
+        return false;
+    }
+
+    mInstances.push_back({ transform, color });
+    return true;
+}
+
+void ShapeInstances::commit()
+{
+    // The draws of the previous commit have been submitted by now
+    if (bCommitted) mInstanceBuffer.finishFrame();
+
+    mInstanceBuffer.setData(mInstances.data(), static_cast<unsigned>(mInstances.size()));
+    bCommitted = true;
+}
+
+void ShapeInstances::bind() const
+{
+    mVao.bind();
+}
+
+const MeshRange& ShapeInstances::getMesh() const
+{
+    return mGeometry->mesh;
+}
+
+const unsigned ShapeInstances::getInstanceCount() const
+{
+    return mInstanceBuffer.getInstanceCount();
+}
+
+const unsigned ShapeInstances::getBaseInstance() const
+{
+    return mInstanceBuffer.getBaseInstance();
+}
@@ -1,63 +1,193 @@
 #include "shapes.h"
+#include "serviceLocator.h"
 #include "logging.h"
 
-#include <cmath>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+    struct ShapeKeyHash
+    {
+        size_t operator()(const ShapeKey& key) const
+        {
+            size_t hash = key.type.hash_code() ^ (static_cast<size_t>(key.format) << 1);
+            for (const auto parameter : key.parameters)
+            {
+                hash ^= std::hash<float>{}(parameter) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+    };
+
+    // Geometry of live shapes. Entries do not keep the geometry alive, it is released with the last shape using it
+    std::unordered_map<ShapeKey, std::weak_ptr<ShapeGeometry>, ShapeKeyHash>& geometryCache()
+    {
+        static std::unordered_map<ShapeKey, std::weak_ptr<ShapeGeometry>, ShapeKeyHash> cache;
+        return cache;
+    }
+}
+
+bool ShapeKey::operator==(const ShapeKey& other) const
+{
+    return type == other.type && format == other.format && parameters == other.parameters;
+}
+
+Shape2D::Shape2D() : mGeometry(std::make_shared<ShapeGeometry>())
+{
+}
 
 void Shape2D::bind() const
 {
-    if (!mGLData)
+    if (!mGeometry->mesh.vao)
     {
         logErr("Shape2D does not have any data");
         return;
     }
 
-    mGLData->vao.bind();
+    mGeometry->mesh.vao->bind();
 }
 
 void Shape2D::unbind() const
 {
-    if (!mGLData)
+    if (!mGeometry->mesh.vao)
     {
         logErr("Shape2D does not have any data");
         return;
     }
 
-    mGLData->vao.unbind();
+    mGeometry->mesh.vao->unbind();
 }
 
 const unsigned Shape2D::getIndexCount() const
 {
-    if (mGLData)
+    return mGeometry->mesh.indexCount;
+}
+
+const MeshRange& Shape2D::getMesh() const
+{
+    return mGeometry->mesh;
+}
+
+const AABB& Shape2D::getAABB() const
+{
+    return mGeometry->aabb;
+}
+
+const BoundingSphere& Shape2D::getBoundingSphere() const
+{
+    return mGeometry->boundingSphere;
+}
+
+const std::shared_ptr<const ShapeGeometry> Shape2D::getGeometry() const
+{
+    return mGeometry;
+}
+
+const unsigned Shape2D::getCachedGeometryCount()
+{
+    unsigned count = 0;
+    for (const auto& entry : geometryCache())
     {
-        return mGLData->ibo.getCount();
+        if (!entry.second.expired()) ++count;
     }
-    else
+    return count;
+}
+
+bool Shape2D::findGeometry(std::type_index type, std::vector<float> parameters, EVertexFormat format)
+{
+    ShapeKey key{ type, std::move(parameters), format };
+
+    auto& cache = geometryCache();
+    if (auto it = cache.find(key); it != cache.end())
     {
-        return 0;
+        if (auto geometry = it->second.lock())
+        {
+            mGeometry = std::move(geometry);
+            mPendingKey.reset();
+            return true;
+        }
+
+        cache.erase(it);
     }
+
+    mPendingKey = std::move(key);
+    return false;
 }
 
 void Shape2D::addVertex(const glm::vec2& pos, const glm::vec3& col, const glm::vec2& tc)
 {
-    mVertices.push_back({ pos.x, pos.y, 0.f, col.r, col.g, col.b, tc.x, tc.y });
+    mGeometry->vertices.push_back({ pos.x, pos.y, 0.f, col.r, col.g, col.b, tc.x, tc.y });
 }
 
 void Shape2D::addIndex(const unsigned idx)
 {
-    mIndices.push_back(idx);
+    mGeometry->indices.push_back(idx);
 }
 
-void Shape2D::init()
+Tessellator<Vertex> Shape2D::makeTessellator()
 {
-    VertexBuffer vbo(mVertices.data(), mVertices.size() * sizeof(Vertex));
-    IndexBuffer ibo(mIndices.data(), mIndices.size() * sizeof(unsigned), static_cast<unsigned>(mIndices.size()));
-    
-    VertexArray vao(vbo, ibo);
-    vao.addAttribute(3, gl::FLOAT, offsetof(Vertex, x), false);
-    vao.addAttribute(3, gl::FLOAT, offsetof(Vertex, r), false);
-    vao.addAttribute(2, gl::FLOAT, offsetof(Vertex, u), false);
+    return Tessellator<Vertex>(mGeometry->vertices, mGeometry->indices);
+}
 
-    mGLData = std::make_unique<ShapeGLData>(std::move(vbo), std::move(ibo), std::move(vao));
+void Shape2D::setPrimitiveType(EPrimitiveType primitive)
+{
+    mGeometry->primitive = primitive;
+}
+
+void Shape2D::init(EVertexFormat format)
+{
+    auto& geometry = *mGeometry;
+
+    // Compute the bounds so the shape can be culled
+    std::vector<glm::vec3> positions;
+    positions.reserve(geometry.vertices.size());
+    for (const auto& vert : geometry.vertices)
+    {
+        positions.emplace_back(vert.x, vert.y, vert.z);
+    }
+    geometry.aabb = makeAABB(positions.data(), static_cast<unsigned>(positions.size()));
+    geometry.boundingSphere = makeBoundingSphere(geometry.aabb);
+
+    std::vector<CompactVertex> packed;
+    if (format == EVertexFormat::Compact)
+    {
+        packVertices(geometry.vertices, packed);
+    }
+
+    const void* vertexData = format == EVertexFormat::Compact ? static_cast<const void*>(packed.data()) : geometry.vertices.data();
+    const auto vertexCount = static_cast<unsigned>(geometry.vertices.size());
+    const auto indexCount = static_cast<unsigned>(geometry.indices.size());
+
+    // Identical shapes created later reuse this geometry
+    if (mPendingKey)
+    {
+        if (mPendingKey->format == format)
+            geometryCache()[*mPendingKey] = mGeometry;
+        else
+            logWarn("Shape2D: Geometry looked up in a different vertex format than it was created in, it is not cached");
+
+        mPendingKey.reset();
+    }
+
+    // Share buffers and vertex array with other shapes when possible
+    if (auto pool = ServiceLocator<MeshPool>::get(); pool && pool->getFormat() == format)
+    {
+        geometry.mesh = pool->allocate(vertexData, vertexCount, geometry.indices.data(), indexCount, geometry.primitive);
+        if (geometry.mesh.vao) return;
+    }
+
+    VertexBuffer vbo(vertexData, static_cast<ptrdiff_t>(vertexCount) * getVertexLayout(format).stride);
+    IndexBuffer ibo(geometry.indices);
+
+    VertexArray vao;
+    vao.setLayout(getVertexLayout(format));
+    vao.setBuffer(vbo);
+    vao.setIndexBuffer(ibo);
+
+    geometry.glData = std::make_unique<ShapeGLData>(std::move(vbo), std::move(ibo), std::move(vao));
+    geometry.mesh = MeshRange{ &geometry.glData->vao, 0, 0, indexCount, geometry.glData->ibo.getType(), geometry.primitive,
+                               geometry.glData->vbo.name(), geometry.glData->ibo.name(), format };
 }
 
 //////
@@ -66,44 +196,25 @@ void Shape2D::init()
 
 Quad::Quad(const glm::vec2& size, const glm::vec3& col)
 {
+    if (findGeometry(typeid(Quad), { size.x, size.y, col.r, col.g, col.b })) return;
+
     addVertex(size / -2.f, col, glm::vec2{ 0.f, 0.f });
     addVertex(glm::vec2{ size.x / 2.f, size.y / -2.f }, col, glm::vec2{ 1.f, 0.f });
     addVertex(size / 2.f, col, glm::vec2{ 1.f, 1.f });
     addVertex(glm::vec2{ size.x / -2.f, size.y / 2.f }, col, glm::vec2{ 0.f, 1.f });
 
-    addIndices(0, 1, 2, 2, 3, 0);
+    // Two triangles as a strip
+    addIndices(0, 1, 3, 2);
+    setPrimitiveType(EPrimitiveType::TriangleStrip);
 
     init();
 }
 
 Circle::Circle(const float radius, const unsigned points, const glm::vec3& col)
 {
-    // The center point
-    addVertex(glm::vec2(0.f, 0.f), col, glm::vec2(0.5f, 0.5f));
-
-    // #TODO Create a proper math header with consts like this
-    constexpr float PI = 3.14156f;
+    if (findGeometry(typeid(Circle), { radius, static_cast<float>(points), col.r, col.g, col.b })) return;
 
-    // Loop around the circle
-    for (unsigned i = 0; i <= points; ++i)
-    {
-        // Add x-Coordinate
-        auto x = std::cos((2 * PI / points) * i) * (radius * 2);
-        auto y = std::sin((2 * PI / points) * i) * (radius * 2);
-
-        // Add Texture Coordinates
-        auto u = std::cos(((2 * PI / points) * i) + 1.f) / 2.f;
-        auto v = std::sin(((2 * PI / points) * i) + 1.f) / 2.f;
-
-        addVertex(glm::vec2(x, y), col, glm::vec2(u, v));
-    }
-
-    // Set up index buffer by walking the circle and stepping into the center for each triangle
-    std::vector<unsigned> indices;
-    for (unsigned i = 0; i <= points; ++i)
-    {
-        addIndices(0, i + 2, i + 1);
-    }
+    makeTessellator().circle(glm::vec2(0.f), radius, points, col);
 
     init();
 }
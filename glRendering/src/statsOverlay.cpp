@@ -0,0 +1,77 @@
+#include "statsOverlay.h"
+#include "renderStats.h"
+
+#include <vector>
+
+#include "imgui.h"
+
+namespace
+{
+    // One row of the counter table: the last frame and the average
+    void counterRow(const char* name, uint64_t last, uint64_t average)
+    {
+        ImGui::Text("%s", name);
+        ImGui::NextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(last));
+        ImGui::NextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(average));
+        ImGui::NextColumn();
+    }
+}
+
+void StatsOverlay::draw(const RenderStats& stats)
+{
+    const auto& history = stats.getHistory();
+    if (history.empty()) return;
+
+    ImGui::SetNextWindowPos(ImVec2(10.f, 10.f), ImGuiCond_Always);
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.f, 0.f, 0.f, 0.5f));
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove |
+                                   ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing;
+    if (!ImGui::Begin("Frame Statistics", nullptr, flags))
+    {
+        ImGui::End();
+        ImGui::PopStyleColor();
+        return;
+    }
+
+    const auto& last = history.back();
+    const float median = stats.getFrameTimePercentile(0.5f);
+    ImGui::Text("%.2f ms (%.0f FPS)", last.frameMs, median > 0.f ? 1000.f / median : 0.f);
+    ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f ms", median, stats.getFrameTimePercentile(0.95f), stats.getFrameTimePercentile(0.99f));
+
+    std::vector<float> times;
+    times.reserve(history.size());
+    for (const auto& frame : history)
+    {
+        times.push_back(frame.frameMs);
+    }
+    ImGui::PlotLines("##FrameTimes", times.data(), static_cast<int>(times.size()), 0, nullptr, 0.f, FLT_MAX, ImVec2(240.f, 40.f));
+
+    ImGui::Checkbox("Counters", &bShowCounters);
+    if (bShowCounters)
+    {
+        const auto& counters = last.counters;
+        const auto average = stats.getAverageCounters();
+
+        ImGui::Columns(3, "Counters", false);
+        ImGui::Text(" ");
+        ImGui::NextColumn();
+        ImGui::Text("Last");
+        ImGui::NextColumn();
+        ImGui::Text("Average");
+        ImGui::NextColumn();
+        counterRow("Draw calls", counters.drawCalls, average.drawCalls);
+        counterRow("Instances", counters.instances, average.instances);
+        counterRow("Indices", counters.indices, average.indices);
+        counterRow("Triangles", counters.triangles, average.triangles);
+        counterRow("Bytes uploaded", counters.bytesUploaded, average.bytesUploaded);
+        counterRow("Texture binds", counters.textureBinds, average.textureBinds);
+        counterRow("Program switches", counters.programSwitches, average.programSwitches);
+        counterRow("State changes", counters.stateChanges, average.stateChanges);
+        ImGui::Columns(1);
+    }
+
+    ImGui::End();
+    ImGui::PopStyleColor();
+}
@@ -0,0 +1,355 @@
+#include "tessellation.h"
+#include "vertexLayout.h"
+#include "logging.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "glm/glm.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TESSELLATION_SSE
+#endif
+
+namespace
+{
+    constexpr float Pi = 3.14159265f;
+
+    // Points generated from one exact sin / cos pair before reseeding, bounds the drift of the recurrence
+    constexpr unsigned RecurrenceRun = 64;
+
+    // Miters longer than this many half thicknesses are beveled instead
+    constexpr float MiterLimit = 4.f;
+
+    // Largest angle covered by one triangle of a round join
+    constexpr float RoundJoinStep = Pi / 16.f;
+
+    template<typename VertexT>
+    inline VertexT makeVertex(const glm::vec2& pos, const glm::vec3& col, float u, float v)
+    {
+        return VertexFormat<VertexT>::fromVertex(Vertex{ pos.x, pos.y, 0.f, col.r, col.g, col.b, u, v });
+    }
+
+    inline float cross(const glm::vec2& a, const glm::vec2& b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+}
+
+void makeCircleDirections(float* cosines, float* sines, unsigned count, float startAngle, float step)
+{
+    unsigned i = 0;
+
+#if defined(TESSELLATION_SSE)
+    // Each lane is rotated by four steps, so four consecutive points are produced per iteration
+    const __m128 stepCos4 = _mm_set1_ps(std::cos(step * 4.f));
+    const __m128 stepSin4 = _mm_set1_ps(std::sin(step * 4.f));
+
+    while (count - i >= 4)
+    {
+        alignas(16) float seedCos[4];
+        alignas(16) float seedSin[4];
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            const float angle = startAngle + step * static_cast<float>(i + lane);
+            seedCos[lane] = std::cos(angle);
+            seedSin[lane] = std::sin(angle);
+        }
+
+        __m128 c = _mm_load_ps(seedCos);
+        __m128 s = _mm_load_ps(seedSin);
+
+        const unsigned runEnd = std::min(count, i + RecurrenceRun);
+        for (; runEnd - i >= 4; i += 4)
+        {
+            _mm_storeu_ps(cosines + i, c);
+            _mm_storeu_ps(sines + i, s);
+
+            const __m128 nextCos = _mm_sub_ps(_mm_mul_ps(c, stepCos4), _mm_mul_ps(s, stepSin4));
+            s = _mm_add_ps(_mm_mul_ps(c, stepSin4), _mm_mul_ps(s, stepCos4));
+            c = nextCos;
+        }
+    }
+#endif
+
+    // Remaining points, or all of them without SIMD
+    const float stepCos = std::cos(step);
+    const float stepSin = std::sin(step);
+    while (i < count)
+    {
+        float c = std::cos(startAngle + step * static_cast<float>(i));
+        float s = std::sin(startAngle + step * static_cast<float>(i));
+
+        const unsigned runEnd = std::min(count, i + RecurrenceRun);
+        for (; i < runEnd; ++i)
+        {
+            cosines[i] = c;
+            sines[i] = s;
+
+            const float nextCos = c * stepCos - s * stepSin;
+            s = c * stepSin + s * stepCos;
+            c = nextCos;
+        }
+    }
+}
+
+template<typename VertexT>
+Tessellator<VertexT>::Tessellator(std::vector<VertexT>& vertices, std::vector<unsigned>& indices) : mVertices(vertices), mIndices(indices)
+{
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::circle(const glm::vec2& center, float radius, unsigned segments, const glm::vec3& col)
+{
+    if (segments < 3)
+    {
+        logWarn("Tessellator: A circle needs at least 3 segments, got {}", segments);
+        return;
+    }
+
+    makeDirections(segments, 0.f, 2.f * Pi / segments);
+
+    auto out = allocate(segments + 1, segments * 3);
+    out.vertices[0] = makeVertex<VertexT>(center, col, 0.5f, 0.5f);
+    for (unsigned i = 0; i < segments; ++i)
+    {
+        const glm::vec2 dir(mDirX[i], mDirY[i]);
+        out.vertices[i + 1] = makeVertex<VertexT>(center + dir * radius, col, 0.5f + dir.x * 0.5f, 0.5f + dir.y * 0.5f);
+    }
+
+    // Fan around the center
+    for (unsigned i = 0; i < segments; ++i)
+    {
+        out.indices[i * 3] = out.first;
+        out.indices[i * 3 + 1] = out.first + 1 + i;
+        out.indices[i * 3 + 2] = out.first + 1 + (i + 1 == segments ? 0 : i + 1);
+    }
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::arc(const glm::vec2& center, float radius, float thickness, float startAngle, float endAngle, unsigned segments, const glm::vec3& col)
+{
+    if (segments == 0)
+    {
+        logWarn("Tessellator: An arc needs at least 1 segment");
+        return;
+    }
+
+    if (endAngle < startAngle) std::swap(startAngle, endAngle);
+    makeDirections(segments + 1, startAngle, (endAngle - startAngle) / segments);
+
+    const float inner = radius - thickness * 0.5f;
+    const float outer = radius + thickness * 0.5f;
+
+    // Inner and outer vertex alternate along the arc
+    auto out = allocate((segments + 1) * 2, segments * 6);
+    const float uStep = 1.f / segments;
+    for (unsigned i = 0; i <= segments; ++i)
+    {
+        const glm::vec2 dir(mDirX[i], mDirY[i]);
+        const float u = static_cast<float>(i) * uStep;
+        out.vertices[i * 2] = makeVertex<VertexT>(center + dir * inner, col, u, 0.f);
+        out.vertices[i * 2 + 1] = makeVertex<VertexT>(center + dir * outer, col, u, 1.f);
+    }
+
+    for (unsigned i = 0; i < segments; ++i)
+    {
+        const unsigned base = out.first + i * 2;
+        unsigned* idx = out.indices + i * 6;
+        idx[0] = base + 1; idx[1] = base + 3; idx[2] = base + 2;
+        idx[3] = base + 2; idx[4] = base; idx[5] = base + 1;
+    }
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::roundedRect(const glm::vec2& center, const glm::vec2& size, float cornerRadius, unsigned cornerSegments, const glm::vec3& col)
+{
+    if (size.x <= 0.f || size.y <= 0.f)
+    {
+        logWarn("Tessellator: Rounded rectangle of size ({}, {}) has no area", size.x, size.y);
+        return;
+    }
+
+    const glm::vec2 half = size * 0.5f;
+    const float radius = std::max(0.f, std::min(cornerRadius, std::min(half.x, half.y)));
+    const unsigned cornerPoints = cornerSegments + 1;
+    const unsigned perimeter = cornerPoints * 4;
+
+    // One quarter circle, rotated by 90 degrees for every corner
+    makeDirections(cornerPoints, 0.f, 0.5f * Pi / std::max(cornerSegments, 1u));
+
+    // Corners counter-clockwise from the top right
+    const glm::vec2 inset = half - glm::vec2(radius);
+    const glm::vec2 cornerCenters[4] = { { inset.x, inset.y }, { -inset.x, inset.y }, { -inset.x, -inset.y }, { inset.x, -inset.y } };
+
+    auto out = allocate(perimeter + 1, perimeter * 3);
+    out.vertices[0] = makeVertex<VertexT>(center, col, 0.5f, 0.5f);
+    for (unsigned corner = 0; corner < 4; ++corner)
+    {
+        for (unsigned i = 0; i < cornerPoints; ++i)
+        {
+            const float c = mDirX[i];
+            const float s = mDirY[i];
+            const glm::vec2 dir = corner == 0 ? glm::vec2(c, s) : corner == 1 ? glm::vec2(-s, c) : corner == 2 ? glm::vec2(-c, -s) : glm::vec2(s, -c);
+            const glm::vec2 offset = cornerCenters[corner] + dir * radius;
+            out.vertices[1 + corner * cornerPoints + i] = makeVertex<VertexT>(center + offset, col, 0.5f + offset.x / size.x, 0.5f + offset.y / size.y);
+        }
+    }
+
+    for (unsigned i = 0; i < perimeter; ++i)
+    {
+        out.indices[i * 3] = out.first;
+        out.indices[i * 3 + 1] = out.first + 1 + i;
+        out.indices[i * 3 + 2] = out.first + 1 + (i + 1 == perimeter ? 0 : i + 1);
+    }
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::line(const glm::vec2& from, const glm::vec2& to, float thickness, const glm::vec3& col)
+{
+    const glm::vec2 delta = to - from;
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    if (length == 0.f) return;
+
+    segment(from, to, glm::vec2(-delta.y, delta.x) * (thickness * 0.5f / length), col);
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::polyline(const glm::vec2* points, unsigned count, float thickness, ELineJoin join, bool closed, const glm::vec3& col)
+{
+    if (count < 2) return;
+    closed = closed && count > 2;
+
+    // Left normal of every segment, zero for segments without length
+    const unsigned segmentCount = closed ? count : count - 1;
+    mNormals.resize(segmentCount);
+    for (unsigned i = 0; i < segmentCount; ++i)
+    {
+        const glm::vec2 delta = points[i + 1 == count ? 0 : i + 1] - points[i];
+        const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+        mNormals[i] = length == 0.f ? glm::vec2(0.f) : glm::vec2(-delta.y, delta.x) * (thickness * 0.5f / length);
+    }
+
+    for (unsigned i = 0; i < segmentCount; ++i)
+    {
+        if (mNormals[i] != glm::vec2(0.f))
+            segment(points[i], points[i + 1 == count ? 0 : i + 1], mNormals[i], col);
+    }
+
+    // Joins at every point that has a segment on both sides
+    for (unsigned i = closed ? 0 : 1; i < (closed ? count : count - 1); ++i)
+    {
+        const unsigned previous = i == 0 ? segmentCount - 1 : i - 1;
+        this->join(points[i], mNormals[previous], mNormals[i], join, col);
+    }
+}
+
+template<typename VertexT>
+typename Tessellator<VertexT>::Allocation Tessellator<VertexT>::allocate(unsigned vertexCount, unsigned indexCount)
+{
+    const size_t firstVertex = mVertices.size();
+    const size_t firstIndex = mIndices.size();
+    mVertices.resize(firstVertex + vertexCount);
+    mIndices.resize(firstIndex + indexCount);
+
+    return Allocation{ mVertices.data() + firstVertex, mIndices.data() + firstIndex, static_cast<unsigned>(firstVertex) };
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::makeDirections(unsigned count, float startAngle, float step)
+{
+    mDirX.resize(count);
+    mDirY.resize(count);
+    makeCircleDirections(mDirX.data(), mDirY.data(), count, startAngle, step);
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::segment(const glm::vec2& a, const glm::vec2& b, const glm::vec2& n, const glm::vec3& col)
+{
+    auto out = allocate(4, 6);
+    out.vertices[0] = makeVertex<VertexT>(a - n, col, 0.f, 0.f);
+    out.vertices[1] = makeVertex<VertexT>(b - n, col, 1.f, 0.f);
+    out.vertices[2] = makeVertex<VertexT>(b + n, col, 1.f, 1.f);
+    out.vertices[3] = makeVertex<VertexT>(a + n, col, 0.f, 1.f);
+
+    const unsigned quad[6] = { 0, 1, 2, 2, 3, 0 };
+    for (unsigned i = 0; i < 6; ++i)
+    {
+        out.indices[i] = out.first + quad[i];
+    }
+}
+
+template<typename VertexT>
+void Tessellator<VertexT>::join(const glm::vec2& point, const glm::vec2& n0, const glm::vec2& n1, ELineJoin type, const glm::vec3& col)
+{
+    // Nothing to fill for straight continuations or next to segments without length
+    const float turn = cross(n0, n1);
+    const float halfSquared = std::max(glm::dot(n0, n0), glm::dot(n1, n1));
+    if (std::abs(turn) <= 1e-6f * halfSquared || glm::dot(n0, n0) == 0.f || glm::dot(n1, n1) == 0.f) return;
+
+    // The gap is on the outside of the turn. Order its edges so first -> second is counter-clockwise around the point
+    const bool leftTurn = turn > 0.f;
+    const glm::vec2 first = leftTurn ? -n0 : n1;
+    const glm::vec2 second = leftTurn ? -n1 : n0;
+    const float edgeV = leftTurn ? 0.f : 1.f;
+    const float halfThickness = std::sqrt(glm::dot(n0, n0));
+
+    if (type == ELineJoin::Miter)
+    {
+        // The miter point lies on the bisector, its distance grows as the angle gets sharper
+        const glm::vec2 bisector = glm::normalize(first + second);
+        const float cosHalfAngle = glm::dot(bisector, first) / halfThickness;
+        if (cosHalfAngle * MiterLimit >= 1.f)
+        {
+            auto out = allocate(4, 6);
+            out.vertices[0] = makeVertex<VertexT>(point, col, 0.5f, 0.5f);
+            out.vertices[1] = makeVertex<VertexT>(point + first, col, 0.5f, edgeV);
+            out.vertices[2] = makeVertex<VertexT>(point + bisector * (halfThickness / cosHalfAngle), col, 0.5f, edgeV);
+            out.vertices[3] = makeVertex<VertexT>(point + second, col, 0.5f, edgeV);
+
+            const unsigned fan[6] = { 0, 1, 2, 0, 2, 3 };
+            for (unsigned i = 0; i < 6; ++i)
+            {
+                out.indices[i] = out.first + fan[i];
+            }
+            return;
+        }
+
+        type = ELineJoin::Bevel;
+    }
+
+    if (type == ELineJoin::Bevel)
+    {
+        auto out = allocate(3, 3);
+        out.vertices[0] = makeVertex<VertexT>(point, col, 0.5f, 0.5f);
+        out.vertices[1] = makeVertex<VertexT>(point + first, col, 0.5f, edgeV);
+        out.vertices[2] = makeVertex<VertexT>(point + second, col, 0.5f, edgeV);
+        out.indices[0] = out.first;
+        out.indices[1] = out.first + 1;
+        out.indices[2] = out.first + 2;
+        return;
+    }
+
+    // Round: Fan of circle points from the first to the second edge
+    const float sweep = std::acos(std::max(-1.f, std::min(1.f, glm::dot(first, second) / (halfThickness * halfThickness))));
+    const unsigned segments = std::max(1u, static_cast<unsigned>(std::ceil(sweep / RoundJoinStep)));
+    makeDirections(segments + 1, std::atan2(first.y, first.x), sweep / segments);
+
+    auto out = allocate(segments + 2, segments * 3);
+    out.vertices[0] = makeVertex<VertexT>(point, col, 0.5f, 0.5f);
+    for (unsigned i = 0; i <= segments; ++i)
+    {
+        out.vertices[i + 1] = makeVertex<VertexT>(point + glm::vec2(mDirX[i], mDirY[i]) * halfThickness, col, 0.5f, edgeV);
+    }
+
+    for (unsigned i = 0; i < segments; ++i)
+    {
+        out.indices[i * 3] = out.first;
+        out.indices[i * 3 + 1] = out.first + 1 + i;
+        out.indices[i * 3 + 2] = out.first + 2 + i;
+    }
+}
+
+template class Tessellator<Vertex>;
+template class Tessellator<CompactVertex>;
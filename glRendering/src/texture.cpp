@@ -1,13 +1,26 @@
 #include "texture.h"
+#include "files.h"
 #include "gl_cpp.hpp"
 #include "logging.h"
+#include "renderStats.h"
 
 #include <memory>
-#include <experimental/filesystem>
 
 #include "stb_image.h"
 
-using namespace std::experimental;
+namespace
+{
+    // Decode an image file to RGBA, returns nullptr if the file is missing or not an image
+    unsigned char* loadImage(const std::string& path, int& width, int& height)
+    {
+        const FileView file = openFile(path);
+        if (file.empty()) return nullptr;
+
+        int comp;
+        return stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()),
+                                     &width, &height, &comp, STBI_rgb_alpha);
+    }
+}
 
 // #TODO - Swap texture after construction
 
@@ -97,6 +110,7 @@ void Texture::bind(const int bindingPoint /*= 0*/) const
 {
     gl::BindTextureUnit(bindingPoint, mName);
     mBindingPoint = bindingPoint;
+    ++RenderStats::counters().textureBinds;
 }
 
 void Texture::unbind() const
@@ -203,10 +217,16 @@ void Texture::copyTextureData(const Texture& other)
 
 void Texture::loadFromFile(const std::string& basePath)
 {
-    int width, height, comp;
+    int width, height;
 
     // Always load MipMap level 0
-    unsigned char* mipBase = stbi_load(basePath.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+    unsigned char* mipBase = loadImage(basePath, width, height);
+    if (!mipBase)
+    {
+        logErr("Failed to load texture: {}", basePath);
+        return;
+    }
+
     gl::TextureStorage2D(mName, mLevels, gl::RGBA8, width, height);
     gl::TextureSubImage2D(mName, 0, 0, 0, width, height, gl::RGBA, gl::UNSIGNED_BYTE, mipBase);
 
@@ -215,10 +235,9 @@ void Texture::loadFromFile(const std::string& basePath)
     {
         // Find new path based on naming convention
         const std::string mipPath = basePath.substr(0, basePath.find(".png")) + "_" + std::to_string(i) + ".png";
-        if (filesystem::v1::exists(mipPath)) // #TODO Swap to non-experimental when available
+        if (unsigned char* mipData = loadImage(mipPath, width, height))
         {
-            // Load and send data to OpenGL
-            unsigned char* mipData = stbi_load(mipPath.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+            // Send data to OpenGL
             gl::TextureSubImage2D(mName, i, 0, 0, width, height, gl::RGBA, gl::UNSIGNED_BYTE, mipData);
             stbi_image_free(mipData);
         }
@@ -237,8 +256,13 @@ void Texture::loadFromFile(const std::string& basePath)
 void Texture::loadArrayFromFile(const std::string& basePath)
 {
     // Load and fetch base image data
-    int width, height, comp;
-    unsigned char* imageData = stbi_load(basePath.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+    int width, height;
+    unsigned char* imageData = loadImage(basePath, width, height);
+    if (!imageData)
+    {
+        logErr("Failed to load texture: {}", basePath);
+        return;
+    }
 
     // Acquire Texture Storage and Assign level 0
     gl::TextureStorage3D(mName, mLevels, gl::RGBA8, width, height, mArrayLevels);
@@ -252,7 +276,7 @@ void Texture::loadArrayFromFile(const std::string& basePath)
     for (unsigned i = 1; i < mArrayLevels; ++i)
     {
         const auto levelPath = basePath.substr(0, basePath.find(".png")) + "-" + std::to_string(i) + ".png";
-        imageData = stbi_load(levelPath.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+        imageData = loadImage(levelPath, width, height);
         gl::TextureSubImage3D(mName, 0, 0, 0, i, width, height, 1, gl::RGBA, gl::UNSIGNED_BYTE, imageData);
         stbi_image_free(imageData);
     }
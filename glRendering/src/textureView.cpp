@@ -1,5 +1,6 @@
 #include "textureView.h"
 #include "texture.h"
+#include "renderStats.h"
 
 #include "gl_cpp.hpp"
 
@@ -38,6 +39,7 @@ TextureView::~TextureView()
 void TextureView::bind(const unsigned bindingPoint /*= 0*/) const
 {
     gl::BindTextureUnit(bindingPoint, mName);
+    ++RenderStats::counters().textureBinds;
 }
 
 void TextureView::unbind(const unsigned bindingPoint /*= 0*/) const
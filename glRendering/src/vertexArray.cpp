@@ -1,29 +1,33 @@
 #include "vertexArray.h"
 #include "logging.h"
 #include "vertex.h"
+#include "renderStats.h"
 
 #include "gl_cpp.hpp"
 
 VertexArray::VertexArray()
 {
+    mStrides.fill(sizeof(Vertex));
     gl::CreateVertexArrays(1, &mName);
 }
 
 VertexArray::VertexArray(const VertexBuffer& vbo)
 {
+    mStrides.fill(sizeof(Vertex));
     gl::CreateVertexArrays(1, &mName);
     setBuffer(vbo);
 }
 
 VertexArray::VertexArray(const VertexBuffer& vbo, const IndexBuffer& ibo)
 {
+    mStrides.fill(sizeof(Vertex));
     gl::CreateVertexArrays(1, &mName);
     setBuffer(vbo);
     setIndexBuffer(ibo);
 }
 
 VertexArray::VertexArray(VertexArray&& other) : mName(other.mName), mNextAttributeBinding(other.mNextAttributeBinding),
-                                                mBufferBinding(other.mBufferBinding)
+                                                mBufferBinding(other.mBufferBinding), mStrides(other.mStrides)
 {
     other.mName = 0;
 }
@@ -33,12 +37,14 @@ VertexArray& VertexArray::operator=(VertexArray&& other)
     if (this == &other) return *this;
 
     // Destructor Work
+    if (sBoundName == mName) sBoundName = 0;
     gl::DeleteVertexArrays(1, &mName);
 
     // Steal Resources
     mName = other.mName;
     mBufferBinding = other.mBufferBinding;
     mNextAttributeBinding = other.mNextAttributeBinding;
+    mStrides = other.mStrides;
     other.mName = 0;
 
     return *this;
@@ -46,17 +52,24 @@ VertexArray& VertexArray::operator=(VertexArray&& other)
 
 VertexArray::~VertexArray()
 {
+    // Deleting the bound vertex array reverts the binding to 0
+    if (mName != 0 && sBoundName == mName) sBoundName = 0;
     gl::DeleteVertexArrays(1, &mName);
 }
 
 void VertexArray::bind() const
 {
+    if (sBoundName == mName) return;
+
     gl::BindVertexArray(mName);
+    sBoundName = mName;
+    ++RenderStats::counters().stateChanges;
 }
 
 void VertexArray::unbind() const
 {
     gl::BindVertexArray(0);
+    sBoundName = 0;
 }
 
 const unsigned VertexArray::name() const
@@ -64,6 +77,12 @@ const unsigned VertexArray::name() const
     return mName;
 }
 
+void VertexArray::invalidateBinding()
+{
+    // The name is never generated, so the next bind always goes through
+    sBoundName = ~0u;
+}
+
 void VertexArray::addAttribute(int size, unsigned type, unsigned offset, bool normalize /*= false*/)
 {
     gl::VertexArrayAttribBinding(mName, mNextAttributeBinding, mBufferBinding);
@@ -80,6 +99,25 @@ void VertexArray::addIntegerAttribute(int size, unsigned type, unsigned offset)
     ++mNextAttributeBinding;
 }
 
+void VertexArray::setLayout(const VertexLayout& layout)
+{
+    for (unsigned i = 0; i < layout.attributeCount; ++i)
+    {
+        const auto& attribute = layout.attributes[i];
+        addAttribute(attribute.size, attribute.type, attribute.offset, attribute.normalize);
+    }
+
+    mStrides[mBufferBinding] = static_cast<int>(layout.stride);
+}
+
+void VertexArray::addMatrixAttribute(unsigned offset)
+{
+    for (unsigned column = 0; column < 4; ++column)
+    {
+        addAttribute(4, gl::FLOAT, offset + column * sizeof(float) * 4);
+    }
+}
+
 void VertexArray::removeLastAttribute()
 {
     if (mNextAttributeBinding != 0)
@@ -95,7 +133,31 @@ void VertexArray::removeLastAttribute()
 
 void VertexArray::setBuffer(const VertexBuffer& vbo)
 {
-    gl::VertexArrayVertexBuffer(mName, mBufferBinding, vbo.name(), 0, sizeof(Vertex));
+    // Typed buffers know their stride, otherwise use the stride of the layout on this binding
+    const int stride = vbo.getStride() != 0 ? vbo.getStride() : mStrides[mBufferBinding];
+    gl::VertexArrayVertexBuffer(mName, mBufferBinding, vbo.name(), 0, stride);
+}
+
+void VertexArray::setBuffer(const VertexBuffer& vbo, int stride, ptrdiff_t offset)
+{
+    gl::VertexArrayVertexBuffer(mName, mBufferBinding, vbo.name(), offset, stride);
+}
+
+void VertexArray::setBuffer(unsigned bufferName, int stride, ptrdiff_t offset)
+{
+    gl::VertexArrayVertexBuffer(mName, mBufferBinding, bufferName, offset, stride);
+}
+
+void VertexArray::setBuffer(const InstanceBuffer& instances)
+{
+    // Bound from the start of the buffer, the current region is selected by the base instance of the draw
+    gl::VertexArrayVertexBuffer(mName, mBufferBinding, instances.name(), 0, instances.getInstanceSize());
+    setBindingDivisor(1);
+}
+
+void VertexArray::setBindingDivisor(unsigned divisor)
+{
+    gl::VertexArrayBindingDivisor(mName, mBufferBinding, divisor);
 }
 
 void VertexArray::setIndexBuffer(const IndexBuffer& ibo)
@@ -103,7 +165,18 @@ void VertexArray::setIndexBuffer(const IndexBuffer& ibo)
     gl::VertexArrayElementBuffer(mName, ibo.name());
 }
 
+void VertexArray::setIndexBuffer(unsigned bufferName)
+{
+    gl::VertexArrayElementBuffer(mName, bufferName);
+}
+
 void VertexArray::setBufferBinding(unsigned binding)
 {
+    if (binding >= MaxBufferBindings)
+    {
+        logWarn("Buffer binding {} is out of range, max is {}", binding, MaxBufferBindings - 1);
+        return;
+    }
+
     mBufferBinding = binding;
 }
@@ -0,0 +1,107 @@
+#include "vertexArrayCache.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+}
+
+const VertexArray& VertexArrayCache::get(const std::vector<VertexBinding>& bindings, unsigned indexBuffer)
+{
+    Key key{ bindings, indexBuffer };
+
+    auto found = mVertexArrays.find(key);
+    if (found != mVertexArrays.end())
+    {
+        return *found->second;
+    }
+
+    if (bindings.size() > VertexArray::MaxBufferBindings)
+    {
+        logWarn("VertexArrayCache: {} bindings requested, only the first {} are used", bindings.size(), VertexArray::MaxBufferBindings);
+    }
+
+    auto vao = std::make_unique<VertexArray>();
+    const unsigned bindingCount = std::min(static_cast<unsigned>(bindings.size()), VertexArray::MaxBufferBindings);
+    for (unsigned i = 0; i < bindingCount; ++i)
+    {
+        const auto& binding = bindings[i];
+        vao->setBufferBinding(i);
+        vao->setLayout(binding.layout);
+        vao->setBuffer(binding.buffer, static_cast<int>(binding.layout.stride), binding.offset);
+        vao->setBindingDivisor(binding.divisor);
+    }
+
+    if (indexBuffer != 0)
+    {
+        vao->setIndexBuffer(indexBuffer);
+    }
+
+    const VertexArray& out = *vao;
+    mVertexArrays.emplace(std::move(key), std::move(vao));
+    return out;
+}
+
+void VertexArrayCache::evict(unsigned buffer)
+{
+    for (auto it = mVertexArrays.begin(); it != mVertexArrays.end();)
+    {
+        const auto& key = it->first;
+        const bool usesBuffer = key.indexBuffer == buffer ||
+                                std::any_of(key.bindings.begin(), key.bindings.end(), [buffer](const VertexBinding& binding)
+                                {
+                                    return binding.buffer == buffer;
+                                });
+
+        if (usesBuffer)
+            it = mVertexArrays.erase(it);
+        else
+            ++it;
+    }
+}
+
+void VertexArrayCache::clear()
+{
+    mVertexArrays.clear();
+}
+
+const unsigned VertexArrayCache::size() const
+{
+    return static_cast<unsigned>(mVertexArrays.size());
+}
+
+bool VertexArrayCache::Key::operator==(const Key& other) const
+{
+    if (indexBuffer != other.indexBuffer || bindings.size() != other.bindings.size())
+        return false;
+
+    for (size_t i = 0; i < bindings.size(); ++i)
+    {
+        const auto& a = bindings[i];
+        const auto& b = other.bindings[i];
+        if (a.buffer != b.buffer || a.offset != b.offset || a.divisor != b.divisor || a.layout != b.layout)
+            return false;
+    }
+
+    return true;
+}
+
+size_t VertexArrayCache::KeyHash::operator()(const Key& key) const
+{
+    size_t seed = std::hash<unsigned>{}(key.indexBuffer);
+    for (const auto& binding : key.bindings)
+    {
+        hashCombine(seed, hashLayout(binding.layout));
+        hashCombine(seed, std::hash<unsigned>{}(binding.buffer));
+        hashCombine(seed, std::hash<ptrdiff_t>{}(binding.offset));
+        hashCombine(seed, std::hash<unsigned>{}(binding.divisor));
+    }
+
+    return seed;
+}
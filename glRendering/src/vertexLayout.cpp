@@ -0,0 +1,173 @@
+#include "vertexLayout.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // Boost style hash combination
+    void hashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    // Quantize a value in [0, 1] to an unsigned normalized integer with max as 1.0
+    unsigned toUnorm(float value, float max)
+    {
+        return static_cast<unsigned>(std::lround(std::min(std::max(value, 0.f), 1.f) * max));
+    }
+}
+
+const VertexLayout& getVertexLayout(EVertexFormat format)
+{
+    switch (format)
+    {
+    case EVertexFormat::Compact:
+        return VertexFormat<CompactVertex>::layout;
+    case EVertexFormat::Standard:
+    default:
+        return VertexFormat<Vertex>::layout;
+    }
+}
+
+bool operator==(const VertexLayout& lhs, const VertexLayout& rhs)
+{
+    if (lhs.attributeCount != rhs.attributeCount || lhs.stride != rhs.stride)
+        return false;
+
+    for (unsigned i = 0; i < lhs.attributeCount; ++i)
+    {
+        const auto& a = lhs.attributes[i];
+        const auto& b = rhs.attributes[i];
+        if (a.size != b.size || a.type != b.type || a.offset != b.offset || a.normalize != b.normalize)
+            return false;
+    }
+
+    return true;
+}
+
+bool operator!=(const VertexLayout& lhs, const VertexLayout& rhs)
+{
+    return !(lhs == rhs);
+}
+
+size_t hashLayout(const VertexLayout& layout)
+{
+    size_t seed = std::hash<unsigned>{}(layout.stride);
+    for (unsigned i = 0; i < layout.attributeCount; ++i)
+    {
+        const auto& attribute = layout.attributes[i];
+        hashCombine(seed, std::hash<int>{}(attribute.size));
+        hashCombine(seed, std::hash<unsigned>{}(attribute.type));
+        hashCombine(seed, std::hash<unsigned>{}(attribute.offset));
+        hashCombine(seed, std::hash<bool>{}(attribute.normalize));
+    }
+
+    return seed;
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t absolute = bits & 0x7FFFFFFFu;
+
+    // NaN stays NaN, Inf and values too large for a half become Inf
+    if (absolute > 0x7F800000u)
+        return static_cast<uint16_t>(sign | 0x7E00u);
+    if (absolute >= 0x477FF000u)
+        return static_cast<uint16_t>(sign | 0x7C00u);
+
+    // Values too small for a half denormal flush to zero
+    if (absolute < 0x33000000u)
+        return static_cast<uint16_t>(sign);
+
+    const int exponent = static_cast<int>(absolute >> 23) - 127 + 15;
+    uint32_t mantissa = (absolute & 0x007FFFFFu) | 0x00800000u;
+
+    uint32_t shift;
+    uint32_t half;
+    if (exponent <= 0)
+    {
+        // Half denormal: Shift the implicit one into the mantissa
+        shift = static_cast<uint32_t>(14 - exponent);
+        half = mantissa >> shift;
+    }
+    else
+    {
+        shift = 13;
+        half = (static_cast<uint32_t>(exponent) << 10) | ((mantissa >> shift) & 0x3FFu);
+    }
+
+    // Round to nearest even. A carry into the exponent is still the correctly rounded value
+    const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    const uint32_t halfway = 1u << (shift - 1u);
+    if (remainder > halfway || (remainder == halfway && (half & 1u)))
+        ++half;
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0x1Fu)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // Normalize the denormal
+        int e = -1;
+        do
+        {
+            mantissa <<= 1;
+            ++e;
+        } while ((mantissa & 0x400u) == 0);
+        bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+
+    float out;
+    std::memcpy(&out, &bits, sizeof(out));
+    return out;
+}
+
+CompactVertex packVertex(const Vertex& vertex)
+{
+    CompactVertex out;
+    out.x = Half{ floatToHalf(vertex.x) };
+    out.y = Half{ floatToHalf(vertex.y) };
+    out.z = Half{ floatToHalf(vertex.z) };
+    out.padding = Half{ 0 };
+
+    out.r = static_cast<uint8_t>(toUnorm(vertex.r, 255.f));
+    out.g = static_cast<uint8_t>(toUnorm(vertex.g, 255.f));
+    out.b = static_cast<uint8_t>(toUnorm(vertex.b, 255.f));
+    out.a = 255;
+
+    out.u = static_cast<uint16_t>(toUnorm(vertex.u, 65535.f));
+    out.v = static_cast<uint16_t>(toUnorm(vertex.v, 65535.f));
+    return out;
+}
+
+void packVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& out)
+{
+    out.resize(vertices.size());
+    std::transform(vertices.begin(), vertices.end(), out.begin(), packVertex);
+}
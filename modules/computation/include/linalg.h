@@ -58,7 +58,7 @@ public:
 	constexpr vecM& operator=(vecM&& other) { if (this == &other) return *this; mData = std::move(other.mData); return *this; }
 
 	// Add-Ass
-	vecM& vecM::operator+=(const vecM& other)
+	vecM& operator+=(const vecM& other)
 	{
 		for (unsigned i = 0; i != M; ++i)
 			mData[i] += other[i];
@@ -69,7 +69,7 @@ public:
 	friend vecM operator+(vecM lhs, const vecM& rhs) { return lhs += rhs; }
 
 	// Sub-Ass
-	vecM& vecM::operator-=(const vecM& other)
+	vecM& operator-=(const vecM& other)
 	{
 		for (unsigned i = 0; i != M; ++i)
 			mData[i] -= other[i];
@@ -340,8 +340,8 @@ public:
 		const T y2{ y * y };
 		const T z2{ z * z };
 		float rads = float(angle) * 0.0174532925f;
-		const float c = std::cosf(rads);
-		const float s = std::sinf(rads);
+		const float c = std::cos(rads);
+		const float s = std::sin(rads);
 		const float omc = 1.0f - c;
 
 		outMatrix[0] = (x2 * omc + c);
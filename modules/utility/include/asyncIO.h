@@ -0,0 +1,156 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include "files.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Reads whole files in the background so that loading
+ * does not stall the main thread. On Linux the reads go
+ * through io_uring, keeping up to queueDepth of them in
+ * flight from one thread, elsewhere (or when the kernel
+ * refuses io_uring) a pool of threads reads with pread.
+ * Waiting requests are started highest priority first.
+ *
+ * Prefetched files are picked up by openFile, so code
+ * that loads by path (Shader, Texture) only waits for
+ * the files it opens, which were read meanwhile.
+ */
+
+// Order in which waiting reads are started
+enum class EIOPriority
+{
+    High = 0,
+    Normal = 1,
+    Low = 2
+};
+
+// Handle to an asynchronous read, shared with the I/O thread
+class IORequest final
+{
+public:
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::atomic<bool> ready{ false };
+        FileView result;
+    };
+
+public:
+    // Create an empty handle
+    IORequest() = default;
+
+    explicit IORequest(std::shared_ptr<State> state) : mState(std::move(state)) {}
+
+    // Whether the handle refers to a read
+    const bool valid() const { return mState != nullptr; }
+
+    // Whether the read finished, without waiting
+    const bool ready() const;
+
+    // Wait for the read to finish
+    void wait() const;
+
+    // Wait for the read and take the contents. The view is not open if the file could not be read
+    FileView take();
+
+private:
+    std::shared_ptr<State> mState = nullptr;
+};
+
+class AsyncIO final
+{
+public:
+    // Start reading in the background. threadCount is only used without io_uring
+    explicit AsyncIO(unsigned threadCount = 4, unsigned queueDepth = 64);
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO& other) = delete;
+    AsyncIO& operator=(const AsyncIO& other) = delete;
+
+    // Read a file in the background
+    IORequest read(const std::string& filepath, EIOPriority priority = EIOPriority::Normal);
+
+    // Queue a batch of reads at once, waking the I/O thread once for all of them
+    std::vector<IORequest> read(const std::vector<std::string>& filepaths, EIOPriority priority = EIOPriority::Normal);
+
+    // Read a file ahead of time, openFile returns it instead of reading it again
+    void prefetch(const std::string& filepath, EIOPriority priority = EIOPriority::Normal);
+
+    // Take a prefetched file, waiting if it is still being read. Returns false if it was not prefetched
+    bool takePrefetched(const std::string& filepath, FileView& out);
+
+    // Whether reads go through io_uring
+    const bool usesIoUring() const { return bIoUring; }
+
+    // Get the AsyncIO whose prefetched files openFile returns (the first one created)
+    static AsyncIO* prefetcher();
+
+private:
+    struct Request
+    {
+        std::string path;
+        EIOPriority priority;
+        uint64_t sequence;
+        std::shared_ptr<IORequest::State> state;
+    };
+
+    // Orders the waiting reads, highest priority then oldest first
+    struct RequestOrder
+    {
+        bool operator()(const Request& a, const Request& b) const
+        {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+
+    struct IOUring;
+
+private:
+    // Add a request to the queue, the caller holds mMutex
+    IORequest enqueue(const std::string& filepath, EIOPriority priority);
+
+    // Take the next request, waiting until there is one. Returns false when shutting down
+    bool popRequest(Request& out, bool wait);
+
+    // Complete a request with the file contents
+    static void complete(Request& request, FileView result);
+
+    // Read on a pool thread with pread
+    void poolThread();
+
+    // Keep reads in flight through io_uring
+    void ringThread();
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::priority_queue<Request, std::vector<Request>, RequestOrder> mQueue;
+    uint64_t mSequence = 0;
+    bool bStopping = false;
+
+    std::vector<std::thread> mThreads;
+    std::unique_ptr<IOUring> mRing;
+    bool bIoUring = false;
+    unsigned mQueueDepth;
+
+    // Prefetched files by path
+    std::mutex mPrefetchMutex;
+    std::unordered_map<std::string, IORequest> mPrefetched;
+};
+
+#endif // ASYNC_IO_H
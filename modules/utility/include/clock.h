@@ -11,6 +11,7 @@
 #define CLOCK_H
 
 #include <chrono>
+#include <cstdint>
 
 class Clock
 {
@@ -27,6 +28,9 @@ public:
     // Restart clock and return the time it had before resetting
     const TimeUnit restart();
 
+    // Get the current time in nanoseconds, comparable between threads (used for profiling timestamps)
+    static const uint64_t nanoseconds();
+
 private:
     // Return the current time (implementation helper for restart/timeSinceStart)
     const TimePoint now() const;
@@ -0,0 +1,36 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Compression in the LZ4 block format. Decompressing
+ * costs little more than a copy, so it suits assets
+ * that are read at every start. The output is a plain
+ * LZ4 block, readable by any LZ4 implementation.
+ */
+
+//************************************
+// Method:    compressLZ4
+// Parameter: const char * source
+// Parameter: size_t size
+// Parameter: std::vector<char> & out
+// Brief:     Compress size bytes into out, replacing its contents
+//************************************
+void compressLZ4(const char* source, size_t size, std::vector<char>& out);
+
+//************************************
+// Method:    decompressLZ4
+// Parameter: const char * source
+// Parameter: size_t size
+// Parameter: char * out
+// Parameter: size_t outSize
+// Brief:     Decompress a block into exactly outSize bytes. Returns false if the block is corrupt
+//************************************
+bool decompressLZ4(const char* source, size_t size, char* out, size_t outSize);
+
+#endif // COMPRESSION_H
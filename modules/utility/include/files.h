@@ -4,13 +4,105 @@
 #ifndef FILES_H
 #define FILES_H
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
+
+/*
+ * Read-only view of the whole contents of a file.
+ * Large files are memory mapped so that loading them
+ * copies nothing, small files and platforms without
+ * mmap read the file into a buffer owned by the view.
+ * The contents are not null terminated.
+ */
+class FileView final
+{
+public:
+    // Create an empty view
+    FileView() = default;
+
+    // Open the file, the view is empty if it can not be read
+    explicit FileView(const std::string& filepath);
+
+    // View memory owned elsewhere, which must outlive the view (e.g. an entry of a mounted resource pack)
+    static FileView fromMemory(const char* data, size_t size);
+
+    // Take ownership of a buffer of size bytes
+    static FileView fromBuffer(std::unique_ptr<char[]> buffer, size_t size);
+
+    FileView(FileView&& other);
+    FileView& operator=(FileView&& other);
+
+    FileView(const FileView& other) = delete;
+    FileView& operator=(const FileView& other) = delete;
+
+    ~FileView();
+
+    // Get the first byte of the file
+    const char* data() const { return mData; }
+
+    // Get the size of the file in bytes
+    const size_t size() const { return mSize; }
+
+    // Whether the file is empty or could not be read
+    const bool empty() const { return mSize == 0; }
+
+    // Whether the file was opened
+    const bool isOpen() const { return bOpen; }
+
+    // Get the contents as a string view
+    std::string_view view() const { return std::string_view(mData, mSize); }
+
+    const char* begin() const { return mData; }
+    const char* end() const { return mData + mSize; }
+
+private:
+    // Unmap or free the contents
+    void release();
+
+private:
+    const char* mData = nullptr;
+    size_t mSize = 0;
+    bool bOpen = false;
+
+    // Whether mData is mapped, otherwise it points into mBuffer
+    bool bMapped = false;
+    std::unique_ptr<char[]> mBuffer = nullptr;
+};
+
+//************************************
+// Method:    openFile
+// Access:    public 
+// Parameter: const std::string & filepath
+// Brief:     Open a file, returning it if it was prefetched by AsyncIO, reading resources (paths from
+//            getResourcePath) from the mounted resource packs when they contain them and from disk otherwise
+//************************************
+FileView openFile(const std::string& filepath);
+
+//************************************
+// Method:    openPackedFile
+// Access:    public 
+// Parameter: const std::string & filepath
+// Parameter: FileView & out
+// Brief:     Open a resource from the mounted resource packs only. Returns false if no pack holds it
+//************************************
+bool openPackedFile(const std::string& filepath, FileView& out);
+
+//************************************
+// Method:    mountResourcePack
+// Access:    public 
+// Parameter: const std::string & packPath
+// Brief:     Read resources from the pack made by the resource packer. Mount packs at startup, before
+//            loading resources from other threads. Returns false if the pack can not be opened
+//************************************
+bool mountResourcePack(const std::string& packPath);
 
 //************************************
 // Method:    readFile
 // Access:    public 
 // Parameter: const std::string & filepath
-// Brief:     Return entire file contents as a string
+// Brief:     Return entire file contents as a string, reading through openFile
 //************************************
 const std::string readFile(const std::string& filepath);
 
@@ -18,7 +110,8 @@ const std::string readFile(const std::string& filepath);
 // Method:    getResourcePath
 // Access:    public 
 // Parameter: const std::string & resourceName
-// Brief:     Get the absolute path to the given resource located in /res/'resourceName'
+// Brief:     Get the absolute path to the given resource located in /res/'resourceName'.
+//            The resource root is looked up once, on the first call
 // Example:   loadResource(getResourcePath("Texture.png"));
 //************************************
 std::string getResourcePath(const std::string& resourceName);
@@ -0,0 +1,177 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Work stealing job scheduler. Every worker owns a
+ * Chase-Lev deque: it pushes and pops its own jobs at
+ * the bottom without locking while idle workers steal
+ * the oldest (largest) jobs from the top. The thread
+ * that creates the system is worker 0 and runs jobs
+ * while it waits, so nothing sits idle in wait().
+ *
+ * Jobs finish by decrementing a JobCounter, which is
+ * also how jobs depend on each other: a job run after
+ * a counter starts once the counter reaches zero.
+ */
+
+class JobSystem;
+struct Job;
+
+// Counts unfinished jobs. Must outlive the jobs it counts
+class JobCounter final
+{
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter& other) = delete;
+    JobCounter& operator=(const JobCounter& other) = delete;
+
+    // Whether every job counted has finished
+    const bool done() const { return mCount.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<unsigned> mCount{ 0 };
+
+    // Jobs waiting for the count to reach zero
+    std::mutex mMutex;
+    std::vector<Job*> mContinuations;
+};
+
+// A unit of work, either a task or a range of a parallel loop
+struct Job
+{
+    // Task run by JobSystem::run
+    std::function<void()> task;
+
+    // Loop body of JobSystem::parallelFor, called with [begin, end) ranges of at most grainSize
+    void (*range)(void* data, unsigned begin, unsigned end) = nullptr;
+    void* data = nullptr;
+    unsigned begin = 0;
+    unsigned end = 0;
+    unsigned grainSize = 1;
+
+    // Decremented when the job finishes
+    JobCounter* counter = nullptr;
+};
+
+class JobSystem final
+{
+public:
+    // Start workerCount threads besides the calling thread. Defaults to one per remaining hardware thread
+    explicit JobSystem(unsigned workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem& other) = delete;
+    JobSystem& operator=(const JobSystem& other) = delete;
+
+    // Run a task, counted by counter until it finishes
+    void run(std::function<void()> task, JobCounter& counter);
+
+    // Run a task once dependency reaches zero, counted by counter until it finishes
+    void run(std::function<void()> task, JobCounter& counter, JobCounter& dependency);
+
+    // Wait for the counter to reach zero, running jobs meanwhile
+    void wait(const JobCounter& counter);
+
+    // Call function(begin, end) over [first, last) split into ranges of grainSize items and wait for all of them.
+    // A grain size of 0 picks one that gives every thread a few ranges to balance with
+    template<typename Function>
+    void parallelFor(unsigned first, unsigned last, unsigned grainSize, Function&& function);
+
+    // Get the number of threads running jobs, including the creating thread
+    const unsigned getThreadCount() const { return static_cast<unsigned>(mDeques.size()); }
+
+private:
+    // Deque of one worker, only the owner pushes and pops, anyone steals
+    class WorkDeque
+    {
+    public:
+        WorkDeque();
+
+        // Push a job on the owner's end, returns false if the deque is full
+        bool push(Job* job);
+
+        // Pop the newest job on the owner's end
+        Job* pop();
+
+        // Take the oldest job from another thread
+        Job* steal();
+
+    private:
+        static constexpr int64_t Capacity = 4096;
+
+        std::unique_ptr<std::atomic<Job*>[]> mJobs;
+        alignas(64) std::atomic<int64_t> mTop{ 0 };
+        alignas(64) std::atomic<int64_t> mBottom{ 0 };
+    };
+
+private:
+    // Loop run by the worker threads
+    void workerThread(unsigned index);
+
+    // Queue a job, on the deque of the calling worker or the shared queue for other threads
+    void submit(Job* job);
+
+    // Find a job: own deque, then the shared queue, then steal. Returns nullptr if there is none
+    Job* findJob(int index);
+
+    // Run a job and free it, finishing its counter
+    void execute(Job* job);
+
+    // Count one job of the counter as finished, starting its continuations at zero
+    void finish(JobCounter& counter);
+
+    // Get the deque index of the calling thread, or -1 for threads that are not workers
+    const int workerIndex() const;
+
+    // Split and run a parallel loop
+    void parallelForRange(unsigned first, unsigned last, unsigned grainSize,
+                          void (*range)(void*, unsigned, unsigned), void* data);
+
+private:
+    std::vector<std::unique_ptr<WorkDeque>> mDeques;
+    std::vector<std::thread> mThreads;
+
+    // Jobs submitted by threads that are not workers
+    std::mutex mSharedMutex;
+    std::deque<Job*> mShared;
+
+    // Jobs queued and not yet taken, idle workers sleep while it is zero
+    std::atomic<unsigned> mQueued{ 0 };
+    std::atomic<unsigned> mSleeping{ 0 };
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+    std::atomic<bool> bStopping{ false };
+};
+
+template<typename Function>
+void JobSystem::parallelFor(unsigned first, unsigned last, unsigned grainSize, Function&& function)
+{
+    using FunctionType = std::remove_reference_t<Function>;
+    auto range = [](void* data, unsigned begin, unsigned end)
+    {
+        (*static_cast<FunctionType*>(data))(begin, end);
+    };
+
+    // The function lives on this stack until every range has run
+    parallelForRange(first, last, grainSize, range, const_cast<void*>(static_cast<const void*>(&function)));
+}
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,22 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdio>
+#include <string>
+
+/*
+ * Helpers for the JSON result and trace files written
+ * with fprintf. Any text that did not come from the
+ * program itself (names, driver strings) must be written
+ * with writeJsonString so quotes and control characters
+ * are escaped and the file stays valid JSON.
+ */
+
+// Write text as a JSON string literal, quotes included
+void writeJsonString(std::FILE* file, const char* text);
+void writeJsonString(std::FILE* file, const std::string& text);
+
+#endif // JSON_H
@@ -5,57 +5,193 @@
 #define LOGGING_H
 
 #include "spdlog/spdlog.h"
+#include "spdlog/fmt/fmt.h"
 
-#include <functional>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+/* COMPILE TIME LOG LEVELS */
+
+// Log calls below LOG_ACTIVE_LEVEL are compiled out, their arguments are not evaluated (see the end of the file)
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+#ifndef LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
 
 namespace detail {
     const std::string logName = "DEBUG";
+
+    // The DEBUG logger, cached so that log calls skip the locked registry lookup
+    inline std::atomic<spdlog::logger*> cachedLogger{ nullptr };
+
+    // Whether messages go through the queue of the background thread
+    inline std::atomic<bool> asyncLogging{ false };
+
+    // Get the DEBUG logger, looked up in the registry until it is found
+    inline spdlog::logger* logger()
+    {
+        auto* logger = cachedLogger.load(std::memory_order_acquire);
+        if (logger) return logger;
+
+        // Registered by hand instead of with initLogging. The registry keeps it alive
+        logger = spdlog::get(logName).get();
+        cachedLogger.store(logger, std::memory_order_release);
+        return logger;
+    }
+
+    // Longest message formatted straight into a queue slot, longer ones are moved to the heap
+    constexpr size_t MaxLogMessageLength = 240;
+
+    // A slot of the queue of the background thread, defined in logging.cpp
+    struct LogSlot;
+
+    // Claim a slot to format a message into, text points to MaxLogMessageLength characters.
+    // Returns nullptr and counts the message as dropped if the queue is full
+    LogSlot* claimLogSlot(char*& text);
+
+    // Hand a claimed slot to the background thread. The message is the first length characters of the slot
+    // text, or longText when it did not fit
+    void publishLogSlot(LogSlot* slot, spdlog::level::level_enum level, size_t length, std::string&& longText = {});
+
+    // Log through the cached logger, formatting into a queue slot when logging is asynchronous
+    template<int Level, spdlog::level::level_enum SpdLevel, typename... T>
+    void log(const char* msg, T&&... fmtargs)
+    {
+        if constexpr (Level >= LOG_ACTIVE_LEVEL)
+        {
+            auto* logger = detail::logger();
+            if (!logger || !logger->should_log(SpdLevel)) return;
+
+            if (asyncLogging.load(std::memory_order_relaxed))
+            {
+                char* text = nullptr;
+                LogSlot* slot = claimLogSlot(text);
+                if (!slot) return;
+
+                // A claimed slot must be published, or the background thread waits on it forever
+                try
+                {
+                    const auto result = fmt::format_to_n(text, MaxLogMessageLength, msg, fmtargs...);
+                    if (result.size <= MaxLogMessageLength)
+                    {
+                        publishLogSlot(slot, SpdLevel, result.size);
+                    }
+                    else
+                    {
+                        std::string longText;
+                        longText.reserve(result.size);
+                        fmt::format_to(std::back_inserter(longText), msg, fmtargs...);
+                        publishLogSlot(slot, SpdLevel, longText.size(), std::move(longText));
+                    }
+                }
+                catch (...)
+                {
+                    publishLogSlot(slot, SpdLevel, 0);
+                    throw;
+                }
+            }
+            else
+            {
+                logger->log(SpdLevel, msg, std::forward<T>(fmtargs)...);
+            }
+        }
+    }
 }
 
+/* SETUP */
+
+//************************************
+// Method:    initLogging
+// Parameter: bool async
+// Parameter: unsigned queueSize
+// Brief:     Create the DEBUG logger writing to the console. When async, messages are formatted on the
+//            calling thread and written by a background thread, queueSize messages can wait before
+//            new ones are dropped
+//************************************
+std::shared_ptr<spdlog::logger> initLogging(bool async = true, unsigned queueSize = 4096);
+
+//************************************
+// Method:    shutdownLogging
+// Brief:     Write the queued messages and stop the background thread
+//************************************
+void shutdownLogging();
+
 /* LOGGING FUNCTIONS*/
 
 //************************************
-// Method:    logInfo
-// Parameter: const std::string & msg
+// Method:    logDebug
+// Parameter: const char * msg
 // Brief:     Log the message at debug level
 //************************************
 template<typename... T>
-void logDebug(const std::string& msg, T&&... fmtargs)
+void logDebug(const char* msg, T&&... fmtargs)
 {
-    spdlog::get(detail::logName)->debug(msg.c_str(), std::forward<T>(fmtargs)...);
+    detail::log<LOG_LEVEL_DEBUG, spdlog::level::debug>(msg, std::forward<T>(fmtargs)...);
 }
 
 //************************************
 // Method:    logInfo
-// Parameter: const std::string & msg
+// Parameter: const char * msg
 // Brief:     Log the message at info level
 //************************************
 template<typename... T>
-void logInfo(const std::string& msg, T&&... fmtargs)
+void logInfo(const char* msg, T&&... fmtargs)
 {
-    spdlog::get(detail::logName)->info(msg.c_str(), std::forward<T>(fmtargs)...);
+    detail::log<LOG_LEVEL_INFO, spdlog::level::info>(msg, std::forward<T>(fmtargs)...);
 }
 
 //************************************
-// Method:    logInfo
-// Parameter: const std::string & msg
+// Method:    logWarn
+// Parameter: const char * msg
 // Brief:     Log the message at warning level
 //************************************
 template<typename... T>
-void logWarn(const std::string& msg, T&&... fmtargs)
+void logWarn(const char* msg, T&&... fmtargs)
 {
-    spdlog::get(detail::logName)->warn(msg.c_str(), std::forward<T>(fmtargs)...);
+    detail::log<LOG_LEVEL_WARN, spdlog::level::warn>(msg, std::forward<T>(fmtargs)...);
 }
 
 //************************************
-// Method:    logInfo
-// Parameter: const std::string & msg
+// Method:    logErr
+// Parameter: const char * msg
 // Brief:     Log the message at error level
 //************************************
 template<typename... T>
-void logErr(const std::string& msg, T&&... fmtargs)
+void logErr(const char* msg, T&&... fmtargs)
 {
-    spdlog::get(detail::logName)->error(msg.c_str(), std::forward<T>(fmtargs)...);
+    detail::log<LOG_LEVEL_ERROR, spdlog::level::err>(msg, std::forward<T>(fmtargs)...);
 }
 
+/* COMPILE TIME STRIPPING */
+
+// Calls below LOG_ACTIVE_LEVEL become statements that are never run, so their arguments are type checked
+// but not evaluated. The name in the expansion refers to the function, macros do not expand recursively
+#if LOG_ACTIVE_LEVEL > LOG_LEVEL_DEBUG
+#define logDebug(...) do { if (false) logDebug(__VA_ARGS__); } while (false)
+#endif
+
+#if LOG_ACTIVE_LEVEL > LOG_LEVEL_INFO
+#define logInfo(...) do { if (false) logInfo(__VA_ARGS__); } while (false)
+#endif
+
+#if LOG_ACTIVE_LEVEL > LOG_LEVEL_WARN
+#define logWarn(...) do { if (false) logWarn(__VA_ARGS__); } while (false)
+#endif
+
+#if LOG_ACTIVE_LEVEL > LOG_LEVEL_ERROR
+#define logErr(...) do { if (false) logErr(__VA_ARGS__); } while (false)
+#endif
+
 #endif // LOGGING_H
@@ -0,0 +1,161 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "clock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Hierarchical CPU profiler. A zone times the scope it
+ * is declared in; nested zones make the hierarchy. Each
+ * thread writes finished zones to its own ring buffer
+ * without locking, endFrame collects every buffer into
+ * the frame history that the profiler panel draws and
+ * that captures are exported from as a Chrome trace
+ * (chrome://tracing or ui.perfetto.dev). Zones timed
+ * elsewhere (e.g. on the GPU) are added to their frame
+ * on a track of their own once their times are known.
+ *
+ * Zones are compiled in with ENABLE_PROFILER. Compiled
+ * in but disabled, a zone costs one relaxed load.
+ */
+
+#if defined(ENABLE_PROFILER)
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Time the rest of the scope. The name must outlive the profiler, e.g. a string literal
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+// A finished zone
+struct ProfileEvent
+{
+    const char* name;
+
+    // Nanoseconds on Clock::nanoseconds
+    uint64_t start;
+    uint64_t end;
+
+    // Thread (track) the zone ran on and how many zones it is nested in
+    uint32_t track;
+    uint32_t depth;
+};
+
+// Every zone that finished during one frame
+struct ProfileFrame
+{
+    uint64_t index;
+    uint64_t start;
+    uint64_t end;
+    std::vector<ProfileEvent> events;
+};
+
+namespace detail
+{
+    // Ring of finished zones, written by its thread and read by endFrame
+    struct ProfileBuffer
+    {
+        static constexpr uint64_t Capacity = 1 << 14;
+
+        std::unique_ptr<ProfileEvent[]> events{ std::make_unique<ProfileEvent[]>(Capacity) };
+        std::atomic<uint64_t> head{ 0 };
+        std::atomic<uint64_t> tail{ 0 };
+        std::atomic<unsigned> dropped{ 0 };
+
+        // Only touched by the owning thread
+        uint32_t track = 0;
+        uint32_t depth = 0;
+    };
+
+    inline std::atomic<bool> profilerEnabled{ true };
+}
+
+class Profiler final
+{
+public:
+    Profiler() = delete;
+
+    // Turn recording on or off at runtime
+    static void setEnabled(bool enabled) { detail::profilerEnabled.store(enabled, std::memory_order_relaxed); }
+
+    // Whether zones are recorded
+    static bool isEnabled() { return detail::profilerEnabled.load(std::memory_order_relaxed); }
+
+    // Name the track of the calling thread
+    static void setThreadName(const std::string& name);
+
+    // Mark the start of a frame
+    static void beginFrame();
+
+    // Collect the zones of every thread into the frame and add it to the history
+    static void endFrame();
+
+    // Get the index of the frame being recorded
+    static uint64_t getFrameIndex();
+
+    // Get the most recent frames, oldest first. Only valid on the thread calling endFrame
+    static const std::deque<ProfileFrame>& getHistory();
+
+    // Add a track for zones that are not timed by a thread, returns its index
+    static uint32_t addTrack(const std::string& name);
+
+    // Add zones to a recorded frame, ignored if it is no longer kept. Only call from the thread calling endFrame
+    static void addEvents(uint64_t frameIndex, const std::vector<ProfileEvent>& events);
+
+    // Get the name of every track, indexed by ProfileEvent::track
+    static std::vector<std::string> getTrackNames();
+
+    // Keep every frame from now on until the capture is stopped, not just the history
+    static void startCapture();
+    static void stopCapture();
+    static bool isCapturing();
+
+    // Write the captured frames, or the history without a capture, as Chrome trace JSON. Returns false on failure
+    static bool writeChromeTrace(const std::string& filepath);
+
+    // Get the thread's buffer, registering it on first use
+    static detail::ProfileBuffer& threadBuffer();
+};
+
+// Times its scope, see PROFILE_SCOPE
+class ProfileZone final
+{
+public:
+    explicit ProfileZone(const char* name)
+    {
+        if (Profiler::isEnabled()) begin(name);
+    }
+
+    ~ProfileZone()
+    {
+        if (mBuffer) end();
+    }
+
+    ProfileZone(const ProfileZone& other) = delete;
+    ProfileZone& operator=(const ProfileZone& other) = delete;
+
+private:
+    void begin(const char* name);
+    void end();
+
+private:
+    detail::ProfileBuffer* mBuffer = nullptr;
+    const char* mName = nullptr;
+    uint64_t mStart = 0;
+    uint32_t mDepth = 0;
+};
+
+#endif // PROFILER_H
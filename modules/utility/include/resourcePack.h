@@ -0,0 +1,109 @@
+///  by Carl Findahl (C) 2018
+/// A Kukon Development Project
+
+#ifndef RESOURCE_PACK_H
+#define RESOURCE_PACK_H
+
+#include "files.h"
+
+#include <cstdint>
+#include <string>
+
+/*
+ * A resource pack bundles the resource folder into one
+ * file that is mapped once, instead of every resource
+ * being opened, read and closed on its own. Entries are
+ * sorted by the hash of their name for a binary search
+ * and may be LZ4 compressed. Stored entries are viewed
+ * in the mapped pack without copying.
+ *
+ * Layout: PackHeader, PackEntry[entryCount], names, data
+ */
+
+// Identifies a resource pack, "RPAK" in file order
+constexpr uint32_t PackMagic = 0x4B415052;
+constexpr uint32_t PackVersion = 1;
+
+// Entry flag telling that the data is an LZ4 block
+constexpr uint32_t PackEntryCompressed = 0x1;
+
+struct PackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t namesSize;
+};
+
+struct PackEntry
+{
+    // Hash of the name, the directory is sorted by it
+    uint64_t nameHash;
+
+    // Where the data starts in the pack and how many bytes are stored
+    uint64_t offset;
+    uint64_t storedSize;
+
+    // Size once decompressed
+    uint64_t size;
+
+    // Name in the names block, relative to the resource folder with '/' separators
+    uint32_t nameOffset;
+    uint32_t nameLength;
+
+    uint32_t flags;
+    uint32_t padding;
+};
+
+class ResourcePack final
+{
+public:
+    // Open a pack, check isOpen for success
+    explicit ResourcePack(const std::string& packPath);
+
+    // Whether the pack was opened and is valid
+    const bool isOpen() const { return bOpen; }
+
+    // Whether the pack holds the resource
+    const bool contains(const std::string& name) const;
+
+    // View a resource, decompressing it if it is compressed. Empty if the pack does not hold it
+    FileView open(const std::string& name) const;
+
+    // Get the number of resources in the pack
+    const unsigned getEntryCount() const { return mEntryCount; }
+
+private:
+    // Find the entry of a resource or nullptr
+    const PackEntry* find(const std::string& name) const;
+
+private:
+    // The mapped pack, everything else points into it
+    FileView mFile;
+
+    const PackEntry* mEntries = nullptr;
+    unsigned mEntryCount = 0;
+    const char* mNames = nullptr;
+
+    bool bOpen = false;
+};
+
+//************************************
+// Method:    hashResourceName
+// Parameter: const char * name
+// Parameter: size_t length
+// Brief:     Hash a resource name for the pack directory (64-bit FNV-1a)
+//************************************
+uint64_t hashResourceName(const char* name, size_t length);
+
+//************************************
+// Method:    writeResourcePack
+// Parameter: const std::string & sourceDir
+// Parameter: const std::string & packPath
+// Parameter: bool compress
+// Brief:     Pack every file under sourceDir. When compress is set, entries that shrink enough are
+//            stored compressed. Returns false if a file can not be read or the pack written
+//************************************
+bool writeResourcePack(const std::string& sourceDir, const std::string& packPath, bool compress = true);
+
+#endif // RESOURCE_PACK_H
@@ -0,0 +1,512 @@
+#include "asyncIO.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ASYNC_IO_USE_PREAD
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define ASYNC_IO_USE_URING
+#endif
+
+namespace
+{
+    // The AsyncIO openFile takes prefetched files from
+    std::atomic<AsyncIO*> activePrefetcher{ nullptr };
+
+#ifdef ASYNC_IO_USE_PREAD
+    // Open a file for reading and get its size, returns -1 on failure
+    int openForRead(const std::string& path, size_t& size)
+    {
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file == -1) return -1;
+
+        struct stat info;
+        if (::fstat(file, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            ::close(file);
+            return -1;
+        }
+
+        size = static_cast<size_t>(info.st_size);
+        return file;
+    }
+#endif
+}
+
+#ifdef ASYNC_IO_USE_URING
+// A submission and completion queue shared with the kernel, set up without liburing
+struct AsyncIO::IOUring
+{
+    int fd = -1;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    io_uring_sqe* sqes = nullptr;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    size_t sqesSize = 0;
+
+    // A read in flight, the buffer fills over as many reads as the kernel needs
+    struct Read
+    {
+        Request request;
+        int file;
+        size_t size;
+        size_t offset;
+        std::unique_ptr<char[]> buffer;
+        iovec vector;
+    };
+
+    // Create the queues, returns false if the kernel does not allow io_uring
+    bool init(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return false;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) return false;
+
+        cqRing = singleMap ? sqRing : ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) return false;
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqeMemory == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+        auto* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    ~IOUring()
+    {
+        if (sqes) ::munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) ::munmap(sqRing, sqRingSize);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // Queue the rest of a read, submitted with the next enter
+    void queueRead(Read* read)
+    {
+        const unsigned tail = *sqTail;
+        const unsigned index = tail & *sqMask;
+
+        read->vector.iov_base = read->buffer.get() + read->offset;
+        read->vector.iov_len = read->size - read->offset;
+
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = read->file;
+        sqe.off = read->offset;
+        sqe.addr = reinterpret_cast<uint64_t>(&read->vector);
+        sqe.len = 1;
+        sqe.user_data = reinterpret_cast<uint64_t>(read);
+
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Number of queued reads the kernel has not taken yet
+    unsigned unsubmitted() const
+    {
+        return *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    }
+
+    // Submit every queued read and wait for at least minComplete to finish. The kernel may take only some of
+    // them, the rest stay queued for the next enter. Returns false on an error retrying does not fix
+    bool enter(unsigned minComplete)
+    {
+        const unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        const long result = ::syscall(__NR_io_uring_enter, fd, unsubmitted(), minComplete, flags, nullptr, 0);
+        return result >= 0 || errno == EINTR || errno == EAGAIN || errno == EBUSY;
+    }
+
+    // Take back the queued reads the kernel has not taken, in the order they were queued
+    std::vector<Read*> unqueue()
+    {
+        const unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        const unsigned tail = *sqTail;
+
+        std::vector<Read*> reads;
+        for (unsigned i = head; i != tail; ++i)
+        {
+            reads.push_back(reinterpret_cast<Read*>(sqes[sqArray[i & *sqMask]].user_data));
+        }
+        __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+        return reads;
+    }
+};
+#else
+struct AsyncIO::IOUring
+{
+};
+#endif
+
+const bool IORequest::ready() const
+{
+    return mState && mState->ready.load(std::memory_order_acquire);
+}
+
+void IORequest::wait() const
+{
+    if (!mState || ready()) return;
+
+    std::unique_lock<std::mutex> lock(mState->mutex);
+    mState->done.wait(lock, [this]() { return mState->ready.load(std::memory_order_acquire); });
+}
+
+FileView IORequest::take()
+{
+    if (!mState) return FileView();
+
+    wait();
+    FileView result = std::move(mState->result);
+    mState = nullptr;
+    return result;
+}
+
+AsyncIO::AsyncIO(unsigned threadCount, unsigned queueDepth) : mQueueDepth(std::max(queueDepth, 1u))
+{
+#ifdef ASYNC_IO_USE_URING
+    // Fall back to the thread pool where io_uring is missing or blocked (old kernels, containers)
+    mRing = std::make_unique<IOUring>();
+    bIoUring = mRing->init(mQueueDepth);
+    if (!bIoUring)
+    {
+        logInfo("AsyncIO: io_uring is not available, reading with a thread pool");
+        mRing = nullptr;
+    }
+#endif
+
+    if (bIoUring)
+    {
+        mThreads.emplace_back(&AsyncIO::ringThread, this);
+    }
+    else
+    {
+        for (unsigned i = 0; i < std::max(threadCount, 1u); ++i)
+        {
+            mThreads.emplace_back(&AsyncIO::poolThread, this);
+        }
+    }
+
+    AsyncIO* expected = nullptr;
+    activePrefetcher.compare_exchange_strong(expected, this);
+}
+
+AsyncIO::~AsyncIO()
+{
+    AsyncIO* expected = this;
+    activePrefetcher.compare_exchange_strong(expected, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        bStopping = true;
+    }
+    mWake.notify_all();
+
+    // Reads in flight finish, waiting ones complete as failed
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+
+    while (!mQueue.empty())
+    {
+        Request request = mQueue.top();
+        mQueue.pop();
+        complete(request, FileView());
+    }
+}
+
+IORequest AsyncIO::read(const std::string& filepath, EIOPriority priority)
+{
+    IORequest request;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        request = enqueue(filepath, priority);
+    }
+    mWake.notify_one();
+    return request;
+}
+
+std::vector<IORequest> AsyncIO::read(const std::vector<std::string>& filepaths, EIOPriority priority)
+{
+    std::vector<IORequest> requests;
+    requests.reserve(filepaths.size());
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& path : filepaths)
+        {
+            requests.push_back(enqueue(path, priority));
+        }
+    }
+    mWake.notify_all();
+    return requests;
+}
+
+void AsyncIO::prefetch(const std::string& filepath, EIOPriority priority)
+{
+    std::lock_guard<std::mutex> lock(mPrefetchMutex);
+    if (mPrefetched.count(filepath) != 0) return;
+
+    mPrefetched.emplace(filepath, read(filepath, priority));
+}
+
+bool AsyncIO::takePrefetched(const std::string& filepath, FileView& out)
+{
+    IORequest request;
+    {
+        std::lock_guard<std::mutex> lock(mPrefetchMutex);
+        const auto found = mPrefetched.find(filepath);
+        if (found == mPrefetched.end()) return false;
+
+        request = std::move(found->second);
+        mPrefetched.erase(found);
+    }
+
+    // Wait outside the lock, other threads may take their own files meanwhile
+    out = request.take();
+    return out.isOpen();
+}
+
+AsyncIO* AsyncIO::prefetcher()
+{
+    return activePrefetcher.load(std::memory_order_acquire);
+}
+
+IORequest AsyncIO::enqueue(const std::string& filepath, EIOPriority priority)
+{
+    auto state = std::make_shared<IORequest::State>();
+    mQueue.push(Request{ filepath, priority, mSequence++, state });
+    return IORequest(std::move(state));
+}
+
+bool AsyncIO::popRequest(Request& out, bool wait)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (wait)
+    {
+        mWake.wait(lock, [this]() { return bStopping || !mQueue.empty(); });
+    }
+
+    if (bStopping || mQueue.empty()) return false;
+
+    out = mQueue.top();
+    mQueue.pop();
+    return true;
+}
+
+void AsyncIO::complete(Request& request, FileView result)
+{
+    auto& state = *request.state;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.result = std::move(result);
+        state.ready.store(true, std::memory_order_release);
+    }
+    state.done.notify_all();
+}
+
+void AsyncIO::poolThread()
+{
+    Request request;
+    while (popRequest(request, true))
+    {
+        // Packed resources are already mapped, only the decompression is left
+        FileView packed;
+        if (openPackedFile(request.path, packed))
+        {
+            complete(request, std::move(packed));
+            continue;
+        }
+
+#ifdef ASYNC_IO_USE_PREAD
+        size_t size = 0;
+        const int file = openForRead(request.path, size);
+        if (file == -1)
+        {
+            complete(request, FileView());
+            continue;
+        }
+
+        auto buffer = std::make_unique<char[]>(size);
+        size_t total = 0;
+        while (total < size)
+        {
+            const auto count = ::pread(file, buffer.get() + total, size - total, static_cast<off_t>(total));
+            if (count <= 0) break;
+            total += static_cast<size_t>(count);
+        }
+        ::close(file);
+
+        complete(request, FileView::fromBuffer(std::move(buffer), total));
+#else
+        // Read into memory, a mapped view would fault the pages in on the thread that uses it
+        std::FILE* file = std::fopen(request.path.c_str(), "rb");
+        if (!file)
+        {
+            complete(request, FileView());
+            continue;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        const auto size = static_cast<size_t>(std::max(std::ftell(file), 0l));
+        std::fseek(file, 0, SEEK_SET);
+        auto buffer = std::make_unique<char[]>(size);
+        const size_t total = std::fread(buffer.get(), 1, size, file);
+        std::fclose(file);
+
+        complete(request, FileView::fromBuffer(std::move(buffer), total));
+#endif
+    }
+}
+
+void AsyncIO::ringThread()
+{
+#ifdef ASYNC_IO_USE_URING
+    using Read = IOUring::Read;
+    IOUring& ring = *mRing;
+    std::vector<std::unique_ptr<Read>> inFlight;
+
+    auto finish = [&](Read* read, bool ok)
+    {
+        ::close(read->file);
+        FileView result = ok ? FileView::fromBuffer(std::move(read->buffer), read->size) : FileView();
+        complete(read->request, std::move(result));
+
+        const auto found = std::find_if(inFlight.begin(), inFlight.end(), [read](const auto& r) { return r.get() == read; });
+        std::swap(*found, inFlight.back());
+        inFlight.pop_back();
+    };
+
+    for (;;)
+    {
+        // Start as many waiting reads as the queue holds, blocking only when there is nothing to wait for
+        Request request;
+        while (inFlight.size() < mQueueDepth && popRequest(request, inFlight.empty()))
+        {
+            FileView packed;
+            if (openPackedFile(request.path, packed))
+            {
+                complete(request, std::move(packed));
+                continue;
+            }
+
+            size_t size = 0;
+            const int file = openForRead(request.path, size);
+            if (file == -1)
+            {
+                complete(request, FileView());
+                continue;
+            }
+
+            if (size == 0)
+            {
+                ::close(file);
+                complete(request, FileView::fromBuffer(nullptr, 0));
+                continue;
+            }
+
+            auto read = std::make_unique<Read>();
+            read->request = std::move(request);
+            read->file = file;
+            read->size = size;
+            read->offset = 0;
+            read->buffer = std::make_unique<char[]>(size);
+            ring.queueRead(read.get());
+            inFlight.push_back(std::move(read));
+        }
+
+        if (inFlight.empty())
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (bStopping) break;
+            continue;
+        }
+
+        // Submit the batch, with any reads the kernel did not take last time, in one call and wait for a completion
+        if (!ring.enter(1))
+        {
+            // Only reads that never reached the kernel can fail now, it still writes into the buffers of the
+            // others, which complete through the queue below
+            const int error = errno;
+            const std::vector<Read*> notSubmitted = ring.unqueue();
+            if (!notSubmitted.empty())
+            {
+                logErr("AsyncIO: io_uring_enter failed ({}), failing {} reads", std::strerror(error), notSubmitted.size());
+            }
+            for (Read* read : notSubmitted) finish(read, false);
+        }
+
+        unsigned head = *ring.cqHead;
+        const unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+            auto* read = reinterpret_cast<Read*>(cqe.user_data);
+
+            if (cqe.res <= 0)
+            {
+                finish(read, false);
+                continue;
+            }
+
+            // Short reads continue where they stopped, submitted with the next enter
+            read->offset += static_cast<size_t>(cqe.res);
+            if (read->offset < read->size)
+            {
+                ring.queueRead(read);
+            }
+            else
+            {
+                finish(read, true);
+            }
+        }
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+}
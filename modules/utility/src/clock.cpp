@@ -20,3 +20,9 @@ const Clock::TimePoint Clock::now() const
 {
     return std::chrono::steady_clock::now();
 }
+
+const uint64_t Clock::nanoseconds()
+{
+    const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count());
+}
@@ -0,0 +1,173 @@
+#include "compression.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // Shortest match the format can encode
+    constexpr size_t MinMatch = 4;
+
+    // The last bytes of a block are always literals, and the last match starts at least MatchStartLimit bytes from the end
+    constexpr size_t LastLiterals = 5;
+    constexpr size_t MatchStartLimit = 12;
+
+    // Largest distance to a match
+    constexpr size_t MaxOffset = 65535;
+
+    // Size of the table of recent positions, by hash of the four bytes found there
+    constexpr unsigned HashBits = 14;
+
+    uint32_t read32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HashBits);
+    }
+
+    // Write a length that did not fit in its nibble of the token
+    void writeLength(std::vector<char>& out, size_t length)
+    {
+        while (length >= 255)
+        {
+            out.push_back(static_cast<char>(255));
+            length -= 255;
+        }
+        out.push_back(static_cast<char>(length));
+    }
+
+    // Read a length continued past its nibble, returns false if the block ends first
+    bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (in == end) return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // Write literals followed by a match, or only literals for the last sequence (matchLength 0)
+    void writeSequence(std::vector<char>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+    {
+        const size_t token = out.size();
+        out.push_back(0);
+
+        uint8_t tokenValue = static_cast<uint8_t>((literalCount < 15 ? literalCount : 15) << 4);
+        if (literalCount >= 15) writeLength(out, literalCount - 15);
+        out.insert(out.end(), literals, literals + literalCount);
+
+        if (matchLength > 0)
+        {
+            out.push_back(static_cast<char>(offset & 0xFF));
+            out.push_back(static_cast<char>(offset >> 8));
+
+            const size_t extra = matchLength - MinMatch;
+            tokenValue |= static_cast<uint8_t>(extra < 15 ? extra : 15);
+            if (extra >= 15) writeLength(out, extra - 15);
+        }
+
+        out[token] = static_cast<char>(tokenValue);
+    }
+}
+
+void compressLZ4(const char* source, size_t size, std::vector<char>& out)
+{
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+
+    const auto* in = reinterpret_cast<const uint8_t*>(source);
+    size_t anchor = 0;
+
+    if (size > MatchStartLimit)
+    {
+        // Positions are stored plus one, so zero means empty
+        std::vector<uint32_t> table(size_t(1) << HashBits, 0);
+
+        const size_t matchEndLimit = size - LastLiterals;
+        const size_t lastMatchStart = size - MatchStartLimit;
+
+        size_t position = 0;
+        while (position <= lastMatchStart)
+        {
+            const uint32_t sequence = read32(in + position);
+            const uint32_t slot = hash(sequence);
+            const size_t candidate = table[slot];
+            table[slot] = static_cast<uint32_t>(position + 1);
+
+            if (candidate == 0 || position - (candidate - 1) > MaxOffset || read32(in + candidate - 1) != sequence)
+            {
+                ++position;
+                continue;
+            }
+
+            // Extend the match as far as the trailing literals allow
+            const size_t match = candidate - 1;
+            size_t length = MinMatch;
+            while (position + length < matchEndLimit && in[match + length] == in[position + length])
+            {
+                ++length;
+            }
+
+            writeSequence(out, in + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+        }
+    }
+
+    writeSequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+bool decompressLZ4(const char* source, size_t size, char* out, size_t outSize)
+{
+    const auto* in = reinterpret_cast<const uint8_t*>(source);
+    const auto* inEnd = in + size;
+    auto* op = reinterpret_cast<uint8_t*>(out);
+    auto* const outBegin = op;
+    auto* const outEnd = op + outSize;
+
+    while (in < inEnd)
+    {
+        const uint8_t token = *in++;
+
+        // Literals
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(in, inEnd, literalCount)) return false;
+        if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > static_cast<size_t>(outEnd - op)) return false;
+
+        std::memcpy(op, in, literalCount);
+        in += literalCount;
+        op += literalCount;
+
+        // The last sequence has no match
+        if (in == inEnd) break;
+
+        // Match
+        if (inEnd - in < 2) return false;
+        const size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - outBegin)) return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength)) return false;
+        matchLength += MinMatch;
+        if (matchLength > static_cast<size_t>(outEnd - op)) return false;
+
+        // Byte by byte, a match may overlap the bytes it produces
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+        {
+            op[i] = match[i];
+        }
+        op += matchLength;
+    }
+
+    return op == outEnd;
+}
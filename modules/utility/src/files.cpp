@@ -1,18 +1,222 @@
 #include "files.h"
+#include "asyncIO.h"
 #include "logging.h"
+#include "resourcePack.h"
 
-#include <sstream>
-#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
 #include <experimental/filesystem>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FILES_USE_MMAP
+#endif
+
 using namespace std::experimental; // For filesystem access
 
+namespace
+{
+    // Below this size, mapping (syscalls and page faults) costs more than copying the file
+    constexpr size_t MinMappedSize = 16 * 1024;
+
+    // The working directory does not change while running, so find the resource folder once
+    const filesystem::path& resourceRoot()
+    {
+        static const filesystem::path root = filesystem::current_path() / "res";
+        return root;
+    }
+
+    // Packs searched by openFile, latest mounted first
+    std::vector<std::unique_ptr<ResourcePack>>& mountedPacks()
+    {
+        static std::vector<std::unique_ptr<ResourcePack>> packs;
+        return packs;
+    }
+}
+
+FileView::FileView(const std::string& filepath)
+{
+#ifdef FILES_USE_MMAP
+    const int file = ::open(filepath.c_str(), O_RDONLY);
+    if (file == -1) return;
+
+    struct stat info;
+    if (::fstat(file, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        ::close(file);
+        return;
+    }
+
+    bOpen = true;
+    mSize = static_cast<size_t>(info.st_size);
+    if (mSize >= MinMappedSize)
+    {
+        void* mapped = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapped != MAP_FAILED)
+        {
+            // Resources are read front to back once
+            ::madvise(mapped, mSize, MADV_SEQUENTIAL);
+            ::close(file);
+
+            mData = static_cast<const char*>(mapped);
+            bMapped = true;
+            return;
+        }
+    }
+
+    // Read the file in one go, the size is known
+    mBuffer = std::make_unique<char[]>(mSize);
+    size_t total = 0;
+    while (total < mSize)
+    {
+        const auto count = ::read(file, mBuffer.get() + total, mSize - total);
+        if (count <= 0) break;
+        total += static_cast<size_t>(count);
+    }
+    ::close(file);
+
+    mData = mBuffer.get();
+    mSize = total;
+#else
+    std::FILE* file = std::fopen(filepath.c_str(), "rb");
+    if (!file) return;
+
+    bOpen = true;
+    std::fseek(file, 0, SEEK_END);
+    const long length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (length > 0)
+    {
+        mBuffer = std::make_unique<char[]>(static_cast<size_t>(length));
+        mSize = std::fread(mBuffer.get(), 1, static_cast<size_t>(length), file);
+        mData = mBuffer.get();
+    }
+    std::fclose(file);
+#endif
+}
+
+FileView FileView::fromMemory(const char* data, size_t size)
+{
+    FileView view;
+    view.mData = data;
+    view.mSize = size;
+    view.bOpen = true;
+    return view;
+}
+
+FileView FileView::fromBuffer(std::unique_ptr<char[]> buffer, size_t size)
+{
+    FileView view;
+    view.mBuffer = std::move(buffer);
+    view.mData = view.mBuffer.get();
+    view.mSize = size;
+    view.bOpen = true;
+    return view;
+}
+
+FileView::FileView(FileView&& other) : mData(other.mData), mSize(other.mSize), bOpen(other.bOpen),
+                                       bMapped(other.bMapped), mBuffer(std::move(other.mBuffer))
+{
+    other.mData = nullptr;
+    other.mSize = 0;
+    other.bOpen = false;
+    other.bMapped = false;
+}
+
+FileView& FileView::operator=(FileView&& other)
+{
+    if (this == &other) return *this;
+
+    // Destructor Work
+    release();
+
+    // Steal Resources
+    mData = other.mData;
+    mSize = other.mSize;
+    bOpen = other.bOpen;
+    bMapped = other.bMapped;
+    mBuffer = std::move(other.mBuffer);
+
+    other.mData = nullptr;
+    other.mSize = 0;
+    other.bOpen = false;
+    other.bMapped = false;
+
+    return *this;
+}
+
+FileView::~FileView()
+{
+    release();
+}
+
+void FileView::release()
+{
+#ifdef FILES_USE_MMAP
+    if (bMapped) ::munmap(const_cast<char*>(mData), mSize);
+#endif
+    mBuffer.reset();
+    mData = nullptr;
+    mSize = 0;
+    bMapped = false;
+}
+
+bool openPackedFile(const std::string& filepath, FileView& out)
+{
+    auto& packs = mountedPacks();
+    if (packs.empty()) return false;
+
+    // Packs store resources by their name relative to the resource root
+    const std::string root = resourceRoot().string();
+    if (filepath.size() <= root.size() + 1 || filepath.compare(0, root.size(), root) != 0) return false;
+
+    std::string name = filepath.substr(root.size() + 1);
+    std::replace(name.begin(), name.end(), '\\', '/');
+
+    for (const auto& pack : packs)
+    {
+        if (pack->contains(name))
+        {
+            out = pack->open(name);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+FileView openFile(const std::string& filepath)
+{
+    FileView out;
+    if (auto* io = AsyncIO::prefetcher())
+    {
+        if (io->takePrefetched(filepath, out)) return out;
+    }
+
+    if (openPackedFile(filepath, out)) return out;
+
+    return FileView(filepath);
+}
+
+bool mountResourcePack(const std::string& packPath)
+{
+    auto pack = std::make_unique<ResourcePack>(packPath);
+    if (!pack->isOpen()) return false;
+
+    logInfo("Mounted resource pack {} with {} entries", packPath, pack->getEntryCount());
+    auto& packs = mountedPacks();
+    packs.insert(packs.begin(), std::move(pack));
+    return true;
+}
+
 const std::string readFile(const std::string& filepath) {
-    std::stringstream out;
-    std::ifstream file(filepath);
-    if (file.is_open()) {
-        out << file.rdbuf();
-        return out.str();
+    const FileView file = openFile(filepath);
+    if (file.isOpen()) {
+        return std::string(file.data(), file.size());
     }
     else
     {
@@ -25,10 +229,10 @@ std::string getResourcePath(const std::string& resourceName)
 {
     // Return the path to the resource in an OS-Agnostic way
 #ifndef NDEBUG
-    auto p = filesystem::v1::current_path().append("res").append(resourceName).string();
+    auto p = (resourceRoot() / resourceName).string();
     logInfo("Getting resource path: {}", p);
     return p;
 #else
-    return filesystem::v1::current_path().append("res").append(resourceName).string();
+    return (resourceRoot() / resourceName).string();
 #endif
 }
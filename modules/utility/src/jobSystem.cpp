@@ -0,0 +1,347 @@
+#include "jobSystem.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Deque of the calling thread, set for workers and the thread that created the job system
+    thread_local const JobSystem* tJobSystem = nullptr;
+    thread_local int tWorkerIndex = -1;
+
+    // Checks for new jobs before an idle worker goes to sleep
+    constexpr unsigned IdleSpins = 64;
+
+    // Ranges per thread parallelFor aims for when it picks the grain size, so stolen work evens out
+    constexpr unsigned RangesPerThread = 4;
+}
+
+JobSystem::WorkDeque::WorkDeque() : mJobs(std::make_unique<std::atomic<Job*>[]>(Capacity))
+{
+}
+
+bool JobSystem::WorkDeque::push(Job* job)
+{
+    const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+    const int64_t top = mTop.load(std::memory_order_acquire);
+    if (bottom - top >= Capacity) return false;
+
+    // Release publishes the job to thieves that read the bottom
+    mJobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+    mBottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job* JobSystem::WorkDeque::pop()
+{
+    const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // Empty
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = mJobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last job, race the thieves for it
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+Job* JobSystem::WorkDeque::steal()
+{
+    int64_t top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = mBottom.load(std::memory_order_acquire);
+    if (top >= bottom) return nullptr;
+
+    Job* job = mJobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+
+    return job;
+}
+
+JobSystem::JobSystem(unsigned workerCount)
+{
+    // The creating thread is worker 0
+    for (unsigned i = 0; i <= workerCount; ++i)
+    {
+        mDeques.push_back(std::make_unique<WorkDeque>());
+    }
+
+    tJobSystem = this;
+    tWorkerIndex = 0;
+
+    for (unsigned i = 1; i <= workerCount; ++i)
+    {
+        mThreads.emplace_back(&JobSystem::workerThread, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        bStopping.store(true);
+    }
+    mWake.notify_all();
+
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+
+    if (tJobSystem == this)
+    {
+        tJobSystem = nullptr;
+        tWorkerIndex = -1;
+    }
+}
+
+void JobSystem::run(std::function<void()> task, JobCounter& counter)
+{
+    Job* job = new Job();
+    job->task = std::move(task);
+    job->counter = &counter;
+
+    counter.mCount.fetch_add(1, std::memory_order_relaxed);
+    submit(job);
+}
+
+void JobSystem::run(std::function<void()> task, JobCounter& counter, JobCounter& dependency)
+{
+    Job* job = new Job();
+    job->task = std::move(task);
+    job->counter = &counter;
+    counter.mCount.fetch_add(1, std::memory_order_relaxed);
+
+    // The lock orders this with the job that brings the dependency to zero
+    {
+        std::lock_guard<std::mutex> lock(dependency.mMutex);
+        if (dependency.mCount.load(std::memory_order_acquire) != 0)
+        {
+            dependency.mContinuations.push_back(job);
+            return;
+        }
+    }
+
+    submit(job);
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+    const int index = workerIndex();
+    while (!counter.done())
+    {
+        if (Job* job = findJob(index))
+        {
+            execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The job that finished the counter may still hold its lock, wait for it so the counter can be destroyed
+    std::lock_guard<std::mutex> lock(const_cast<JobCounter&>(counter).mMutex);
+}
+
+void JobSystem::workerThread(unsigned index)
+{
+    tJobSystem = this;
+    tWorkerIndex = static_cast<int>(index);
+    Profiler::setThreadName("Job Worker " + std::to_string(index));
+
+    while (!bStopping.load(std::memory_order_relaxed))
+    {
+        if (Job* job = findJob(static_cast<int>(index)))
+        {
+            execute(job);
+            continue;
+        }
+
+        // Spin briefly, jobs often come in bursts
+        unsigned spins = 0;
+        while (spins < IdleSpins && mQueued.load(std::memory_order_relaxed) == 0)
+        {
+            std::this_thread::yield();
+            ++spins;
+        }
+        if (spins < IdleSpins) continue;
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleeping.fetch_add(1, std::memory_order_seq_cst);
+        mWake.wait(lock, [this]() { return bStopping.load() || mQueued.load(std::memory_order_seq_cst) != 0; });
+        mSleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::submit(Job* job)
+{
+    const int index = workerIndex();
+    if (index >= 0)
+    {
+        // A full deque means the job is better off run right away than queued
+        if (!mDeques[index]->push(job))
+        {
+            execute(job);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(mSharedMutex);
+        mShared.push_back(job);
+    }
+
+    mQueued.fetch_add(1, std::memory_order_seq_cst);
+    if (mSleeping.load(std::memory_order_seq_cst) != 0)
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mWake.notify_one();
+    }
+}
+
+Job* JobSystem::findJob(int index)
+{
+    Job* job = nullptr;
+    if (index >= 0) job = mDeques[index]->pop();
+
+    if (!job && mQueued.load(std::memory_order_relaxed) != 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mSharedMutex);
+            if (!mShared.empty())
+            {
+                job = mShared.front();
+                mShared.pop_front();
+            }
+        }
+
+        // Steal from the others, starting after this worker so thieves spread out
+        const auto count = static_cast<unsigned>(mDeques.size());
+        const unsigned start = index >= 0 ? static_cast<unsigned>(index) + 1 : 0;
+        for (unsigned i = 0; !job && i < count; ++i)
+        {
+            const unsigned victim = (start + i) % count;
+            if (static_cast<int>(victim) != index) job = mDeques[victim]->steal();
+        }
+    }
+
+    if (job) mQueued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::execute(Job* job)
+{
+    PROFILE_SCOPE("Job");
+
+    if (job->range)
+    {
+        // Keep the lower half and hand out the upper one, thieves take the largest ranges from the top
+        while (job->end - job->begin > job->grainSize)
+        {
+            const unsigned middle = job->begin + (job->end - job->begin) / 2;
+
+            Job* half = new Job();
+            half->range = job->range;
+            half->data = job->data;
+            half->begin = middle;
+            half->end = job->end;
+            half->grainSize = job->grainSize;
+            half->counter = job->counter;
+            job->counter->mCount.fetch_add(1, std::memory_order_relaxed);
+            submit(half);
+
+            job->end = middle;
+        }
+
+        job->range(job->data, job->begin, job->end);
+    }
+    else
+    {
+        job->task();
+    }
+
+    JobCounter* counter = job->counter;
+    delete job;
+    if (counter) finish(*counter);
+}
+
+void JobSystem::finish(JobCounter& counter)
+{
+    // Not the last job, no one can be waiting on the lock
+    unsigned count = counter.mCount.load(std::memory_order_relaxed);
+    while (count > 1)
+    {
+        if (counter.mCount.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) return;
+    }
+
+    // Possibly the last job, hold the lock while reaching zero so continuations are not missed
+    std::vector<Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter.mMutex);
+        if (counter.mCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            ready.swap(counter.mContinuations);
+        }
+    }
+
+    for (Job* job : ready)
+    {
+        submit(job);
+    }
+}
+
+const int JobSystem::workerIndex() const
+{
+    return tJobSystem == this ? tWorkerIndex : -1;
+}
+
+void JobSystem::parallelForRange(unsigned first, unsigned last, unsigned grainSize,
+                                 void (*range)(void*, unsigned, unsigned), void* data)
+{
+    if (first >= last) return;
+
+    const unsigned count = last - first;
+    if (grainSize == 0)
+    {
+        grainSize = std::max(1u, count / (getThreadCount() * RangesPerThread));
+    }
+
+    // Too small to split, jobs would only add overhead
+    if (count <= grainSize)
+    {
+        range(data, first, last);
+        return;
+    }
+
+    JobCounter counter;
+    Job* job = new Job();
+    job->range = range;
+    job->data = data;
+    job->begin = first;
+    job->end = last;
+    job->grainSize = grainSize;
+    job->counter = &counter;
+    counter.mCount.store(1, std::memory_order_relaxed);
+
+    execute(job);
+    wait(counter);
+}
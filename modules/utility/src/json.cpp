@@ -0,0 +1,29 @@
+#include "json.h"
+
+void writeJsonString(std::FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (; *text; ++text)
+    {
+        const char c = *text;
+        if (c == '"' || c == '\\')
+        {
+            std::fputc('\\', file);
+            std::fputc(c, file);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            std::fprintf(file, "\\u%04x", c);
+        }
+        else
+        {
+            std::fputc(c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+void writeJsonString(std::FILE* file, const std::string& text)
+{
+    writeJsonString(file, text.c_str());
+}
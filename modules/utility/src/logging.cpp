@@ -0,0 +1,252 @@
+#include "logging.h"
+
+#if __has_include("spdlog/sinks/stdout_color_sinks.h")
+#include "spdlog/sinks/stdout_color_sinks.h"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A message in the queue, claimed by a producer and formatted in place
+struct detail::LogSlot
+{
+    std::atomic<size_t> sequence{ 0 };
+    size_t position = 0;
+    spdlog::level::level_enum level = spdlog::level::info;
+    spdlog::log_clock::time_point time;
+    size_t length = 0;
+    char text[MaxLogMessageLength];
+    std::string longText;
+};
+
+namespace
+{
+    using detail::LogSlot;
+    using detail::MaxLogMessageLength;
+
+    // Bounded multi producer queue of messages. Producers claim a slot with a compare exchange on the tail,
+    // each slot carries a sequence number that tells whether it is free or holds a message for the consumer
+    class LogQueue
+    {
+    public:
+        explicit LogQueue(unsigned size)
+        {
+            // Round up to a power of two so positions wrap with a mask
+            unsigned capacity = 2;
+            while (capacity < size) capacity *= 2;
+
+            mSlots = std::vector<LogSlot>(capacity);
+            mMask = capacity - 1;
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Claim a slot for a message, nullptr if the queue is full. The time is taken here so it is when the
+        // call was made
+        LogSlot* claim()
+        {
+            size_t position = mTail.load(std::memory_order_relaxed);
+            LogSlot* slot = nullptr;
+            for (;;)
+            {
+                slot = &mSlots[position & mMask];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+                if (difference == 0)
+                {
+                    if (mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                }
+                else if (difference < 0)
+                {
+                    return nullptr;
+                }
+                else
+                {
+                    position = mTail.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->position = position;
+            slot->time = spdlog::log_clock::now();
+            return slot;
+        }
+
+        // Hand a claimed slot holding its message to the consumer
+        void publish(LogSlot* slot)
+        {
+            slot->sequence.store(slot->position + 1, std::memory_order_release);
+        }
+
+        // Take the oldest message, only called from the logging thread
+        bool pop(spdlog::level::level_enum& level, spdlog::log_clock::time_point& time, std::string& text)
+        {
+            LogSlot& slot = mSlots[mHead & mMask];
+            if (slot.sequence.load(std::memory_order_acquire) != mHead + 1) return false;
+
+            level = slot.level;
+            time = slot.time;
+            if (slot.length <= MaxLogMessageLength)
+            {
+                text.assign(slot.text, slot.length);
+            }
+            else
+            {
+                text = std::move(slot.longText);
+                slot.longText = std::string();
+            }
+            slot.sequence.store(mHead + mMask + 1, std::memory_order_release);
+            ++mHead;
+            return true;
+        }
+
+    private:
+        std::vector<LogSlot> mSlots;
+        size_t mMask = 0;
+
+        // Written by producers and the consumer on their own cache lines
+        alignas(64) std::atomic<size_t> mTail{ 0 };
+        alignas(64) size_t mHead = 0;
+    };
+
+    // State of the background thread
+    struct AsyncLog
+    {
+        std::unique_ptr<LogQueue> queue;
+        std::shared_ptr<spdlog::logger> logger;
+        std::thread thread;
+        std::atomic<bool> running{ false };
+        std::atomic<unsigned> dropped{ 0 };
+
+        // Wakes the thread when it sleeps on an empty queue
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::atomic<bool> sleeping{ false };
+
+        // Stop the thread if the application exits without shutting logging down
+        ~AsyncLog()
+        {
+            if (!thread.joinable()) return;
+
+            running.store(false, std::memory_order_release);
+            wake.notify_one();
+            thread.join();
+        }
+    };
+
+    AsyncLog& asyncLog()
+    {
+        static AsyncLog state;
+        return state;
+    }
+
+    // Write every queued message, returns whether there were any
+    bool drain(AsyncLog& state)
+    {
+        spdlog::level::level_enum level;
+        spdlog::log_clock::time_point time;
+        std::string text;
+        bool wroteAny = false;
+        bool flush = false;
+        while (state.queue->pop(level, time, text))
+        {
+            state.logger->log(time, spdlog::source_loc{}, level, spdlog::string_view_t(text.data(), text.size()));
+            flush |= level >= spdlog::level::err;
+            wroteAny = true;
+        }
+
+        const unsigned dropped = state.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            state.logger->warn("Logging: Queue full, dropped {} messages", dropped);
+        }
+
+        // Errors are written out right away in case the application is about to go down
+        if (flush) state.logger->flush();
+        return wroteAny;
+    }
+
+    void logThread(AsyncLog& state)
+    {
+        while (state.running.load(std::memory_order_acquire))
+        {
+            if (drain(state)) continue;
+
+            // Sleep until a producer wakes us, the timeout covers a wake that races with going to sleep
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.sleeping.store(true, std::memory_order_seq_cst);
+            state.wake.wait_for(lock, std::chrono::milliseconds(10));
+            state.sleeping.store(false, std::memory_order_relaxed);
+        }
+
+        drain(state);
+        state.logger->flush();
+    }
+}
+
+std::shared_ptr<spdlog::logger> initLogging(bool async, unsigned queueSize)
+{
+    auto logger = spdlog::get(detail::logName);
+    if (!logger) logger = spdlog::stdout_color_mt(detail::logName);
+    detail::cachedLogger.store(logger.get(), std::memory_order_release);
+
+    auto& state = asyncLog();
+    if (async && !state.running.load())
+    {
+        state.queue = std::make_unique<LogQueue>(queueSize);
+        state.logger = logger;
+        state.running.store(true, std::memory_order_release);
+        state.thread = std::thread(logThread, std::ref(state));
+        detail::asyncLogging.store(true, std::memory_order_release);
+    }
+
+    return logger;
+}
+
+void shutdownLogging()
+{
+    auto& state = asyncLog();
+    if (!state.running.load()) return;
+
+    // Log calls after this point are written synchronously
+    detail::asyncLogging.store(false, std::memory_order_release);
+    state.running.store(false, std::memory_order_release);
+    state.wake.notify_one();
+    state.thread.join();
+
+    // The queue stays, a log call that saw async logging still on may be pushing to it
+    state.logger.reset();
+}
+
+detail::LogSlot* detail::claimLogSlot(char*& text)
+{
+    auto& state = asyncLog();
+    LogSlot* slot = state.queue->claim();
+    if (!slot)
+    {
+        state.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    text = slot->text;
+    return slot;
+}
+
+void detail::publishLogSlot(LogSlot* slot, spdlog::level::level_enum level, size_t length, std::string&& longText)
+{
+    slot->level = level;
+    slot->length = length;
+    if (length > MaxLogMessageLength) slot->longText = std::move(longText);
+
+    auto& state = asyncLog();
+    state.queue->publish(slot);
+    if (state.sleeping.load(std::memory_order_seq_cst))
+    {
+        state.wake.notify_one();
+    }
+}
@@ -0,0 +1,299 @@
+#include "profiler.h"
+#include "json.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+namespace
+{
+    // Frames kept for the profiler panel
+    constexpr size_t HistorySize = 300;
+
+    // Longest capture, about a minute at 60 frames per second
+    constexpr size_t MaxCaptureFrames = 3600;
+
+    struct ProfilerState
+    {
+        // Guards the buffers and track names, taken when a track is added and once per frame
+        std::mutex mutex;
+        std::vector<std::shared_ptr<detail::ProfileBuffer>> buffers;
+        std::vector<std::string> trackNames;
+
+        // Only touched by the thread calling endFrame
+        std::deque<ProfileFrame> history;
+        std::vector<ProfileFrame> capture;
+        bool bCapturing = false;
+        uint64_t frameIndex = 0;
+        uint64_t frameStart = 0;
+    };
+
+    ProfilerState& profilerState()
+    {
+        static ProfilerState state;
+        return state;
+    }
+
+    // Keeps the buffer alive while the thread runs, the state keeps it after the thread exits
+    thread_local std::shared_ptr<detail::ProfileBuffer> tBuffer = nullptr;
+
+    // Move the finished zones of a buffer to the frame, returns how many were dropped since the last time
+    unsigned drainBuffer(detail::ProfileBuffer& buffer, std::vector<ProfileEvent>& out)
+    {
+        const uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+        const uint64_t head = buffer.head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i != head; ++i)
+        {
+            out.push_back(buffer.events[i & (detail::ProfileBuffer::Capacity - 1)]);
+        }
+        buffer.tail.store(head, std::memory_order_release);
+
+        return buffer.dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Zones are written when they close, children before their parent. Order them by track and start
+    void sortEvents(std::vector<ProfileEvent>& events)
+    {
+        std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+        {
+            if (a.track != b.track) return a.track < b.track;
+            return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+        });
+    }
+
+    // Add zones to the frame with the index in frames, if it is there
+    template<typename Frames>
+    void addToFrame(Frames& frames, uint64_t frameIndex, const std::vector<ProfileEvent>& events)
+    {
+        if (frames.empty() || frameIndex < frames.front().index || frameIndex > frames.back().index) return;
+
+        // Frames are consecutive
+        auto& frame = frames[static_cast<size_t>(frameIndex - frames.front().index)];
+        frame.events.insert(frame.events.end(), events.begin(), events.end());
+        sortEvents(frame.events);
+    }
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    const auto& buffer = threadBuffer();
+    auto& state = profilerState();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.trackNames[buffer.track] = name;
+}
+
+void Profiler::beginFrame()
+{
+    profilerState().frameStart = Clock::nanoseconds();
+}
+
+void Profiler::endFrame()
+{
+    auto& state = profilerState();
+
+    ProfileFrame frame;
+    frame.index = state.frameIndex++;
+    frame.end = Clock::nanoseconds();
+    frame.start = state.frameStart != 0 ? state.frameStart : frame.end;
+
+    std::vector<std::shared_ptr<detail::ProfileBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        buffers = state.buffers;
+    }
+
+    unsigned dropped = 0;
+    for (const auto& buffer : buffers)
+    {
+        dropped += drainBuffer(*buffer, frame.events);
+    }
+    if (dropped > 0)
+    {
+        logWarn("Profiler: Zone buffers full, dropped {} zones", dropped);
+    }
+
+    sortEvents(frame.events);
+
+    if (state.bCapturing)
+    {
+        if (state.capture.size() < MaxCaptureFrames)
+        {
+            state.capture.push_back(frame);
+        }
+        else
+        {
+            logWarn("Profiler: Capture reached {} frames, stopping", MaxCaptureFrames);
+            state.bCapturing = false;
+        }
+    }
+
+    state.history.push_back(std::move(frame));
+    if (state.history.size() > HistorySize)
+    {
+        state.history.pop_front();
+    }
+
+    state.frameStart = 0;
+}
+
+uint64_t Profiler::getFrameIndex()
+{
+    return profilerState().frameIndex;
+}
+
+const std::deque<ProfileFrame>& Profiler::getHistory()
+{
+    return profilerState().history;
+}
+
+uint32_t Profiler::addTrack(const std::string& name)
+{
+    auto& state = profilerState();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.trackNames.push_back(name);
+    return static_cast<uint32_t>(state.trackNames.size() - 1);
+}
+
+void Profiler::addEvents(uint64_t frameIndex, const std::vector<ProfileEvent>& events)
+{
+    auto& state = profilerState();
+    addToFrame(state.history, frameIndex, events);
+    addToFrame(state.capture, frameIndex, events);
+}
+
+std::vector<std::string> Profiler::getTrackNames()
+{
+    auto& state = profilerState();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.trackNames;
+}
+
+void Profiler::startCapture()
+{
+    auto& state = profilerState();
+    state.capture.clear();
+    state.bCapturing = true;
+}
+
+void Profiler::stopCapture()
+{
+    profilerState().bCapturing = false;
+}
+
+bool Profiler::isCapturing()
+{
+    return profilerState().bCapturing;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filepath)
+{
+    auto& state = profilerState();
+
+    std::FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+    {
+        logErr("Profiler: Failed to create trace {}", filepath);
+        return false;
+    }
+
+    const auto trackNames = getTrackNames();
+    std::fputs("{\"traceEvents\":[\n", file);
+
+    // Name the tracks so the viewer shows threads by name instead of by id
+    bool first = true;
+    for (size_t track = 0; track != trackNames.size(); ++track)
+    {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":",
+                     first ? "" : ",\n", track);
+        writeJsonString(file, trackNames[track].c_str());
+        std::fputs("}}", file);
+        first = false;
+    }
+
+    // Complete events with times in microseconds relative to the first frame
+    auto writeFrames = [&](const auto& frames)
+    {
+        if (frames.empty()) return;
+
+        const uint64_t origin = frames.front().start;
+        for (const auto& frame : frames)
+        {
+            for (const auto& event : frame.events)
+            {
+                std::fputs(first ? "{\"name\":" : ",\n{\"name\":", file);
+                writeJsonString(file, event.name);
+                std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             event.track,
+                             (static_cast<double>(event.start) - static_cast<double>(origin)) / 1000.0,
+                             static_cast<double>(event.end - event.start) / 1000.0);
+                first = false;
+            }
+        }
+    };
+
+    if (!state.capture.empty())
+    {
+        writeFrames(state.capture);
+    }
+    else
+    {
+        writeFrames(state.history);
+    }
+
+    std::fputs("\n]}\n", file);
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if (failed)
+    {
+        logErr("Profiler: Failed to write trace {}", filepath);
+        return false;
+    }
+
+    return true;
+}
+
+detail::ProfileBuffer& Profiler::threadBuffer()
+{
+    if (!tBuffer)
+    {
+        auto& state = profilerState();
+        tBuffer = std::make_shared<detail::ProfileBuffer>();
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        tBuffer->track = static_cast<uint32_t>(state.trackNames.size());
+        state.buffers.push_back(tBuffer);
+        state.trackNames.push_back("Thread " + std::to_string(tBuffer->track));
+    }
+
+    return *tBuffer;
+}
+
+void ProfileZone::begin(const char* name)
+{
+    mBuffer = &Profiler::threadBuffer();
+    mName = name;
+    mDepth = mBuffer->depth++;
+    mStart = Clock::nanoseconds();
+}
+
+void ProfileZone::end()
+{
+    const uint64_t now = Clock::nanoseconds();
+    --mBuffer->depth;
+
+    // Only this thread writes the head, endFrame moves the tail
+    const uint64_t head = mBuffer->head.load(std::memory_order_relaxed);
+    if (head - mBuffer->tail.load(std::memory_order_acquire) >= detail::ProfileBuffer::Capacity)
+    {
+        mBuffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    mBuffer->events[head & (detail::ProfileBuffer::Capacity - 1)] = ProfileEvent{ mName, mStart, now, mBuffer->track, mDepth };
+    mBuffer->head.store(head + 1, std::memory_order_release);
+}
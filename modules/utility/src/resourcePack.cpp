@@ -0,0 +1,244 @@
+#include "resourcePack.h"
+#include "compression.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <experimental/filesystem>
+#include <vector>
+
+using namespace std::experimental; // For filesystem access
+
+namespace
+{
+    // Entry data starts on this alignment, so the mapped resources can be read in place by any type
+    constexpr uint64_t DataAlignment = 16;
+
+    // Only keep compressed data that saves this much, decompressing nearly incompressible files (e.g. PNG) is wasted time
+    constexpr double MaxCompressedRatio = 0.9;
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+ResourcePack::ResourcePack(const std::string& packPath) : mFile(packPath)
+{
+    if (!mFile.isOpen()) return;
+
+    if (mFile.size() < sizeof(PackHeader))
+    {
+        logErr("Resource pack {} is too small to be a pack!", packPath);
+        return;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, mFile.data(), sizeof(header));
+    if (header.magic != PackMagic || header.version != PackVersion)
+    {
+        logErr("Resource pack {} has the wrong format or version!", packPath);
+        return;
+    }
+
+    const uint64_t directoryEnd = sizeof(PackHeader) + uint64_t(header.entryCount) * sizeof(PackEntry) + header.namesSize;
+    if (directoryEnd > mFile.size())
+    {
+        logErr("Resource pack {} is truncated!", packPath);
+        return;
+    }
+
+    mEntries = reinterpret_cast<const PackEntry*>(mFile.data() + sizeof(PackHeader));
+    mEntryCount = header.entryCount;
+    mNames = mFile.data() + sizeof(PackHeader) + header.entryCount * sizeof(PackEntry);
+
+    for (unsigned i = 0; i < mEntryCount; ++i)
+    {
+        const auto& entry = mEntries[i];
+        if (entry.storedSize > mFile.size() || entry.offset > mFile.size() - entry.storedSize ||
+            uint64_t(entry.nameOffset) + entry.nameLength > header.namesSize)
+        {
+            logErr("Resource pack {} has entries outside the pack!", packPath);
+            return;
+        }
+
+        // Uncompressed entries are viewed in place with their size, which must be what is stored
+        if (!(entry.flags & PackEntryCompressed) && entry.size != entry.storedSize)
+        {
+            logErr("Resource pack {} has an uncompressed entry with the wrong size!", packPath);
+            return;
+        }
+    }
+
+    bOpen = true;
+}
+
+const bool ResourcePack::contains(const std::string& name) const
+{
+    return find(name) != nullptr;
+}
+
+FileView ResourcePack::open(const std::string& name) const
+{
+    const PackEntry* entry = find(name);
+    if (!entry) return FileView();
+
+    const char* data = mFile.data() + entry->offset;
+    if (!(entry->flags & PackEntryCompressed))
+    {
+        return FileView::fromMemory(data, static_cast<size_t>(entry->size));
+    }
+
+    auto buffer = std::make_unique<char[]>(static_cast<size_t>(entry->size));
+    if (!decompressLZ4(data, static_cast<size_t>(entry->storedSize), buffer.get(), static_cast<size_t>(entry->size)))
+    {
+        logErr("Resource pack entry {} is corrupt!", name);
+        return FileView();
+    }
+
+    return FileView::fromBuffer(std::move(buffer), static_cast<size_t>(entry->size));
+}
+
+const PackEntry* ResourcePack::find(const std::string& name) const
+{
+    if (!bOpen) return nullptr;
+
+    const uint64_t nameHash = hashResourceName(name.data(), name.size());
+    const PackEntry* end = mEntries + mEntryCount;
+    const PackEntry* entry = std::lower_bound(mEntries, end, nameHash,
+                                              [](const PackEntry& e, uint64_t value) { return e.nameHash < value; });
+
+    // Compare names to rule out hash collisions
+    for (; entry != end && entry->nameHash == nameHash; ++entry)
+    {
+        if (entry->nameLength == name.size() && std::memcmp(mNames + entry->nameOffset, name.data(), name.size()) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+uint64_t hashResourceName(const char* name, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<uint8_t>(name[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool writeResourcePack(const std::string& sourceDir, const std::string& packPath, bool compress)
+{
+    struct PendingEntry
+    {
+        std::string name;
+        std::vector<char> data;
+        uint64_t size;
+        uint32_t flags;
+    };
+
+    // Read every file, named relative to the source folder
+    std::vector<PendingEntry> pending;
+    const filesystem::path root(sourceDir);
+    for (const auto& item : filesystem::recursive_directory_iterator(root))
+    {
+        if (!filesystem::is_regular_file(item.status())) continue;
+
+        std::string name = item.path().string().substr(root.string().size());
+        std::replace(name.begin(), name.end(), '\\', '/');
+        while (!name.empty() && name.front() == '/') name.erase(name.begin());
+
+        const FileView file(item.path().string());
+        if (!file.isOpen())
+        {
+            logErr("Resource packer failed to read {}", item.path().string());
+            return false;
+        }
+
+        PendingEntry entry{ name, std::vector<char>(file.begin(), file.end()), file.size(), 0 };
+        if (compress && file.size() > 0)
+        {
+            std::vector<char> compressed;
+            compressLZ4(file.data(), file.size(), compressed);
+            if (compressed.size() < file.size() * MaxCompressedRatio)
+            {
+                entry.data = std::move(compressed);
+                entry.flags |= PackEntryCompressed;
+            }
+        }
+
+        pending.push_back(std::move(entry));
+    }
+
+    // Sort by hash for the binary search, names break ties so packs are reproducible
+    std::sort(pending.begin(), pending.end(), [](const PendingEntry& a, const PendingEntry& b)
+    {
+        const auto hashA = hashResourceName(a.name.data(), a.name.size());
+        const auto hashB = hashResourceName(b.name.data(), b.name.size());
+        return hashA != hashB ? hashA < hashB : a.name < b.name;
+    });
+
+    // Lay out the directory, names and data
+    std::vector<PackEntry> entries;
+    std::string names;
+    for (const auto& item : pending)
+    {
+        PackEntry entry{};
+        entry.nameHash = hashResourceName(item.name.data(), item.name.size());
+        entry.storedSize = item.data.size();
+        entry.size = item.size;
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint32_t>(item.name.size());
+        entry.flags = item.flags;
+        names += item.name;
+        entries.push_back(entry);
+    }
+
+    const PackHeader header{ PackMagic, PackVersion, static_cast<uint32_t>(entries.size()), static_cast<uint32_t>(names.size()) };
+    uint64_t offset = alignUp(sizeof(PackHeader) + entries.size() * sizeof(PackEntry) + names.size(), DataAlignment);
+    for (auto& entry : entries)
+    {
+        entry.offset = offset;
+        offset = alignUp(offset + entry.storedSize, DataAlignment);
+    }
+
+    std::FILE* file = std::fopen(packPath.c_str(), "wb");
+    if (!file)
+    {
+        logErr("Resource packer failed to create {}", packPath);
+        return false;
+    }
+
+    // Write everything in order, padding up to each entry's offset. Short writes are caught by ferror below
+    const char padding[DataAlignment] = {};
+    uint64_t written = 0;
+    auto write = [&](const void* data, size_t size)
+    {
+        std::fwrite(data, 1, size, file);
+        written += size;
+    };
+
+    write(&header, sizeof(header));
+    write(entries.data(), entries.size() * sizeof(PackEntry));
+    write(names.data(), names.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        write(padding, static_cast<size_t>(entries[i].offset - written));
+        write(pending[i].data.data(), pending[i].data.size());
+    }
+
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed)
+    {
+        logErr("Resource packer failed to write {}", packPath);
+        return false;
+    }
+
+    return true;
+}
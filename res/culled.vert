@@ -0,0 +1,24 @@
+#version 450 core
+
+// Vertex Attributes
+layout (location=0) in vec4 aPosition;
+layout (location=1) in vec3 aColor;
+layout (location=2) in vec2 aTexCoord;
+
+// Transforms of the instances that survived GPU culling
+layout(std430, binding = 1) readonly buffer VisibleTransforms {
+    mat4 visibleTransforms[];
+};
+
+uniform mat4 viewProjection;
+
+// Out Parameters
+out vec4 fs_color;
+out vec2 fs_texCoord;
+
+// Main Func
+void main() {
+    gl_Position = viewProjection * visibleTransforms[gl_InstanceID] * vec4(aPosition.xyz, 1.f);
+    fs_color = vec4(aColor, 1);
+    fs_texCoord = aTexCoord;
+}
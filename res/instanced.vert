@@ -0,0 +1,23 @@
+#version 450 core
+
+// Vertex Attributes
+layout (location=0) in vec4 aPosition;
+layout (location=1) in vec3 aColor;
+layout (location=2) in vec2 aTexCoord;
+
+// Instance Attributes (advance once per instance)
+layout (location=3) in mat4 aTransform;
+layout (location=7) in vec4 aInstanceColor;
+
+uniform mat4 viewProjection;
+
+// Out Parameters
+out vec4 fs_color;
+out vec2 fs_texCoord;
+
+// Main Func
+void main() {
+    gl_Position = viewProjection * aTransform * vec4(aPosition.xyz, 1.f);
+    fs_color = vec4(aColor, 1) * aInstanceColor;
+    fs_texCoord = aTexCoord;
+}
@@ -0,0 +1,475 @@
+#include "clock.h"
+#include "glBackend.h"
+#include "glTrace.h"
+#include "headlessContext.h"
+#include "json.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gl_cpp.hpp"
+#include "spdlog/fmt/fmt.h"
+
+namespace
+{
+    constexpr size_t FunctionCount = static_cast<size_t>(EGLFunction::Count);
+
+    // Time spent in the calls of one function
+    struct FunctionTiming
+    {
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    // A mapped range of a buffer as it was traced, with where it is mapped in the replay
+    struct MappedRange
+    {
+        uint64_t offset;
+        uint64_t length;
+        unsigned char* data;
+    };
+
+    // Size of the window of OpenGLRendering, which traces do not record unless they set a viewport on it
+    constexpr GLsizei DefaultWindowWidth = 1280;
+    constexpr GLsizei DefaultWindowHeight = 720;
+
+    // Stands in for the default framebuffer of the trace, which a headless context does not have
+    struct WindowFramebuffer
+    {
+        GLuint name = 0;
+        GLuint color = 0;
+        GLuint depthStencil = 0;
+        GLsizei width = 0;
+        GLsizei height = 0;
+    };
+
+    struct ReplayState
+    {
+        std::vector<FunctionTiming> timings = std::vector<FunctionTiming>(FunctionCount);
+        std::vector<float> frameTimes;
+
+        // Functions that only read state back are not replayed, nothing uses what they return
+        std::vector<bool> bSkipped = std::vector<bool>(FunctionCount);
+
+        // Fences by the value they had in the trace, mappings by buffer
+        std::unordered_map<uintptr_t, GLsync> syncs;
+        std::unordered_map<GLuint, MappedRange> mappings;
+
+        // Draws and clears of framebuffer 0 go here, bound for drawing at first like the default framebuffer
+        WindowFramebuffer window;
+        bool bWindowBound = true;
+
+        uint64_t calls = 0;
+        uint64_t skippedCalls = 0;
+        uint64_t unknownCalls = 0;
+        uint64_t nameMismatches = 0;
+        uint64_t lostWrites = 0;
+    };
+
+    bool isSkipped(const char* name)
+    {
+        for (const char* prefix : { "Get", "Is", "ReadPixels", "ReadnPixels", "CheckFramebufferStatus", "CheckNamedFramebufferStatus",
+                                    "DebugMessageCallback", "ObjectPtrLabel" })
+        {
+            if (std::strncmp(name, prefix, std::strlen(prefix)) == 0) return true;
+        }
+        return false;
+    }
+
+    // (Re)create the storage of the window framebuffer, its name stays so it can stay bound
+    void resizeWindow(WindowFramebuffer& window, GLsizei width, GLsizei height)
+    {
+        if (!window.name) gl::CreateFramebuffers(1, &window.name);
+        if (window.color) gl::DeleteRenderbuffers(1, &window.color);
+        if (window.depthStencil) gl::DeleteRenderbuffers(1, &window.depthStencil);
+
+        gl::CreateRenderbuffers(1, &window.color);
+        gl::NamedRenderbufferStorage(window.color, gl::RGBA8, width, height);
+        gl::NamedFramebufferRenderbuffer(window.name, gl::COLOR_ATTACHMENT0, gl::RENDERBUFFER, window.color);
+
+        gl::CreateRenderbuffers(1, &window.depthStencil);
+        gl::NamedRenderbufferStorage(window.depthStencil, gl::DEPTH24_STENCIL8, width, height);
+        gl::NamedFramebufferRenderbuffer(window.name, gl::DEPTH_STENCIL_ATTACHMENT, gl::RENDERBUFFER, window.depthStencil);
+
+        window.width = width;
+        window.height = height;
+    }
+
+    // Point the framebuffer arguments that name the default framebuffer at the window framebuffer
+    template<EGLFunction F, typename Arguments>
+    void redirectDefaultFramebuffer(ReplayState& state, Arguments& arguments)
+    {
+        auto redirect = [&state](GLuint& framebuffer) { if (framebuffer == 0) framebuffer = state.window.name; };
+
+        if constexpr (F == EGLFunction::BindFramebuffer)
+        {
+            const GLenum target = std::get<0>(arguments);
+            if (target == gl::FRAMEBUFFER || target == gl::DRAW_FRAMEBUFFER) state.bWindowBound = std::get<1>(arguments) == 0;
+            redirect(std::get<1>(arguments));
+        }
+        else if constexpr (F == EGLFunction::BlitNamedFramebuffer)
+        {
+            redirect(std::get<0>(arguments));
+            redirect(std::get<1>(arguments));
+        }
+        else if constexpr (F == EGLFunction::ClearNamedFramebufferfi || F == EGLFunction::ClearNamedFramebufferfv ||
+                           F == EGLFunction::ClearNamedFramebufferiv || F == EGLFunction::ClearNamedFramebufferuiv)
+        {
+            redirect(std::get<0>(arguments));
+        }
+        else if constexpr (F == EGLFunction::Viewport)
+        {
+            // A viewport set on the default framebuffer tells how large the window was
+            const GLsizei width = std::get<0>(arguments) + std::get<2>(arguments);
+            const GLsizei height = std::get<1>(arguments) + std::get<3>(arguments);
+            if (state.bWindowBound && (width > state.window.width || height > state.window.height))
+            {
+                resizeWindow(state.window, std::max(width, state.window.width), std::max(height, state.window.height));
+            }
+        }
+    }
+
+    template<typename Tuple, typename Visit, size_t... I>
+    void forEachArgument(Tuple& arguments, Visit&& visit, std::index_sequence<I...>)
+    {
+        (visit(std::get<I>(arguments), static_cast<unsigned>(I)), ...);
+    }
+
+    template<typename... Args>
+    constexpr size_t argumentSize(const std::tuple<Args...>*)
+    {
+        return (sizeof(Args) + ... + 0);
+    }
+
+    // Make a traced call again, with pointers pointing at the payloads and fences made by the replay
+    template<EGLFunction F>
+    void replayCall(ReplayState& state, const GLTraceRecord& record)
+    {
+        using Signature = GLSignature<typename GLFunctionTraits<F>::Type>;
+        using Arguments = typename Signature::Arguments;
+        using Result = typename Signature::Result;
+
+        if (record.argumentSize != argumentSize(static_cast<const Arguments*>(nullptr)))
+        {
+            logErr("Replay: Arguments of {} do not match this build of the loader, skipping it", getGLFunctionName(F));
+            ++state.unknownCalls;
+            return;
+        }
+
+        const Arguments traced = GLCommand{ F, record.arguments, record.argumentSize }.getArguments<F>();
+        Arguments arguments = traced;
+
+        // What outputs are written to and the pointer arrays of strings, both alive until the call returned
+        std::vector<std::vector<unsigned char>> outputs;
+        std::vector<std::vector<const GLchar*>> strings;
+        outputs.reserve(record.payloads.size());
+        strings.reserve(record.payloads.size());
+
+        forEachArgument(arguments, [&](auto& value, unsigned index)
+        {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, GLsync>)
+            {
+                const auto it = state.syncs.find(reinterpret_cast<uintptr_t>(value));
+                value = it != state.syncs.end() ? it->second : nullptr;
+            }
+            else if constexpr (std::is_pointer_v<T> && !std::is_function_v<std::remove_pointer_t<T>>)
+            {
+                const GLTracePayload* payload = record.findPayload(index);
+                if (!payload) return;
+
+                if (payload->flags & GLTracePayload::Strings)
+                {
+                    if constexpr (std::is_same_v<T, const GLchar* const*>)
+                    {
+                        auto& pointers = strings.emplace_back();
+                        for (uint32_t offset = 0; offset < payload->size; offset += static_cast<uint32_t>(std::strlen(reinterpret_cast<const GLchar*>(payload->data + offset))) + 1)
+                        {
+                            pointers.push_back(reinterpret_cast<const GLchar*>(payload->data + offset));
+                        }
+                        value = pointers.data();
+                    }
+                }
+                else if (payload->flags & GLTracePayload::Output)
+                {
+                    auto& output = outputs.emplace_back(payload->data, payload->data + payload->size);
+                    value = reinterpret_cast<T>(output.data());
+                }
+                else
+                {
+                    value = reinterpret_cast<T>(const_cast<unsigned char*>(payload->data));
+                }
+            }
+        }, std::make_index_sequence<std::tuple_size_v<Arguments>>());
+        redirectDefaultFramebuffer<F>(state, arguments);
+
+        auto& timing = state.timings[static_cast<size_t>(F)];
+        const uint64_t start = Clock::nanoseconds();
+        std::conditional_t<std::is_void_v<Result>, char, Result> result{};
+        if constexpr (std::is_void_v<Result>)
+        {
+            std::apply(GLFunctionTraits<F>::pointer(), arguments);
+        }
+        else
+        {
+            result = std::apply(GLFunctionTraits<F>::pointer(), arguments);
+        }
+        const uint64_t elapsed = Clock::nanoseconds() - start;
+
+        ++timing.calls;
+        timing.totalNs += elapsed;
+        timing.maxNs = std::max(timing.maxNs, elapsed);
+        ++state.calls;
+
+        // Names are passed on as they were traced, which only works while the driver hands out the same ones
+        size_t outputIndex = 0;
+        for (const auto& payload : record.payloads)
+        {
+            if (!(payload.flags & GLTracePayload::Output)) continue;
+            if (std::memcmp(outputs[outputIndex++].data(), payload.data, payload.size) != 0) ++state.nameMismatches;
+        }
+
+        if constexpr (!std::is_void_v<Result>)
+        {
+            Result tracedResult{};
+            if (record.resultSize == sizeof(Result)) std::memcpy(&tracedResult, record.result, sizeof(Result));
+
+            if constexpr (F == EGLFunction::CreateShader || F == EGLFunction::CreateProgram || F == EGLFunction::CreateShaderProgramv)
+            {
+                if (result != tracedResult) ++state.nameMismatches;
+            }
+            else if constexpr (F == EGLFunction::FenceSync)
+            {
+                state.syncs[reinterpret_cast<uintptr_t>(tracedResult)] = result;
+            }
+            else if constexpr (F == EGLFunction::MapNamedBufferRange)
+            {
+                if (result)
+                {
+                    state.mappings[std::get<0>(traced)] = { static_cast<uint64_t>(std::get<1>(traced)), static_cast<uint64_t>(std::get<2>(traced)),
+                                                            static_cast<unsigned char*>(result) };
+                }
+            }
+            else if constexpr (F == EGLFunction::UnmapNamedBuffer)
+            {
+                state.mappings.erase(std::get<0>(traced));
+            }
+        }
+
+        if constexpr (F == EGLFunction::DeleteSync)
+        {
+            state.syncs.erase(reinterpret_cast<uintptr_t>(std::get<0>(traced)));
+        }
+    }
+
+    using ReplayFunction = void (*)(ReplayState&, const GLTraceRecord&);
+
+    const ReplayFunction replayFunctions[] = {
+#define GL_FUNCTION(name) &replayCall<EGLFunction::name>,
+#include "gl_cpp_functions.hpp"
+#undef GL_FUNCTION
+    };
+
+    void replayMappedWrite(ReplayState& state, const GLTraceRecord& record)
+    {
+        // Writes outside the traced range of the mapping would go past the replayed mapping
+        const auto it = state.mappings.find(record.buffer);
+        if (it == state.mappings.end() || record.offset < it->second.offset ||
+            record.offset - it->second.offset > it->second.length || record.size > it->second.length - (record.offset - it->second.offset))
+        {
+            ++state.lostWrites;
+            return;
+        }
+
+        std::memcpy(it->second.data + (record.offset - it->second.offset), record.data, record.size);
+    }
+
+    float percentile(const std::vector<float>& sorted, float fraction)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    void printResults(const ReplayState& state, float totalSeconds, unsigned top)
+    {
+        std::cout << fmt::format("Replayed {} calls in {} frames in {:.2f} s, {} queries skipped\n",
+                                 state.calls, state.frameTimes.size(), totalSeconds, state.skippedCalls);
+
+        if (!state.frameTimes.empty())
+        {
+            std::vector<float> sorted = state.frameTimes;
+            std::sort(sorted.begin(), sorted.end());
+            std::cout << fmt::format("Frame times: min {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms\n",
+                                     sorted.front(), percentile(sorted, 0.5f), percentile(sorted, 0.95f), percentile(sorted, 0.99f), sorted.back());
+        }
+
+        if (state.unknownCalls) std::cout << fmt::format("{} calls this build of the loader can not make were skipped\n", state.unknownCalls);
+        if (state.nameMismatches) std::cout << fmt::format("{} names differ from the trace, the driver hands out names differently and the replay is not faithful\n", state.nameMismatches);
+        if (state.lostWrites) std::cout << fmt::format("{} writes to mapped buffers had no mapping to go to or went past it\n", state.lostWrites);
+
+        std::vector<size_t> order;
+        for (size_t i = 0; i != FunctionCount; ++i)
+        {
+            if (state.timings[i].calls) order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return state.timings[a].totalNs > state.timings[b].totalNs; });
+        order.resize(std::min<size_t>(order.size(), top));
+
+        std::cout << fmt::format("\n{:<40} {:>10} {:>12} {:>10} {:>10}\n", "Function", "Calls", "Total ms", "Mean us", "Max us");
+        for (const size_t i : order)
+        {
+            const auto& timing = state.timings[i];
+            std::cout << fmt::format("{:<40} {:>10} {:>12.3f} {:>10.2f} {:>10.2f}\n", getGLFunctionName(static_cast<EGLFunction>(i)),
+                                     timing.calls, timing.totalNs * 1e-6, static_cast<double>(timing.totalNs) / timing.calls * 1e-3, timing.maxNs * 1e-3);
+        }
+    }
+
+    bool writeResults(const ReplayState& state, const std::string& filepath)
+    {
+        std::FILE* file = std::fopen(filepath.c_str(), "w");
+        if (!file)
+        {
+            logErr("Replay: Failed to write results to {}", filepath);
+            return false;
+        }
+
+        const auto* renderer = reinterpret_cast<const char*>(gl::GetString(gl::RENDERER));
+        std::fputs("{\n  \"renderer\": ", file);
+        writeJsonString(file, renderer ? renderer : "unknown");
+        std::fprintf(file, ",\n  \"calls\": %llu,\n  \"nameMismatches\": %llu,\n  \"frameTimesMs\": [",
+                     static_cast<unsigned long long>(state.calls), static_cast<unsigned long long>(state.nameMismatches));
+        for (size_t i = 0; i != state.frameTimes.size(); ++i)
+        {
+            std::fprintf(file, "%s%.4f", i == 0 ? "" : ", ", state.frameTimes[i]);
+        }
+
+        std::fputs("],\n  \"functions\": [", file);
+        bool bFirst = true;
+        for (size_t i = 0; i != FunctionCount; ++i)
+        {
+            const auto& timing = state.timings[i];
+            if (!timing.calls) continue;
+
+            std::fprintf(file, "%s\n    {\"name\": ", bFirst ? "" : ",");
+            writeJsonString(file, getGLFunctionName(static_cast<EGLFunction>(i)));
+            std::fprintf(file, ", \"calls\": %llu, \"totalMs\": %.6f, \"maxUs\": %.3f}", static_cast<unsigned long long>(timing.calls),
+                         timing.totalNs * 1e-6, timing.maxNs * 1e-3);
+            bFirst = false;
+        }
+        std::fputs("\n  ]\n}\n", file);
+        std::fclose(file);
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Usage: glReplay <trace> [--finish] [--top N] [--json results.json]\n"
+                  << "  --finish   Wait for the GPU at the end of every frame, so frame times include GPU work\n"
+                  << "  --top      Number of functions to list, the slowest in total first (default: 20)\n"
+                  << "  --json     Write frame times and the timings of every function to a file\n";
+    }
+
+    // Parse a whole unsigned number, false if the text is anything else
+    bool parseUnsigned(const char* text, unsigned& value)
+    {
+        const char* last = text + std::strlen(text);
+        const auto [end, error] = std::from_chars(text, last, value);
+        return error == std::errc() && end == last && end != text;
+    }
+}
+
+// Play a trace written with OpenGLRendering --trace back in a headless context and time every call
+// Usage: glReplay <trace> [--finish] [--top N] [--json results.json]
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    initLogging(false);
+
+    bool bFinish = false;
+    unsigned top = 20;
+    std::string resultsPath;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--finish") == 0) bFinish = true;
+        else if (std::strcmp(argv[i], "--top") == 0)
+        {
+            if (i + 1 >= argc || !parseUnsigned(argv[++i], top))
+            {
+                std::cerr << "Invalid value for --top\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) resultsPath = argv[++i];
+        else logWarn("Replay: Unknown argument {}", argv[i]);
+    }
+
+    GLTraceReader reader(argv[1]);
+    if (!reader.isValid()) return 1;
+
+    HeadlessContext context;
+    if (!context.isValid())
+    {
+        logErr("Replay: No headless GL context{}", HeadlessContext::isSupported() ? "" : ", glReplay was built without EGL");
+        return 1;
+    }
+
+    // Traces of the windowed application draw to the default framebuffer, which a headless context does not have.
+    // They draw into an offscreen framebuffer of the window size instead, so those draws cost what they did
+    ReplayState state;
+    resizeWindow(state.window, DefaultWindowWidth, DefaultWindowHeight);
+    gl::BindFramebuffer(gl::FRAMEBUFFER, state.window.name);
+    for (size_t i = 0; i != FunctionCount; ++i)
+    {
+        state.bSkipped[i] = isSkipped(getGLFunctionName(static_cast<EGLFunction>(i)));
+    }
+
+    const Clock runClock;
+    Clock frameClock;
+    GLTraceRecord record;
+    while (reader.next(record))
+    {
+        switch (record.type)
+        {
+        case EGLTraceRecord::Call:
+            if (record.function == EGLFunction::Count) ++state.unknownCalls;
+            else if (state.bSkipped[static_cast<size_t>(record.function)]) ++state.skippedCalls;
+            else replayFunctions[static_cast<size_t>(record.function)](state, record);
+            break;
+        case EGLTraceRecord::MappedWrite:
+            replayMappedWrite(state, record);
+            break;
+        case EGLTraceRecord::FrameEnd:
+            if (bFinish) gl::Finish();
+            state.frameTimes.push_back(frameClock.restart().count() * 1000.f);
+            break;
+        }
+    }
+
+    gl::Finish();
+    const float totalSeconds = runClock.timeSinceStart().count();
+    if (!reader.isValid()) logWarn("Replay: The trace is damaged, results are for the part before the damage");
+
+    logInfo("Replay: Drew the default framebuffer into a {}x{} offscreen framebuffer", state.window.width, state.window.height);
+    printResults(state, totalSeconds, top);
+    if (!resultsPath.empty() && !writeResults(state, resultsPath)) return 1;
+
+    return 0;
+}
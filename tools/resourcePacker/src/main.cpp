@@ -0,0 +1,25 @@
+#include "logging.h"
+#include "resourcePack.h"
+
+#include <cstring>
+#include <iostream>
+
+// Pack a resource folder into a resource pack
+// Usage: resourcePacker <resource folder> <pack file> [--store]
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: resourcePacker <resource folder> <pack file> [--store]\n"
+                  << "  --store    Do not compress entries\n";
+        return 1;
+    }
+
+    initLogging(false);
+
+    const bool compress = !(argc > 3 && std::strcmp(argv[3], "--store") == 0);
+    if (!writeResourcePack(argv[1], argv[2], compress)) return 1;
+
+    std::cout << "PACKING:\n" << argv[1] << " => " << argv[2] << "\n";
+    return 0;
+}